@@ -0,0 +1,585 @@
+#include "Client.h"
+#include "../ledger/Ledger.h"
+#include "lib/common/BinaryPack.hpp"
+#include "lib/common/Crypto.h"
+#include "lib/common/Logger.h"
+#include "lib/common/Utilities.h"
+
+#include <cli11.hpp>
+#include <json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t ID_GENESIS = 0;        // Native token (matches AccountBuffer)
+constexpr uint64_t ID_RESERVE = 2;        // Funds new accounts (matches AccountBuffer)
+constexpr uint64_t ID_FIRST_USER = 1ULL << 30;  // Min new account ID (matches AccountBuffer)
+
+/**
+ * LatencyHistogram - Log-linear histogram in the style of HdrHistogram.
+ *
+ * Values below 2^SUB_BUCKET_BITS get one bucket each; above that every power
+ * of two is split into 2^(SUB_BUCKET_BITS-1) buckets, so any recorded value is
+ * reported within 1/64 (about 1.6%) of its true value at a fixed memory cost.
+ */
+class LatencyHistogram {
+public:
+  void record(uint64_t value) {
+    ++counts_[getIndex(value)];
+    ++count_;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  void merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  uint64_t getCount() const { return count_; }
+
+  /** Highest value equivalent to the one at the percentile (0-100). */
+  uint64_t getValueAtPercentile(double percentile) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    const auto rank = static_cast<uint64_t>(
+        std::ceil(percentile / 100.0 * static_cast<double>(count_)));
+    const uint64_t target = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      seen += counts_[i];
+      if (seen >= target) {
+        return std::min(getHighestValue(i), max_);
+      }
+    }
+    return max_;
+  }
+
+  nlohmann::json toJson() const {
+    nlohmann::json j;
+    j["count"] = count_;
+    j["min"] = count_ ? min_ : 0;
+    j["mean"] = count_ ? sum_ / count_ : 0;
+    j["p50"] = getValueAtPercentile(50);
+    j["p90"] = getValueAtPercentile(90);
+    j["p99"] = getValueAtPercentile(99);
+    j["p999"] = getValueAtPercentile(99.9);
+    j["p9999"] = getValueAtPercentile(99.99);
+    j["max"] = max_;
+    return j;
+  }
+
+private:
+  static constexpr int SUB_BUCKET_BITS = 7;
+  static constexpr uint64_t SUB_BUCKET_COUNT = 1ULL << SUB_BUCKET_BITS;
+  static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+  static constexpr size_t BUCKET_COUNT =
+      (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+
+  static size_t getIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+      return static_cast<size_t>(value);
+    }
+    const int shift = std::bit_width(value) - SUB_BUCKET_BITS;
+    return static_cast<size_t>(shift * SUB_BUCKET_HALF + (value >> shift));
+  }
+
+  static uint64_t getHighestValue(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+      return index;
+    }
+    const uint64_t shift = index / SUB_BUCKET_HALF - 1;
+    const uint64_t mantissa = index - shift * SUB_BUCKET_HALF;
+    return ((mantissa + 1) << shift) - 1;
+  }
+
+  std::vector<uint64_t> counts_ = std::vector<uint64_t>(BUCKET_COUNT, 0);
+  uint64_t count_{ 0 };
+  uint64_t sum_{ 0 };
+  uint64_t min_{ std::numeric_limits<uint64_t>::max() };
+  uint64_t max_{ 0 };
+};
+
+enum OpType { OP_TX, OP_BLOCK, OP_ACCOUNT, OP_HISTORY, OP_COUNT };
+const char *const OP_NAMES[OP_COUNT] = { "tx", "block", "account", "history" };
+
+struct OpStats {
+  uint64_t errors{ 0 };
+  uint64_t busy{ 0 };  // Rejected with E_BUSY by the server's admission control
+  LatencyHistogram latency;
+  std::string lastError;
+};
+
+struct Wallet {
+  uint64_t id{ 0 };
+  std::string privateKey;
+};
+
+struct Options {
+  pp::network::IpEndpoint endpoint;
+  bool isMiner{ false };
+  size_t connections{ 8 };
+  double rate{ 0 };       // Requests per second over all connections; 0 = unthrottled
+  double duration{ 10 };  // Seconds
+  uint64_t weights[OP_COUNT]{ 1, 1, 1, 1 };
+  uint64_t fundFrom{ 0 };
+  std::vector<std::string> fundKeys;
+  size_t wallets{ 16 };
+  uint64_t walletBalance{ 1000000 };
+  uint64_t fee{ 1 };
+  double fundTimeout{ 120 };  // Seconds to wait for the wallets to appear on chain
+  size_t maxTx{ 200000 };
+};
+
+pp::Roe<std::string> decodeKey(const std::string &key) {
+  std::string keyStr = pp::utl::readKey(key);
+  if (keyStr.size() >= 2 && keyStr[0] == '0' && (keyStr[1] == 'x' || keyStr[1] == 'X'))
+    keyStr = keyStr.substr(2);
+  std::string privateKey = pp::utl::hexDecode(keyStr);
+  if (privateKey.size() != 32) {
+    return pp::Error(1, "Key must be 32 bytes (64 hex chars): " + key);
+  }
+  return privateKey;
+}
+
+void setValidationWindow(pp::Ledger::TxIdempotencyWindow &tx, std::mt19937_64 &gen) {
+  const int64_t now = static_cast<int64_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(
+          std::chrono::system_clock::now().time_since_epoch()).count());
+  tx.idempotentId = gen() | 1;
+  tx.validationTsMin = now - 60;
+  tx.validationTsMax = now + 3600;
+}
+
+pp::Roe<pp::Ledger::Record> signRecord(uint16_t type, std::string data,
+                                       const std::vector<std::string> &privateKeys) {
+  pp::Ledger::Record rec;
+  rec.type = type;
+  for (const auto &privateKey : privateKeys) {
+    auto sigResult = pp::utl::ed25519Sign(privateKey, data);
+    if (!sigResult) {
+      return pp::Error(2, sigResult.error().message);
+    }
+    rec.signatures.push_back(*sigResult);
+  }
+  rec.data = std::move(data);
+  return rec;
+}
+
+/** Create the test wallets from the funding account and wait until they are on chain. */
+pp::Roe<std::vector<Wallet>> createWallets(pp::Client &client, const Options &opts,
+                                           const std::vector<std::string> &fundKeys,
+                                           std::mt19937_64 &gen) {
+  std::uniform_int_distribution<uint64_t> idDist(ID_FIRST_USER,
+                                                 std::numeric_limits<uint64_t>::max());
+  std::vector<Wallet> wallets;
+  for (size_t i = 0; i < opts.wallets; ++i) {
+    auto pair = pp::utl::ed25519Generate();
+    if (!pair) {
+      return pp::Error(3, pair.error().message);
+    }
+    Wallet wallet{ idDist(gen), pair->privateKey };
+
+    pp::Client::UserAccount account;
+    account.wallet.publicKeys.push_back(pair->publicKey);
+    account.wallet.minSignatures = 1;
+    account.wallet.keyType = pp::Crypto::TK_ED25519;
+    account.wallet.mBalances[ID_GENESIS] = static_cast<int64_t>(opts.walletBalance);
+    account.meta = "pp-loadgen";
+    pp::Ledger::TxNewUser tx;
+    tx.fromWalletId = opts.fundFrom;
+    tx.toWalletId = wallet.id;
+    tx.amount = opts.walletBalance;
+    tx.fee = opts.fee;
+    tx.meta = account.ltsToString();
+    setValidationWindow(tx, gen);
+    auto rec = signRecord(pp::Ledger::T_NEW_USER, pp::utl::binaryPack(tx), fundKeys);
+    if (!rec) {
+      return rec.error();
+    }
+    auto added = client.addTransaction(*rec);
+    if (!added) {
+      return pp::Error(4, "Failed to create wallet " + std::to_string(wallet.id) + ": " +
+                              added.error().message);
+    }
+    wallets.push_back(std::move(wallet));
+  }
+
+  std::cerr << "Created " << wallets.size() << " wallets, waiting for them on chain...\n";
+  const auto deadline = Clock::now() + std::chrono::duration<double>(opts.fundTimeout);
+  for (const auto &wallet : wallets) {
+    while (!client.fetchUserAccount(wallet.id)) {
+      if (Clock::now() >= deadline) {
+        return pp::Error(5, "Wallet " + std::to_string(wallet.id) + " not on chain after " +
+                                std::to_string(opts.fundTimeout) + " s");
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+  }
+  return wallets;
+}
+
+/** Sign transfers up front, so signing does not count against the measured rate. */
+pp::Roe<std::vector<pp::Ledger::Record>> presignTransfers(const std::vector<Wallet> &wallets,
+                                                          size_t count, uint64_t fee,
+                                                          std::mt19937_64 &gen) {
+  std::vector<pp::Ledger::Record> records;
+  records.reserve(count);
+  std::uniform_int_distribution<size_t> walletDist(0, wallets.size() - 1);
+  for (size_t i = 0; i < count; ++i) {
+    const auto &from = wallets[i % wallets.size()];
+    const auto &to = wallets[walletDist(gen)];
+    pp::Ledger::TxDefault tx;
+    tx.fromWalletId = from.id;
+    tx.toWalletId = to.id;
+    tx.amount = 1;
+    tx.fee = fee;
+    setValidationWindow(tx, gen);
+    auto rec = signRecord(pp::Ledger::T_DEFAULT, pp::utl::binaryPack(tx), { from.privateKey });
+    if (!rec) {
+      return rec.error();
+    }
+    records.push_back(std::move(*rec));
+  }
+  return records;
+}
+
+struct Shared {
+  Options opts;
+  uint64_t nextBlockId{ 0 };
+  std::vector<uint64_t> accountIds;
+  std::vector<pp::Ledger::Record> transfers;
+  std::atomic<size_t> nextTransfer{ 0 };
+  std::atomic<uint64_t> transfersExhausted{ 0 };
+  Clock::time_point startTime;
+  Clock::time_point endTime;
+};
+
+uint64_t elapsedMicros(Clock::time_point since) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count());
+}
+
+template <typename T>
+void recordResult(OpStats &stats, const pp::Client::Roe<T> &result, uint64_t micros) {
+  stats.latency.record(micros);
+  if (!result) {
+    ++stats.errors;
+    if (result.error().code == pp::Client::E_BUSY) {
+      ++stats.busy;
+    }
+    stats.lastError = result.error().message;
+  }
+}
+
+/**
+ * One connection's share of the load. With a target rate, request k of
+ * worker i is due at (i + k * connections) / rate and its latency counts from
+ * that due time rather than from when it was actually sent, so a stalled
+ * server shows up in the percentiles (no coordinated omission).
+ */
+void runWorker(size_t index, Shared &shared, std::vector<OpStats> &stats) {
+  const auto &opts = shared.opts;
+  pp::Client client;
+  client.setEndpoint(opts.endpoint);
+
+  std::mt19937_64 gen(std::random_device{}() + index);
+  std::discrete_distribution<int> opDist(std::begin(opts.weights), std::end(opts.weights));
+  std::uniform_int_distribution<uint64_t> blockDist(0, shared.nextBlockId - 1);
+  std::uniform_int_distribution<size_t> accountDist(0, shared.accountIds.size() - 1);
+
+  for (uint64_t k = 0;; ++k) {
+    auto dueTime = Clock::now();
+    if (opts.rate > 0) {
+      const double offset = static_cast<double>(index + k * opts.connections) / opts.rate;
+      dueTime = shared.startTime + std::chrono::duration_cast<Clock::duration>(
+                                       std::chrono::duration<double>(offset));
+      if (dueTime >= shared.endTime) {
+        break;
+      }
+      std::this_thread::sleep_until(dueTime);
+    } else if (dueTime >= shared.endTime) {
+      break;
+    }
+
+    auto op = static_cast<OpType>(opDist(gen));
+    if (op == OP_TX) {
+      const size_t next = shared.nextTransfer.fetch_add(1);
+      if (next >= shared.transfers.size()) {
+        ++shared.transfersExhausted;
+        continue;
+      }
+      auto result = client.addTransaction(shared.transfers[next]);
+      recordResult(stats[op], result, elapsedMicros(dueTime));
+    } else if (op == OP_BLOCK) {
+      auto result = client.fetchBlock(blockDist(gen));
+      recordResult(stats[op], result, elapsedMicros(dueTime));
+    } else if (op == OP_ACCOUNT) {
+      auto result = client.fetchUserAccount(shared.accountIds[accountDist(gen)]);
+      recordResult(stats[op], result, elapsedMicros(dueTime));
+    } else {
+      pp::Client::TxGetByWalletRequest request;
+      request.walletId = shared.accountIds[accountDist(gen)];
+      auto result = client.fetchTransactionsByWallet(request);
+      recordResult(stats[op], result, elapsedMicros(dueTime));
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  CLI::App app{"pp-loadgen - Load generator for pp-ledger beacon, relay and miner servers"};
+
+  bool debug = false;
+  app.add_flag("--debug", debug, "Enable debug logging");
+
+  std::string host = pp::Client::DEFAULT_HOST;
+  app.add_option("--host", host, "Server host (or host:port)")->capture_default_str();
+
+  uint16_t port = 0;
+  app.add_option("-p,--port", port, "Server port (overrides default)")
+      ->check(CLI::Range(1, 65535));
+
+  bool connectToBeacon = false;
+  app.add_flag("-b,--beacon", connectToBeacon, "Target a BeaconServer or relay (default port: 8517)");
+
+  bool connectToMiner = false;
+  app.add_flag("-m,--miner", connectToMiner, "Target a MinerServer (default port: 8518)");
+
+  Options opts;
+  app.add_option("-c,--connections", opts.connections, "Concurrent connections")
+      ->capture_default_str()
+      ->check(CLI::Range(1, 4096));
+  app.add_option("-r,--rate", opts.rate, "Target requests per second over all connections (0 = as fast as possible)")
+      ->capture_default_str()
+      ->check(CLI::NonNegativeNumber);
+  app.add_option("-t,--duration", opts.duration, "Run time in seconds")
+      ->capture_default_str()
+      ->check(CLI::PositiveNumber);
+  app.add_option("--tx-weight", opts.weights[OP_TX], "Share of T_REQ_TX_ADD (pre-signed TxDefault transfers)")
+      ->capture_default_str();
+  app.add_option("--block-weight", opts.weights[OP_BLOCK], "Share of T_REQ_BLOCK_GET (random block)")
+      ->capture_default_str();
+  app.add_option("--account-weight", opts.weights[OP_ACCOUNT], "Share of T_REQ_ACCOUNT_GET (random test wallet)")
+      ->capture_default_str();
+  app.add_option("--history-weight", opts.weights[OP_HISTORY], "Share of T_REQ_TX_GET_BY_WALLET (random test wallet)")
+      ->capture_default_str();
+
+  opts.fundFrom = ID_RESERVE;  // As in the test network scripts
+  app.add_option("--fund-from", opts.fundFrom, "Account that funds the test wallets")
+      ->capture_default_str();
+  app.add_option("-k,--key", opts.fundKeys, "Private key (hex or file) of the funding account; repeat for multisig");
+  app.add_option("-w,--wallets", opts.wallets, "Number of test wallets to create")
+      ->capture_default_str()
+      ->check(CLI::Range(1, 100000));
+  app.add_option("--wallet-balance", opts.walletBalance, "Initial balance of each test wallet")
+      ->capture_default_str();
+  app.add_option("-f,--fee", opts.fee, "Fee of each transaction")->capture_default_str();
+  app.add_option("--fund-timeout", opts.fundTimeout, "Seconds to wait for the test wallets to be on chain")
+      ->capture_default_str();
+  app.add_option("--max-tx", opts.maxTx, "Max pre-signed transfers (the whole pool when unthrottled)")
+      ->capture_default_str();
+
+  std::string outputPath;
+  app.add_option("-o,--output", outputPath, "Write the JSON report to this file instead of stdout");
+
+  app.footer(
+      "Examples:\n"
+      "  pp-loadgen -m -p 8518 -k reserve1.key -k reserve2.key -k reserve3.key -c 16 -r 500 -t 30\n"
+      "  pp-loadgen -b --tx-weight 0 --block-weight 1 --account-weight 0 --history-weight 0 -c 32\n"
+      "\n"
+      "Transfers go from a pool of new wallets funded by --fund-from; account and\n"
+      "history reads pick from the same pool (system accounts with --tx-weight 0).\n"
+      "Latencies in the report are in microseconds. With -r they count from each\n"
+      "request's scheduled time, so queueing behind a slow server is included.\n");
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (connectToBeacon == connectToMiner) {
+    std::cerr << "Error: Specify exactly one of -b/--beacon or -m/--miner.\n";
+    return 1;
+  }
+  const bool hasTx = opts.weights[OP_TX] > 0;
+  if (hasTx && (!connectToMiner || opts.fundKeys.empty())) {
+    std::cerr << "Error: Transfers need -m/--miner and -k/--key for the funding account; "
+                 "use --tx-weight 0 for a read-only load.\n";
+    return 1;
+  }
+  if (std::all_of(std::begin(opts.weights), std::end(opts.weights),
+                  [](uint64_t w) { return w == 0; })) {
+    std::cerr << "Error: All request weights are 0.\n";
+    return 1;
+  }
+
+  std::string parsedHost = host;
+  uint16_t parsedPort = port;
+  uint16_t extractedPort = 0;
+  if (pp::utl::parseHostPort(host, parsedHost, extractedPort)) {
+    if (port == 0) {
+      parsedPort = extractedPort;
+    }
+  }
+  if (parsedPort == 0) {
+    parsedPort = connectToBeacon ? pp::Client::DEFAULT_BEACON_PORT
+                                 : pp::Client::DEFAULT_MINER_PORT;
+  }
+  opts.endpoint = pp::network::IpEndpoint{ parsedHost, parsedPort };
+  opts.isMiner = connectToMiner;
+
+  pp::logging::getRootLogger().setLevel(debug ? pp::logging::Level::DEBUG
+                                              : pp::logging::Level::WARNING);
+
+  Shared shared;
+  shared.opts = opts;
+  std::mt19937_64 gen(std::random_device{}());
+
+  pp::Client client;
+  client.setEndpoint(opts.endpoint);
+  auto calibration = client.fetchCalibration();
+  if (!calibration) {
+    std::cerr << "Error: " << calibration.error().message << "\n";
+    return 1;
+  }
+  shared.nextBlockId = std::max<uint64_t>(calibration.value().nextBlockId, 1);
+
+  if (hasTx) {
+    std::vector<std::string> fundKeys;
+    for (const auto &key : opts.fundKeys) {
+      auto decoded = decodeKey(key);
+      if (!decoded) {
+        std::cerr << "Error: " << decoded.error().message << "\n";
+        return 1;
+      }
+      fundKeys.push_back(*decoded);
+    }
+    auto wallets = createWallets(client, opts, fundKeys, gen);
+    if (!wallets) {
+      std::cerr << "Error: " << wallets.error().message << "\n";
+      return 1;
+    }
+    for (const auto &wallet : *wallets) {
+      shared.accountIds.push_back(wallet.id);
+    }
+
+    uint64_t totalWeight = 0;
+    for (uint64_t w : opts.weights) {
+      totalWeight += w;
+    }
+    size_t txCount = opts.maxTx;
+    if (opts.rate > 0) {
+      // Expected share plus headroom for the randomness of the mix
+      const double expected = opts.rate * opts.duration * static_cast<double>(opts.weights[OP_TX]) /
+                              static_cast<double>(totalWeight);
+      txCount = std::min(txCount, static_cast<size_t>(expected * 1.2) + opts.connections);
+    }
+    std::cerr << "Signing " << txCount << " transfers...\n";
+    auto transfers = presignTransfers(*wallets, txCount, opts.fee, gen);
+    if (!transfers) {
+      std::cerr << "Error: " << transfers.error().message << "\n";
+      return 1;
+    }
+    shared.transfers = std::move(*transfers);
+  } else {
+    for (uint64_t id = ID_GENESIS; id <= ID_RESERVE; ++id) {
+      shared.accountIds.push_back(id);
+    }
+  }
+
+  std::cerr << "Running " << opts.connections << " connections against " << opts.endpoint
+            << " for " << opts.duration << " s...\n";
+  std::vector<std::vector<OpStats>> workerStats(opts.connections,
+                                                std::vector<OpStats>(OP_COUNT));
+  shared.startTime = Clock::now();
+  shared.endTime = shared.startTime + std::chrono::duration_cast<Clock::duration>(
+                                          std::chrono::duration<double>(opts.duration));
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < opts.connections; ++i) {
+    workers.emplace_back([i, &shared, &workerStats] { runWorker(i, shared, workerStats[i]); });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - shared.startTime).count();
+
+  nlohmann::json report;
+  report["target"] = parsedHost + ":" + std::to_string(parsedPort);
+  report["connections"] = opts.connections;
+  report["targetRate"] = opts.rate;
+  report["durationSec"] = elapsed;
+  report["blocks"] = shared.nextBlockId;
+  report["wallets"] = hasTx ? shared.accountIds.size() : 0;
+
+  LatencyHistogram total;
+  uint64_t totalErrors = 0;
+  uint64_t totalBusy = 0;
+  for (int op = 0; op < OP_COUNT; ++op) {
+    if (opts.weights[op] == 0) {
+      continue;
+    }
+    OpStats merged;
+    for (const auto &stats : workerStats) {
+      merged.latency.merge(stats[op].latency);
+      merged.errors += stats[op].errors;
+      merged.busy += stats[op].busy;
+      if (!stats[op].lastError.empty()) {
+        merged.lastError = stats[op].lastError;
+      }
+    }
+    nlohmann::json j;
+    j["requests"] = merged.latency.getCount();
+    j["errors"] = merged.errors;
+    j["busy"] = merged.busy;
+    j["throughput"] = static_cast<double>(merged.latency.getCount()) / elapsed;
+    j["latencyUs"] = merged.latency.toJson();
+    if (!merged.lastError.empty()) {
+      j["lastError"] = merged.lastError;
+    }
+    report["ops"][OP_NAMES[op]] = j;
+    total.merge(merged.latency);
+    totalErrors += merged.errors;
+    totalBusy += merged.busy;
+  }
+  if (hasTx) {
+    report["ops"]["tx"]["poolExhausted"] = shared.transfersExhausted.load();
+  }
+  report["requests"] = total.getCount();
+  report["errors"] = totalErrors;
+  report["busy"] = totalBusy;
+  report["throughput"] = static_cast<double>(total.getCount()) / elapsed;
+  report["latencyUs"] = total.toJson();
+
+  if (outputPath.empty()) {
+    std::cout << report.dump(2) << "\n";
+  } else {
+    std::ofstream f(outputPath);
+    f << report.dump(2) << "\n";
+    if (!f) {
+      std::cerr << "Error: Failed to write " << outputPath << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -1,87 +1,500 @@
 #include "AccountBuffer.h"
 
+#include <algorithm>
 #include <limits>
 #include <string>
 
 namespace pp {
 
+namespace {
+
+uint64_t stakeOf(int64_t nativeBalance) {
+  return nativeBalance > 0 ? static_cast<uint64_t>(nativeBalance) : 0;
+}
+
+// splitmix64 finalizer; account ids are either tiny system ids or random 64-bit values
+uint64_t mixAccountId(uint64_t id) {
+  id ^= id >> 30;
+  id *= 0xbf58476d1ce4e5b9ULL;
+  id ^= id >> 27;
+  id *= 0x94d049bb133111ebULL;
+  id ^= id >> 31;
+  return id;
+}
+
+} // namespace
+
 AccountBuffer::AccountBuffer() {}
 
 bool AccountBuffer::hasAccount(uint64_t id) const {
-  return mAccounts_.find(id) != mAccounts_.end();
+  return findPosition(id) != NPOS || isBaseVisible(id);
+}
+
+bool AccountBuffer::isEmpty() const { return size() == 0; }
+
+size_t AccountBuffer::size() const {
+  if (base_ == nullptr) {
+    return accounts_.size();
+  }
+  // Every hidden id is a base account; local copies of base accounts are hidden
+  return accounts_.size() + base_->size() - hiddenBaseIds_.size();
+}
+
+bool AccountBuffer::isOverlay() const { return base_ != nullptr; }
+
+void AccountBuffer::setBase(const AccountBuffer *base) {
+  clear();
+  base_ = base;
+}
+
+bool AccountBuffer::isBaseVisible(uint64_t id) const {
+  return base_ != nullptr && hiddenBaseIds_.count(id) == 0 &&
+         base_->hasAccount(id);
+}
+
+int64_t AccountBuffer::getBaseDelta(uint64_t id, uint64_t tokenId) const {
+  auto it = mBalanceDeltas_.find(id);
+  if (it == mBalanceDeltas_.end()) {
+    return 0;
+  }
+  auto deltaIt = it->second.find(tokenId);
+  return deltaIt == it->second.end() ? 0 : deltaIt->second;
+}
+
+void AccountBuffer::setBaseBalance(uint64_t id, uint64_t tokenId,
+                                   int64_t balance) {
+  if (tokenId == ID_GENESIS) {
+    baseStakeAdjust_ += stakeOf(balance) - stakeOf(getBalance(id, ID_GENESIS));
+  }
+  // Deltas wrap like the balances they were derived from
+  const int64_t delta = static_cast<int64_t>(
+      static_cast<uint64_t>(balance) -
+      static_cast<uint64_t>(base_->getBalance(id, tokenId)));
+  // Setting a token the base account does not hold creates its entry even at
+  // zero, so keep the zero delta for commitTo() to do the same
+  if (delta != 0 || !base_->hasBalanceEntry(id, tokenId)) {
+    mBalanceDeltas_[id][tokenId] = delta;
+    return;
+  }
+  auto it = mBalanceDeltas_.find(id);
+  if (it == mBalanceDeltas_.end()) {
+    return;
+  }
+  it->second.erase(tokenId);
+  if (it->second.empty()) {
+    mBalanceDeltas_.erase(it);
+  }
+}
+
+bool AccountBuffer::hasBalanceEntry(uint64_t id, uint64_t tokenId) const {
+  size_t position = findPosition(id);
+  if (position != NPOS) {
+    return accounts_[position].wallet.mBalances.count(tokenId) > 0;
+  }
+  if (!isBaseVisible(id)) {
+    return false;
+  }
+  auto it = mBalanceDeltas_.find(id);
+  if (it != mBalanceDeltas_.end() && it->second.count(tokenId) > 0) {
+    return true;
+  }
+  return base_->hasBalanceEntry(id, tokenId);
+}
+
+std::map<uint64_t, int64_t> AccountBuffer::getBaseBalances(uint64_t id) const {
+  std::map<uint64_t, int64_t> balances;
+  auto accountResult = base_->getAccount(id);
+  if (accountResult) {
+    balances = accountResult.value().wallet.mBalances;
+  }
+  auto it = mBalanceDeltas_.find(id);
+  if (it != mBalanceDeltas_.end()) {
+    for (const auto &[tokenId, delta] : it->second) {
+      balances[tokenId] = static_cast<int64_t>(
+          static_cast<uint64_t>(balances[tokenId]) + static_cast<uint64_t>(delta));
+    }
+  }
+  return balances;
+}
+
+void AccountBuffer::hideBaseAccount(uint64_t id) {
+  if (hiddenBaseIds_.count(id) > 0) {
+    return;
+  }
+  baseStakeAdjust_ -= stakeOf(getBalance(id, ID_GENESIS));
+  hiddenBaseIds_.insert(id);
+  mBalanceDeltas_.erase(id);
+}
+
+void AccountBuffer::setBalance(uint64_t id, uint64_t tokenId, int64_t balance) {
+  size_t position = findPosition(id);
+  if (position != NPOS) {
+    setBalanceAt(position, tokenId, balance);
+  } else {
+    setBaseBalance(id, tokenId, balance);
+  }
 }
 
-bool AccountBuffer::isEmpty() const { return mAccounts_.empty(); }
+size_t AccountBuffer::homeSlot(uint64_t id) const {
+  return static_cast<size_t>(mixAccountId(id)) & (index_.size() - 1);
+}
+
+size_t AccountBuffer::findPosition(uint64_t id) const {
+  if (index_.empty()) {
+    return NPOS;
+  }
+  const size_t mask = index_.size() - 1;
+  for (size_t i = homeSlot(id);; i = (i + 1) & mask) {
+    const IndexSlot &slot = index_[i];
+    if (slot.position == NO_POSITION) {
+      return NPOS;
+    }
+    if (slot.id == id) {
+      return slot.position;
+    }
+  }
+}
+
+void AccountBuffer::rehash(size_t capacity) {
+  std::vector<IndexSlot> old;
+  old.swap(index_);
+  index_.assign(capacity, IndexSlot{});
+  const size_t mask = capacity - 1;
+  for (const auto &slot : old) {
+    if (slot.position == NO_POSITION) {
+      continue;
+    }
+    size_t i = homeSlot(slot.id);
+    while (index_[i].position != NO_POSITION) {
+      i = (i + 1) & mask;
+    }
+    index_[i] = slot;
+  }
+}
+
+void AccountBuffer::indexInsert(uint64_t id, uint32_t position) {
+  if ((accounts_.size() + 1) * 2 > index_.size()) {
+    rehash(std::max(MIN_INDEX_CAPACITY, index_.size() * 2));
+  }
+  const size_t mask = index_.size() - 1;
+  size_t i = homeSlot(id);
+  while (index_[i].position != NO_POSITION) {
+    i = (i + 1) & mask;
+  }
+  index_[i].id = id;
+  index_[i].position = position;
+}
+
+void AccountBuffer::indexUpdate(uint64_t id, uint32_t position) {
+  const size_t mask = index_.size() - 1;
+  for (size_t i = homeSlot(id); index_[i].position != NO_POSITION;
+       i = (i + 1) & mask) {
+    if (index_[i].id == id) {
+      index_[i].position = position;
+      return;
+    }
+  }
+}
+
+void AccountBuffer::indexErase(uint64_t id) {
+  const size_t mask = index_.size() - 1;
+  size_t hole = homeSlot(id);
+  while (index_[hole].id != id) {
+    if (index_[hole].position == NO_POSITION) {
+      return;
+    }
+    hole = (hole + 1) & mask;
+  }
+  // Backward-shift deletion keeps probe chains intact without tombstones
+  for (size_t j = (hole + 1) & mask; index_[j].position != NO_POSITION;
+       j = (j + 1) & mask) {
+    const size_t home = homeSlot(index_[j].id);
+    const bool reachable = (hole <= j) ? (hole < home && home <= j)
+                                       : (hole < home || home <= j);
+    if (!reachable) {
+      index_[hole] = index_[j];
+      hole = j;
+    }
+  }
+  index_[hole] = IndexSlot{};
+}
+
+void AccountBuffer::eraseAt(size_t position) {
+  const uint64_t stake = stakeOf(nativeBalances_[position]);
+  if (stake > 0) {
+    totalStake_ -= stake;
+    stakeChangedIds_.push_back(accounts_[position].id);
+  }
+  renewalIndex_.erase({accounts_[position].blockId, accounts_[position].id});
+  indexErase(accounts_[position].id);
+  const size_t last = accounts_.size() - 1;
+  if (position != last) {
+    accounts_[position] = std::move(accounts_[last]);
+    nativeBalances_[position] = nativeBalances_[last];
+    stakeDirty_[position] = stakeDirty_[last];
+    indexUpdate(accounts_[position].id, static_cast<uint32_t>(position));
+  }
+  accounts_.pop_back();
+  nativeBalances_.pop_back();
+  stakeDirty_.pop_back();
+}
+
+int64_t AccountBuffer::getBalanceAt(size_t position, uint64_t tokenId) const {
+  if (tokenId == ID_GENESIS) {
+    return nativeBalances_[position];
+  }
+  const auto &balances = accounts_[position].wallet.mBalances;
+  auto it = balances.find(tokenId);
+  return it == balances.end() ? 0 : it->second;
+}
+
+void AccountBuffer::setBalanceAt(size_t position, uint64_t tokenId,
+                                 int64_t balance) {
+  accounts_[position].wallet.mBalances[tokenId] = balance;
+  if (tokenId == ID_GENESIS) {
+    setNativeBalanceAt(position, balance);
+  }
+}
+
+void AccountBuffer::setNativeBalanceAt(size_t position, int64_t balance) {
+  const uint64_t oldStake = stakeOf(nativeBalances_[position]);
+  const uint64_t newStake = stakeOf(balance);
+  nativeBalances_[position] = balance;
+  if (oldStake != newStake) {
+    totalStake_ = totalStake_ - oldStake + newStake;
+    markStakeChanged(position);
+  }
+}
 
-bool AccountBuffer::isNegativeBalanceAllowed(const Account &account,
+void AccountBuffer::markStakeChanged(size_t position) {
+  if (!stakeDirty_[position]) {
+    stakeDirty_[position] = 1;
+    stakeChangedIds_.push_back(accounts_[position].id);
+  }
+}
+
+bool AccountBuffer::isNegativeBalanceAllowed(uint64_t accountId,
                                              uint64_t tokenId) const {
   // Only the genesis token account can have negative balances
-  return account.id < ID_FIRST_USER && account.id == tokenId;
+  return accountId < ID_FIRST_USER && accountId == tokenId;
 }
 
 std::vector<uint64_t>
 AccountBuffer::getAccountIdsBeforeBlockId(uint64_t blockId) const {
   std::vector<uint64_t> ids;
-  for (const auto &[id, account] : mAccounts_) {
-    if (account.blockId < blockId) {
-      ids.push_back(id);
+  auto end = renewalIndex_.lower_bound({blockId, 0});
+  for (auto it = renewalIndex_.begin(); it != end; ++it) {
+    ids.push_back(it->second);
+  }
+  if (base_ != nullptr) {
+    for (uint64_t id : base_->getAccountIdsBeforeBlockId(blockId)) {
+      if (hiddenBaseIds_.count(id) == 0 && findPosition(id) == NPOS) {
+        ids.push_back(id);
+      }
     }
   }
+  std::sort(ids.begin(), ids.end());
   return ids;
 }
 
 AccountBuffer::Roe<const AccountBuffer::Account &>
 AccountBuffer::getAccount(uint64_t id) const {
-  auto it = mAccounts_.find(id);
-  if (it == mAccounts_.end()) {
+  size_t position = findPosition(id);
+  if (position != NPOS) {
+    return accounts_[position];
+  }
+  if (!isBaseVisible(id)) {
     return Error(E_ACCOUNT, "Account not found: " + std::to_string(id));
   }
-  return it->second;
+  auto baseResult = base_->getAccount(id);
+  auto it = mBalanceDeltas_.find(id);
+  if (!baseResult || it == mBalanceDeltas_.end()) {
+    return baseResult;
+  }
+  // Merged only here: the result holds its own copy of the account anyway,
+  // so balance changes never copy accounts and readers never write
+  Account merged = baseResult.value();
+  for (const auto &[tokenId, delta] : it->second) {
+    auto &balance = merged.wallet.mBalances[tokenId];
+    balance = static_cast<int64_t>(static_cast<uint64_t>(balance) +
+                                   static_cast<uint64_t>(delta));
+  }
+  return merged;
 }
 
 int64_t AccountBuffer::getBalance(uint64_t accountId, uint64_t tokenId) const {
-  auto it = mAccounts_.find(accountId);
-  if (it == mAccounts_.end()) {
-    return 0;
+  size_t position = findPosition(accountId);
+  if (position != NPOS) {
+    return getBalanceAt(position, tokenId);
   }
-  auto balanceIt = it->second.wallet.mBalances.find(tokenId);
-  if (balanceIt == it->second.wallet.mBalances.end()) {
+  if (!isBaseVisible(accountId)) {
     return 0;
   }
-  return balanceIt->second;
+  return static_cast<int64_t>(
+      static_cast<uint64_t>(base_->getBalance(accountId, tokenId)) +
+      static_cast<uint64_t>(getBaseDelta(accountId, tokenId)));
 }
 
 std::vector<consensus::Stakeholder> AccountBuffer::getStakeholders() const {
   std::vector<consensus::Stakeholder> stakeholders;
-  for (const auto &[id, account] : mAccounts_) {
-    auto balanceIt = account.wallet.mBalances.find(ID_GENESIS);
-    if (balanceIt == account.wallet.mBalances.end()) {
-      continue;
+  if (base_ == nullptr) {
+    for (size_t i = 0; i < nativeBalances_.size(); ++i) {
+      if (nativeBalances_[i] > 0) {
+        stakeholders.push_back({accounts_[i].id, uint64_t(nativeBalances_[i])});
+      }
     }
-    if (balanceIt->second > 0) {
-      stakeholders.push_back({id, uint64_t(balanceIt->second)});
+    std::sort(stakeholders.begin(), stakeholders.end(),
+              [](const consensus::Stakeholder &a,
+                 const consensus::Stakeholder &b) { return a.id < b.id; });
+    return stakeholders;
+  }
+
+  // Stakes this overlay changed (0 = hidden or no stake), merged into the
+  // base distribution in one pass
+  std::map<uint64_t, uint64_t> overrides;
+  for (uint64_t id : hiddenBaseIds_) {
+    overrides[id] = 0;
+  }
+  for (const auto &[id, deltas] : mBalanceDeltas_) {
+    if (deltas.count(ID_GENESIS) > 0) {
+      overrides[id] = stakeOf(getBalance(id, ID_GENESIS));
+    }
+  }
+  for (size_t i = 0; i < accounts_.size(); ++i) {
+    overrides[accounts_[i].id] = stakeOf(nativeBalances_[i]);
+  }
+
+  const auto baseStakeholders = base_->getStakeholders();
+  stakeholders.reserve(baseStakeholders.size() + overrides.size());
+  auto overrideIt = overrides.begin();
+  for (const auto &stakeholder : baseStakeholders) {
+    for (; overrideIt != overrides.end() && overrideIt->first < stakeholder.id;
+         ++overrideIt) {
+      if (overrideIt->second > 0) {
+        stakeholders.push_back({overrideIt->first, overrideIt->second});
+      }
+    }
+    if (overrideIt != overrides.end() && overrideIt->first == stakeholder.id) {
+      if (overrideIt->second > 0) {
+        stakeholders.push_back({stakeholder.id, overrideIt->second});
+      }
+      ++overrideIt;
+    } else {
+      stakeholders.push_back(stakeholder);
+    }
+  }
+  for (; overrideIt != overrides.end(); ++overrideIt) {
+    if (overrideIt->second > 0) {
+      stakeholders.push_back({overrideIt->first, overrideIt->second});
     }
   }
   return stakeholders;
 }
 
+uint64_t AccountBuffer::getTotalStake() const {
+  if (base_ == nullptr) {
+    return totalStake_;
+  }
+  return base_->getTotalStake() + totalStake_ + baseStakeAdjust_;
+}
+
+AccountBuffer::StakeUpdate AccountBuffer::takeStakeUpdate() {
+  StakeUpdate update;
+  if (isFullStakeUpdatePending_ || base_ != nullptr) {
+    update.isFull = true;
+    update.changes = getStakeholders();
+    std::fill(stakeDirty_.begin(), stakeDirty_.end(), 0);
+  } else {
+    std::sort(stakeChangedIds_.begin(), stakeChangedIds_.end());
+    stakeChangedIds_.erase(
+        std::unique(stakeChangedIds_.begin(), stakeChangedIds_.end()),
+        stakeChangedIds_.end());
+    update.changes.reserve(stakeChangedIds_.size());
+    for (uint64_t id : stakeChangedIds_) {
+      size_t position = findPosition(id);
+      uint64_t stake = 0;
+      if (position != NPOS) {
+        stake = stakeOf(nativeBalances_[position]);
+        stakeDirty_[position] = 0;
+      }
+      update.changes.push_back({id, stake});
+    }
+  }
+  isFullStakeUpdatePending_ = false;
+  stakeChangedIds_.clear();
+  return update;
+}
+
+void AccountBuffer::requestFullStakeUpdate() {
+  isFullStakeUpdatePending_ = true;
+}
+
 AccountBuffer::Roe<void> AccountBuffer::add(const Account &account) {
   if (hasAccount(account.id)) {
     return Error(E_ACCOUNT, "Account already exists");
   }
+  if (base_ != nullptr && base_->hasAccount(account.id)) {
+    hideBaseAccount(account.id);
+  }
 
-  mAccounts_[account.id] = account;
+  indexInsert(account.id, static_cast<uint32_t>(accounts_.size()));
+  renewalIndex_.insert({account.blockId, account.id});
+  accounts_.push_back(account);
+  auto balanceIt = account.wallet.mBalances.find(ID_GENESIS);
+  nativeBalances_.push_back(0);
+  stakeDirty_.push_back(0);
+  if (balanceIt != account.wallet.mBalances.end()) {
+    setNativeBalanceAt(accounts_.size() - 1, balanceIt->second);
+  }
 
   return {};
 }
 
 AccountBuffer::Roe<void> AccountBuffer::update(const AccountBuffer &other) {
-  for (const auto &[id, account] : other.mAccounts_) {
+  // Removals of an overlay's base accounts have no update equivalent
+  for (uint64_t id : other.hiddenBaseIds_) {
+    if (other.findPosition(id) == NPOS) {
+      return Error(E_INPUT, "Cannot update from an overlay that removed account " +
+                                std::to_string(id));
+    }
+  }
+  for (const auto &[id, deltas] : other.mBalanceDeltas_) {
     if (!hasAccount(id)) {
       return Error(E_ACCOUNT,
                    "Account to update not found: " + std::to_string(id));
     }
-    mAccounts_[id] = account;
+  }
+  for (size_t i = 0; i < other.accounts_.size(); ++i) {
+    if (!hasAccount(other.accounts_[i].id)) {
+      return Error(E_ACCOUNT, "Account to update not found: " +
+                                  std::to_string(other.accounts_[i].id));
+    }
+  }
+
+  for (size_t i = 0; i < other.accounts_.size(); ++i) {
+    const auto &account = other.accounts_[i];
+    size_t position = findPosition(account.id);
+    if (position == NPOS) {
+      // Read-through base account of this overlay: replace it with a local copy
+      remove(account.id);
+      auto addResult = add(account);
+      if (!addResult) {
+        return addResult;
+      }
+      continue;
+    }
+    if (accounts_[position].blockId != account.blockId) {
+      renewalIndex_.erase({accounts_[position].blockId, account.id});
+      renewalIndex_.insert({account.blockId, account.id});
+    }
+    accounts_[position] = account;
+    setNativeBalanceAt(position, other.nativeBalances_[i]);
+  }
+  // Balance changes `other` keeps against its base
+  for (const auto &[id, deltas] : other.mBalanceDeltas_) {
+    for (const auto &entry : deltas) {
+      setBalance(id, entry.first, other.getBalance(id, entry.first));
+    }
   }
   return {};
 }
@@ -125,35 +538,20 @@ AccountBuffer::Roe<void> AccountBuffer::verifySpendingPower(uint64_t accountId,
   const int64_t feeSigned = static_cast<int64_t>(fee);
 
   // Check if account exists
-  auto it = mAccounts_.find(accountId);
-  if (it == mAccounts_.end()) {
+  if (!hasAccount(accountId)) {
     return Error(E_ACCOUNT, "Account not found: " + std::to_string(accountId));
   }
 
   // Get token balance
-  int64_t tokenBalance = 0;
-  auto tokenBalanceIt = it->second.wallet.mBalances.find(tokenId);
-  if (tokenBalanceIt != it->second.wallet.mBalances.end()) {
-    tokenBalance = tokenBalanceIt->second;
-  }
+  int64_t tokenBalance = getBalance(accountId, tokenId);
 
-  // Get fee balance (in ID_GENESIS token)
-  int64_t feeBalance = 0;
-  if (tokenId == ID_GENESIS) {
-    // If tokenId is ID_GENESIS, the fee comes from the same balance as the
-    // transfer
-    feeBalance = tokenBalance;
-  } else {
-    auto feeBalanceIt = it->second.wallet.mBalances.find(ID_GENESIS);
-    if (feeBalanceIt != it->second.wallet.mBalances.end()) {
-      feeBalance = feeBalanceIt->second;
-    }
-  }
+  // Get fee balance (in ID_GENESIS token); same balance as the transfer when
+  // tokenId is ID_GENESIS
+  int64_t feeBalance = getBalance(accountId, ID_GENESIS);
 
   // Check if negative balance is allowed for this token (only for genesis token
   // account)
-  bool allowNegativeTokenBalance =
-      isNegativeBalanceAllowed(it->second, tokenId);
+  bool allowNegativeTokenBalance = isNegativeBalanceAllowed(accountId, tokenId);
 
   // Check sufficient balance
   if (tokenId == ID_GENESIS) {
@@ -203,14 +601,19 @@ AccountBuffer::Roe<void> AccountBuffer::verifyBalance(
   const int64_t amountSigned = static_cast<int64_t>(amount);
   const int64_t feeSigned = static_cast<int64_t>(fee);
 
-  // Check if account exists
-  auto it = mAccounts_.find(accountId);
-  if (it == mAccounts_.end()) {
+  // Check if account exists; overlay reads merge base balances with deltas
+  std::map<uint64_t, int64_t> mergedBalances;
+  const std::map<uint64_t, int64_t> *balances = nullptr;
+  size_t position = findPosition(accountId);
+  if (position != NPOS) {
+    balances = &accounts_[position].wallet.mBalances;
+  } else if (isBaseVisible(accountId)) {
+    mergedBalances = getBaseBalances(accountId);
+    balances = &mergedBalances;
+  } else {
     return Error(E_ACCOUNT, "Account not found: " + std::to_string(accountId));
   }
-
-  const auto &account = it->second;
-  const auto &bufferBalances = account.wallet.mBalances;
+  const auto &bufferBalances = *balances;
 
   // Helper to get balance or zero
   auto getBalanceOrZero = [](const std::map<uint64_t, int64_t> &balances,
@@ -286,21 +689,15 @@ AccountBuffer::Roe<void> AccountBuffer::depositBalance(uint64_t accountId,
     return Error(E_INPUT, "Deposit amount must be non-negative");
   }
 
-  auto it = mAccounts_.find(accountId);
-  if (it == mAccounts_.end()) {
+  if (!hasAccount(accountId)) {
     return Error(E_ACCOUNT, "Account not found: " + std::to_string(accountId));
   }
 
-  int64_t currentBalance = 0;
-  auto balanceIt = it->second.wallet.mBalances.find(tokenId);
-  if (balanceIt != it->second.wallet.mBalances.end()) {
-    currentBalance = balanceIt->second;
-  }
-
+  int64_t currentBalance = getBalance(accountId, tokenId);
   if (currentBalance > INT64_MAX - amount) {
     return Error(E_BALANCE, "Deposit would cause balance overflow");
   }
-  it->second.wallet.mBalances[tokenId] = currentBalance + amount;
+  setBalance(accountId, tokenId, currentBalance + amount);
   return {};
 }
 
@@ -311,25 +708,19 @@ AccountBuffer::Roe<void> AccountBuffer::withdrawBalance(uint64_t accountId,
     return Error(E_INPUT, "Withdraw amount must be non-negative");
   }
 
-  auto it = mAccounts_.find(accountId);
-  if (it == mAccounts_.end()) {
+  if (!hasAccount(accountId)) {
     return Error(E_ACCOUNT, "Account not found: " + std::to_string(accountId));
   }
 
-  int64_t currentBalance = 0;
-  auto balanceIt = it->second.wallet.mBalances.find(tokenId);
-  if (balanceIt != it->second.wallet.mBalances.end()) {
-    currentBalance = balanceIt->second;
-  }
-
-  if (!isNegativeBalanceAllowed(it->second, tokenId) &&
+  int64_t currentBalance = getBalance(accountId, tokenId);
+  if (!isNegativeBalanceAllowed(accountId, tokenId) &&
       currentBalance < amount) {
     return Error(E_BALANCE, "Insufficient balance");
   }
   if (currentBalance < INT64_MIN + amount) {
     return Error(E_BALANCE, "Withdraw would cause balance underflow");
   }
-  it->second.wallet.mBalances[tokenId] = currentBalance - amount;
+  setBalance(accountId, tokenId, currentBalance - amount);
   return {};
 }
 
@@ -344,27 +735,16 @@ AccountBuffer::transferBalance(uint64_t fromId, uint64_t toId, uint64_t tokenId,
   const int64_t amountSigned = static_cast<int64_t>(amount);
   const int64_t feeSigned = static_cast<int64_t>(fee);
 
-  auto fromIt = mAccounts_.find(fromId);
-  if (fromIt == mAccounts_.end()) {
+  if (!hasAccount(fromId)) {
     return Error(E_ACCOUNT, "Source account not found: " + std::to_string(fromId));
   }
 
-  auto toIt = mAccounts_.find(toId);
-  if (toIt == mAccounts_.end()) {
+  if (!hasAccount(toId)) {
     return Error(E_ACCOUNT, "Destination account not found: " + std::to_string(toId));
   }
 
-  int64_t fromBalance = 0;
-  auto fromBalanceIt = fromIt->second.wallet.mBalances.find(tokenId);
-  if (fromBalanceIt != fromIt->second.wallet.mBalances.end()) {
-    fromBalance = fromBalanceIt->second;
-  }
-
-  int64_t toBalance = 0;
-  auto toBalanceIt = toIt->second.wallet.mBalances.find(tokenId);
-  if (toBalanceIt != toIt->second.wallet.mBalances.end()) {
-    toBalance = toBalanceIt->second;
-  }
+  int64_t fromBalance = getBalance(fromId, tokenId);
+  int64_t toBalance = getBalance(toId, tokenId);
 
   // Check for overflow in destination account
   if (toBalance > INT64_MAX - amountSigned) {
@@ -375,70 +755,111 @@ AccountBuffer::transferBalance(uint64_t fromId, uint64_t toId, uint64_t tokenId,
   int64_t genesisBalance = 0;
   if (fee > 0 && tokenId != ID_GENESIS) {
     // For custom token transfers, retrieve ID_GENESIS balance for fee deduction
-    auto genesisBalanceIt = fromIt->second.wallet.mBalances.find(ID_GENESIS);
-    if (genesisBalanceIt != fromIt->second.wallet.mBalances.end()) {
-      genesisBalance = genesisBalanceIt->second;
-    }
+    genesisBalance = getBalance(fromId, ID_GENESIS);
   }
 
   // Perform the transfer
-  fromIt->second.wallet.mBalances[tokenId] = fromBalance - amountSigned;
-  toIt->second.wallet.mBalances[tokenId] = toBalance + amountSigned;
+  setBalance(fromId, tokenId, fromBalance - amountSigned);
+  setBalance(toId, tokenId, toBalance + amountSigned);
 
   // Deduct the fee from sender and credit to ID_FEE account
   if (fee > 0) {
     if (tokenId == ID_GENESIS) {
-      fromIt->second.wallet.mBalances[ID_GENESIS] =
-          fromBalance - amountSigned - feeSigned;
+      setBalance(fromId, ID_GENESIS, fromBalance - amountSigned - feeSigned);
     } else {
-      fromIt->second.wallet.mBalances[ID_GENESIS] = genesisBalance - feeSigned;
+      setBalance(fromId, ID_GENESIS, genesisBalance - feeSigned);
     }
 
-    auto feeIt = mAccounts_.find(ID_FEE);
-    if (feeIt == mAccounts_.end()) {
+    if (!hasAccount(ID_FEE)) {
       return Error(E_ACCOUNT, "Fee account not found: " + std::to_string(ID_FEE));
     }
-    int64_t feeAccountBalance = 0;
-    auto feeBalanceIt = feeIt->second.wallet.mBalances.find(ID_GENESIS);
-    if (feeBalanceIt != feeIt->second.wallet.mBalances.end()) {
-      feeAccountBalance = feeBalanceIt->second;
-    }
+    int64_t feeAccountBalance = getBalance(ID_FEE, ID_GENESIS);
     if (feeAccountBalance > INT64_MAX - feeSigned) {
       return Error(E_INPUT, "Fee account balance would overflow");
     }
-    feeIt->second.wallet.mBalances[ID_GENESIS] = feeAccountBalance + feeSigned;
+    setBalance(ID_FEE, ID_GENESIS, feeAccountBalance + feeSigned);
   }
 
   return {};
 }
 
 AccountBuffer::Roe<void> AccountBuffer::writeOff(uint64_t accountId) {
-  auto itAccount = mAccounts_.find(accountId);
-  if (itAccount == mAccounts_.end()) {
+  if (!hasAccount(accountId)) {
     return Error(E_ACCOUNT, "Account not found: " + std::to_string(accountId));
   }
 
-  auto itRecycle = mAccounts_.find(ID_RECYCLE);
-  if (itRecycle == mAccounts_.end()) {
+  if (!hasAccount(ID_RECYCLE)) {
     return Error(E_ACCOUNT, "Recycle account not found: " + std::to_string(ID_RECYCLE));
   }
 
-  for (const auto &[tokenId, amount] : itAccount->second.wallet.mBalances) {
+  size_t position = findPosition(accountId);
+  const std::map<uint64_t, int64_t> balances =
+      position != NPOS ? accounts_[position].wallet.mBalances
+                       : getBaseBalances(accountId);
+  for (const auto &[tokenId, amount] : balances) {
     // Notice negative balances are not handled here.
     // In case of custom token genesis account, the balance becomes history and
     // cannot be used for minting new tokens.
     if (amount > 0) {
-      itRecycle->second.wallet.mBalances[tokenId] += amount;
+      setBalance(ID_RECYCLE, tokenId, getBalance(ID_RECYCLE, tokenId) + amount);
     }
   }
 
-  mAccounts_.erase(itAccount);
+  remove(accountId);
   return {};
 }
 
-void AccountBuffer::remove(uint64_t id) { mAccounts_.erase(id); }
+void AccountBuffer::remove(uint64_t id) {
+  size_t position = findPosition(id);
+  if (position != NPOS) {
+    eraseAt(position);
+  } else if (isBaseVisible(id)) {
+    hideBaseAccount(id);
+  }
+}
 
-void AccountBuffer::clear() { mAccounts_.clear(); }
+AccountBuffer::Roe<void> AccountBuffer::commitTo(AccountBuffer &base) {
+  if (&base != base_) {
+    return Error(E_INPUT, "Overlay can only be committed to its own base");
+  }
+  for (uint64_t id : hiddenBaseIds_) {
+    base.remove(id);
+  }
+  for (const auto &account : accounts_) {
+    base.remove(account.id);
+    auto addResult = base.add(account);
+    if (!addResult) {
+      return addResult;
+    }
+  }
+  for (const auto &[id, deltas] : mBalanceDeltas_) {
+    if (!base.hasAccount(id)) {
+      return Error(E_ACCOUNT, "Account not found: " + std::to_string(id));
+    }
+    for (const auto &[tokenId, delta] : deltas) {
+      base.setBalance(id, tokenId,
+                      static_cast<int64_t>(
+                          static_cast<uint64_t>(base.getBalance(id, tokenId)) +
+                          static_cast<uint64_t>(delta)));
+    }
+  }
+  clear();
+  return {};
+}
+
+void AccountBuffer::clear() {
+  accounts_.clear();
+  nativeBalances_.clear();
+  index_.clear();
+  renewalIndex_.clear();
+  stakeDirty_.clear();
+  stakeChangedIds_.clear();
+  isFullStakeUpdatePending_ = true;
+  totalStake_ = 0;
+  hiddenBaseIds_.clear();
+  mBalanceDeltas_.clear();
+  baseStakeAdjust_ = 0;
+}
 
 void AccountBuffer::reset() { clear(); }
 
@@ -5,15 +5,30 @@
 #include "../consensus/Ouroboros.h"
 #include "lib/common/ResultOrError.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <map>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace pp {
 
 /**
  * AccountBuffer - Manages user accounts in a buffer.
+ *
+ * Accounts are stored densely in a vector and located through an
+ * open-addressing id index, with the native token balance kept in a parallel
+ * array so balance checks and stake scans stay on contiguous memory.
+ * References returned by getAccount() are invalidated by add/remove/writeOff.
+ *
+ * A buffer given a base with setBase() is a copy-on-write overlay: accounts it
+ * has not replaced are read through to the base, balance changes on them are
+ * kept as per-token deltas, and removals as hidden ids. Only accounts that are
+ * added (or removed and re-added, as updates and renewals do) are stored
+ * locally, so clear() and commitTo() cost O(changes) instead of O(accounts).
+ * The base must outlive the overlay and is never modified except by commitTo().
  */
 class AccountBuffer {
 public:
@@ -37,11 +52,20 @@ public:
   constexpr static int32_t E_BALANCE = 2;
   constexpr static int32_t E_INPUT = 3;
 
+  /** Native-token stake changes, see takeStakeUpdate(). */
+  struct StakeUpdate {
+    bool isFull{false}; // changes describe the whole distribution
+    std::vector<consensus::Stakeholder> changes; // current stake, 0 = removed
+  };
+
   struct Account {
     uint64_t id{0};
     Client::Wallet wallet;
     uint64_t blockId{
         0}; // blockId of the last registration/renewal of the account
+    // Serialized meta of that registration/renewal record, so renewals need
+    // not re-read block `blockId`. Empty means unknown (read from the ledger).
+    std::string meta;
   };
 
   AccountBuffer();
@@ -49,12 +73,25 @@ public:
 
   bool isEmpty() const;
   bool hasAccount(uint64_t id) const;
+  size_t size() const;
+  bool isOverlay() const;
   /** Returns account IDs whose blockId is strictly before the given blockId
-   * (account.blockId < blockId). */
+   * (account.blockId < blockId), in ascending id order. Served from the
+   * renewal index in O(k log N) for k matching accounts. */
   std::vector<uint64_t> getAccountIdsBeforeBlockId(uint64_t blockId) const;
   Roe<const Account &> getAccount(uint64_t id) const;
   int64_t getBalance(uint64_t accountId, uint64_t tokenId) const;
+  /** Accounts with positive native balance, in ascending id order. */
   std::vector<consensus::Stakeholder> getStakeholders() const;
+  /** Sum of positive native balances, maintained on every balance change. */
+  uint64_t getTotalStake() const;
+  /** Stakes changed since the previous call, in ascending id order. The
+   * first call, and the first call after clear() or requestFullStakeUpdate(),
+   * returns the full distribution with isFull set. */
+  StakeUpdate takeStakeUpdate();
+  /** Make the next takeStakeUpdate() return the full distribution. Overlays
+   * always return the full distribution. */
+  void requestFullStakeUpdate();
 
   /** Verify if an account has sufficient spending power for a transaction.
    *  Checks both the transfer amount and fee balance requirements.
@@ -75,6 +112,9 @@ public:
 
   Roe<void> add(const Account &account);
 
+  /** Replace existing accounts with their versions in `other`. When `other`
+   * is an overlay its balance deltas are applied too; an overlay that removed
+   * base accounts is rejected with E_INPUT (use commitTo()). */
   Roe<void> update(const AccountBuffer &other);
 
   /** Ensure `accountId` exists in this buffer by copying it from `committed`
@@ -96,13 +136,77 @@ public:
   /** Remove account by id. No-op if id does not exist. */
   void remove(uint64_t id);
 
+  /** Clear this buffer and make it an overlay over `base` (nullptr detaches). */
+  void setBase(const AccountBuffer *base);
+  /** Apply this overlay's changes to `base` (which must be its base) in
+   * O(changes), then clear the overlay. */
+  Roe<void> commitTo(AccountBuffer &base);
+
+  /** Drop all accounts; an overlay drops its changes and keeps its base. */
   void clear();
   void reset();
 
 private:
-  bool isNegativeBalanceAllowed(const Account &account, uint64_t tokenId) const;
+  /** Open-addressing (linear probing) slot: account id -> position in accounts_. */
+  struct IndexSlot {
+    uint64_t id{0};
+    uint32_t position{NO_POSITION};
+  };
 
-  std::map<uint64_t, Account> mAccounts_;
+  constexpr static uint32_t NO_POSITION = UINT32_MAX;
+  constexpr static size_t NPOS = SIZE_MAX;
+  constexpr static size_t MIN_INDEX_CAPACITY = 16;
+
+  bool isNegativeBalanceAllowed(uint64_t accountId, uint64_t tokenId) const;
+
+  size_t findPosition(uint64_t id) const;
+  int64_t getBalanceAt(size_t position, uint64_t tokenId) const;
+  void setBalanceAt(size_t position, uint64_t tokenId, int64_t balance);
+  void setNativeBalanceAt(size_t position, int64_t balance);
+  void markStakeChanged(size_t position);
+  void eraseAt(size_t position);
+  void setBalance(uint64_t id, uint64_t tokenId, int64_t balance);
+
+  // Overlay read-through helpers, valid for base accounts without a local copy
+  bool isBaseVisible(uint64_t id) const;
+  int64_t getBaseDelta(uint64_t id, uint64_t tokenId) const;
+  void setBaseBalance(uint64_t id, uint64_t tokenId, int64_t balance);
+  /** Whether account id has an entry (possibly zero) for tokenId. */
+  bool hasBalanceEntry(uint64_t id, uint64_t tokenId) const;
+  std::map<uint64_t, int64_t> getBaseBalances(uint64_t id) const;
+  void hideBaseAccount(uint64_t id);
+
+  size_t homeSlot(uint64_t id) const;
+  void indexInsert(uint64_t id, uint32_t position);
+  void indexUpdate(uint64_t id, uint32_t position);
+  void indexErase(uint64_t id);
+  void rehash(size_t capacity);
+
+  // Dense account storage, unordered (removal moves the last account into the hole)
+  std::vector<Account> accounts_;
+  // Native token (ID_GENESIS) balance per position, mirrors accounts_[i].wallet.mBalances
+  std::vector<int64_t> nativeBalances_;
+  // Power-of-two sized id index, load factor kept at or below 1/2
+  std::vector<IndexSlot> index_;
+  // Positions whose stake changed since the last takeStakeUpdate()
+  std::vector<uint8_t> stakeDirty_;
+  // Ids of changed stakes, may contain duplicates after remove + re-add
+  std::vector<uint64_t> stakeChangedIds_;
+  bool isFullStakeUpdatePending_{true};
+  uint64_t totalStake_{0};
+  // Renewal deadline index: (account.blockId, account.id), kept in sync with accounts_
+  std::set<std::pair<uint64_t, uint64_t>> renewalIndex_;
+
+  // Overlay state (see setBase); all empty when base_ is null
+  const AccountBuffer *base_{nullptr};
+  // Base accounts removed in, or shadowed by a local account of, this overlay
+  std::set<uint64_t> hiddenBaseIds_;
+  // Balance changes of read-through base accounts: accountId -> tokenId -> delta;
+  // getAccount() applies them to a copy of the base account
+  std::map<uint64_t, std::map<uint64_t, int64_t>> mBalanceDeltas_;
+  // Native stake change of base accounts: merged minus base stake of accounts
+  // with deltas, minus base stake of hidden accounts (wraps like totalStake_)
+  uint64_t baseStakeAdjust_{0};
 };
 
 } // namespace pp
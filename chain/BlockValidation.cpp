@@ -5,6 +5,7 @@
 #include "lib/common/Utilities.h"
 
 #include <limits>
+#include <ostream>
 #include <set>
 #include <utility>
 
@@ -32,8 +33,14 @@ bool isValidTimestamp(const consensus::Ouroboros &consensus,
 } // namespace
 
 std::string calculateBlockHash(const Ledger::Block &block) {
-  std::string serialized = block.ltsToString();
-  return utl::sha256(serialized);
+  if (block.version >= Ledger::Block::VERSION_MERKLE) {
+    return Ledger::BlockHeader::fromBlock(block).calculateHash();
+  }
+  // Version 1: hash the serialized block as it is written, no intermediate copy
+  utl::Sha256Sink sink;
+  std::ostream os(&sink);
+  block.ltsToStream(os);
+  return sink.finalHex();
 }
 
 chain_tx::Roe<void> validateGenesisBlock(const Ledger::ChainNode &block,
@@ -429,12 +436,10 @@ chain_tx::Roe<void> validateAccountRenewals(
   }
   const uint64_t maxBlockIdForRenewal = maxBlockIdResult.value();
 
-  std::set<uint64_t> accountsNeedingRenewal;
+  std::vector<uint64_t> accountsNeedingRenewal;
   if (maxBlockIdForRenewal > 0) {
-    for (uint64_t accountId :
-         bank.getAccountIdsBeforeBlockId(maxBlockIdForRenewal)) {
-      accountsNeedingRenewal.insert(accountId);
-    }
+    accountsNeedingRenewal =
+        bank.getAccountIdsBeforeBlockId(maxBlockIdForRenewal);
   }
 
   std::set<uint64_t> accountsRenewedInBlock;
@@ -3,12 +3,15 @@
 #include "RecordHandler.h"
 #include "TxFees.h"
 #include "TxLedgerMeta.h"
+#include "TxSchedule.h"
 #include "TxSignatures.h"
 #include "lib/common/Logger.h"
 #include "lib/common/Utilities.h"
 #include <algorithm>
 #include <chrono>
+#include <climits>
 #include <filesystem>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -34,6 +37,9 @@ Chain::Roe<void> mapTxVoid(chain_tx::Roe<void> r) {
 
 Chain::Chain() {
   redirectLogger("Chain");
+  parallelApplyThreads_ =
+      std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()),
+                       MAX_PARALLEL_APPLY_THREADS);
   txContext_.ledger.redirectLogger(log().getFullName() + ".Ledger");
   txContext_.consensus.redirectLogger(log().getFullName() + ".Obo");
   recordHandler_.redirectLoggers(log().getFullName());
@@ -78,6 +84,10 @@ bool Chain::shouldUseStrictMode(uint64_t blockIndex) const {
   return blockIndex >= txContext_.checkpoint.currentId;
 }
 
+bool Chain::isAssumedValid(uint64_t blockIndex) const {
+  return assumeValid_.isEnabled() && blockIndex <= assumeValid_.blockId;
+}
+
 bool Chain::needsCheckpoint(const BlockChainConfig &config) const {
   const uint64_t age = chain_block::getBlockAgeSeconds(
       txContext_.checkpoint.currentId, txContext_.ledger,
@@ -150,6 +160,15 @@ Chain::Roe<Ledger::ChainNode> Chain::readBlock(uint64_t blockId) const {
   return result.value();
 }
 
+Chain::Roe<Ledger::BlockLocation> Chain::readRawBlock(uint64_t blockId) const {
+  auto result = txContext_.ledger.readRawBlock(blockId);
+  if (!result) {
+    return Error(E_BLOCK_NOT_FOUND,
+                 "Block not found: " + std::to_string(blockId));
+  }
+  return result.value();
+}
+
 Chain::Roe<Client::UserAccount> Chain::getAccount(uint64_t accountId) const {
   auto roeAccount = txContext_.bank.getAccount(accountId);
   if (!roeAccount) {
@@ -163,15 +182,19 @@ Chain::Roe<Client::UserAccount> Chain::getAccount(uint64_t accountId) const {
 }
 
 Chain::Roe<std::string> Chain::getUpdatedAccountMetadataForRenewal(
-    const Ledger::Block &block, const AccountBuffer::Account &account,
-    uint64_t minFee) const {
+    const AccountBuffer::Account &account, uint64_t minFee) const {
   const auto &fns = txContext_.fnAccountMetaForRecord;
   if (!fns.has_value()) {
     return Error(E_INTERNAL,
                  "Account meta extractors not configured on TxContext");
   }
+  auto metaResult = chain_tx::getAccountMeta(txContext_.ledger, account,
+                                             fns->fnUser, fns->fnGenesis);
+  if (!metaResult) {
+    return Error(metaResult.error());
+  }
   return mapTx(chain_tx::getUpdatedAccountMetadataForRenewal(
-      block, account, minFee, fns->fnUser, fns->fnGenesis));
+      metaResult.value(), account, minFee));
 }
 
 Chain::Roe<Ledger::Record>
@@ -209,16 +232,8 @@ Chain::createRenewalTx(uint64_t accountId) const {
   }
 
   if (type == Ledger::T_RENEWAL) {
-    // Get account metadata from previous block
-    auto blockResult = txContext_.ledger.readBlock(account.blockId);
-    if (!blockResult) {
-      return Error(E_BLOCK_NOT_FOUND,
-                   "Block not found: " + std::to_string(account.blockId));
-    }
-    auto const &block = blockResult.value().block;
     tx.fee = minimumFee;
-    auto metaResult =
-        getUpdatedAccountMetadataForRenewal(block, account, minimumFee);
+    auto metaResult = getUpdatedAccountMetadataForRenewal(account, minimumFee);
     if (!metaResult) {
       return metaResult.error();
     }
@@ -335,8 +350,8 @@ Chain::findTransactionsByWalletId(uint64_t walletId,
   return out;
 }
 
-Chain::Roe<Ledger::Record>
-Chain::findTransactionByIndex(uint64_t txIndex) const {
+Chain::Roe<Ledger::ChainNode>
+Chain::readBlockByTxIndex(uint64_t txIndex) const {
   const uint64_t firstBlockId = txContext_.ledger.getStartingBlockId();
   const uint64_t nextBlockId = txContext_.ledger.getNextBlockId();
   if (nextBlockId <= firstBlockId) {
@@ -360,49 +375,71 @@ Chain::findTransactionByIndex(uint64_t txIndex) const {
                      " >= " + std::to_string(totalTxCount));
   }
 
-  uint64_t low = firstBlockId;
-  uint64_t high = nextBlockId - 1;
-
-  while (low <= high) {
-    const uint64_t mid = low + (high - low) / 2;
-    auto blockRoe = txContext_.ledger.readBlock(mid);
-    if (!blockRoe) {
-      return Error(
-          E_LEDGER_READ,
-          "Failed to read block " + std::to_string(mid) +
-              " during findTransactionByIndex: " + blockRoe.error().message);
-    }
+  auto blockIdRoe = txContext_.ledger.findBlockIdByTxIndex(txIndex);
+  if (!blockIdRoe) {
+    return Error(E_LEDGER_READ, "Failed to locate transaction index " +
+                                    std::to_string(txIndex) + ": " +
+                                    blockIdRoe.error().message);
+  }
 
-    const auto &block = blockRoe.value().block;
-    const uint64_t blockStart = block.txIndex;
-    const uint64_t blockTxCount =
-        static_cast<uint64_t>(block.records.size());
+  const uint64_t blockId = blockIdRoe.value();
+  auto blockRoe = txContext_.ledger.readBlock(blockId);
+  if (!blockRoe) {
+    return Error(E_LEDGER_READ,
+                 "Failed to read block " + std::to_string(blockId) +
+                     " for transaction index " + std::to_string(txIndex) +
+                     ": " + blockRoe.error().message);
+  }
 
-    if (txIndex < blockStart) {
-      if (mid == firstBlockId) {
-        break;
-      }
-      high = mid - 1;
-      continue;
-    }
+  const auto &block = blockRoe.value().block;
+  const uint64_t blockStart = block.txIndex;
+  const uint64_t blockEnd =
+      blockStart + static_cast<uint64_t>(block.records.size()); // exclusive
+  if (txIndex < blockStart || txIndex >= blockEnd) {
+    return Error(E_LEDGER_READ, "Transaction index " + std::to_string(txIndex) +
+                                    " not found in block " + std::to_string(blockId));
+  }
+  return blockRoe.value();
+}
 
-    if (blockTxCount == 0) {
-      low = mid + 1;
-      continue;
-    }
+Chain::Roe<Ledger::Record>
+Chain::findTransactionByIndex(uint64_t txIndex) const {
+  auto nodeRoe = readBlockByTxIndex(txIndex);
+  if (!nodeRoe) {
+    return nodeRoe.error();
+  }
+  const auto &block = nodeRoe.value().block;
+  const uint64_t localIndex = txIndex - block.txIndex;
+  return block.records[static_cast<size_t>(localIndex)];
+}
 
-    const uint64_t blockEnd = blockStart + blockTxCount; // exclusive
-    if (txIndex >= blockEnd) {
-      low = mid + 1;
-      continue;
-    }
+Chain::Roe<Ledger::TxProof>
+Chain::findTransactionProof(uint64_t txIndex) const {
+  auto nodeRoe = readBlockByTxIndex(txIndex);
+  if (!nodeRoe) {
+    return nodeRoe.error();
+  }
+  const auto &node = nodeRoe.value();
+  if (node.block.version < Ledger::Block::VERSION_MERKLE) {
+    return Error(E_INVALID_ARGUMENT,
+                 "Block " + std::to_string(node.block.index) + " (version " +
+                     std::to_string(node.block.version) +
+                     ") has no Merkle root");
+  }
 
-    const uint64_t localIndex = txIndex - blockStart;
-    return block.records[static_cast<size_t>(localIndex)];
+  const uint64_t localIndex = txIndex - node.block.txIndex;
+  auto proofRoe = Ledger::buildMerkleProof(node.block.records, localIndex);
+  if (!proofRoe) {
+    return Error(E_INTERNAL, "Failed to build Merkle proof: " +
+                                 proofRoe.error().message);
   }
 
-  return Error(E_LEDGER_READ, "Transaction index " + std::to_string(txIndex) +
-                                  " not found in any block");
+  Ledger::TxProof txProof;
+  txProof.record = node.block.records[static_cast<size_t>(localIndex)];
+  txProof.header = Ledger::BlockHeader::fromBlock(node.block);
+  txProof.blockHash = node.hash;
+  txProof.proof = std::move(proofRoe.value());
+  return txProof;
 }
 
 std::string Chain::calculateHash(const Ledger::Block &block) const {
@@ -411,21 +448,30 @@ std::string Chain::calculateHash(const Ledger::Block &block) const {
 
 void Chain::refreshStakeholders() {
   if (txContext_.consensus.isStakeUpdateNeeded()) {
-    auto stakeholders = txContext_.bank.getStakeholders();
-    txContext_.consensus.setStakeholders(stakeholders);
+    applyStakeUpdate(txContext_.consensus.getCurrentEpoch());
   }
 }
 
 void Chain::refreshStakeholders(uint64_t blockSlot) {
   uint64_t epoch = txContext_.consensus.getEpochFromSlot(blockSlot);
   if (txContext_.consensus.isStakeUpdateNeeded(epoch)) {
-    auto stakeholders = txContext_.bank.getStakeholders();
-    txContext_.consensus.setStakeholders(stakeholders, epoch);
+    applyStakeUpdate(epoch);
+  }
+}
+
+void Chain::applyStakeUpdate(uint64_t epoch) {
+  // Bank tracks stake deltas since the last hand-off; full set only after reset
+  auto update = txContext_.bank.takeStakeUpdate();
+  if (update.isFull) {
+    txContext_.consensus.setStakeholders(update.changes, epoch);
+  } else {
+    txContext_.consensus.updateStakeholders(update.changes, epoch);
   }
 }
 
 void Chain::initConsensus(const consensus::Ouroboros::Config &config) {
   txContext_.consensus.init(config);
+  txContext_.bank.requestFullStakeUpdate();
 }
 
 Chain::Roe<void> Chain::initLedger(const Ledger::InitConfig &config) {
@@ -525,6 +571,16 @@ Chain::Roe<void> Chain::addBlock(const Ledger::ChainNode &block) {
 
 Chain::Roe<void> Chain::processBlock(const Ledger::ChainNode &block,
                                      bool isStrictMode) {
+  // Hash linkage is still validated below, so a match here vouches for every
+  // assumed-valid block before it
+  if (assumeValid_.isEnabled() && block.block.index == assumeValid_.blockId &&
+      block.hash != assumeValid_.blockHash) {
+    return Error(E_BLOCK_HASH, "Block " + std::to_string(block.block.index) +
+                                   " hash " + block.hash +
+                                   " does not match assume-valid hash " +
+                                   assumeValid_.blockHash);
+  }
+
   if (block.block.index == 0) {
     return processGenesisBlock(block);
   } else {
@@ -553,8 +609,11 @@ Chain::Roe<void> Chain::processGenesisBlock(const Ledger::ChainNode &block) {
 
 Chain::Roe<void> Chain::processNormalBlock(const Ledger::ChainNode &block,
                                            bool isStrictMode) {
+  // Assumed-valid blocks skip the slot-leader and timing checks of strict
+  // validation but are still applied with strict state rules
+  const bool isTrusted = isAssumedValid(block.block.index);
   auto roe = mapTxVoid(chain_block::validateNormalBlock(
-      block, isStrictMode, txContext_.ledger, txContext_.consensus,
+      block, isStrictMode && !isTrusted, txContext_.ledger, txContext_.consensus,
       txContext_.bank, txContext_.optChainConfig, txContext_.checkpoint,
       recordHandler_));
   if (!roe) {
@@ -563,13 +622,10 @@ Chain::Roe<void> Chain::processNormalBlock(const Ledger::ChainNode &block,
                                          ": " + roe.error().message);
   }
 
-  for (const auto &rec : block.block.records) {
-    auto result = processNormalTxRecord(rec, block.block.index, block.block.slot,
-                                        block.block.slotLeader, isStrictMode);
-    if (!result) {
-      return Error(E_TX_VALIDATION,
-                   "Failed to process transaction: " + result.error().message);
-    }
+  auto applyResult =
+      applyNormalTxRecords(block.block, isStrictMode, isTrusted);
+  if (!applyResult) {
+    return applyResult;
   }
 
   if (txContext_.optChainConfig.has_value() &&
@@ -584,6 +640,163 @@ Chain::Roe<void> Chain::processNormalBlock(const Ledger::ChainNode &block,
   return {};
 }
 
+Chain::Roe<void> Chain::applyNormalTxRecords(const Ledger::Block &block,
+                                             bool isStrictMode,
+                                             bool isAssumedValid) {
+  if (parallelApplyThreads_ <= 1) {
+    return applyNormalTxRecordsSerial(block, 0, block.records.size(),
+                                      isStrictMode, isAssumedValid);
+  }
+
+  for (const auto &wave : chain_tx::scheduleTxWaves(block.records, isStrictMode)) {
+    if (wave.isParallel && isParallelWaveWorthwhile(wave)) {
+      auto result = applyParallelWave(block, wave, isStrictMode, isAssumedValid);
+      if (result) {
+        continue;
+      }
+      if (result.error().code == E_INTERNAL) {
+        return result;
+      }
+      // Shards were discarded; replay serially for the exact serial error
+    }
+    auto result = applyNormalTxRecordsSerial(block, wave.begin, wave.end,
+                                             isStrictMode, isAssumedValid);
+    if (!result) {
+      return result;
+    }
+  }
+  return {};
+}
+
+Chain::Roe<void> Chain::applyNormalTxRecordsSerial(const Ledger::Block &block,
+                                                   size_t begin, size_t end,
+                                                   bool isStrictMode,
+                                                   bool isAssumedValid) {
+  for (size_t i = begin; i < end; ++i) {
+    auto result = applyNormalTxRecord(block.records[i], txContext_.bank,
+                                      block.index, block.slot,
+                                      block.slotLeader, isStrictMode,
+                                      isAssumedValid);
+    if (!result) {
+      return Error(E_TX_VALIDATION,
+                   "Failed to process transaction: " + result.error().message);
+    }
+  }
+  return {};
+}
+
+bool Chain::isParallelWaveWorthwhile(const chain_tx::TxWave &wave) const {
+  if (wave.size() < MIN_PARALLEL_WAVE_SIZE) {
+    return false;
+  }
+  // Shards credit fees independently; only merge them when the fee account
+  // cannot overflow, where serial order would decide which record fails
+  if (wave.feeCredit > 0 && txContext_.bank.hasAccount(AccountBuffer::ID_FEE)) {
+    const int64_t feeBalance =
+        txContext_.bank.getBalance(AccountBuffer::ID_FEE, AccountBuffer::ID_GENESIS);
+    if (wave.feeCredit > static_cast<uint64_t>(INT64_MAX) ||
+        feeBalance > INT64_MAX - static_cast<int64_t>(wave.feeCredit)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Chain::Roe<void> Chain::applyParallelWave(const Ledger::Block &block,
+                                          const chain_tx::TxWave &wave,
+                                          bool isStrictMode,
+                                          bool isAssumedValid) {
+  const size_t shardCount =
+      std::min(parallelApplyThreads_, wave.size() / MIN_RECORDS_PER_SHARD);
+  std::vector<std::vector<size_t>> shardRecords(shardCount);
+  for (size_t i = wave.begin; i < wave.end; ++i) {
+    const uint64_t senderId = wave.senderIds[i - wave.begin];
+    shardRecords[chain_tx::getShardIndex(senderId, shardCount)].push_back(i);
+  }
+
+  // Records of a wave touch disjoint accounts (fee credits aside, which
+  // commute), so each shard applies its share on its own overlay of the
+  // committed bank, which is only read until the shards are merged
+  std::vector<AccountBuffer> shards(shardCount);
+  std::vector<std::optional<Error>> errors(shardCount);
+  auto applyShard = [&](size_t shard) {
+    shards[shard].setBase(&txContext_.bank);
+    for (size_t i : shardRecords[shard]) {
+      auto result = applyNormalTxRecord(block.records[i], shards[shard],
+                                        block.index, block.slot,
+                                        block.slotLeader, isStrictMode,
+                                        isAssumedValid);
+      if (!result) {
+        errors[shard] = result.error();
+        return;
+      }
+    }
+  };
+
+  if (!applyPool_) {
+    applyPool_ = std::make_unique<WorkerPool>(parallelApplyThreads_ - 1);
+  }
+  applyPool_->run(shardCount, applyShard);
+
+  for (const auto &error : errors) {
+    if (error) {
+      return Error(E_TX_VALIDATION, error->message);
+    }
+  }
+  for (auto &shard : shards) {
+    auto commitResult = shard.commitTo(txContext_.bank);
+    if (!commitResult) {
+      return Error(E_INTERNAL, "Failed to merge transaction shard: " +
+                                   commitResult.error().message);
+    }
+  }
+  return {};
+}
+
+void Chain::setParallelApplyThreads(size_t threads) {
+  if (threads != parallelApplyThreads_) {
+    applyPool_.reset();
+  }
+  parallelApplyThreads_ = threads;
+}
+
+void Chain::setAssumeValid(const AssumeValidConfig &config) {
+  assumeValid_ = config;
+  if (assumeValid_.isEnabled()) {
+    log().info << "Assuming blocks up to " << assumeValid_.blockId
+               << " are valid (hash " << assumeValid_.blockHash << ")";
+  }
+}
+
+Chain::Roe<void> Chain::checkAssumeValid() const {
+  if (!assumeValid_.isEnabled()) {
+    return {};
+  }
+  const std::string blockIdStr = std::to_string(assumeValid_.blockId);
+  if (getNextBlockId() <= assumeValid_.blockId) {
+    return Error(E_BLOCK_NOT_FOUND, "Assume-valid block " + blockIdStr +
+                                        " not reached, next block is " +
+                                        std::to_string(getNextBlockId()));
+  }
+  auto blockResult = txContext_.ledger.readBlock(assumeValid_.blockId);
+  if (!blockResult) {
+    return Error(E_BLOCK_NOT_FOUND, "Assume-valid block " + blockIdStr +
+                                        " not found in ledger: " +
+                                        blockResult.error().message);
+  }
+  if (blockResult.value().hash != assumeValid_.blockHash) {
+    return Error(E_BLOCK_HASH, "Assume-valid block " + blockIdStr + " hash " +
+                                   blockResult.value().hash +
+                                   " does not match trusted hash " +
+                                   assumeValid_.blockHash);
+  }
+  return {};
+}
+
+void Chain::initBufferBank(AccountBuffer &bank) const {
+  bank.setBase(&txContext_.bank);
+}
+
 Chain::Roe<void> Chain::addBufferTransaction(
     AccountBuffer &bank,
     const Ledger::Record &record,
@@ -617,13 +830,16 @@ Chain::Roe<void> Chain::processGenesisTxRecord(
   return mapTxVoid(recordHandler_.applyBlock(record, txContext_.bank, ctx));
 }
 
-Chain::Roe<void> Chain::processNormalTxRecord(
-    const Ledger::Record &record, uint64_t blockId,
-    uint64_t blockSlot, uint64_t slotLeaderId, bool isStrictMode) {
-  auto roe = validateTxSignatures(record, slotLeaderId, isStrictMode);
-  if (!roe) {
-    return Error(E_TX_SIGNATURE,
-                 "Failed to validate transaction: " + roe.error().message);
+Chain::Roe<void> Chain::applyNormalTxRecord(
+    const Ledger::Record &record, AccountBuffer &bank, uint64_t blockId,
+    uint64_t blockSlot, uint64_t slotLeaderId, bool isStrictMode,
+    bool isAssumedValid) {
+  if (!isAssumedValid) {
+    auto roe = validateTxSignatures(record, slotLeaderId, isStrictMode);
+    if (!roe) {
+      return Error(E_TX_SIGNATURE,
+                   "Failed to validate transaction: " + roe.error().message);
+    }
   }
 
   BlockApplyContext ctx{ txContext_,
@@ -631,7 +847,7 @@ Chain::Roe<void> Chain::processNormalTxRecord(
                          blockSlot,
                          slotLeaderId,
                          isStrictMode };
-  return mapTxVoid(recordHandler_.applyBlock(record, txContext_.bank, ctx));
+  return mapTxVoid(recordHandler_.applyBlock(record, bank, ctx));
 }
 
 Chain::Roe<void> Chain::verifySignaturesAgainstAccount(
@@ -9,13 +9,16 @@
 #include "RecordHandler.h"
 #include "TxContext.h"
 #include "TxError.h"
+#include "TxSchedule.h"
 #include "Types.h"
 #include "lib/common/Crypto.h"
 #include "lib/common/Module.h"
 #include "lib/common/ResultOrError.hpp"
 #include "lib/common/Utilities.h"
+#include "lib/common/WorkerPool.hpp"
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -38,6 +41,7 @@ class Chain : public Module {
 public:
   using Checkpoint = ::pp::Checkpoint;
   using CheckpointConfig = ::pp::CheckpointConfig;
+  using AssumeValidConfig = ::pp::AssumeValidConfig;
   using BlockChainConfig = ::pp::BlockChainConfig;
   using GenesisAccountMeta = ::pp::GenesisAccountMeta;
 
@@ -92,6 +96,9 @@ public:
   constexpr static int32_t E_INTERNAL_BUFFER = chain_err::E_INTERNAL_BUFFER;
   constexpr static int32_t E_INTERNAL = chain_err::E_INTERNAL;
 
+  /** Cap on the default (one per core) and configured parallel apply threads. */
+  constexpr static const size_t MAX_PARALLEL_APPLY_THREADS = 8;
+
   Chain();
   ~Chain() override = default;
 
@@ -125,6 +132,8 @@ public:
   collectRenewals(uint64_t slot) const;
 
   Roe<Ledger::ChainNode> readBlock(uint64_t blockId) const;
+  /** On-disk location of a block's serialized bytes (see Ledger::readRawBlock). */
+  Roe<Ledger::BlockLocation> readRawBlock(uint64_t blockId) const;
   Roe<Ledger::ChainNode> readLastBlock() const;
 
   Roe<uint64_t>
@@ -135,7 +144,26 @@ public:
   findTransactionsByWalletId(uint64_t walletId, uint64_t &ioBlockId) const;
   Roe<Ledger::Record>
   findTransactionByIndex(uint64_t txIndex) const;
-
+  /** Record at txIndex with its Merkle audit path and block header; fails
+   * for blocks older than Ledger::Block::VERSION_MERKLE. */
+  Roe<Ledger::TxProof>
+  findTransactionProof(uint64_t txIndex) const;
+
+  /** Make `bank` a copy-on-write overlay over the committed accounts, so
+   * addBufferTransaction() reads through instead of copying touched accounts.
+   * Its deltas are relative to the committed state, so clear it whenever a
+   * block is added. */
+  void initBufferBank(AccountBuffer &bank) const;
+  /** Threads used to apply independent transfers of a block concurrently
+   * (see chain_tx::scheduleTxWaves); 0 or 1 applies records one at a time.
+   * The resulting state is the same either way. */
+  void setParallelApplyThreads(size_t threads);
+  /** Trust blocks up to config.blockId: they keep hash-chain checks but skip
+   * signature and slot-leader verification. */
+  void setAssumeValid(const AssumeValidConfig &config);
+  /** Fails unless the assume-valid block is in the ledger with the trusted
+   * hash; succeeds when assume-valid is disabled. */
+  Roe<void> checkAssumeValid() const;
   Roe<void>
   addBufferTransaction(AccountBuffer &bank,
                        const Ledger::Record &record,
@@ -159,15 +187,25 @@ private:
    */
   constexpr static const uint64_t MAX_BLOCKS_TO_SCAN_FOR_WALLET_TX = 32;
   constexpr static const uint64_t THRESHOLD_TXES_FOR_WALLET_TX = 32;
+  /** Smaller waves are applied serially; threads would cost more than they save. */
+  constexpr static const size_t MIN_PARALLEL_WAVE_SIZE = 16;
+  constexpr static const size_t MIN_RECORDS_PER_SHARD = 8;
 
   bool shouldUseStrictMode(uint64_t blockIndex) const;
+  bool isAssumedValid(uint64_t blockIndex) const;
+
+  /** Read the block holding global transaction index txIndex. */
+  Roe<Ledger::ChainNode> readBlockByTxIndex(uint64_t txIndex) const;
+
+  /** Hand the bank's stake changes (or full distribution after a reset) to consensus. */
+  void applyStakeUpdate(uint64_t epoch);
 
   /** Account metadata for renewal: user accounts get genesis balance adjusted
    * to post-renewal (current - fee) since verifyBalance expects that. Uses
+   * the meta cached on the account, falling back to the ledger through the
    * TxContext account-meta extractors (from RecordHandler). */
   Roe<std::string>
-  getUpdatedAccountMetadataForRenewal(const Ledger::Block &block,
-                                      const AccountBuffer::Account &account,
+  getUpdatedAccountMetadataForRenewal(const AccountBuffer::Account &account,
                                       uint64_t minFee) const;
 
   Roe<void>
@@ -193,9 +231,22 @@ private:
   Roe<void> processGenesisTxRecord(
       const Ledger::Record &record);
   Roe<void>
-  processNormalTxRecord(const Ledger::Record &record,
-                        uint64_t blockId, uint64_t blockSlot,
-                        uint64_t slotLeaderId, bool isStrictMode);
+  applyNormalTxRecord(const Ledger::Record &record, AccountBuffer &bank,
+                      uint64_t blockId, uint64_t blockSlot,
+                      uint64_t slotLeaderId, bool isStrictMode,
+                      bool isAssumedValid);
+  /** Apply the records of a normal block in waves of independent records. A
+   * wave that fails in parallel is replayed serially, so errors and state
+   * match applying the records one at a time. */
+  Roe<void> applyNormalTxRecords(const Ledger::Block &block, bool isStrictMode,
+                                 bool isAssumedValid);
+  Roe<void> applyNormalTxRecordsSerial(const Ledger::Block &block, size_t begin,
+                                       size_t end, bool isStrictMode,
+                                       bool isAssumedValid);
+  bool isParallelWaveWorthwhile(const chain_tx::TxWave &wave) const;
+  Roe<void> applyParallelWave(const Ledger::Block &block,
+                              const chain_tx::TxWave &wave, bool isStrictMode,
+                              bool isAssumedValid);
   Roe<void>
   validateTxSignatures(const Ledger::Record &record,
                        uint64_t slotLeaderId, bool isStrictMode) const;
@@ -203,6 +254,11 @@ private:
   TxContext txContext_{};
 
   RecordHandler recordHandler_{};
+  size_t parallelApplyThreads_{ 1 };
+  // Workers for parallel waves (the applying thread runs one shard itself),
+  // created on first use and kept across blocks
+  std::unique_ptr<WorkerPool> applyPool_;
+  AssumeValidConfig assumeValid_{};
 };
 
 std::ostream &operator<<(std::ostream &os, const CheckpointConfig &config);
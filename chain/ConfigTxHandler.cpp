@@ -117,6 +117,7 @@ chain_tx::Roe<void> applyConfigUpdateCore(
   account.id = AccountBuffer::ID_GENESIS;
   account.blockId = blockId;
   account.wallet = gm.genesis.wallet;
+  account.meta = tx.meta;
   auto addResult = bank.add(account);
   if (!addResult) {
     return chain_tx::TxError(chain_err::E_INTERNAL_BUFFER,
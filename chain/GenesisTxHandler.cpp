@@ -92,6 +92,7 @@ chain_tx::Roe<void> GenesisTxHandler::applyGenesisInit(
   genesisAccount.id = AccountBuffer::ID_GENESIS;
   genesisAccount.blockId = 0;
   genesisAccount.wallet = gm.genesis.wallet;
+  genesisAccount.meta = tx.meta;
   auto roeAddGenesis = ctx.bank.add(genesisAccount);
   if (!roeAddGenesis) {
     return chain_tx::TxError(
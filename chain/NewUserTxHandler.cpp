@@ -210,6 +210,7 @@ chain_tx::Roe<void> NewUserTxHandler::applyNewUser(
   account.blockId = blockId;
   account.wallet = userAccount.wallet;
   account.wallet.mBalances.clear();
+  account.meta = tx.meta;
 
   auto addResult = bank.add(account);
   if (!addResult) {
@@ -177,8 +177,7 @@ chain_tx::Roe<void> RenewalTxHandler::applyRenewal(
     }
   }
 
-  auto genesisAccountResult = bank.getAccount(AccountBuffer::ID_GENESIS);
-  if (!genesisAccountResult) {
+  if (!bank.hasAccount(AccountBuffer::ID_GENESIS)) {
     if (isStrictMode) {
       return chain_tx::TxError(chain_err::E_ACCOUNT_NOT_FOUND,
                                "Genesis account not found for renewal");
@@ -199,6 +198,7 @@ chain_tx::Roe<void> RenewalTxHandler::applyRenewal(
   account.id = AccountBuffer::ID_GENESIS;
   account.blockId = blockId;
   account.wallet = gm.genesis.wallet;
+  account.meta = tx.meta;
   auto addResult = bank.add(account);
   if (!addResult) {
     return chain_tx::TxError(
@@ -93,30 +93,17 @@ Roe<uint64_t> calculateMinimumFeeForAccountMeta(
                    "User account not found: " + std::to_string(accountId));
   }
 
-  auto blockResult = ledger.readBlock(accountResult.value().blockId);
-  if (!blockResult) {
-    return TxError(chain_err::E_BLOCK_NOT_FOUND,
-                   "Block not found: " +
-                       std::to_string(accountResult.value().blockId));
+  const auto &account = accountResult.value();
+  auto metaResult = getAccountMeta(ledger, account, fnUserMetaForRecord,
+                                   fnGenesisMetaForRecord);
+  if (!metaResult) {
+    return metaResult.error();
   }
-
-  size_t metaSize = 0;
-
-  if (accountId == AccountBuffer::ID_GENESIS) {
-    auto metaResult = getGenesisAccountMetaFromBlock(
-        blockResult.value().block, fnGenesisMetaForRecord);
-    if (!metaResult) {
-      return metaResult.error();
-    }
-    metaSize = metaResult.value().genesis.meta.size();
-  } else {
-    auto userMetaResult = getUserAccountMetaFromBlock(
-        blockResult.value().block, accountId, fnUserMetaForRecord);
-    if (!userMetaResult) {
-      return userMetaResult.error();
-    }
-    metaSize = userMetaResult.value().meta.size();
+  auto metaSizeResult = getAccountCustomMetaSize(account, metaResult.value());
+  if (!metaSizeResult) {
+    return metaSizeResult.error();
   }
+  const size_t metaSize = metaSizeResult.value();
 
   if (metaSize > config.maxCustomMetaSize) {
     return TxError(chain_err::E_TX_VALIDATION,
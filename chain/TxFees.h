@@ -32,7 +32,8 @@ Roe<uint64_t> calculateMinimumFeeForTransaction(
     const BlockChainConfig &config, const Ledger::TypedTx &tx,
     const FnBillableCustomMetaSizeForFee &fnBillableCustomMetaSizeForFee);
 
-/** Minimum renewal fee from serialized account meta at the account's block. */
+/** Minimum renewal fee from the account's serialized meta (cached on the
+ *  account, or read from the account's block). */
 Roe<uint64_t> calculateMinimumFeeForAccountMeta(
     const Ledger &ledger, const BlockChainConfig &config,
     const AccountBuffer &bank, uint64_t accountId,
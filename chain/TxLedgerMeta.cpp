@@ -6,61 +6,121 @@
 
 namespace pp::chain_tx {
 
-Roe<Client::UserAccount>
-getUserAccountMetaFromBlock(const Ledger::Block &block, uint64_t accountId,
-                            const FnUserAccountMetaForRecord &fnUserMetaForRecord) {
+namespace {
+
+Roe<Client::UserAccount> parseUserAccountMeta(const std::string &meta) {
+  Client::UserAccount userAccount;
+  if (!userAccount.ltsFromString(meta)) {
+    return TxError(chain_err::E_INTERNAL_DESERIALIZE,
+                   "Failed to deserialize account info: " +
+                       std::to_string(meta.size()) + " bytes");
+  }
+  return userAccount;
+}
+
+Roe<GenesisAccountMeta> parseGenesisAccountMeta(const std::string &meta) {
+  GenesisAccountMeta gm;
+  if (!gm.ltsFromString(meta)) {
+    return TxError(chain_err::E_INTERNAL_DESERIALIZE,
+                   "Failed to deserialize checkpoint: " +
+                       std::to_string(meta.size()) + " bytes");
+  }
+  return gm;
+}
+
+Roe<std::string>
+findUserAccountMetaInBlock(const Ledger::Block &block, uint64_t accountId,
+                           const FnUserAccountMetaForRecord &fnUserMetaForRecord) {
   for (auto it = block.records.rbegin(); it != block.records.rend();
        ++it) {
     auto metaOpt = fnUserMetaForRecord(*it, accountId);
-    if (!metaOpt) {
-      continue;
-    }
-    const std::string &meta = *metaOpt;
-    Client::UserAccount userAccount;
-    if (!userAccount.ltsFromString(meta)) {
-      return TxError(chain_err::E_INTERNAL_DESERIALIZE,
-                     "Failed to deserialize account info: " +
-                         std::to_string(meta.size()) + " bytes");
+    if (metaOpt) {
+      return std::move(*metaOpt);
     }
-    return userAccount;
   }
-
   return TxError(chain_err::E_INTERNAL,
                  "No prior user/renewal from this account in block");
 }
 
-Roe<GenesisAccountMeta>
-getGenesisAccountMetaFromBlock(
+Roe<std::string> findGenesisAccountMetaInBlock(
     const Ledger::Block &block,
     const FnGenesisAccountMetaForRecord &fnGenesisMetaForRecord) {
   for (auto it = block.records.rbegin(); it != block.records.rend();
        ++it) {
     auto metaOpt = fnGenesisMetaForRecord(*it, block);
-    if (!metaOpt) {
-      continue;
-    }
-    const std::string &meta = *metaOpt;
-
-    GenesisAccountMeta gm;
-    if (!gm.ltsFromString(meta)) {
-      return TxError(chain_err::E_INTERNAL_DESERIALIZE,
-                     "Failed to deserialize checkpoint: " +
-                         std::to_string(meta.size()) + " bytes");
+    if (metaOpt) {
+      return std::move(*metaOpt);
     }
-    return gm;
   }
-
   return TxError(chain_err::E_INTERNAL,
                  "No prior checkpoint/user/renewal from this account in block");
 }
 
-Roe<std::string> getUpdatedAccountMetadataForRenewal(
-    const Ledger::Block &block, const AccountBuffer::Account &account,
-    uint64_t minFee, const FnUserAccountMetaForRecord &fnUserMetaForRecord,
+} // namespace
+
+Roe<Client::UserAccount>
+getUserAccountMetaFromBlock(const Ledger::Block &block, uint64_t accountId,
+                            const FnUserAccountMetaForRecord &fnUserMetaForRecord) {
+  auto metaResult =
+      findUserAccountMetaInBlock(block, accountId, fnUserMetaForRecord);
+  if (!metaResult) {
+    return metaResult.error();
+  }
+  return parseUserAccountMeta(metaResult.value());
+}
+
+Roe<GenesisAccountMeta>
+getGenesisAccountMetaFromBlock(
+    const Ledger::Block &block,
     const FnGenesisAccountMetaForRecord &fnGenesisMetaForRecord) {
+  auto metaResult = findGenesisAccountMetaInBlock(block, fnGenesisMetaForRecord);
+  if (!metaResult) {
+    return metaResult.error();
+  }
+  return parseGenesisAccountMeta(metaResult.value());
+}
+
+Roe<std::string>
+getAccountMeta(const Ledger &ledger, const AccountBuffer::Account &account,
+               const FnUserAccountMetaForRecord &fnUserMetaForRecord,
+               const FnGenesisAccountMetaForRecord &fnGenesisMetaForRecord) {
+  if (!account.meta.empty()) {
+    return account.meta;
+  }
+
+  auto blockResult = ledger.readBlock(account.blockId);
+  if (!blockResult) {
+    return TxError(chain_err::E_BLOCK_NOT_FOUND,
+                   "Block not found: " + std::to_string(account.blockId));
+  }
+  const auto &block = blockResult.value().block;
+  if (account.id == AccountBuffer::ID_GENESIS) {
+    return findGenesisAccountMetaInBlock(block, fnGenesisMetaForRecord);
+  }
+  return findUserAccountMetaInBlock(block, account.id, fnUserMetaForRecord);
+}
+
+Roe<size_t> getAccountCustomMetaSize(const AccountBuffer::Account &account,
+                                     const std::string &meta) {
+  if (account.id == AccountBuffer::ID_GENESIS) {
+    auto gmResult = parseGenesisAccountMeta(meta);
+    if (!gmResult) {
+      return gmResult.error();
+    }
+    return gmResult.value().genesis.meta.size();
+  }
+  auto userResult = parseUserAccountMeta(meta);
+  if (!userResult) {
+    return userResult.error();
+  }
+  return userResult.value().meta.size();
+}
+
+Roe<std::string> getUpdatedAccountMetadataForRenewal(
+    const std::string &meta, const AccountBuffer::Account &account,
+    uint64_t minFee) {
   if (account.id == AccountBuffer::ID_GENESIS) {
-    auto metaResult =
-        getGenesisAccountMetaFromBlock(block, fnGenesisMetaForRecord);
+    auto metaResult = parseGenesisAccountMeta(meta);
     if (!metaResult) {
       return metaResult.error();
     }
@@ -80,8 +140,7 @@ Roe<std::string> getUpdatedAccountMetadataForRenewal(
     return gm.ltsToString();
   }
 
-  auto userAccountRoe =
-      getUserAccountMetaFromBlock(block, account.id, fnUserMetaForRecord);
+  auto userAccountRoe = parseUserAccountMeta(meta);
   if (!userAccountRoe) {
     return userAccountRoe.error();
   }
@@ -7,6 +7,7 @@
 #include "../client/Client.h"
 #include "../ledger/Ledger.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <optional>
@@ -30,10 +31,23 @@ getGenesisAccountMetaFromBlock(
     const Ledger::Block &block,
     const FnGenesisAccountMetaForRecord &fnGenesisMetaForRecord);
 
+/** Serialized meta of the account's last registration/renewal record. Uses the
+ *  copy cached on the account; falls back to scanning block account.blockId
+ *  when the cache is empty (accounts restored without their record). */
+Roe<std::string>
+getAccountMeta(const Ledger &ledger, const AccountBuffer::Account &account,
+               const FnUserAccountMetaForRecord &fnUserMetaForRecord,
+               const FnGenesisAccountMetaForRecord &fnGenesisMetaForRecord);
+
+/** Size of the billable custom meta inside serialized account meta. */
+Roe<size_t> getAccountCustomMetaSize(const AccountBuffer::Account &account,
+                                     const std::string &meta);
+
+/** Renewal meta: `meta` (from getAccountMeta) with the wallet replaced by the
+ *  account's current wallet and the renewal fee deducted. */
 Roe<std::string> getUpdatedAccountMetadataForRenewal(
-    const Ledger::Block &block, const AccountBuffer::Account &account,
-    uint64_t minFee, const FnUserAccountMetaForRecord &fnUserMetaForRecord,
-    const FnGenesisAccountMetaForRecord &fnGenesisMetaForRecord);
+    const std::string &meta, const AccountBuffer::Account &account,
+    uint64_t minFee);
 
 } // namespace pp::chain_tx
 
@@ -0,0 +1,93 @@
+#include "TxSchedule.h"
+#include "AccountBuffer.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <variant>
+
+namespace pp::chain_tx {
+
+std::optional<TxAccessSet> getParallelAccessSet(const Ledger::Record &record,
+                                                bool isStrictMode) {
+  if (record.type != Ledger::T_DEFAULT) {
+    return std::nullopt;
+  }
+  auto txRoe = record.decode();
+  if (!txRoe) {
+    return std::nullopt;
+  }
+  const auto *tx = std::get_if<Ledger::TxDefault>(&txRoe.value());
+  if (!tx) {
+    return std::nullopt;
+  }
+  if (isStrictMode && tx->idempotentId != 0) {
+    return std::nullopt;
+  }
+
+  TxAccessSet access;
+  access.exclusiveIds.push_back(tx->fromWalletId);
+  if (tx->toWalletId != tx->fromWalletId) {
+    access.exclusiveIds.push_back(tx->toWalletId);
+  }
+  access.feeCredit = tx->fee;
+  return access;
+}
+
+std::vector<TxWave> scheduleTxWaves(const std::vector<Ledger::Record> &records,
+                                    bool isStrictMode) {
+  std::vector<TxWave> waves;
+  TxWave wave;
+  std::unordered_set<uint64_t> waveIds;
+
+  auto closeWave = [&](size_t end) {
+    if (wave.begin < end) {
+      wave.end = end;
+      waves.push_back(std::move(wave));
+    }
+    wave = TxWave{};
+    wave.begin = end;
+    waveIds.clear();
+  };
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    auto access = getParallelAccessSet(records[i], isStrictMode);
+    if (!access) {
+      closeWave(i);
+      TxWave single;
+      single.begin = i;
+      single.end = i + 1;
+      waves.push_back(std::move(single));
+      wave.begin = i + 1;
+      continue;
+    }
+
+    const bool touchesFeeAccount =
+        std::find(access->exclusiveIds.begin(), access->exclusiveIds.end(),
+                  AccountBuffer::ID_FEE) != access->exclusiveIds.end();
+    bool isConflict =
+        (touchesFeeAccount && wave.feeCredit > 0) ||
+        (access->feeCredit > 0 && waveIds.count(AccountBuffer::ID_FEE) != 0) ||
+        access->feeCredit > UINT64_MAX - wave.feeCredit;
+    for (uint64_t id : access->exclusiveIds) {
+      isConflict = isConflict || waveIds.count(id) != 0;
+    }
+    if (isConflict) {
+      closeWave(i);
+    }
+
+    waveIds.insert(access->exclusiveIds.begin(), access->exclusiveIds.end());
+    wave.feeCredit += access->feeCredit;
+    wave.senderIds.push_back(access->exclusiveIds.front());
+    wave.isParallel = true;
+  }
+  closeWave(records.size());
+  return waves;
+}
+
+size_t getShardIndex(uint64_t accountId, size_t shardCount) {
+  // Fibonacci hashing spreads sequential account ids across shards
+  const uint64_t mixed = accountId * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>((mixed >> 32) % shardCount);
+}
+
+} // namespace pp::chain_tx
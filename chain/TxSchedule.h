@@ -0,0 +1,60 @@
+#ifndef PP_LEDGER_TX_SCHEDULE_H
+#define PP_LEDGER_TX_SCHEDULE_H
+
+#include "../ledger/Ledger.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace pp::chain_tx {
+
+/** Accounts a record touches when applied to a block. */
+struct TxAccessSet {
+  /** Accounts read and written by the record; order between records matters. */
+  std::vector<uint64_t> exclusiveIds;
+  /** Fee credited to AccountBuffer::ID_FEE; credits commute, so records that
+   * only add to the fee account do not conflict with each other. */
+  uint64_t feeCredit{ 0 };
+};
+
+/** Contiguous run of block records [begin, end). A parallel wave's records
+ * touch disjoint accounts, so applying them in any order (or concurrently on
+ * separate overlays) gives the same state as applying them in block order. */
+struct TxWave {
+  size_t begin{ 0 };
+  size_t end{ 0 };
+  bool isParallel{ false };
+  /** Sum of feeCredit over the wave, for the fee account overflow check. */
+  uint64_t feeCredit{ 0 };
+  /** Sending account of each record of a parallel wave, for sharding. */
+  std::vector<uint64_t> senderIds;
+
+  size_t size() const { return end - begin; }
+};
+
+/**
+ * Access set of a record that may share a wave with others, or nullopt when
+ * it must apply alone. Only plain transfers qualify, and in strict mode only
+ * without an idempotency id (that check reads the ledger, which is not safe to
+ * read concurrently). Records that fail to decode apply alone.
+ */
+std::optional<TxAccessSet> getParallelAccessSet(const Ledger::Record &record,
+                                                bool isStrictMode);
+
+/**
+ * Split records into waves in block order. A record joins the current wave
+ * while it conflicts with none of its records; otherwise, or when it cannot
+ * share a wave at all, the wave is closed. Deterministic: depends only on the
+ * records and isStrictMode.
+ */
+std::vector<TxWave> scheduleTxWaves(const std::vector<Ledger::Record> &records,
+                                    bool isStrictMode);
+
+/** Shard in [0, shardCount) that applies records sent from accountId. */
+size_t getShardIndex(uint64_t accountId, size_t shardCount);
+
+} // namespace pp::chain_tx
+
+#endif
@@ -5,6 +5,32 @@
 
 namespace pp {
 
+ResultOrError<AssumeValidConfig, RoeErrorBase>
+parseAssumeValid(const nlohmann::json &ja) {
+  if (!ja.is_object()) {
+    return RoeErrorBase("Field 'assumeValid' must be an object");
+  }
+  if (!ja.contains("blockId") || !ja["blockId"].is_number_unsigned()) {
+    return RoeErrorBase("Field 'assumeValid.blockId' is required and must "
+                        "be a non-negative number");
+  }
+  if (!ja.contains("hash") || !ja["hash"].is_string()) {
+    return RoeErrorBase("Field 'assumeValid.hash' is required and must be "
+                        "a string");
+  }
+  AssumeValidConfig config;
+  config.blockId = ja["blockId"].get<uint64_t>();
+  config.blockHash = ja["hash"].get<std::string>();
+  if (config.isEnabled() &&
+      (config.blockHash.size() != 64 ||
+       config.blockHash.find_first_not_of("0123456789abcdef") !=
+           std::string::npos)) {
+    return RoeErrorBase("Field 'assumeValid.hash' must be empty or 64 "
+                        "lowercase hex characters");
+  }
+  return config;
+}
+
 std::ostream &operator<<(std::ostream &os, const CheckpointConfig &config) {
   os << "CheckpointConfig{minBlocks: " << config.minBlocks
      << ", minAgeSeconds: " << config.minAgeSeconds << "}";
@@ -2,6 +2,9 @@
 #define PP_LEDGER_CHAIN_TYPES_H
 
 #include "../client/Client.h"
+#include "lib/common/ResultOrError.hpp"
+
+#include <nlohmann/json.hpp>
 
 #include <cstdint>
 #include <ostream>
@@ -28,6 +31,20 @@ struct CheckpointConfig {
   }
 };
 
+/** Trusted block for fast sync: blocks up to blockId skip signature and
+ * slot-leader checks, and the block at blockId must hash to blockHash. */
+struct AssumeValidConfig {
+  uint64_t blockId{0};
+  std::string blockHash; // Empty disables assume-valid
+
+  bool isEnabled() const { return !blockHash.empty(); }
+};
+
+/** Parse the run-file `assumeValid` object {blockId, hash}; the hash must be
+ * empty or 64 lowercase hex characters. */
+ResultOrError<AssumeValidConfig, RoeErrorBase>
+parseAssumeValid(const nlohmann::json &ja);
+
 struct BlockChainConfig {
   int64_t genesisTime{0};
   uint64_t slotDuration{0};
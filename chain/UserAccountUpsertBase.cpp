@@ -105,8 +105,7 @@ chain_tx::Roe<void> UserAccountUpsertBase::applyUserAccountUpsert(
                              "User account must require at least one signature");
   }
 
-  auto bufferAccountResult = bank.getAccount(tx.walletId);
-  if (!bufferAccountResult) {
+  if (!bank.hasAccount(tx.walletId)) {
     if (isStrictMode) {
       return chain_tx::TxError(chain_err::E_ACCOUNT_NOT_FOUND,
                                "User account not found in buffer: " +
@@ -127,6 +126,7 @@ chain_tx::Roe<void> UserAccountUpsertBase::applyUserAccountUpsert(
   account.id = tx.walletId;
   account.blockId = blockId;
   account.wallet = userAccount.wallet;
+  account.meta = tx.meta;
   auto addResult = bank.add(account);
   if (!addResult) {
     return chain_tx::TxError(
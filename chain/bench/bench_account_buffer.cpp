@@ -0,0 +1,116 @@
+#include "../AccountBuffer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pp;
+
+namespace {
+
+constexpr size_t DEFAULT_ACCOUNT_COUNT = 1000000;
+constexpr size_t OPERATION_COUNT = 1000000;
+
+template <typename Fn> double measureNsPerOp(size_t count, Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return static_cast<double>(ns) / static_cast<double>(count);
+}
+
+void report(const std::string &name, double nsPerOp) {
+  std::cout << name << ": " << nsPerOp << " ns/op" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t accountCount = DEFAULT_ACCOUNT_COUNT;
+  if (argc > 1) {
+    accountCount = std::strtoull(argv[1], nullptr, 10);
+  }
+
+  // User ids are random 64-bit values in production
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<uint64_t> idDist(AccountBuffer::ID_FIRST_USER,
+                                                 UINT64_MAX);
+  std::vector<uint64_t> ids;
+  ids.reserve(accountCount);
+
+  AccountBuffer bank;
+  AccountBuffer::Account feeAccount;
+  feeAccount.id = AccountBuffer::ID_FEE;
+  bank.add(feeAccount);
+
+  double addNs = measureNsPerOp(accountCount, [&] {
+    while (ids.size() < accountCount) {
+      AccountBuffer::Account account;
+      account.id = idDist(rng);
+      account.wallet.mBalances[AccountBuffer::ID_GENESIS] = 1000000;
+      account.wallet.publicKeys.push_back(std::string(32, 'k'));
+      account.wallet.minSignatures = 1;
+      if (bank.add(account)) {
+        ids.push_back(account.id);
+      }
+    }
+  });
+
+  std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+  std::vector<std::pair<uint64_t, uint64_t>> pairs(OPERATION_COUNT);
+  for (auto &p : pairs) {
+    p = {ids[pick(rng)], ids[pick(rng)]};
+  }
+
+  int64_t checksum = 0;
+  double balanceNs = measureNsPerOp(OPERATION_COUNT, [&] {
+    for (const auto &p : pairs) {
+      checksum += bank.getBalance(p.first, AccountBuffer::ID_GENESIS);
+    }
+  });
+
+  size_t failures = 0;
+  double transferNs = measureNsPerOp(OPERATION_COUNT, [&] {
+    for (const auto &p : pairs) {
+      if (!bank.transferBalance(p.first, p.second, AccountBuffer::ID_GENESIS, 1,
+                                1)) {
+        ++failures;
+      }
+    }
+  });
+
+  // Epoch hand-off after a burst of transfers: only touched accounts are reported
+  bank.takeStakeUpdate();
+  for (size_t i = 0; i < 10000; ++i) {
+    bank.transferBalance(pairs[i].first, pairs[i].second,
+                         AccountBuffer::ID_GENESIS, 1, 1);
+  }
+  size_t stakeChanges = 0;
+  double stakeUpdateNs = measureNsPerOp(1, [&] {
+    stakeChanges = bank.takeStakeUpdate().changes.size();
+  });
+
+  constexpr size_t STAKE_ROUNDS = 5;
+  size_t stakeholders = 0;
+  double stakeNs = measureNsPerOp(STAKE_ROUNDS, [&] {
+    for (size_t i = 0; i < STAKE_ROUNDS; ++i) {
+      stakeholders += bank.getStakeholders().size();
+    }
+  });
+
+  std::cout << "accounts: " << bank.size() << std::endl;
+  report("add", addNs);
+  report("getBalance", balanceNs);
+  report("transferBalance", transferNs);
+  report("getStakeholders", stakeNs);
+  report("takeStakeUpdate", stakeUpdateNs);
+  std::cout << "(checksum " << checksum << ", transfer failures " << failures
+            << ", stakeholders " << stakeholders / STAKE_ROUNDS
+            << ", stake changes " << stakeChanges << ")"
+            << std::endl;
+  return 0;
+}
@@ -2,6 +2,7 @@
 #include "AccountBuffer.h"
 #include <gtest/gtest.h>
 #include <cstdint>
+#include <map>
 
 using namespace pp;
 
@@ -878,3 +879,339 @@ TEST_F(AccountBufferTest, VerifyBalance_MissingCustomTokenInExpected_Error) {
     ASSERT_TRUE(r.isError());
     EXPECT_EQ(r.error().code, AccountBuffer::E_BALANCE);
 }
+
+// --- flat account table ---
+
+TEST_F(AccountBufferTest, ManyAccounts_AddRemove_IndexStaysConsistent) {
+    std::map<uint64_t, int64_t> expected;
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    auto nextId = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed | AccountBuffer::ID_FIRST_USER;
+    };
+
+    for (int i = 0; i < 5000; ++i) {
+        uint64_t id = nextId();
+        if (expected.count(id)) {
+            continue;
+        }
+        ASSERT_TRUE(buf.add(makeAccount(id, i + 1)).isOk());
+        expected[id] = i + 1;
+    }
+    // Remove every third account, then write off every fifth of the rest
+    auto recycle = makeAccount(AccountBuffer::ID_RECYCLE, 0);
+    ASSERT_TRUE(buf.add(recycle).isOk());
+    int64_t recycled = 0;
+    int n = 0;
+    for (auto it = expected.begin(); it != expected.end(); ++n) {
+        if (n % 3 == 0) {
+            buf.remove(it->first);
+            it = expected.erase(it);
+        } else if (n % 5 == 0) {
+            ASSERT_TRUE(buf.writeOff(it->first).isOk());
+            recycled += it->second;
+            it = expected.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    EXPECT_EQ(buf.size(), expected.size() + 1);
+    EXPECT_EQ(buf.getBalance(AccountBuffer::ID_RECYCLE, AccountBuffer::ID_GENESIS), recycled);
+    for (const auto &[id, balance] : expected) {
+        ASSERT_TRUE(buf.hasAccount(id));
+        EXPECT_EQ(buf.getBalance(id, AccountBuffer::ID_GENESIS), balance);
+        auto got = buf.getAccount(id);
+        ASSERT_TRUE(got.isOk());
+        EXPECT_EQ(got.value().id, id);
+    }
+
+    auto stakeholders = buf.getStakeholders();
+    ASSERT_EQ(stakeholders.size(), expected.size() + 1);
+    for (size_t i = 1; i < stakeholders.size(); ++i) {
+        EXPECT_LT(stakeholders[i - 1].id, stakeholders[i].id);
+    }
+}
+
+TEST_F(AccountBufferTest, NativeBalance_TracksTransfersAndUpdates) {
+    addFeeAccount();
+    ASSERT_TRUE(buf.add(makeAccount(AccountBuffer::ID_FIRST_USER, 100)).isOk());
+    ASSERT_TRUE(buf.add(makeAccount(AccountBuffer::ID_FIRST_USER + 1, 0)).isOk());
+
+    ASSERT_TRUE(buf.transferBalance(AccountBuffer::ID_FIRST_USER, AccountBuffer::ID_FIRST_USER + 1,
+                                    AccountBuffer::ID_GENESIS, 30, 5).isOk());
+    EXPECT_EQ(buf.getBalance(AccountBuffer::ID_FIRST_USER, AccountBuffer::ID_GENESIS), 65);
+    EXPECT_EQ(buf.getBalance(AccountBuffer::ID_FIRST_USER + 1, AccountBuffer::ID_GENESIS), 30);
+    EXPECT_EQ(buf.getBalance(AccountBuffer::ID_FEE, AccountBuffer::ID_GENESIS), 5);
+
+    AccountBuffer other;
+    ASSERT_TRUE(other.add(makeAccount(AccountBuffer::ID_FIRST_USER + 1, 7)).isOk());
+    ASSERT_TRUE(buf.update(other).isOk());
+    EXPECT_EQ(buf.getBalance(AccountBuffer::ID_FIRST_USER + 1, AccountBuffer::ID_GENESIS), 7);
+    EXPECT_TRUE(buf.verifySpendingPower(AccountBuffer::ID_FIRST_USER + 1,
+                                        AccountBuffer::ID_GENESIS, 7, 0).isOk());
+    EXPECT_TRUE(buf.verifySpendingPower(AccountBuffer::ID_FIRST_USER + 1,
+                                        AccountBuffer::ID_GENESIS, 7, 1).isError());
+}
+
+// --- getAccountIdsBeforeBlockId ---
+
+TEST_F(AccountBufferTest, GetAccountIdsBeforeBlockId_FollowsAddUpdateRemove) {
+    auto a = makeAccount(30, 1);
+    a.blockId = 5;
+    auto b = makeAccount(10, 1);
+    b.blockId = 8;
+    auto c = makeAccount(20, 1);
+    c.blockId = 2;
+    ASSERT_TRUE(buf.add(a).isOk());
+    ASSERT_TRUE(buf.add(b).isOk());
+    ASSERT_TRUE(buf.add(c).isOk());
+
+    EXPECT_EQ(buf.getAccountIdsBeforeBlockId(2), std::vector<uint64_t>{});
+    EXPECT_EQ(buf.getAccountIdsBeforeBlockId(6), (std::vector<uint64_t>{20, 30}));
+    EXPECT_EQ(buf.getAccountIdsBeforeBlockId(9), (std::vector<uint64_t>{10, 20, 30}));
+
+    // Renewal moves account 20 past the deadline
+    AccountBuffer renewed;
+    auto c2 = c;
+    c2.blockId = 12;
+    ASSERT_TRUE(renewed.add(c2).isOk());
+    ASSERT_TRUE(buf.update(renewed).isOk());
+    EXPECT_EQ(buf.getAccountIdsBeforeBlockId(9), (std::vector<uint64_t>{10, 30}));
+
+    buf.remove(30);
+    EXPECT_EQ(buf.getAccountIdsBeforeBlockId(9), std::vector<uint64_t>{10});
+
+    buf.clear();
+    EXPECT_TRUE(buf.getAccountIdsBeforeBlockId(100).empty());
+}
+
+// --- stake tracking ---
+
+TEST_F(AccountBufferTest, TakeStakeUpdate_FullThenDeltas) {
+    addFeeAccount();
+    ASSERT_TRUE(buf.add(makeAccount(10, 100)).isOk());
+    ASSERT_TRUE(buf.add(makeAccount(20, 50)).isOk());
+    ASSERT_TRUE(buf.add(makeAccount(30, 0)).isOk());
+    EXPECT_EQ(buf.getTotalStake(), 150u);
+
+    auto full = buf.takeStakeUpdate();
+    EXPECT_TRUE(full.isFull);
+    ASSERT_EQ(full.changes.size(), 2u);
+    EXPECT_EQ(full.changes[0].id, 10u);
+    EXPECT_EQ(full.changes[1].id, 20u);
+
+    EXPECT_TRUE(buf.takeStakeUpdate().changes.empty());
+
+    // 10 -> 30 moves 40 plus fee 2; fee account becomes a stakeholder
+    ASSERT_TRUE(buf.transferBalance(10, 30, AccountBuffer::ID_GENESIS, 40, 2).isOk());
+    buf.remove(20);
+    EXPECT_EQ(buf.getTotalStake(), 100u);
+
+    auto delta = buf.takeStakeUpdate();
+    EXPECT_FALSE(delta.isFull);
+    ASSERT_EQ(delta.changes.size(), 4u);
+    EXPECT_EQ(delta.changes[0].id, AccountBuffer::ID_FEE);
+    EXPECT_EQ(delta.changes[0].stake, 2u);
+    EXPECT_EQ(delta.changes[1].id, 10u);
+    EXPECT_EQ(delta.changes[1].stake, 58u);
+    EXPECT_EQ(delta.changes[2].id, 20u);
+    EXPECT_EQ(delta.changes[2].stake, 0u);
+    EXPECT_EQ(delta.changes[3].id, 30u);
+    EXPECT_EQ(delta.changes[3].stake, 40u);
+
+    buf.clear();
+    EXPECT_EQ(buf.getTotalStake(), 0u);
+    EXPECT_TRUE(buf.takeStakeUpdate().isFull);
+}
+
+// --- overlay ---
+
+TEST_F(AccountBufferTest, Overlay_ReadsThroughAndKeepsBaseUntouched) {
+    addFeeAccount();
+    ASSERT_TRUE(buf.add(makeAccount(10, 100)).isOk());
+    ASSERT_TRUE(buf.add(makeAccount(20, 50)).isOk());
+
+    AccountBuffer overlay;
+    overlay.setBase(&buf);
+    EXPECT_TRUE(overlay.isOverlay());
+    EXPECT_TRUE(overlay.hasAccount(10));
+    EXPECT_EQ(overlay.size(), 3u);
+    EXPECT_EQ(overlay.getTotalStake(), 150u);
+
+    ASSERT_TRUE(overlay.transferBalance(10, 20, AccountBuffer::ID_GENESIS, 30, 2).isOk());
+    EXPECT_EQ(overlay.getBalance(10, AccountBuffer::ID_GENESIS), 68);
+    EXPECT_EQ(overlay.getBalance(20, AccountBuffer::ID_GENESIS), 80);
+    EXPECT_EQ(overlay.getBalance(AccountBuffer::ID_FEE, AccountBuffer::ID_GENESIS), 2);
+    EXPECT_EQ(overlay.getTotalStake(), 150u);
+    auto got = overlay.getAccount(10);
+    ASSERT_TRUE(got.isOk());
+    EXPECT_EQ(got.value().wallet.mBalances.at(AccountBuffer::ID_GENESIS), 68);
+    EXPECT_EQ(got.value().wallet.publicKeys, std::vector<std::string>{"pk-10"});
+    std::map<uint64_t, int64_t> expected = {{AccountBuffer::ID_GENESIS, 80}};
+    EXPECT_TRUE(overlay.verifyBalance(20, 0, 0, expected).isOk());
+
+    // Read-through: no account was copied into the overlay
+    EXPECT_TRUE(overlay.seedFromCommittedIfMissing(buf, 10).isOk());
+    EXPECT_EQ(buf.getBalance(10, AccountBuffer::ID_GENESIS), 100);
+    EXPECT_EQ(buf.getBalance(20, AccountBuffer::ID_GENESIS), 50);
+
+    overlay.clear();
+    EXPECT_EQ(overlay.getBalance(10, AccountBuffer::ID_GENESIS), 100);
+    EXPECT_EQ(overlay.size(), 3u);
+}
+
+TEST_F(AccountBufferTest, Overlay_CommitMatchesDirectApply) {
+    addFeeAccount();
+    ASSERT_TRUE(buf.add(makeAccount(AccountBuffer::ID_RECYCLE, 0)).isOk());
+    for (uint64_t id = 10; id <= 50; id += 10) {
+        auto account = makeAccount(id, static_cast<int64_t>(id * 10));
+        account.blockId = id / 10;
+        ASSERT_TRUE(buf.add(account).isOk());
+    }
+    AccountBuffer direct = buf;
+    AccountBuffer overlay;
+    overlay.setBase(&buf);
+
+    auto apply = [&](AccountBuffer &bank) {
+        ASSERT_TRUE(bank.transferBalance(10, 20, AccountBuffer::ID_GENESIS, 40, 1).isOk());
+        ASSERT_TRUE(bank.depositBalance(30, 7, 5).isOk());
+        // Zero transfer of a token neither side holds still creates entries
+        ASSERT_TRUE(bank.transferBalance(20, 10, 7, 0, 0).isOk());
+        ASSERT_TRUE(bank.writeOff(40).isOk());
+        // Update-style replace of 50 with a later blockId
+        auto renewed = makeAccount(50, bank.getBalance(50, AccountBuffer::ID_GENESIS) - 3);
+        renewed.blockId = 9;
+        bank.remove(50);
+        ASSERT_TRUE(bank.add(renewed).isOk());
+        ASSERT_TRUE(bank.add(makeAccount(60, 0)).isOk());
+        ASSERT_TRUE(bank.depositBalance(60, AccountBuffer::ID_GENESIS, 3).isOk());
+    };
+    apply(direct);
+    apply(overlay);
+
+    EXPECT_EQ(overlay.size(), direct.size());
+    EXPECT_FALSE(overlay.hasAccount(40));
+    EXPECT_EQ(overlay.getTotalStake(), direct.getTotalStake());
+    EXPECT_EQ(overlay.getAccountIdsBeforeBlockId(4),
+              direct.getAccountIdsBeforeBlockId(4));
+    auto overlayStakes = overlay.getStakeholders();
+    auto directStakes = direct.getStakeholders();
+    ASSERT_EQ(overlayStakes.size(), directStakes.size());
+    for (size_t i = 0; i < directStakes.size(); ++i) {
+        EXPECT_EQ(overlayStakes[i].id, directStakes[i].id);
+        EXPECT_EQ(overlayStakes[i].stake, directStakes[i].stake);
+    }
+
+    AccountBuffer other;
+    EXPECT_TRUE(overlay.commitTo(other).isError());
+    ASSERT_TRUE(overlay.commitTo(buf).isOk());
+    EXPECT_EQ(buf.size(), direct.size());
+    EXPECT_EQ(buf.getTotalStake(), direct.getTotalStake());
+    for (uint64_t id : {AccountBuffer::ID_FEE, AccountBuffer::ID_RECYCLE,
+                        uint64_t(10), uint64_t(20), uint64_t(30), uint64_t(50),
+                        uint64_t(60)}) {
+        ASSERT_TRUE(buf.hasAccount(id)) << id;
+        EXPECT_EQ(buf.getAccount(id).value().wallet.mBalances,
+                  direct.getAccount(id).value().wallet.mBalances) << id;
+        EXPECT_EQ(buf.getAccount(id).value().blockId,
+                  direct.getAccount(id).value().blockId) << id;
+    }
+    EXPECT_FALSE(buf.hasAccount(40));
+    EXPECT_EQ(overlay.getBalance(20, AccountBuffer::ID_GENESIS),
+              buf.getBalance(20, AccountBuffer::ID_GENESIS));
+}
+
+TEST_F(AccountBufferTest, Overlay_StakeAndSizeTrackRemoveAndReAdd) {
+    addFeeAccount();
+    ASSERT_TRUE(buf.add(makeAccount(10, 100)).isOk());
+    ASSERT_TRUE(buf.add(makeAccount(20, 50)).isOk());
+    ASSERT_TRUE(buf.add(makeAccount(30, 0)).isOk());
+
+    AccountBuffer overlay;
+    overlay.setBase(&buf);
+    ASSERT_TRUE(overlay.transferBalance(10, 30, AccountBuffer::ID_GENESIS, 25, 0).isOk());
+    overlay.remove(20);
+    EXPECT_EQ(overlay.size(), 3u);
+    EXPECT_EQ(overlay.getTotalStake(), 100u);
+
+    // Renewal-style replace of a base account that already had a delta
+    auto renewed = makeAccount(10, overlay.getBalance(10, AccountBuffer::ID_GENESIS) + 5);
+    overlay.remove(10);
+    ASSERT_TRUE(overlay.add(renewed).isOk());
+    ASSERT_TRUE(overlay.add(makeAccount(20, 4)).isOk());
+    EXPECT_EQ(overlay.size(), 4u);
+    EXPECT_EQ(overlay.getTotalStake(), 80u + 25u + 4u);
+
+    auto stakes = overlay.getStakeholders();
+    ASSERT_EQ(stakes.size(), 3u);
+    EXPECT_EQ(stakes[0].id, 10u);
+    EXPECT_EQ(stakes[0].stake, 80u);
+    EXPECT_EQ(stakes[1].id, 20u);
+    EXPECT_EQ(stakes[1].stake, 4u);
+    EXPECT_EQ(stakes[2].id, 30u);
+    EXPECT_EQ(stakes[2].stake, 25u);
+
+    overlay.clear();
+    EXPECT_EQ(overlay.size(), 4u);
+    EXPECT_EQ(overlay.getTotalStake(), 150u);
+}
+
+TEST_F(AccountBufferTest, Overlay_GetAccountFollowsBalanceChanges) {
+    auto base = makeAccount(10, 100);
+    base.wallet.mBalances[7] = 9;
+    ASSERT_TRUE(buf.add(base).isOk());
+    AccountBuffer overlay;
+    overlay.setBase(&buf);
+    ASSERT_TRUE(overlay.depositBalance(10, AccountBuffer::ID_GENESIS, 5).isOk());
+    ASSERT_TRUE(overlay.depositBalance(10, 7, 1).isOk());
+
+    const AccountBuffer &reader = overlay;
+    auto got = reader.getAccount(10);
+    ASSERT_TRUE(got.isOk());
+    EXPECT_EQ(got.value().wallet.mBalances.at(AccountBuffer::ID_GENESIS), 105);
+    EXPECT_EQ(got.value().wallet.mBalances.at(7), 10);
+    EXPECT_EQ(got.value().wallet.publicKeys, std::vector<std::string>{"pk-10"});
+
+    // Back to the base balance on one token keeps the other token's change
+    ASSERT_TRUE(overlay.withdrawBalance(10, AccountBuffer::ID_GENESIS, 5).isOk());
+    EXPECT_EQ(reader.getAccount(10).value().wallet.mBalances.at(AccountBuffer::ID_GENESIS), 100);
+    EXPECT_EQ(reader.getAccount(10).value().wallet.mBalances.at(7), 10);
+    ASSERT_TRUE(overlay.withdrawBalance(10, 7, 1).isOk());
+    EXPECT_EQ(reader.getAccount(10).value().wallet.mBalances,
+              buf.getAccount(10).value().wallet.mBalances);
+}
+
+TEST_F(AccountBufferTest, Overlay_ZeroBalanceOnNewTokenCreatesEntry) {
+    ASSERT_TRUE(buf.add(makeAccount(10, 100)).isOk());
+    AccountBuffer overlay;
+    overlay.setBase(&buf);
+    ASSERT_TRUE(overlay.depositBalance(10, 7, 0).isOk());
+    EXPECT_EQ(overlay.getAccount(10).value().wallet.mBalances.count(7), 1u);
+    EXPECT_EQ(buf.getAccount(10).value().wallet.mBalances.count(7), 0u);
+
+    ASSERT_TRUE(overlay.commitTo(buf).isOk());
+    EXPECT_EQ(buf.getAccount(10).value().wallet.mBalances.at(7), 0);
+}
+
+TEST_F(AccountBufferTest, Update_FromOverlayAppliesDeltasAndRejectsRemovals) {
+    ASSERT_TRUE(buf.add(makeAccount(10, 100)).isOk());
+    ASSERT_TRUE(buf.add(makeAccount(20, 50)).isOk());
+    AccountBuffer target;
+    ASSERT_TRUE(target.add(makeAccount(10, 100)).isOk());
+    ASSERT_TRUE(target.add(makeAccount(20, 50)).isOk());
+
+    AccountBuffer overlay;
+    overlay.setBase(&buf);
+    ASSERT_TRUE(overlay.depositBalance(10, AccountBuffer::ID_GENESIS, 7).isOk());
+    ASSERT_TRUE(overlay.depositBalance(20, 5, 3).isOk());
+    ASSERT_TRUE(target.update(overlay).isOk());
+    EXPECT_EQ(target.getBalance(10, AccountBuffer::ID_GENESIS), 107);
+    EXPECT_EQ(target.getBalance(20, 5), 3);
+    EXPECT_EQ(target.getTotalStake(), 157u);
+
+    overlay.remove(20);
+    EXPECT_TRUE(target.update(overlay).isError());
+}
@@ -3,6 +3,9 @@
 #include "lib/common/Utilities.h"
 #include "AccountBuffer.h"
 #include "Chain.h"
+#include "TxFees.h"
+#include "TxLedgerMeta.h"
+#include "TxSchedule.h"
 
 #include <gtest/gtest.h>
 
@@ -230,6 +233,59 @@ TEST(ChainTest, GenesisAccountMeta_RoundTrip) {
   EXPECT_EQ(parsed.genesis.wallet.mBalances, gm.genesis.wallet.mBalances);
 }
 
+TEST(ChainTest, AccountMeta_RenewalUsesCachedMetaWithoutLedger) {
+  auto key = makeKeyPair();
+  Chain::BlockChainConfig chainConfig = makeChainConfig(1000);
+  Client::UserAccount userAccount = makeUserAccount(key.publicKey, 100);
+  userAccount.meta = std::string(chainConfig.freeCustomMetaSize + 10, 'x');
+
+  AccountBuffer bank;
+  AccountBuffer::Account account;
+  account.id = AccountBuffer::ID_FIRST_USER;
+  account.blockId = 42; // not in the (empty) ledger
+  account.wallet = userAccount.wallet;
+  account.meta = userAccount.ltsToString();
+  ASSERT_TRUE(bank.add(account).isOk());
+
+  // Extractors must not be consulted while the meta is cached.
+  bool isExtractorCalled = false;
+  chain_tx::FnUserAccountMetaForRecord fnUser =
+      [&](const Ledger::Record &, uint64_t) -> std::optional<std::string> {
+    isExtractorCalled = true;
+    return std::nullopt;
+  };
+  chain_tx::FnGenesisAccountMetaForRecord fnGenesis =
+      [&](const Ledger::Record &,
+          const Ledger::Block &) -> std::optional<std::string> {
+    isExtractorCalled = true;
+    return std::nullopt;
+  };
+
+  Ledger ledger;
+  auto feeResult = chain_tx::calculateMinimumFeeForAccountMeta(
+      ledger, chainConfig, bank, account.id, fnUser, fnGenesis);
+  ASSERT_TRUE(feeResult.isOk()) << feeResult.error().message;
+  EXPECT_EQ(feeResult.value(),
+            calculateMinimumFeeFromNonFreeMetaSize(chainConfig, 10));
+
+  auto metaResult = chain_tx::getAccountMeta(ledger, account, fnUser, fnGenesis);
+  ASSERT_TRUE(metaResult.isOk());
+  auto renewedResult = chain_tx::getUpdatedAccountMetadataForRenewal(
+      metaResult.value(), account, feeResult.value());
+  ASSERT_TRUE(renewedResult.isOk()) << renewedResult.error().message;
+  Client::UserAccount renewed;
+  ASSERT_TRUE(renewed.ltsFromString(renewedResult.value()));
+  EXPECT_EQ(renewed.meta, userAccount.meta);
+  EXPECT_EQ(renewed.wallet.mBalances[AccountBuffer::ID_GENESIS],
+            100 - static_cast<int64_t>(feeResult.value()));
+  EXPECT_FALSE(isExtractorCalled);
+
+  // Without a cached copy the meta comes from the account's block.
+  account.meta.clear();
+  EXPECT_FALSE(
+      chain_tx::getAccountMeta(ledger, account, fnUser, fnGenesis).isOk());
+}
+
 TEST(ChainTest, CalculateHash_DeterministicAndSensitive) {
   Chain validator;
 
@@ -250,6 +306,38 @@ TEST(ChainTest, CalculateHash_DeterministicAndSensitive) {
   EXPECT_NE(hash1, hash3);
 }
 
+TEST(ChainTest, CalculateHash_MatchesHashOfSerializedBlock) {
+  Chain validator;
+  Ledger::Block block;
+  block.version = 1;
+  block.index = 3;
+  block.previousHash = "prev";
+  Ledger::Record rec;
+  rec.type = Ledger::T_DEFAULT;
+  rec.data = std::string(20000, 'x'); // larger than the sink buffer
+  rec.signatures = {"sig"};
+  block.records = {rec, rec};
+  EXPECT_EQ(validator.calculateHash(block), utl::sha256(block.ltsToString()));
+}
+
+TEST(ChainTest, CalculateHash_MerkleVersionHashesHeader) {
+  Chain validator;
+  Ledger::Block block;
+  block.index = 3;
+  block.previousHash = "prev";
+  Ledger::Record rec;
+  rec.type = Ledger::T_DEFAULT;
+  rec.data = "payload";
+  block.records = {rec};
+  ASSERT_EQ(block.version, Ledger::Block::VERSION_MERKLE);
+
+  const std::string hash = validator.calculateHash(block);
+  EXPECT_EQ(hash, Ledger::BlockHeader::fromBlock(block).calculateHash());
+
+  block.records[0].data = "tampered";
+  EXPECT_NE(validator.calculateHash(block), hash);
+}
+
 TEST(ChainTest, AddBlock_FailsOnGenesisHashMismatch) {
   Chain validator;
 
@@ -800,6 +888,380 @@ TEST(ChainTest,
   std::filesystem::remove_all(tempDir, ec);
 }
 
+TEST(ChainTest, FindTransactionProof_VerifiesAgainstGenesisBlockHash) {
+  Chain validator;
+
+  auto genesisKey = makeKeyPair();
+  auto feeKey = makeKeyPair();
+  auto reserveKey = makeKeyPair();
+  auto recycleKey = makeKeyPair();
+  Chain::BlockChainConfig chainConfig = makeChainConfig(1000);
+
+  consensus::Ouroboros::Config consensusConfig;
+  consensusConfig.genesisTime = 0;
+  consensusConfig.timeOffset = 0;
+  consensusConfig.slotDuration = 1;
+  consensusConfig.slotsPerEpoch = 10;
+  validator.initConsensus(consensusConfig);
+
+  std::filesystem::path tempDir =
+      std::filesystem::temp_directory_path() / "pp-ledger-chain-test-txproof";
+  std::error_code ec;
+  std::filesystem::remove_all(tempDir, ec);
+  ASSERT_FALSE(ec);
+
+  Ledger::InitConfig ledgerConfig;
+  ledgerConfig.workDir = tempDir.string();
+  ledgerConfig.startingBlockId = 0;
+  auto initResult = validator.initLedger(ledgerConfig);
+  ASSERT_TRUE(initResult.isOk());
+
+  Ledger::ChainNode genesis = makeGenesisBlock(
+      validator, chainConfig, genesisKey, feeKey, reserveKey, recycleKey);
+  auto addResult = validator.addBlock(genesis);
+  ASSERT_TRUE(addResult.isOk());
+
+  for (size_t i = 0; i < genesis.block.records.size(); ++i) {
+    auto result = validator.findTransactionProof(static_cast<uint64_t>(i));
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    const auto &txProof = result.value();
+    EXPECT_EQ(txProof.blockHash, genesis.hash);
+    EXPECT_EQ(txProof.record.data, genesis.block.records[i].data);
+    auto verifyResult = txProof.verify(static_cast<uint64_t>(i));
+    EXPECT_TRUE(verifyResult.isOk()) << verifyResult.error().message;
+  }
+
+  auto outOfRange =
+      validator.findTransactionProof(genesis.block.records.size());
+  ASSERT_TRUE(outOfRange.isError());
+  EXPECT_EQ(outOfRange.error().code, Chain::E_INVALID_ARGUMENT);
+
+  std::filesystem::remove_all(tempDir, ec);
+}
+
+namespace {
+
+Ledger::Record makeTransfer(uint64_t fromId, uint64_t toId, uint64_t amount,
+                            uint64_t fee, const utl::Ed25519KeyPair &signer) {
+  Ledger::TxDefault tx;
+  tx.tokenId = AccountBuffer::ID_GENESIS;
+  tx.fromWalletId = fromId;
+  tx.toWalletId = toId;
+  tx.amount = amount;
+  tx.fee = fee;
+  return makeRecord(Ledger::T_DEFAULT, tx, signer);
+}
+
+/** Chain with genesis and `userKeys.size()` funded users, built block by block
+ * so that a second chain can be fed the same blocks. */
+struct TransferChainFixture {
+  utl::Ed25519KeyPair genesisKey = makeKeyPair();
+  utl::Ed25519KeyPair feeKey = makeKeyPair();
+  utl::Ed25519KeyPair reserveKey = makeKeyPair();
+  utl::Ed25519KeyPair recycleKey = makeKeyPair();
+  Chain::BlockChainConfig chainConfig = makeChainConfig(1000);
+  std::vector<utl::Ed25519KeyPair> userKeys;
+  std::vector<Ledger::ChainNode> blocks;
+
+  static uint64_t userId(size_t i) { return AccountBuffer::ID_FIRST_USER + i; }
+
+  void initChain(Chain &chain, const std::filesystem::path &dir) const {
+    consensus::Ouroboros::Config consensusConfig;
+    consensusConfig.genesisTime = 0;
+    consensusConfig.timeOffset = 0;
+    consensusConfig.slotDuration = 1;
+    consensusConfig.slotsPerEpoch = 10;
+    chain.initConsensus(consensusConfig);
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    Ledger::InitConfig ledgerConfig;
+    ledgerConfig.workDir = dir.string();
+    ledgerConfig.startingBlockId = 0;
+    ASSERT_TRUE(chain.initLedger(ledgerConfig).isOk());
+  }
+
+  /** Build genesis and the user funding block on `chain`. */
+  void build(Chain &chain, size_t userCount) {
+    blocks.push_back(makeGenesisBlock(chain, chainConfig, genesisKey, feeKey,
+                                      reserveKey, recycleKey));
+    ASSERT_TRUE(chain.addBlock(blocks.back()).isOk());
+
+    std::vector<Ledger::Record> records;
+    for (size_t i = 0; i < userCount; ++i) {
+      userKeys.push_back(makeKeyPair());
+      Ledger::TxNewUser tx;
+      tx.fromWalletId = AccountBuffer::ID_RESERVE;
+      tx.toWalletId = userId(i);
+      tx.amount = 100000;
+      tx.fee = 1;
+      tx.meta = makeUserAccount(userKeys.back().publicKey, 100000).ltsToString();
+      records.push_back(makeRecord(Ledger::T_NEW_USER, tx, reserveKey));
+    }
+    chain.refreshStakeholders();
+    blocks.push_back(makeNextBlock(chain, blocks.back(), records));
+    auto addResult = chain.addBlock(blocks.back());
+    ASSERT_TRUE(addResult.isOk()) << addResult.error().message;
+  }
+
+  /** Replay the built blocks on another chain. */
+  void replay(Chain &chain) const {
+    for (const auto &block : blocks) {
+      chain.refreshStakeholders();
+      auto result = chain.addBlock(block);
+      ASSERT_TRUE(result.isOk()) << result.error().message;
+    }
+  }
+};
+
+void expectSameAccounts(const Chain &serial, const Chain &parallel,
+                        const std::vector<uint64_t> &accountIds) {
+  EXPECT_EQ(parallel.getTotalStake(), serial.getTotalStake());
+  auto serialStakes = serial.getStakeholders();
+  auto parallelStakes = parallel.getStakeholders();
+  ASSERT_EQ(parallelStakes.size(), serialStakes.size());
+  for (size_t i = 0; i < serialStakes.size(); ++i) {
+    EXPECT_EQ(parallelStakes[i].id, serialStakes[i].id);
+    EXPECT_EQ(parallelStakes[i].stake, serialStakes[i].stake);
+  }
+  for (uint64_t id : accountIds) {
+    auto serialAccount = serial.getAccount(id);
+    auto parallelAccount = parallel.getAccount(id);
+    ASSERT_EQ(parallelAccount.isOk(), serialAccount.isOk()) << id;
+    if (serialAccount.isOk()) {
+      EXPECT_EQ(parallelAccount.value().wallet.mBalances,
+                serialAccount.value().wallet.mBalances)
+          << id;
+    }
+  }
+}
+
+} // namespace
+
+TEST(ChainTest, ScheduleTxWaves_SplitsOnSharedAccounts) {
+  auto key = makeKeyPair();
+  std::vector<Ledger::Record> records;
+  records.push_back(makeTransfer(10, 11, 1, 1, key));
+  records.push_back(makeTransfer(12, 13, 1, 1, key));
+  records.push_back(makeTransfer(11, 14, 1, 1, key)); // shares 11
+  records.push_back(makeTransfer(15, 16, 1, 0, key));
+  records.push_back(makeTransfer(17, AccountBuffer::ID_FEE, 1, 0, key));
+  Ledger::TxNewUser newUser;
+  records.push_back(makeRecord(Ledger::T_NEW_USER, newUser, key));
+  records.push_back(makeTransfer(18, 19, 1, 1, key));
+
+  auto waves = chain_tx::scheduleTxWaves(records, true);
+  ASSERT_EQ(waves.size(), 5u);
+  EXPECT_EQ(waves[0].begin, 0u);
+  EXPECT_EQ(waves[0].end, 2u);
+  EXPECT_EQ(waves[0].feeCredit, 2u);
+  EXPECT_EQ(waves[0].senderIds, (std::vector<uint64_t>{10, 12}));
+  EXPECT_EQ(waves[1].begin, 2u); // 11 again
+  EXPECT_EQ(waves[1].end, 4u);
+  EXPECT_EQ(waves[2].begin, 4u); // fee account after fee credits
+  EXPECT_EQ(waves[2].end, 5u);
+  EXPECT_TRUE(waves[2].isParallel);
+  EXPECT_EQ(waves[3].begin, 5u); // new user applies alone
+  EXPECT_FALSE(waves[3].isParallel);
+  EXPECT_EQ(waves[4].begin, 6u);
+  EXPECT_EQ(waves[4].end, 7u);
+
+  // Idempotent transfers read the ledger and apply alone in strict mode
+  Ledger::TxDefault idempotent;
+  idempotent.fromWalletId = 20;
+  idempotent.toWalletId = 21;
+  idempotent.idempotentId = 5;
+  std::vector<Ledger::Record> idemRecords{
+      makeRecord(Ledger::T_DEFAULT, idempotent, key)};
+  EXPECT_FALSE(chain_tx::scheduleTxWaves(idemRecords, true)[0].isParallel);
+  EXPECT_TRUE(chain_tx::scheduleTxWaves(idemRecords, false)[0].isParallel);
+}
+
+TEST(ChainTest, ParallelApply_MatchesSerialApply) {
+  const auto tempDir = std::filesystem::temp_directory_path();
+  constexpr size_t USER_COUNT = 64;
+
+  Chain serial;
+  serial.setParallelApplyThreads(1);
+  TransferChainFixture fixture;
+  fixture.initChain(serial, tempDir / "pp-ledger-chain-test-apply-serial");
+  fixture.build(serial, USER_COUNT);
+  ASSERT_EQ(fixture.blocks.size(), 2u);
+
+  // Disjoint pairs, then the same users shifted by one (conflicts with the
+  // first round), with a self transfer and a transfer into the fee account
+  std::vector<Ledger::Record> records;
+  for (size_t i = 0; i < USER_COUNT; i += 2) {
+    records.push_back(makeTransfer(fixture.userId(i), fixture.userId(i + 1),
+                                   100 + i, 1, fixture.userKeys[i]));
+  }
+  for (size_t i = 1; i < USER_COUNT; i += 2) {
+    const size_t to = (i + 1) % USER_COUNT;
+    records.push_back(makeTransfer(fixture.userId(i), fixture.userId(to), 7, 2,
+                                   fixture.userKeys[i]));
+  }
+  records.push_back(makeTransfer(fixture.userId(3), fixture.userId(3), 5, 1,
+                                 fixture.userKeys[3]));
+  records.push_back(makeTransfer(fixture.userId(4), AccountBuffer::ID_FEE, 9, 1,
+                                 fixture.userKeys[4]));
+  serial.refreshStakeholders();
+  fixture.blocks.push_back(makeNextBlock(serial, fixture.blocks.back(), records));
+  auto serialResult = serial.addBlock(fixture.blocks.back());
+  ASSERT_TRUE(serialResult.isOk()) << serialResult.error().message;
+
+  Chain parallel;
+  parallel.setParallelApplyThreads(4);
+  fixture.initChain(parallel, tempDir / "pp-ledger-chain-test-apply-parallel");
+  fixture.replay(parallel);
+
+  std::vector<uint64_t> accountIds{AccountBuffer::ID_GENESIS,
+                                   AccountBuffer::ID_FEE,
+                                   AccountBuffer::ID_RESERVE,
+                                   AccountBuffer::ID_RECYCLE};
+  for (size_t i = 0; i < USER_COUNT; ++i) {
+    accountIds.push_back(fixture.userId(i));
+  }
+  expectSameAccounts(serial, parallel, accountIds);
+  EXPECT_EQ(parallel.getAccount(fixture.userId(1)).value().wallet.mBalances.at(
+                AccountBuffer::ID_GENESIS),
+            100000 + 100 - 7 - 2);
+
+  std::error_code ec;
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-apply-serial", ec);
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-apply-parallel", ec);
+}
+
+TEST(ChainTest, ParallelApply_FailingWaveReportsSerialError) {
+  const auto tempDir = std::filesystem::temp_directory_path();
+  constexpr size_t USER_COUNT = 40;
+
+  Chain serial;
+  serial.setParallelApplyThreads(1);
+  TransferChainFixture fixture;
+  fixture.initChain(serial, tempDir / "pp-ledger-chain-test-fail-serial");
+  fixture.build(serial, USER_COUNT);
+
+  Chain parallel;
+  parallel.setParallelApplyThreads(4);
+  fixture.initChain(parallel, tempDir / "pp-ledger-chain-test-fail-parallel");
+  fixture.replay(parallel);
+
+  // One overdraft in the middle of a wave of disjoint transfers
+  std::vector<Ledger::Record> records;
+  for (size_t i = 0; i < USER_COUNT; i += 2) {
+    const uint64_t amount = i == 20 ? 1000000 : 10;
+    records.push_back(makeTransfer(fixture.userId(i), fixture.userId(i + 1),
+                                   amount, 1, fixture.userKeys[i]));
+  }
+  serial.refreshStakeholders();
+  parallel.refreshStakeholders();
+  auto block = makeNextBlock(serial, fixture.blocks.back(), records);
+
+  auto serialResult = serial.addBlock(block);
+  auto parallelResult = parallel.addBlock(block);
+  ASSERT_TRUE(serialResult.isError());
+  ASSERT_TRUE(parallelResult.isError());
+  EXPECT_EQ(parallelResult.error().message, serialResult.error().message);
+
+  std::vector<uint64_t> accountIds{AccountBuffer::ID_FEE};
+  for (size_t i = 0; i < USER_COUNT; ++i) {
+    accountIds.push_back(fixture.userId(i));
+  }
+  expectSameAccounts(serial, parallel, accountIds);
+
+  std::error_code ec;
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-fail-serial", ec);
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-fail-parallel", ec);
+}
+
+TEST(ChainTest, AssumeValid_SkipsSignaturesUpToTrustedBlock) {
+  const auto tempDir = std::filesystem::temp_directory_path();
+
+  Chain source;
+  TransferChainFixture fixture;
+  fixture.initChain(source, tempDir / "pp-ledger-chain-test-assume-source");
+  fixture.build(source, 2);
+
+  // Hash-linked block whose transfer is signed with the wrong key
+  source.refreshStakeholders();
+  fixture.blocks.push_back(makeNextBlock(
+      source, fixture.blocks.back(),
+      {makeTransfer(fixture.userId(0), fixture.userId(1), 10, 1,
+                    fixture.userKeys[1])}));
+  const auto &forged = fixture.blocks.back();
+  auto sourceResult = source.addBlock(forged);
+  ASSERT_TRUE(sourceResult.isError());
+
+  Chain trusting;
+  trusting.setAssumeValid({forged.block.index, forged.hash});
+  fixture.initChain(trusting, tempDir / "pp-ledger-chain-test-assume-trusting");
+  EXPECT_TRUE(trusting.checkAssumeValid().isError());
+  fixture.replay(trusting);
+  auto checkResult = trusting.checkAssumeValid();
+  ASSERT_TRUE(checkResult.isOk()) << checkResult.error().message;
+  EXPECT_EQ(trusting.getAccount(fixture.userId(1)).value().wallet.mBalances.at(
+                AccountBuffer::ID_GENESIS),
+            100000 + 10);
+
+  // Blocks past the trusted one are verified in full again
+  Chain partial;
+  partial.setAssumeValid({1, fixture.blocks[1].hash});
+  fixture.initChain(partial, tempDir / "pp-ledger-chain-test-assume-partial");
+  for (size_t i = 0; i < 2; ++i) {
+    partial.refreshStakeholders();
+    ASSERT_TRUE(partial.addBlock(fixture.blocks[i]).isOk());
+  }
+  partial.refreshStakeholders();
+  EXPECT_TRUE(partial.addBlock(forged).isError());
+
+  std::error_code ec;
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-assume-source", ec);
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-assume-trusting", ec);
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-assume-partial", ec);
+}
+
+TEST(ChainTest, AssumeValid_RejectsMismatchedTrustedHash) {
+  const auto tempDir = std::filesystem::temp_directory_path();
+
+  Chain source;
+  TransferChainFixture fixture;
+  fixture.initChain(source, tempDir / "pp-ledger-chain-test-assume-bad-source");
+  fixture.build(source, 2);
+
+  Chain trusting;
+  trusting.setAssumeValid({1, std::string(64, '0')});
+  fixture.initChain(trusting, tempDir / "pp-ledger-chain-test-assume-bad");
+  ASSERT_TRUE(trusting.addBlock(fixture.blocks[0]).isOk());
+  trusting.refreshStakeholders();
+  auto addResult = trusting.addBlock(fixture.blocks[1]);
+  ASSERT_TRUE(addResult.isError());
+  EXPECT_EQ(trusting.getNextBlockId(), 1u);
+  EXPECT_TRUE(trusting.checkAssumeValid().isError());
+
+  std::error_code ec;
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-assume-bad-source", ec);
+  std::filesystem::remove_all(tempDir / "pp-ledger-chain-test-assume-bad", ec);
+}
+
+TEST(ChainTest, ParseAssumeValid_ValidatesFields) {
+  const std::string hash(64, 'a');
+  auto parsed = parseAssumeValid({{"blockId", 7u}, {"hash", hash}});
+  ASSERT_TRUE(parsed.isOk());
+  EXPECT_EQ(parsed.value().blockId, 7u);
+  EXPECT_EQ(parsed.value().blockHash, hash);
+
+  auto disabled = parseAssumeValid({{"blockId", 0u}, {"hash", ""}});
+  ASSERT_TRUE(disabled.isOk());
+  EXPECT_FALSE(disabled.value().isEnabled());
+
+  EXPECT_TRUE(parseAssumeValid(nlohmann::json::array()).isError());
+  EXPECT_TRUE(parseAssumeValid({{"hash", hash}}).isError());
+  EXPECT_TRUE(parseAssumeValid({{"blockId", -1}, {"hash", hash}}).isError());
+  EXPECT_TRUE(parseAssumeValid({{"blockId", 7u}}).isError());
+  EXPECT_TRUE(parseAssumeValid({{"blockId", 7u}, {"hash", "abc"}}).isError());
+  EXPECT_TRUE(parseAssumeValid({{"blockId", 7u}, {"hash", std::string(64, 'A')}}).isError());
+}
+
 TEST(ChainTest, Checkpoint_RotateAndKeepRecentTwo) {
   Chain validator;
 
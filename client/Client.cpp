@@ -184,6 +184,8 @@ std::string Client::getErrorMessage(uint16_t errorCode) {
     return "Failed to parse response";
   case E_REQUEST_FAILED:
     return "Request failed";
+  case E_BUSY:
+    return "Server busy";
   default:
     return "Unknown error";
   }
@@ -202,38 +204,69 @@ void Client::setEndpoint(const network::IpEndpoint &endpoint) {
   endpoint_ = endpoint;
 }
 
-Client::Roe<std::string> Client::sendRequest(uint32_t type, const std::string &payload,
-                                             std::chrono::milliseconds timeout) {
-  if (endpoint_.port == 0) {
-    return Error(E_NOT_CONNECTED, getErrorMessage(E_NOT_CONNECTED));
-  }
+void Client::setConnectionPool(const network::FetchClient::PoolConfig &config) {
+  fetchClient_.setPoolConfig(config);
+}
 
+std::string Client::packRequest(uint32_t type, const std::string &payload) {
   Request req;
   req.version = Request::VERSION;
   req.type = type;
   req.payload = payload;
+  return utl::binaryPack(req);
+}
 
-  std::string requestData = utl::binaryPack(req);
-  log().debug << "Sending binary request: " << req;
-
-  auto result = fetchClient_.fetchSync(endpoint_, requestData, timeout);
-
-  if (!result.isOk()) {
-    return Error(E_REQUEST_FAILED,
-                 getErrorMessage(E_REQUEST_FAILED) + ": " +
-                     result.error().message);
-  }
-  auto respResult = utl::binaryUnpack<Response>(result.value());
+Client::Roe<std::string> Client::unpackResponse(const std::string &data) {
+  auto respResult = utl::binaryUnpack<Response>(data);
   if (!respResult) {
     return Error(E_INVALID_RESPONSE, respResult.error().message);
   }
   const Response &resp = respResult.value();
   if (resp.isError()) {
-    return Error(E_SERVER_ERROR, resp.payload);
+    return Error(resp.errorCode == E_BUSY ? E_BUSY : E_SERVER_ERROR,
+                 resp.payload);
   }
   return resp.payload;
 }
 
+void Client::sendRequestAsync(uint32_t type, const std::string &payload,
+                              std::chrono::milliseconds timeout,
+                              std::function<void(const Roe<std::string> &)> callback) {
+  if (endpoint_.port == 0) {
+    callback(Error(E_NOT_CONNECTED, getErrorMessage(E_NOT_CONNECTED)));
+    return;
+  }
+  fetchClient_.fetch(
+      endpoint_, packRequest(type, payload),
+      [callback = std::move(callback)](const network::FetchClient::Roe<std::string> &result) {
+        if (!result) {
+          callback(Error(E_REQUEST_FAILED, getErrorMessage(E_REQUEST_FAILED) +
+                                               ": " + result.error().message));
+          return;
+        }
+        callback(unpackResponse(result.value()));
+      },
+      timeout);
+}
+
+Client::Roe<std::string> Client::sendRequest(uint32_t type, const std::string &payload,
+                                             std::chrono::milliseconds timeout) {
+  if (endpoint_.port == 0) {
+    return Error(E_NOT_CONNECTED, getErrorMessage(E_NOT_CONNECTED));
+  }
+
+  log().debug << "Sending binary request: type=" << type << ", payload="
+              << payload.size() << " bytes";
+  auto result = fetchClient_.fetchSync(endpoint_, packRequest(type, payload), timeout);
+
+  if (!result.isOk()) {
+    return Error(E_REQUEST_FAILED,
+                 getErrorMessage(E_REQUEST_FAILED) + ": " +
+                     result.error().message);
+  }
+  return unpackResponse(result.value());
+}
+
 // BeaconServer API - Block operations (binary T_REQ_BLOCK_GET)
 
 Client::Roe<Ledger::ChainNode> Client::fetchBlock(uint64_t blockId) {
@@ -252,6 +285,77 @@ Client::Roe<Ledger::ChainNode> Client::fetchBlock(uint64_t blockId) {
   return node;
 }
 
+Client::Roe<Client::BlockRange>
+Client::fetchBlockRange(const BlockRangeRequest &request) {
+  log().debug << "Requesting up to " << request.maxCount << " blocks from "
+              << request.fromId;
+
+  auto result = sendRequest(T_REQ_BLOCK_GET_RANGE, utl::binaryPack(request), TIMEOUT_DATA);
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+
+  return unpackBlockRange(result.value(), request.fromId, false);
+}
+
+void Client::fetchBlockRange(const BlockRangeRequest &request,
+                             std::function<void(const Roe<BlockRange> &)> callback) {
+  log().debug << "Requesting up to " << request.maxCount << " blocks from "
+              << request.fromId << " (async)";
+
+  const uint64_t fromId = request.fromId;
+  sendRequestAsync(T_REQ_BLOCK_GET_RANGE, utl::binaryPack(request), TIMEOUT_DATA,
+                   [fromId, callback = std::move(callback)](const Roe<std::string> &result) {
+                     if (!result) {
+                       callback(result.error());
+                       return;
+                     }
+                     callback(unpackBlockRange(result.value(), fromId, false));
+                   });
+}
+
+void Client::subscribeBlocks(const BlockSubscribeRequest &request,
+                             std::function<void(const Roe<BlockRange> &)> callback) {
+  log().debug << "Subscribing to blocks from " << request.fromId;
+
+  const uint64_t fromId = request.fromId;
+  const auto timeout = std::chrono::milliseconds(request.maxWaitMs) + TIMEOUT_FAST;
+  sendRequestAsync(T_REQ_BLOCK_SUBSCRIBE, utl::binaryPack(request), timeout,
+                   [fromId, callback = std::move(callback)](const Roe<std::string> &result) {
+                     if (!result) {
+                       callback(result.error());
+                       return;
+                     }
+                     callback(unpackBlockRange(result.value(), fromId, true));
+                   });
+}
+
+Client::Roe<Client::BlockRange>
+Client::unpackBlockRange(const std::string &data, uint64_t fromId,
+                         bool isEmptyAllowed) {
+  auto rangeResult = utl::binaryUnpack<BlockRangeResponse>(data);
+  if (!rangeResult) {
+    return Error(E_INVALID_RESPONSE,
+                 "Failed to unpack block range: " + rangeResult.error().message);
+  }
+  const auto &response = rangeResult.value();
+  if ((response.blocks.empty() && !isEmptyAllowed) ||
+      response.nextBlockId != fromId + response.blocks.size()) {
+    return Error(E_INVALID_RESPONSE, "Inconsistent block range response");
+  }
+
+  BlockRange range;
+  range.nextBlockId = response.nextBlockId;
+  range.blocks.resize(response.blocks.size());
+  for (size_t i = 0; i < response.blocks.size(); ++i) {
+    if (!range.blocks[i].ltsFromString(response.blocks[i])) {
+      return Error(E_INVALID_RESPONSE, "Failed to deserialize block " +
+                                           std::to_string(fromId + i));
+    }
+  }
+  return range;
+}
+
 Client::Roe<Client::UserAccount> Client::fetchUserAccount(const uint64_t accountId) {
   log().debug << "Requesting user account: " << accountId;
 
@@ -318,8 +422,26 @@ Client::Roe<Client::CalibrationResponse> Client::fetchCalibration() {
   if (!result) {
     return Error(result.error().code, result.error().message);
   }
+  return unpackCalibration(result.value());
+}
+
+void Client::fetchCalibration(
+    std::function<void(const Roe<CalibrationResponse> &)> callback) {
+  log().debug << "Requesting precise timestamp for calibration (async)";
+
+  sendRequestAsync(T_REQ_CALIBRATION, "", TIMEOUT_FAST,
+                   [callback = std::move(callback)](const Roe<std::string> &result) {
+                     if (!result) {
+                       callback(result.error());
+                       return;
+                     }
+                     callback(unpackCalibration(result.value()));
+                   });
+}
 
-  auto roe = utl::binaryUnpack<CalibrationResponse>(result.value());
+Client::Roe<Client::CalibrationResponse>
+Client::unpackCalibration(const std::string &data) {
+  auto roe = utl::binaryUnpack<CalibrationResponse>(data);
   if (!roe) {
     return Error(E_INVALID_RESPONSE, "Failed to unpack calibration response: " + roe.error().message);
   }
@@ -388,6 +510,28 @@ Client::fetchTransactionByIndex(const TxGetByIndexRequest &request) {
   return responseResult.value();
 }
 
+Client::Roe<Ledger::TxProof>
+Client::fetchTransactionProof(const TxGetByIndexRequest &request) {
+  log().debug << "Requesting transaction proof by index: " << request.txIndex;
+
+  std::string payload = utl::binaryPack(request);
+  auto result = sendRequest(T_REQ_TX_PROOF, payload, TIMEOUT_DATA);
+
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+
+  auto responseResult = utl::binaryUnpack<Ledger::TxProof>(result.value());
+  if (!responseResult) {
+    return Error(E_INVALID_RESPONSE, "Failed to unpack transaction proof response: " + responseResult.error().message);
+  }
+  auto verifyResult = responseResult.value().verify(request.txIndex);
+  if (!verifyResult) {
+    return Error(E_INVALID_RESPONSE, "Invalid transaction proof: " + verifyResult.error().message);
+  }
+  return responseResult.value();
+}
+
 Client::Roe<bool> Client::addBlock(const Ledger::ChainNode& block) {
   log().debug << "Adding block " << block.block.index;
 
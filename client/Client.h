@@ -12,6 +12,7 @@
 #include <chrono>
 
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -85,12 +86,21 @@ public:
 
   static constexpr const uint32_t T_REQ_BLOCK_GET = 1001;
   static constexpr const uint32_t T_REQ_BLOCK_ADD = 1002;
+  /** Consecutive blocks in one response, for catch-up sync. */
+  static constexpr const uint32_t T_REQ_BLOCK_GET_RANGE = 1003;
+  /** Long poll: answered with new blocks once the server has them (BlockSubscribeRequest). */
+  static constexpr const uint32_t T_REQ_BLOCK_SUBSCRIBE = 1004;
+
+  /** Caps on a block range response; the byte cap leaves room below the 16 MiB frame limit. */
+  static constexpr const uint64_t MAX_BLOCK_RANGE_COUNT = 1000;
+  static constexpr const uint64_t MAX_BLOCK_RANGE_BYTES = 15 * 1024 * 1024;
 
   static constexpr const uint32_t T_REQ_ACCOUNT_GET = 2001;
 
   static constexpr const uint32_t T_REQ_TX_GET_BY_WALLET = 3001;
   static constexpr const uint32_t T_REQ_TX_ADD = 3002;
   static constexpr const uint32_t T_REQ_TX_GET_BY_INDEX = 3003;
+  static constexpr const uint32_t T_REQ_TX_PROOF = 3004;
 
   // Error codes
   static constexpr const uint16_t E_NOT_CONNECTED = 1;
@@ -98,6 +108,8 @@ public:
   static constexpr const uint16_t E_SERVER_ERROR = 3;
   static constexpr const uint16_t E_PARSE_ERROR = 4;
   static constexpr const uint16_t E_REQUEST_FAILED = 5;
+  // Server queue full or peer over its rate limit; also sent on the wire
+  static constexpr const uint16_t E_BUSY = 6;
 
   // Get human-friendly error message for an error code
   static std::string getErrorMessage(uint16_t errorCode);
@@ -188,6 +200,51 @@ public:
     pp::common::Meta ltsToMeta() const;
   };
 
+  struct BlockRangeRequest {
+    uint64_t fromId{ 0 };
+    uint64_t maxCount{ MAX_BLOCK_RANGE_COUNT };
+    uint64_t maxBytes{ MAX_BLOCK_RANGE_BYTES };
+
+    template <typename Archive>
+    void serialize(Archive &ar) {
+      ar & fromId & maxCount & maxBytes;
+    }
+  };
+
+  /** Longest a server holds a T_REQ_BLOCK_SUBSCRIBE request. */
+  static constexpr const uint64_t MAX_SUBSCRIBE_WAIT_MS = 60000;
+
+  /**
+   * Blocks from fromId as soon as the server has any; an empty range
+   * (nextBlockId == fromId) once maxWaitMs passes without a new block.
+   */
+  struct BlockSubscribeRequest {
+    uint64_t fromId{ 0 };
+    uint64_t maxWaitMs{ 20000 };
+    uint64_t maxBytes{ MAX_BLOCK_RANGE_BYTES };
+
+    template <typename Archive>
+    void serialize(Archive &ar) {
+      ar & fromId & maxWaitMs & maxBytes;
+    }
+  };
+
+  /** Serialized blocks fromId, fromId + 1, ...; nextBlockId continues the range. */
+  struct BlockRangeResponse {
+    std::vector<std::string> blocks;
+    uint64_t nextBlockId{ 0 };
+
+    template <typename Archive>
+    void serialize(Archive &ar) {
+      ar & blocks & nextBlockId;
+    }
+  };
+
+  struct BlockRange {
+    std::vector<Ledger::ChainNode> blocks;
+    uint64_t nextBlockId{ 0 };
+  };
+
   struct TxGetByIndexRequest {
     uint64_t txIndex{ 0 };
 
@@ -214,17 +271,37 @@ public:
 
   Roe<void> setEndpoint(const std::string& endpoint);
   void setEndpoint(const network::IpEndpoint &endpoint);
+  /** Size and idle timeout of the pooled connections requests reuse. */
+  void setConnectionPool(const network::FetchClient::PoolConfig &config);
 
   Roe<BeaconState> fetchBeaconState();
   /** Fetch server's current time in milliseconds since Unix epoch (for calibration). */
   Roe<CalibrationResponse> fetchCalibration();
+  /** fetchCalibration without blocking; callback as for subscribeBlocks. */
+  void fetchCalibration(std::function<void(const Roe<CalibrationResponse> &)> callback);
   Roe<BeaconState> registerMinerServer(const MinerInfo &minerInfo);
   Roe<std::vector<MinerInfo>> fetchMinerList();
   Roe<MinerStatus> fetchMinerStatus();
   Roe<Ledger::ChainNode> fetchBlock(uint64_t blockId);
+  /** Fetch blocks from request.fromId; fewer than asked (at least one) if limits are hit. */
+  Roe<BlockRange> fetchBlockRange(const BlockRangeRequest &request);
+  /** fetchBlockRange without blocking; callback as for subscribeBlocks. */
+  void fetchBlockRange(const BlockRangeRequest &request,
+                       std::function<void(const Roe<BlockRange> &)> callback);
+  /**
+   * T_REQ_BLOCK_SUBSCRIBE without blocking: callback gets the range (empty
+   * when the wait expired) on the fetch engine thread, so it must not block.
+   * It may run after this Client is destroyed.
+   */
+  void subscribeBlocks(const BlockSubscribeRequest &request,
+                       std::function<void(const Roe<BlockRange> &)> callback);
   Roe<UserAccount> fetchUserAccount(const uint64_t accountId);
   Roe<TxGetByWalletResponse> fetchTransactionsByWallet(const TxGetByWalletRequest &request);
   Roe<Ledger::Record> fetchTransactionByIndex(const TxGetByIndexRequest &request);
+  /** Fetch a transaction with its Merkle proof, verified against the returned
+   * header and block hash; compare proof.blockHash with a trusted hash to
+   * anchor it to the chain. */
+  Roe<Ledger::TxProof> fetchTransactionProof(const TxGetByIndexRequest &request);
 
   Roe<void> addTransaction(const Ledger::Record &record);
   Roe<bool> addBlock(const Ledger::ChainNode& block);
@@ -232,6 +309,16 @@ public:
 private:
   Roe<std::string> sendRequest(uint32_t type, const std::string &payload,
                                std::chrono::milliseconds timeout = TIMEOUT_FAST);
+  /** Like sendRequest, on the fetch engine; callback may outlive this Client. */
+  void sendRequestAsync(uint32_t type, const std::string &payload,
+                        std::chrono::milliseconds timeout,
+                        std::function<void(const Roe<std::string> &)> callback);
+  static std::string packRequest(uint32_t type, const std::string &payload);
+  /** Payload of a packed Response, or its error. */
+  static Roe<std::string> unpackResponse(const std::string &data);
+  static Roe<CalibrationResponse> unpackCalibration(const std::string &data);
+  static Roe<BlockRange> unpackBlockRange(const std::string &data, uint64_t fromId,
+                                          bool isEmptyAllowed);
 
   bool connected_{false};
   network::IpEndpoint endpoint_;
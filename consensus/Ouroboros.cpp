@@ -2,10 +2,7 @@
 #include "lib/common/Utilities.h"
 #include <algorithm>
 #include <chrono>
-#include <cstdlib>
-#include <iomanip>
-#include <numeric>
-#include <sstream>
+#include <string>
 
 namespace pp {
 namespace consensus {
@@ -23,12 +20,12 @@ bool Ouroboros::isSlotLeader(uint64_t slot,
 }
 
 bool Ouroboros::isStakeUpdateNeeded() const {
-  uint64_t currentEpoch = getCurrentEpoch();
-  return currentEpoch != cache_.lastStakeUpdateEpoch;
+  return isStakeUpdateNeeded(getCurrentEpoch());
 }
 
 bool Ouroboros::isStakeUpdateNeeded(uint64_t forEpoch) const {
-  return forEpoch != cache_.lastStakeUpdateEpoch;
+  // A kept snapshot already answers leader queries for the epoch
+  return getStakeSnapshot(forEpoch) == nullptr;
 }
 
 bool Ouroboros::isSlotBlockProductionTime(uint64_t slot) const {
@@ -90,6 +87,24 @@ Ouroboros::Roe<uint64_t> Ouroboros::getSlotLeader(uint64_t slot) const {
   return leader;
 }
 
+Ouroboros::StakeSnapshotPtr Ouroboros::getStakeSnapshot(uint64_t epoch) const {
+  StakeSnapshotListPtr snapshots = getStakeSnapshots();
+  if (!snapshots) {
+    return nullptr;
+  }
+  for (auto it = snapshots->rbegin(); it != snapshots->rend(); ++it) {
+    if ((*it)->epoch == epoch) {
+      return *it;
+    }
+  }
+  return nullptr;
+}
+
+Ouroboros::StakeSnapshotListPtr Ouroboros::getStakeSnapshots() const {
+  std::lock_guard<std::mutex> lock(snapshotsMutex_);
+  return snapshots_;
+}
+
 uint64_t Ouroboros::getEpochFromSlot(uint64_t slot) const {
   if (config_.slotsPerEpoch == 0) {
     log().error << "Slots per epoch is 0";
@@ -105,11 +120,7 @@ uint64_t Ouroboros::getStake(uint64_t stakeholderId) const {
   return it->second;
 }
 
-uint64_t Ouroboros::getTotalStake() const {
-  return std::accumulate(
-      cache_.mStakeholders.begin(), cache_.mStakeholders.end(), uint64_t(0),
-      [](uint64_t sum, const auto &pair) { return sum + pair.second; });
-}
+uint64_t Ouroboros::getTotalStake() const { return cache_.totalStake; }
 
 size_t Ouroboros::getStakeholderCount() const { return cache_.mStakeholders.size(); }
 
@@ -140,6 +151,8 @@ void Ouroboros::assertConfigIsSet() const {
 void Ouroboros::init(const Config& config) {
   config_ = config;
   cache_ = {};
+  std::lock_guard<std::mutex> lock(snapshotsMutex_);
+  snapshots_.reset();
 }
 
 void Ouroboros::setStakeholders(const std::vector<Stakeholder>& stakeholders) {
@@ -149,64 +162,141 @@ void Ouroboros::setStakeholders(const std::vector<Stakeholder>& stakeholders) {
 void Ouroboros::setStakeholders(const std::vector<Stakeholder>& stakeholders,
                                 uint64_t forEpoch) {
   cache_.mStakeholders.clear();
+  cache_.byStake.clear();
+  cache_.totalStake = 0;
   for (const auto& stakeholder : stakeholders) {
-    cache_.mStakeholders[stakeholder.id] = stakeholder.stake;
+    putStake(stakeholder.id, stakeholder.stake);
+  }
+  publishStakeSnapshot(forEpoch);
+}
+
+void Ouroboros::updateStakeholders(const std::vector<Stakeholder>& changes,
+                                   uint64_t forEpoch) {
+  for (const auto& change : changes) {
+    if (change.stake == 0) {
+      eraseStake(change.id);
+    } else {
+      putStake(change.id, change.stake);
+    }
+  }
+  publishStakeSnapshot(forEpoch);
+}
+
+void Ouroboros::putStake(uint64_t stakeholderId, uint64_t stake) {
+  eraseStake(stakeholderId);
+  cache_.mStakeholders[stakeholderId] = stake;
+  if (stake > 0) {
+    cache_.byStake.insert({stake, stakeholderId});
+    cache_.totalStake += stake;
+  }
+}
+
+void Ouroboros::eraseStake(uint64_t stakeholderId) {
+  auto it = cache_.mStakeholders.find(stakeholderId);
+  if (it == cache_.mStakeholders.end()) {
+    return;
   }
-  cache_.lastStakeUpdateEpoch = forEpoch;
+  cache_.byStake.erase({it->second, stakeholderId});
+  cache_.totalStake -= it->second;
+  cache_.mStakeholders.erase(it);
 }
 
 std::vector<uint64_t> Ouroboros::getEligibleLeaderPool() const {
-  if (cache_.mStakeholders.empty()) {
-    return {};
-  }
-  std::vector<std::pair<uint64_t, uint64_t>> byStake(cache_.mStakeholders.begin(),
-                                                     cache_.mStakeholders.end());
-  byStake.erase(
-      std::remove_if(byStake.begin(), byStake.end(),
-                     [](const auto& p) { return p.second == 0; }),
-      byStake.end());
-  if (byStake.empty()) {
-    return {};
-  }
-  // Sort by stake descending, then by id ascending for deterministic tie-break
-  std::sort(byStake.begin(), byStake.end(),
-            [](const auto& a, const auto& b) {
-              if (a.second != b.second) return a.second > b.second;
-              return a.first < b.first;
-            });
-  size_t n = std::min(kMaxLeaderPoolSize, byStake.size());
+  // byStake is ordered by stake descending, then by id ascending for deterministic tie-break
+  size_t n = std::min(kMaxLeaderPoolSize, cache_.byStake.size());
   std::vector<uint64_t> pool;
   pool.reserve(n);
-  for (size_t i = 0; i < n; ++i) {
-    pool.push_back(byStake[i].first);
+  for (auto it = cache_.byStake.begin(); pool.size() < n; ++it) {
+    pool.push_back(it->second);
   }
   return pool;
 }
 
+void Ouroboros::publishStakeSnapshot(uint64_t epoch) {
+  auto snapshot = std::make_shared<StakeSnapshot>();
+  snapshot->epoch = epoch;
+  snapshot->slotsPerEpoch = config_.slotsPerEpoch;
+  snapshot->totalStake = cache_.totalStake;
+  snapshot->stakeholderCount = cache_.mStakeholders.size();
+  snapshot->leaderPool = getEligibleLeaderPool();
+
+  // A single candidate needs no hashing; see StakeSnapshot::getSlotLeader()
+  const auto &pool = snapshot->leaderPool;
+  if (pool.size() > 1 && config_.slotsPerEpoch > 0 &&
+      config_.slotsPerEpoch <= kMaxScheduleSlots) {
+    const uint64_t firstSlot = epoch * config_.slotsPerEpoch;
+    snapshot->leaderSchedule.reserve(config_.slotsPerEpoch);
+    for (uint64_t i = 0; i < config_.slotsPerEpoch; ++i) {
+      const uint64_t hashValue = hashSlotAndEpoch(firstSlot + i, epoch);
+      snapshot->leaderSchedule.push_back(pool[hashValue % pool.size()]);
+    }
+  }
+
+  // Build the next list aside; readers keep whichever list they already hold
+  auto snapshots = std::make_shared<StakeSnapshotList>();
+  if (StakeSnapshotListPtr current = getStakeSnapshots()) {
+    for (const auto &s : *current) {
+      if (s->epoch != epoch) {
+        snapshots->push_back(s);
+      }
+    }
+  }
+  snapshots->push_back(std::move(snapshot));
+  if (snapshots->size() > kMaxStakeSnapshots) {
+    snapshots->erase(snapshots->begin(),
+                     snapshots->end() - kMaxStakeSnapshots);
+  }
+
+  std::lock_guard<std::mutex> lock(snapshotsMutex_);
+  snapshots_ = std::move(snapshots);
+}
+
 uint64_t Ouroboros::selectSlotLeader(uint64_t slot, uint64_t epoch) const {
-  std::vector<uint64_t> pool = getEligibleLeaderPool();
-  if (pool.empty()) {
+  StakeSnapshotPtr snapshot = getStakeSnapshot(epoch);
+  if (snapshot) {
+    return snapshot->getSlotLeader(slot);
+  }
+  StakeSnapshotListPtr snapshots = getStakeSnapshots();
+  if (!snapshots || snapshots->empty()) {
     return 0;
   }
 
-  // Cryptographic hash (SHA-256) for unpredictable, verifiable leader selection
-  std::string slotHash = hashSlotAndEpoch(slot, epoch);
-  if (slotHash.size() < 16) {
-    return pool[0];
+  // Epoch without its own snapshot: draw from the live distribution
+  const auto &pool = snapshots->back()->leaderPool;
+  if (pool.empty()) {
+    return 0;
   }
+  // Cryptographic hash (SHA-256) for unpredictable, verifiable leader selection;
+  // equal weight over eligible pool (normalized layer)
+  return pool[hashSlotAndEpoch(slot, epoch) % pool.size()];
+}
 
-  // Use first 64 bits of hash; equal weight over eligible pool (normalized layer)
-  uint64_t hashValue = std::strtoull(slotHash.substr(0, 16).c_str(), nullptr, 16);
-  size_t index = static_cast<size_t>(hashValue % pool.size());
-  return pool[index];
+uint64_t Ouroboros::StakeSnapshot::getSlotLeader(uint64_t slot) const {
+  if (leaderPool.empty()) {
+    return 0;
+  }
+  if (leaderPool.size() == 1) {
+    return leaderPool[0];
+  }
+  if (!leaderSchedule.empty()) {
+    return leaderSchedule[slot % slotsPerEpoch];
+  }
+  return leaderPool[hashSlotAndEpoch(slot, epoch) % leaderPool.size()];
 }
 
-std::string Ouroboros::hashSlotAndEpoch(uint64_t slot, uint64_t epoch) const {
+uint64_t Ouroboros::hashSlotAndEpoch(uint64_t slot, uint64_t epoch) {
   // Domain-separated input for protocol versioning and cross-system uniqueness
-  std::stringstream ss;
-  ss << "pp-ledger/ouroboros/v1:slot:" << slot << ":epoch:" << epoch;
-  std::string input = ss.str();
-  return pp::utl::sha256(input);
+  const std::string input = "pp-ledger/ouroboros/v1:slot:" +
+                            std::to_string(slot) +
+                            ":epoch:" + std::to_string(epoch);
+  utl::Sha256Sink sink;
+  sink.update(input.data(), input.size());
+  const std::string digest = sink.finalDigest();
+  uint64_t value = 0;
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    value = (value << 8) | static_cast<uint8_t>(digest[i]);
+  }
+  return value;
 }
 
 bool Ouroboros::validateSlotLeader(uint64_t slotLeader,
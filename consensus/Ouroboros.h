@@ -6,7 +6,10 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace pp {
@@ -37,6 +40,26 @@ public:
 
   template <typename T> using Roe = ResultOrError<T, Error>;
 
+  /**
+   * Stake distribution an epoch's leaders are drawn from. Immutable once
+   * published, so holders of the pointer can pick leaders without touching
+   * the live distribution.
+   */
+  struct StakeSnapshot {
+    uint64_t epoch{ 0 };
+    uint64_t slotsPerEpoch{ 0 };
+    uint64_t totalStake{ 0 };
+    size_t stakeholderCount{ 0 };
+    std::vector<uint64_t> leaderPool;
+    // Leader of each slot in the epoch; empty when not worth a table
+    std::vector<uint64_t> leaderSchedule;
+
+    /** Leader of a slot of this epoch, 0 when the pool is empty. */
+    uint64_t getSlotLeader(uint64_t slot) const;
+  };
+
+  using StakeSnapshotPtr = std::shared_ptr<const StakeSnapshot>;
+
   /**
    * Constructor
    * @param slotDuration Duration of each slot in seconds
@@ -48,9 +71,9 @@ public:
 
   // ----- accessors -----
   bool isSlotLeader(uint64_t slot, uint64_t stakeholderId) const;
-  /** True when live clock epoch differs from last update (for live adding). */
+  /** True when no stake snapshot is kept for the live clock epoch (for live adding). */
   bool isStakeUpdateNeeded() const;
-  /** True when given epoch differs from last update (for load-from-ledger). */
+  /** True when no stake snapshot is kept for the given epoch (for load-from-ledger). */
   bool isStakeUpdateNeeded(uint64_t forEpoch) const;
   bool isSlotBlockProductionTime(uint64_t slot) const;
 
@@ -69,6 +92,10 @@ public:
   size_t getStakeholderCount() const;
   std::vector<Stakeholder> getStakeholders() const;
   Roe<uint64_t> getSlotLeader(uint64_t slot) const;
+  /** Snapshot published for the epoch, or null when it is not among the
+   * last kMaxStakeSnapshots updates. Safe to call from any thread, also
+   * while stake is being updated. */
+  StakeSnapshotPtr getStakeSnapshot(uint64_t epoch) const;
   int64_t getTimestamp() const;
 
   /** Set stakeholders and record update epoch (live: use getCurrentEpoch()). */
@@ -76,6 +103,12 @@ public:
   /** Set stakeholders for a specific epoch (load-from-ledger: use block slot). */
   void setStakeholders(const std::vector<Stakeholder>& stakeholders,
                        uint64_t forEpoch);
+  /**
+   * Apply stake changes on top of the current distribution and record update epoch.
+   * Each entry carries the stakeholder's new stake; 0 removes it. O(changes).
+   */
+  void updateStakeholders(const std::vector<Stakeholder>& changes,
+                          uint64_t forEpoch);
 
   // ----- methods -----
   void init(const Config& config);
@@ -83,25 +116,55 @@ public:
   bool validateBlockTiming(int64_t blockTimestamp, uint64_t slot) const;
 
 private:
+  /** Orders (stake, id) by stake descending, then id ascending. */
+  struct StakeOrder {
+    bool operator()(const std::pair<uint64_t, uint64_t>& a,
+                    const std::pair<uint64_t, uint64_t>& b) const {
+      if (a.first != b.first) return a.first > b.first;
+      return a.second < b.second;
+    }
+  };
+
   struct Cache {
     std::map<uint64_t, uint64_t> mStakeholders;
-    uint64_t lastStakeUpdateEpoch{ static_cast<uint64_t>(-1) }; // -1 = never
+    // Non-zero stakes as (stake, id), kept in leader pool order
+    std::set<std::pair<uint64_t, uint64_t>, StakeOrder> byStake;
+    uint64_t totalStake{ 0 };
   };
 
+  // One snapshot per updated epoch, oldest first, latest is the live one
+  using StakeSnapshotList = std::vector<StakeSnapshotPtr>;
+  using StakeSnapshotListPtr = std::shared_ptr<const StakeSnapshotList>;
+
   void assertConfigIsSet() const;
+  void putStake(uint64_t stakeholderId, uint64_t stake);
+  void eraseStake(uint64_t stakeholderId);
   // Helper methods for slot leader selection
   /** Eligible pool for leader selection: all if ≤kMaxLeaderPoolSize, else top by stake. */
   std::vector<uint64_t> getEligibleLeaderPool() const;
+  /** Publish the live distribution as the given epoch's snapshot, replacing
+   * an earlier one for the same epoch and evicting the oldest beyond
+   * kMaxStakeSnapshots. */
+  void publishStakeSnapshot(uint64_t epoch);
+  /** Current snapshot list; the list is never modified once published. */
+  StakeSnapshotListPtr getStakeSnapshots() const;
   uint64_t selectSlotLeader(uint64_t slot, uint64_t epoch) const;
   uint64_t calculateStakeThreshold(uint64_t stakeholderId,
                                    uint64_t totalStake) const;
-  std::string hashSlotAndEpoch(uint64_t slot, uint64_t epoch) const;
+  /** First 64 bits (big-endian) of the SHA-256 of the slot/epoch input. */
+  static uint64_t hashSlotAndEpoch(uint64_t slot, uint64_t epoch);
 
   static constexpr size_t kMaxLeaderPoolSize = 100;
+  /** Larger epochs pick leaders per query instead of keeping a table. */
+  static constexpr uint64_t kMaxScheduleSlots = 1 << 20;
+  static constexpr size_t kMaxStakeSnapshots = 8;
 
   // Data members
   Config config_;
   Cache cache_;
+  // Copy-on-write: publishStakeSnapshot() swaps in a new list under the lock
+  mutable std::mutex snapshotsMutex_;
+  StakeSnapshotListPtr snapshots_;
 };
 
 } // namespace consensus
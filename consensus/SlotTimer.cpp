@@ -55,7 +55,18 @@ int64_t SlotTimer::getCurrentTime() const {
   auto now = std::chrono::system_clock::now();
   return std::chrono::duration_cast<std::chrono::seconds>(
              now.time_since_epoch())
-      .count();
+             .count() +
+         timeOffset_;
+}
+
+int64_t SlotTimer::getMsUntilTime(int64_t timestamp) const {
+  // getCurrentTime() ticks over when local time reaches a whole second
+  auto now = std::chrono::system_clock::now();
+  int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      now.time_since_epoch())
+                      .count();
+  int64_t targetMs = (timestamp - timeOffset_) * 1000;
+  return targetMs > nowMs ? targetMs - nowMs : 0;
 }
 
 void SlotTimer::setSlotDuration(uint64_t duration) {
@@ -53,16 +53,26 @@ public:
   int64_t getTimeUntilSlot(uint64_t slot, int64_t genesisTime) const;
 
   /**
-   * Get current timestamp
+   * Get current timestamp (local time shifted by the time offset)
    */
   int64_t getCurrentTime() const;
 
+  /**
+   * Calculate milliseconds until getCurrentTime() reaches a timestamp
+   * Returns 0 if the timestamp has already been reached
+   */
+  int64_t getMsUntilTime(int64_t timestamp) const;
+
   // Configuration
   void setSlotDuration(uint64_t duration);
   uint64_t getSlotDuration() const { return slotDuration_; }
+  /** Seconds added to local time, same as Ouroboros::Config::timeOffset */
+  void setTimeOffset(int64_t offset) { timeOffset_ = offset; }
+  int64_t getTimeOffset() const { return timeOffset_; }
 
 private:
   uint64_t slotDuration_;
+  int64_t timeOffset_{ 0 };
 };
 
 } // namespace consensus
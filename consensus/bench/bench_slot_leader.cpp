@@ -0,0 +1,99 @@
+#include "../Ouroboros.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pp::consensus;
+
+namespace {
+
+constexpr size_t DEFAULT_STAKEHOLDER_COUNT = 10000;
+constexpr uint64_t SLOTS_PER_EPOCH = 8640;
+constexpr size_t QUERY_COUNT = 1000000;
+
+template <typename Fn> double measureNsPerOp(size_t count, Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return static_cast<double>(ns) / static_cast<double>(count);
+}
+
+void report(const std::string &name, double nsPerOp) {
+  std::cout << name << ": " << nsPerOp << " ns/op" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t stakeholderCount = DEFAULT_STAKEHOLDER_COUNT;
+  if (argc > 1) {
+    stakeholderCount = std::strtoull(argv[1], nullptr, 10);
+  }
+
+  Ouroboros consensus;
+  consensus.init({ .genesisTime = 0,
+                   .timeOffset = 0,
+                   .slotDuration = 1,
+                   .slotsPerEpoch = SLOTS_PER_EPOCH });
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<uint64_t> stakeDist(1, 1000000);
+  std::vector<Stakeholder> stakeholders(stakeholderCount);
+  for (size_t i = 0; i < stakeholderCount; ++i) {
+    stakeholders[i].id = 1000 + i;
+    stakeholders[i].stake = stakeDist(rng);
+  }
+
+  constexpr uint64_t EPOCH = 5;
+  double setNs = measureNsPerOp(1, [&] {
+    consensus.setStakeholders(stakeholders, EPOCH);
+  });
+
+  // Miner loop and block validation: slots of the epoch the stake is for
+  std::uniform_int_distribution<uint64_t> slotDist(
+      EPOCH * SLOTS_PER_EPOCH, (EPOCH + 1) * SLOTS_PER_EPOCH - 1);
+  std::vector<uint64_t> slots(QUERY_COUNT);
+  for (auto &slot : slots) {
+    slot = slotDist(rng);
+  }
+
+  uint64_t checksum = 0;
+  double scheduledNs = measureNsPerOp(QUERY_COUNT, [&] {
+    for (uint64_t slot : slots) {
+      checksum += consensus.getSlotLeader(slot).value();
+    }
+  });
+
+  size_t matches = 0;
+  double validateNs = measureNsPerOp(QUERY_COUNT, [&] {
+    for (uint64_t slot : slots) {
+      if (consensus.validateSlotLeader(1000 + slot % stakeholderCount, slot)) {
+        ++matches;
+      }
+    }
+  });
+
+  // Slots outside the scheduled epoch are hashed per query
+  constexpr size_t UNSCHEDULED_COUNT = 100000;
+  double unscheduledNs = measureNsPerOp(UNSCHEDULED_COUNT, [&] {
+    for (size_t i = 0; i < UNSCHEDULED_COUNT; ++i) {
+      checksum += consensus.getSlotLeader(slots[i] + SLOTS_PER_EPOCH).value();
+    }
+  });
+
+  std::cout << "stakeholders: " << consensus.getStakeholderCount()
+            << ", slots per epoch: " << SLOTS_PER_EPOCH << std::endl;
+  report("setStakeholders (pool + epoch schedule)", setNs);
+  report("getSlotLeader (scheduled epoch)", scheduledNs);
+  report("validateSlotLeader (scheduled epoch)", validateNs);
+  report("getSlotLeader (other epoch)", unscheduledNs);
+  std::cout << "(checksum " << checksum << ", matches " << matches << ")"
+            << std::endl;
+  return 0;
+}
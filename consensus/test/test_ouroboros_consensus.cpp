@@ -1,7 +1,14 @@
 #include "Ouroboros.h"
+#include "lib/common/Utilities.h"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <set>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace pp::consensus;
 using ::testing::Ge;
@@ -209,3 +216,132 @@ TEST_F(OuroborosWithStakeholdersTest, ProducesConsistentLeaderAcrossEpochs) {
     EXPECT_THAT(leader1.value(), AnyOf(Eq(1), Eq(2), Eq(3)));
     EXPECT_THAT(leader2.value(), AnyOf(Eq(1), Eq(2), Eq(3)));
 }
+
+TEST_F(OuroborosTest, UpdateStakeholdersAppliesChanges) {
+    consensus->setStakeholders({{1, 1000}, {2, 2000}, {3, 500}}, 0);
+
+    consensus->updateStakeholders({{2, 0}, {3, 700}, {4, 100}}, 1);
+
+    EXPECT_EQ(consensus->getStakeholderCount(), 3);
+    EXPECT_EQ(consensus->getTotalStake(), 1800);
+    EXPECT_EQ(consensus->getStake(2), 0);
+    EXPECT_EQ(consensus->getStake(3), 700);
+    EXPECT_FALSE(consensus->isStakeUpdateNeeded(1));
+
+    // Same leaders as a full reset to the same distribution (epoch 0 keeps
+    // its own snapshot, so start at epoch 1)
+    Ouroboros full;
+    full.init(consensus->getConfig());
+    full.setStakeholders({{1, 1000}, {3, 700}, {4, 100}}, 1);
+    for (uint64_t slot = 10; slot < 60; ++slot) {
+        EXPECT_EQ(consensus->getSlotLeader(slot).value(), full.getSlotLeader(slot).value());
+    }
+}
+
+TEST_F(OuroborosTest, ScheduledLeadersMatchHashSelection) {
+    // More stakeholders than the leader pool, with ties broken by id
+    std::vector<Stakeholder> stakeholders;
+    for (uint64_t id = 1; id <= 150; ++id) {
+        stakeholders.push_back({id, 1000 + (id % 7) * 100});
+    }
+    consensus->setStakeholders(stakeholders, 3);
+
+    std::vector<std::pair<uint64_t, uint64_t>> byStake;
+    for (const auto &s : stakeholders) {
+        byStake.push_back({s.stake, s.id});
+    }
+    std::sort(byStake.begin(), byStake.end(), [](const auto &a, const auto &b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    byStake.resize(100);
+
+    auto expectedLeader = [&](uint64_t slot) {
+        const uint64_t epoch = slot / 10;
+        std::string hash = pp::utl::sha256("pp-ledger/ouroboros/v1:slot:" +
+                                           std::to_string(slot) + ":epoch:" +
+                                           std::to_string(epoch));
+        uint64_t value = std::strtoull(hash.substr(0, 16).c_str(), nullptr, 16);
+        return byStake[value % byStake.size()].second;
+    };
+
+    // Slots 30-39 come from the epoch 3 table, the others are hashed per query
+    for (uint64_t slot = 20; slot < 50; ++slot) {
+        EXPECT_EQ(consensus->getSlotLeader(slot).value(), expectedLeader(slot))
+            << "slot " << slot;
+        EXPECT_TRUE(consensus->validateSlotLeader(expectedLeader(slot), slot));
+    }
+}
+
+TEST_F(OuroborosTest, StakeSnapshotsKeepLeadersOfRecentEpochs) {
+    consensus->setStakeholders({{1, 1000}, {2, 2000}, {3, 500}}, 0);
+    std::vector<uint64_t> epoch0Leaders;
+    for (uint64_t slot = 0; slot < 10; ++slot) {
+        epoch0Leaders.push_back(consensus->getSlotLeader(slot).value());
+    }
+    auto epoch0 = consensus->getStakeSnapshot(0);
+    ASSERT_NE(epoch0, nullptr);
+
+    // Epoch 1 has a single candidate, epoch 0 still draws from its own pool
+    consensus->updateStakeholders({{1, 0}, {2, 0}}, 1);
+    EXPECT_EQ(consensus->getTotalStake(), 500);
+    for (uint64_t slot = 0; slot < 10; ++slot) {
+        EXPECT_EQ(consensus->getSlotLeader(slot).value(), epoch0Leaders[slot]);
+        EXPECT_EQ(epoch0->getSlotLeader(slot), epoch0Leaders[slot]);
+        EXPECT_EQ(consensus->getSlotLeader(slot + 10).value(), 3);
+    }
+    EXPECT_EQ(epoch0->totalStake, 3500);
+    EXPECT_EQ(epoch0->stakeholderCount, 3);
+    EXPECT_FALSE(consensus->isStakeUpdateNeeded(0));
+    EXPECT_FALSE(consensus->isStakeUpdateNeeded(1));
+    EXPECT_TRUE(consensus->isStakeUpdateNeeded(2));
+
+    // Old epochs are evicted, while held pointers stay valid
+    for (uint64_t epoch = 2; epoch < 10; ++epoch) {
+        consensus->updateStakeholders({}, epoch);
+    }
+    EXPECT_EQ(consensus->getStakeSnapshot(0), nullptr);
+    EXPECT_EQ(consensus->getStakeSnapshot(1), nullptr);
+    EXPECT_NE(consensus->getStakeSnapshot(2), nullptr);
+    EXPECT_TRUE(consensus->isStakeUpdateNeeded(0));
+    EXPECT_EQ(epoch0->getSlotLeader(3), epoch0Leaders[3]);
+}
+
+TEST_F(OuroborosTest, StakeSnapshotsReadWhileStakeUpdates) {
+    consensus->setStakeholders({{1, 1000}, {2, 2000}, {3, 500}}, 0);
+    std::vector<uint64_t> epoch0Leaders;
+    for (uint64_t slot = 0; slot < 10; ++slot) {
+        epoch0Leaders.push_back(consensus->getStakeSnapshot(0)->getSlotLeader(slot));
+    }
+
+    // Validators read snapshots while the chain publishes later epochs
+    std::atomic<bool> isDone{ false };
+    std::atomic<size_t> mismatches{ 0 };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!isDone) {
+                auto snapshot = consensus->getStakeSnapshot(0);
+                if (!snapshot) {
+                    continue;  // Evicted by the writer
+                }
+                for (uint64_t slot = 0; slot < 10; ++slot) {
+                    if (snapshot->getSlotLeader(slot) != epoch0Leaders[slot]) {
+                        ++mismatches;
+                    }
+                }
+            }
+        });
+    }
+    for (uint64_t round = 0; round < 200; ++round) {
+        consensus->setStakeholders({{1, 1000}, {2, 2000}, {3, 500}}, 0);
+        for (uint64_t epoch = 1; epoch < 4; ++epoch) {
+            consensus->updateStakeholders({{epoch, epoch * 100}}, epoch);
+        }
+    }
+    isDone = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_NE(consensus->getStakeSnapshot(3), nullptr);
+}
@@ -225,3 +225,17 @@ TEST_F(SlotTimerTest, UpdatesSlotDuration) {
     int64_t slot1Start = timer->getSlotStartTime(1, genesisTime);
     EXPECT_EQ(slot1Start, genesisTime + 5);
 }
+
+TEST_F(SlotTimerTest, CalculatesMsUntilTimeWithOffset) {
+    int64_t now = timer->getCurrentTime();
+    EXPECT_EQ(timer->getMsUntilTime(now), 0);
+    EXPECT_EQ(timer->getMsUntilTime(now - 10), 0);
+    EXPECT_GT(timer->getMsUntilTime(now + 3), 1000);
+    EXPECT_LE(timer->getMsUntilTime(now + 3), 3000);
+
+    // Clock 100s ahead: the same target is reached 100s sooner
+    timer->setTimeOffset(100);
+    EXPECT_GE(timer->getCurrentTime() - now, 100);
+    EXPECT_EQ(timer->getMsUntilTime(now + 3), 0);
+    EXPECT_GT(timer->getMsUntilTime(now + 103), 1000);
+}
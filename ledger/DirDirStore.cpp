@@ -288,6 +288,35 @@ DirDirStore::Roe<std::string> DirDirStore::readBlock(uint64_t index) const {
   return Error("Dir " + std::to_string(dirId) + " has no store");
 }
 
+DirDirStore::Roe<DirDirStore::BlockLocation>
+DirDirStore::getBlockLocation(uint64_t index) const {
+  if (rootStore_) {
+    if (index < rootStore_->getBlockCount()) {
+      return rootStore_->getBlockLocation(index);
+    }
+    return Error("Block " + std::to_string(index) + " not found (root store has " +
+                 std::to_string(rootStore_->getBlockCount()) + " blocks)");
+  }
+
+  auto [dirId, indexWithinDir] = findBlockDir(index);
+  if (dirId == 0 && indexWithinDir == 0 && index != 0) {
+    return Error("Block " + std::to_string(index) + " not found");
+  }
+
+  auto it = dirInfoMap_.find(dirId);
+  if (it == dirInfoMap_.end()) {
+    return Error("Dir " + std::to_string(dirId) + " not found");
+  }
+
+  if (it->second.fileDirStore) {
+    return it->second.fileDirStore->getBlockLocation(indexWithinDir);
+  } else if (it->second.dirDirStore) {
+    return it->second.dirDirStore->getBlockLocation(indexWithinDir);
+  }
+
+  return Error("Dir " + std::to_string(dirId) + " has no store");
+}
+
 DirDirStore::Roe<uint64_t> DirDirStore::appendBlock(const std::string &block) {
   // If using root store, try to write there first
   if (rootStore_) {
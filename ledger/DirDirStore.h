@@ -110,6 +110,7 @@ public:
     size_t getCurrentLevel() const { return currentLevel_; }
 
     Roe<std::string> readBlock(uint64_t index) const override;
+    Roe<BlockLocation> getBlockLocation(uint64_t index) const override;
     Roe<uint64_t> appendBlock(const std::string &block) override;
     Roe<void> rewindTo(uint64_t index) override;
     uint64_t countSizeFromBlockId(uint64_t blockId) const override;
@@ -1,6 +1,7 @@
 #ifndef PP_LEDGER_DIR_STORE_H
 #define PP_LEDGER_DIR_STORE_H
 
+#include "FileStore.h"
 #include "lib/common/Module.h"
 #include "lib/common/ResultOrError.hpp"
 #include <cstdint>
@@ -20,6 +21,8 @@ public:
 
     template <typename T> using Roe = ResultOrError<T, Error>;
 
+    using BlockLocation = FileStore::BlockLocation;
+
     /**
      * Magic number constants for index files
      */
@@ -56,6 +59,13 @@ public:
      */
     virtual Roe<std::string> readBlock(uint64_t index) const = 0;
 
+    /**
+     * Locate a block's data on disk without reading it
+     * @param index Block index (0-based)
+     * @return File path, offset and size of the block data, or error
+     */
+    virtual Roe<BlockLocation> getBlockLocation(uint64_t index) const = 0;
+
     /**
      * Append a block to the store
      * @param block Block data to append
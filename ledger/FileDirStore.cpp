@@ -170,6 +170,32 @@ FileDirStore::Roe<std::string> FileDirStore::readBlock(uint64_t index) const {
   return readResult.value();
 }
 
+FileDirStore::Roe<FileDirStore::BlockLocation>
+FileDirStore::getBlockLocation(uint64_t index) const {
+  auto [fileId, indexWithinFile] = findBlockFile(index);
+  if (fileId == 0 && indexWithinFile == 0 && index != 0) {
+    return Error("Block " + std::to_string(index) + " not found");
+  }
+
+  auto it = fileInfoMap_.find(fileId);
+  if (it == fileInfoMap_.end() || !it->second.blockFile) {
+    // Try to open the file
+    FileDirStore *nonConstThis = const_cast<FileDirStore *>(this);
+    FileStore *blockFile = nonConstThis->getBlockFile(fileId);
+    if (!blockFile) {
+      return Error("Block file " + std::to_string(fileId) + " not found");
+    }
+    it = fileInfoMap_.find(fileId);
+  }
+
+  auto locationResult = it->second.blockFile->getBlockLocation(indexWithinFile);
+  if (!locationResult.isOk()) {
+    return Error("Failed to locate block " + std::to_string(index) + ": " +
+                 locationResult.error().message);
+  }
+  return locationResult.value();
+}
+
 uint64_t FileDirStore::countSizeFromBlockId(uint64_t blockId) const {
   if (blockId >= totalBlockCount_) {
     return 0;
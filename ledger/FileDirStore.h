@@ -66,6 +66,7 @@ public:
     Roe<void> mount(const std::string &dirPath);
 
     Roe<std::string> readBlock(uint64_t index) const override;
+    Roe<BlockLocation> getBlockLocation(uint64_t index) const override;
     Roe<uint64_t> appendBlock(const std::string &block) override;
     Roe<void> rewindTo(uint64_t index) override;
 
@@ -266,6 +266,27 @@ FileStore::Roe<uint64_t> FileStore::getBlockSize(uint64_t index) {
   return blockIndex_[index].size;
 }
 
+FileStore::Roe<FileStore::BlockLocation>
+FileStore::getBlockLocation(uint64_t index) const {
+  // Need to cast away const for internal operations
+  auto indexResult = const_cast<FileStore *>(this)->ensureBlockIndex();
+  if (!indexResult.isOk()) {
+    return Error(indexResult.error().message);
+  }
+
+  if (index >= blockIndex_.size()) {
+    return Error("Block index " + std::to_string(index) + " out of range (max: " +
+                 std::to_string(blockIndex_.size()) + ")");
+  }
+
+  const BlockEntry &entry = blockIndex_[index];
+  BlockLocation location;
+  location.filePath = filepath_;
+  location.offset = static_cast<uint64_t>(entry.offset) + SIZE_PREFIX_BYTES;
+  location.size = entry.size;
+  return location;
+}
+
 bool FileStore::canFit(uint64_t size) const {
   // currentSize_ already includes header, add size prefix overhead
   return (currentSize_ + SIZE_PREFIX_BYTES + size) <= maxSize_;
@@ -28,6 +28,16 @@ public:
 
   template <typename T> using Roe = ResultOrError<T, Error>;
 
+  /**
+   * Where the data of a block lies on disk, for readers that send it
+   * without loading it (e.g. sendfile)
+   */
+  struct BlockLocation {
+    std::string filePath;
+    uint64_t offset{ 0 }; // Offset of the block data (after the size prefix)
+    uint64_t size{ 0 };   // Size of the block data
+  };
+
   /**
    * Configuration for FileStore initialization
    */
@@ -96,6 +106,14 @@ public:
    */
   Roe<uint64_t> getBlockSize(uint64_t index);
 
+  /**
+   * Get the location of a block's data in this file (0-based index)
+   * Lazily builds the block index on first call if not already built.
+   * @param index Block index within this file (0-based)
+   * @return Roe<BlockLocation> with file path, data offset and size, or error
+   */
+  Roe<BlockLocation> getBlockLocation(uint64_t index) const;
+
   /**
    * Get the number of blocks stored in this file
    * @return Number of blocks
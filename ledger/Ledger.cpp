@@ -26,17 +26,45 @@ std::string transactionTypeToHumanString(uint16_t type) {
   }
 }
 
+constexpr char MERKLE_LEAF_PREFIX = 0x00;
+constexpr char MERKLE_NODE_PREFIX = 0x01;
+constexpr size_t MERKLE_HASH_SIZE = 32;
+
+std::string hashMerkleNode(const std::string &left, const std::string &right) {
+  utl::Sha256Sink sink;
+  sink.update(&MERKLE_NODE_PREFIX, 1);
+  sink.update(left.data(), left.size());
+  sink.update(right.data(), right.size());
+  return sink.finalDigest();
+}
+
+/** Parent level of a Merkle tree level; a trailing odd node is carried up. */
+std::vector<std::string> hashMerkleLevel(const std::vector<std::string> &level) {
+  std::vector<std::string> parents;
+  parents.reserve((level.size() + 1) / 2);
+  for (size_t i = 0; i + 1 < level.size(); i += 2) {
+    parents.push_back(hashMerkleNode(level[i], level[i + 1]));
+  }
+  if (level.size() % 2 == 1) {
+    parents.push_back(level.back());
+  }
+  return parents;
+}
+
 } // namespace
 
 std::string Ledger::Block::ltsToString() const {
   std::ostringstream oss(std::ios::binary);
-  OutputArchive ar(oss);
+  ltsToStream(oss);
+  return oss.str();
+}
 
-  // Serialize version and block fields (always write CURRENT_VERSION with all fields)
-  uint16_t version = CURRENT_VERSION;
-  ar & version & *this;
+void Ledger::Block::ltsToStream(std::ostream &os) const {
+  OutputArchive ar(os);
 
-  return oss.str();
+  // Serialize version and block fields (the block's own version, so stored
+  // blocks re-serialize to the bytes they were hashed from)
+  ar & version & *this;
 }
 
 bool Ledger::Block::ltsFromString(const std::string &str) {
@@ -58,6 +86,7 @@ bool Ledger::Block::ltsFromString(const std::string &str) {
 
   // Deserialize block fields
   ar & *this;
+  this->version = version;
 
   if (ar.failed()) {
     return false;
@@ -229,6 +258,7 @@ Ledger::Record::decode() const {
 
 pp::common::Meta Ledger::Block::ltsToMeta() const {
   pp::common::Meta j;
+  j.set("version", static_cast<uint64_t>(version));
   j.set("index", index);
   j.set("timestamp", utl::formatTimestampLocal(timestamp));
   j.set("previousHash", utl::toJsonSafeString(previousHash));
@@ -253,6 +283,175 @@ pp::common::Meta Ledger::ChainNode::ltsToMeta() const {
   return j;
 }
 
+Ledger::BlockHeader Ledger::BlockHeader::fromBlock(const Block &block) {
+  BlockHeader header;
+  header.version = block.version;
+  header.index = block.index;
+  header.timestamp = block.timestamp;
+  header.merkleRoot = calculateMerkleRoot(block.records);
+  header.recordCount = block.records.size();
+  header.previousHash = block.previousHash;
+  header.nonce = block.nonce;
+  header.slot = block.slot;
+  header.slotLeader = block.slotLeader;
+  header.txIndex = block.txIndex;
+  return header;
+}
+
+std::string Ledger::BlockHeader::calculateHash() const {
+  utl::Sha256Sink sink;
+  std::ostream os(&sink);
+  OutputArchive ar(os);
+  ar & *this;
+  return sink.finalHex();
+}
+
+pp::common::Meta Ledger::BlockHeader::ltsToMeta() const {
+  pp::common::Meta j;
+  j.set("version", static_cast<uint64_t>(version));
+  j.set("index", index);
+  j.set("timestamp", utl::formatTimestampLocal(timestamp));
+  j.set("merkleRoot", utl::hexEncode(merkleRoot));
+  j.set("recordCount", recordCount);
+  j.set("previousHash", utl::toJsonSafeString(previousHash));
+  j.set("nonce", nonce);
+  j.set("slot", slot);
+  j.set("slotLeader", slotLeader);
+  j.set("startingTxIndex", txIndex);
+  return j;
+}
+
+Ledger::Roe<void> Ledger::TxProof::verify(uint64_t txIndex) const {
+  if (header.version < Block::VERSION_MERKLE) {
+    return Error("Block version " + std::to_string(header.version) +
+                 " has no Merkle root");
+  }
+  // An odd node is carried up unhashed, so with a different leaf count the
+  // same root can be reached from another position
+  if (proof.leafCount != header.recordCount) {
+    return Error("Proof leaf count " + std::to_string(proof.leafCount) +
+                 " does not match the block's " +
+                 std::to_string(header.recordCount) + " records");
+  }
+  if (txIndex < header.txIndex || txIndex - header.txIndex != proof.leafIndex) {
+    return Error("Proof position does not match txIndex " +
+                 std::to_string(txIndex));
+  }
+  auto rootResult =
+      calculateMerkleRootFromProof(calculateRecordHash(record), proof);
+  if (!rootResult) {
+    return rootResult.error();
+  }
+  if (rootResult.value() != header.merkleRoot) {
+    return Error("Record does not match the block's Merkle root");
+  }
+  if (header.calculateHash() != blockHash) {
+    return Error("Block header does not match the block hash");
+  }
+  return {};
+}
+
+pp::common::Meta Ledger::TxProof::ltsToMeta() const {
+  pp::common::Meta j;
+  j.set("record", record.ltsToMeta());
+  j.set("blockHash", utl::toJsonSafeString(blockHash));
+  j.set("header", header.ltsToMeta());
+  j.set("leafIndex", proof.leafIndex);
+  j.set("leafCount", proof.leafCount);
+  std::vector<pp::common::Meta::Value> pathVals;
+  pathVals.reserve(proof.path.size());
+  for (const auto &hash : proof.path) {
+    pathVals.push_back(utl::hexEncode(hash));
+  }
+  j.set("path", pp::common::Meta::array(std::move(pathVals)));
+  return j;
+}
+
+std::string Ledger::calculateRecordHash(const Record &record) {
+  utl::Sha256Sink sink;
+  sink.update(&MERKLE_LEAF_PREFIX, 1);
+  std::ostream os(&sink);
+  OutputArchive ar(os);
+  ar & record;
+  return sink.finalDigest();
+}
+
+std::string Ledger::calculateMerkleRoot(const std::vector<Record> &records) {
+  if (records.empty()) {
+    return utl::Sha256Sink().finalDigest();
+  }
+  std::vector<std::string> level;
+  level.reserve(records.size());
+  for (const auto &record : records) {
+    level.push_back(calculateRecordHash(record));
+  }
+  while (level.size() > 1) {
+    level = hashMerkleLevel(level);
+  }
+  return level.front();
+}
+
+Ledger::Roe<Ledger::MerkleProof>
+Ledger::buildMerkleProof(const std::vector<Record> &records,
+                         uint64_t leafIndex) {
+  if (leafIndex >= records.size()) {
+    return Error("Leaf index " + std::to_string(leafIndex) +
+                 " out of range for " + std::to_string(records.size()) +
+                 " records");
+  }
+  MerkleProof proof;
+  proof.leafIndex = leafIndex;
+  proof.leafCount = records.size();
+
+  std::vector<std::string> level;
+  level.reserve(records.size());
+  for (const auto &record : records) {
+    level.push_back(calculateRecordHash(record));
+  }
+  uint64_t index = leafIndex;
+  while (level.size() > 1) {
+    const uint64_t sibling = index ^ 1;
+    if (sibling < level.size()) {
+      proof.path.push_back(level[sibling]);
+    }
+    level = hashMerkleLevel(level);
+    index >>= 1;
+  }
+  return proof;
+}
+
+Ledger::Roe<std::string>
+Ledger::calculateMerkleRootFromProof(const std::string &leafHash,
+                                     const MerkleProof &proof) {
+  if (proof.leafIndex >= proof.leafCount) {
+    return Error("Proof leaf index out of range");
+  }
+  std::string hash = leafHash;
+  uint64_t index = proof.leafIndex;
+  uint64_t levelSize = proof.leafCount;
+  size_t pathPos = 0;
+  while (levelSize > 1) {
+    const uint64_t sibling = index ^ 1;
+    if (sibling < levelSize) {
+      if (pathPos >= proof.path.size()) {
+        return Error("Proof path too short");
+      }
+      const std::string &other = proof.path[pathPos++];
+      if (other.size() != MERKLE_HASH_SIZE) {
+        return Error("Invalid proof hash size: " + std::to_string(other.size()));
+      }
+      hash = (index & 1) ? hashMerkleNode(other, hash)
+                         : hashMerkleNode(hash, other);
+    }
+    index >>= 1;
+    levelSize = (levelSize + 1) / 2;
+  }
+  if (pathPos != proof.path.size()) {
+    return Error("Proof path too long");
+  }
+  return hash;
+}
+
 Ledger::Ledger() {
   redirectLogger("Ledger");
   store_.redirectLogger(log().getFullName() + ".Store");
@@ -275,6 +474,7 @@ Ledger::Roe<void> Ledger::init(const InitConfig& config) {
   workDir_ = config.workDir;
   dataDir_ = workDir_ + "/data";
   indexFilePath_ = workDir_ + "/ledger_index.dat";
+  txIndexFilePath_ = workDir_ + "/ledger_txindex.dat";
   
   // Verify work directory does NOT exist (fresh initialization)
   std::error_code ec;
@@ -310,6 +510,13 @@ Ledger::Roe<void> Ledger::init(const InitConfig& config) {
     return Error("Failed to save initial index");
   }
 
+  // Start with an empty tx index table
+  blockTxIndexes_.clear();
+  std::ofstream txIndexFile(txIndexFilePath_, std::ios::binary | std::ios::trunc);
+  if (!txIndexFile) {
+    return Error("Failed to create tx index file: " + txIndexFilePath_);
+  }
+
   log().info << "Ledger initialized at " << workDir_ 
             << " with startingBlockId=" << meta_.startingBlockId
             << ", nextBlockId=" << getNextBlockId();
@@ -321,6 +528,7 @@ Ledger::Roe<void> Ledger::mount(const std::string& workDir) {
   workDir_ = workDir;
   dataDir_ = workDir_ + "/data";
   indexFilePath_ = workDir_ + "/ledger_index.dat";
+  txIndexFilePath_ = workDir_ + "/ledger_txindex.dat";
 
   // Verify work directory exists (loading existing ledger)
   std::error_code ec;
@@ -357,6 +565,14 @@ Ledger::Roe<void> Ledger::mount(const std::string& workDir) {
             << " with startingBlockId=" << meta_.startingBlockId
             << ", nextBlockId=" << getNextBlockId();
 
+  // Load tx index table; rebuild from blocks if missing or out of sync (e.g. older ledgers)
+  if (!loadTxIndex()) {
+    auto rebuildResult = rebuildTxIndex();
+    if (!rebuildResult) {
+      return Error("Failed to rebuild tx index: " + rebuildResult.error().message);
+    }
+  }
+
   if (store_.getBlockCount() > 0) {
     auto result = readBlock(getNextBlockId() - 1);
     if (result.isOk()) {
@@ -387,6 +603,10 @@ Ledger::Roe<void> Ledger::addBlock(const Ledger::ChainNode& block) {
     return Error("Failed to save index after adding block");
   }
 
+  if (!appendTxIndex(block.block.txIndex)) {
+    return Error("Failed to save tx index after adding block");
+  }
+
   latestBlockCache_ = block;
   return {};
 }
@@ -497,6 +717,22 @@ Ledger::Roe<Ledger::ChainNode> Ledger::readBlock(uint64_t blockId) const {
   return node;
 }
 
+Ledger::Roe<Ledger::BlockLocation> Ledger::readRawBlock(uint64_t blockId) const {
+  uint64_t nextBlockId = getNextBlockId();
+  if (blockId < meta_.startingBlockId || blockId >= nextBlockId) {
+    return Error("Block ID " + std::to_string(blockId) + " out of range [" +
+                 std::to_string(meta_.startingBlockId) + ", " +
+                 std::to_string(nextBlockId) + ")");
+  }
+
+  auto locationResult = store_.getBlockLocation(blockId - meta_.startingBlockId);
+  if (!locationResult.isOk()) {
+    return Error("Failed to locate block " + std::to_string(blockId) + ": " +
+                 locationResult.error().message);
+  }
+  return locationResult.value();
+}
+
 std::string Ledger::ChainNode::ltsToString() const {
   RawBlock rawBlock;
   rawBlock.data = block.ltsToString();
@@ -646,6 +882,101 @@ Ledger::Roe<Ledger::ChainNode> Ledger::findBlockByTimestamp(int64_t timestamp) c
   return readBlock(low);
 }
 
+Ledger::Roe<uint64_t> Ledger::findBlockIdByTxIndex(uint64_t txIndex) const {
+  if (blockTxIndexes_.empty()) {
+    return Error("No blocks in ledger");
+  }
+  // Last block whose starting txIndex <= txIndex; empty blocks share the start of their successor
+  auto it = std::upper_bound(blockTxIndexes_.begin(), blockTxIndexes_.end(), txIndex);
+  if (it == blockTxIndexes_.begin()) {
+    return Error("Transaction index " + std::to_string(txIndex) +
+                 " precedes starting block " + std::to_string(meta_.startingBlockId));
+  }
+  uint64_t position = static_cast<uint64_t>(std::distance(blockTxIndexes_.begin(), it)) - 1;
+  return meta_.startingBlockId + position;
+}
+
+bool Ledger::loadTxIndex() {
+  blockTxIndexes_.clear();
+  std::ifstream file(txIndexFilePath_, std::ios::binary | std::ios::ate);
+  if (!file) {
+    log().warning << "Tx index file not found: " << txIndexFilePath_;
+    return false;
+  }
+
+  auto fileSize = static_cast<uint64_t>(file.tellg());
+  if (fileSize % sizeof(uint64_t) != 0 ||
+      fileSize / sizeof(uint64_t) != store_.getBlockCount()) {
+    log().warning << "Tx index size mismatch: " << fileSize << " bytes for "
+                  << store_.getBlockCount() << " blocks";
+    return false;
+  }
+
+  blockTxIndexes_.resize(fileSize / sizeof(uint64_t));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(blockTxIndexes_.data()),
+            static_cast<std::streamsize>(fileSize));
+  if (!file) {
+    log().error << "Failed to read tx index file: " << txIndexFilePath_;
+    blockTxIndexes_.clear();
+    return false;
+  }
+
+  log().info << "Loaded tx index: blocks=" << blockTxIndexes_.size();
+  return true;
+}
+
+bool Ledger::appendTxIndex(uint64_t txIndex) {
+  std::ofstream file(txIndexFilePath_, std::ios::binary | std::ios::app);
+  if (!file) {
+    log().error << "Failed to open tx index file for writing: " << txIndexFilePath_;
+    return false;
+  }
+  file.write(reinterpret_cast<const char *>(&txIndex), sizeof(txIndex));
+  if (!file.good()) {
+    log().error << "Failed to write tx index file";
+    return false;
+  }
+  blockTxIndexes_.push_back(txIndex);
+  return true;
+}
+
+Ledger::Roe<void> Ledger::rebuildTxIndex() {
+  log().info << "Rebuilding tx index from " << store_.getBlockCount() << " blocks";
+
+  std::vector<uint64_t> txIndexes;
+  txIndexes.reserve(store_.getBlockCount());
+  for (uint64_t blockId = meta_.startingBlockId; blockId < getNextBlockId(); ++blockId) {
+    auto result = readBlock(blockId);
+    if (!result) {
+      return Error("Failed to read block " + std::to_string(blockId) + ": " + result.error().message);
+    }
+    txIndexes.push_back(result.value().block.txIndex);
+  }
+
+  std::string tempPath = txIndexFilePath_ + ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return Error("Failed to open tx index file for writing: " + tempPath);
+    }
+    file.write(reinterpret_cast<const char *>(txIndexes.data()),
+               static_cast<std::streamsize>(txIndexes.size() * sizeof(uint64_t)));
+    if (!file.good()) {
+      return Error("Failed to write tx index file: " + tempPath);
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tempPath, txIndexFilePath_, ec);
+  if (ec) {
+    return Error("Failed to rename tx index file: " + ec.message());
+  }
+
+  blockTxIndexes_ = std::move(txIndexes);
+  return {};
+}
+
 Ledger::Roe<void> Ledger::cleanupData() {
   std::error_code ec;
   
@@ -665,6 +996,15 @@ Ledger::Roe<void> Ledger::cleanupData() {
     }
   }
 
+  // Remove tx index file
+  if (std::filesystem::exists(txIndexFilePath_, ec)) {
+    std::filesystem::remove(txIndexFilePath_, ec);
+    if (ec) {
+      return Error("Failed to remove tx index file: " + ec.message());
+    }
+  }
+  blockTxIndexes_.clear();
+
   log().info << "Cleaned up ledger data at " << workDir_;
   
   return {};
@@ -9,6 +9,7 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <ostream>
 #include <memory>
 #include <optional>
 #include <variant>
@@ -146,8 +147,14 @@ public:
    * Block data structure (without hash)
    */
   struct Block {
-    static constexpr uint16_t CURRENT_VERSION = 1;
+    /** Version 2 blocks are hashed through BlockHeader, which commits to the
+     * Merkle root and count of the records (see calculateMerkleRoot). New
+     * blocks are version 2, which nodes built before it reject: a hard fork. */
+    static constexpr uint16_t CURRENT_VERSION = 2;
+    static constexpr uint16_t VERSION_MERKLE = 2;
 
+    /** Serialization version, kept so older blocks re-serialize (and hash) as stored. */
+    uint16_t version{ CURRENT_VERSION };
     uint64_t index{ 0 };
     int64_t timestamp{ 0 };
     std::vector<Record> records;
@@ -163,11 +170,84 @@ public:
     }
 
     std::string ltsToString() const;
+    /** Write the ltsToString() bytes to `os` (e.g. a hash sink). */
+    void ltsToStream(std::ostream &os) const;
     bool ltsFromString(const std::string &str);
     pp::common::Meta ltsToMeta() const;
 
   };
 
+  /**
+   * Block fields with the records replaced by their Merkle root; the hash of
+   * a version 2 block is the hash of its header.
+   */
+  struct BlockHeader {
+    uint16_t version{ Block::CURRENT_VERSION };
+    uint64_t index{ 0 };
+    int64_t timestamp{ 0 };
+    std::string merkleRoot; // raw 32-byte root over records
+    // Fixes the tree shape, so a proof cannot place a record elsewhere
+    uint64_t recordCount{ 0 };
+    std::string previousHash;
+    uint64_t nonce{ 0 };
+    uint64_t slot{ 0 };
+    uint64_t slotLeader{ 0 };
+    uint64_t txIndex{ 0 };
+
+    template <typename Archive> void serialize(Archive &ar) {
+      ar & version & index & timestamp & merkleRoot & recordCount &
+          previousHash & nonce & slot & slotLeader & txIndex;
+    }
+
+    static BlockHeader fromBlock(const Block &block);
+    /** Hex SHA-256 of the serialized header. */
+    std::string calculateHash() const;
+    pp::common::Meta ltsToMeta() const;
+  };
+
+  /** Audit path of one record: sibling hashes from the leaf up. */
+  struct MerkleProof {
+    uint64_t leafIndex{ 0 };
+    uint64_t leafCount{ 0 };
+    std::vector<std::string> path; // raw 32-byte hashes
+
+    template <typename Archive> void serialize(Archive &ar) {
+      ar & leafIndex & leafCount & path;
+    }
+  };
+
+  /** Record with what is needed to check it belongs to block `header`. */
+  struct TxProof {
+    Record record;
+    BlockHeader header;
+    std::string blockHash;
+    MerkleProof proof;
+
+    template <typename Archive> void serialize(Archive &ar) {
+      ar & record & header & blockHash & proof;
+    }
+
+    /** Check the record hashes up to header.merkleRoot in a tree of
+     * header.recordCount leaves and the header to blockHash, at global
+     * position txIndex. Whether blockHash belongs to the chain is up to the
+     * caller. */
+    Roe<void> verify(uint64_t txIndex) const;
+    pp::common::Meta ltsToMeta() const;
+  };
+
+  /**
+   * Merkle tree over block records. Leaves are SHA-256(0x00 || record bytes),
+   * inner nodes SHA-256(0x01 || left || right); a node without a sibling is
+   * carried up unchanged. Hashes are raw 32 bytes; the root of no records is
+   * SHA-256 of the empty string.
+   */
+  static std::string calculateRecordHash(const Record &record);
+  static std::string calculateMerkleRoot(const std::vector<Record> &records);
+  static Roe<MerkleProof> buildMerkleProof(const std::vector<Record> &records,
+                                           uint64_t leafIndex);
+  static Roe<std::string> calculateMerkleRootFromProof(const std::string &leafHash,
+                                                       const MerkleProof &proof);
+
   /**
    * ChainNode data structure (Block + hash)
    * Simple struct for in-memory representation
@@ -200,6 +280,8 @@ public:
     uint64_t startingBlockId{ 0 };
   };
 
+  using BlockLocation = DirStore::BlockLocation;
+
   uint64_t getNextBlockId() const;
   /** First valid block ID (same as startingBlockId from init/mount). No blocks when getNextBlockId() <= getStartingBlockId(). */
   uint64_t getStartingBlockId() const;
@@ -209,9 +291,19 @@ public:
   Roe<void> addBlock(const ChainNode& block);
   Roe<void> updateCheckpoints(const std::vector<uint64_t>& blockIds);
   Roe<ChainNode> readBlock(uint64_t blockId) const;
+  /**
+   * Where block blockId is stored on disk. The bytes there are
+   * ChainNode::ltsToString() of the block, so they can be sent as is.
+   */
+  Roe<BlockLocation> readRawBlock(uint64_t blockId) const;
   Roe<ChainNode> readLastBlock() const;
   /** Smallest blockId such that block.timestamp >= timestamp (O(log n) block reads). */
   Roe<ChainNode> findBlockByTimestamp(int64_t timestamp) const;
+  /**
+   * Id of the block whose records may contain the given global txIndex (no block reads).
+   * The caller still has to check txIndex against the block's record count.
+   */
+  Roe<uint64_t> findBlockIdByTxIndex(uint64_t txIndex) const;
   uint64_t countSizeFromBlockId(uint64_t blockId) const;
 
 private:
@@ -262,14 +354,24 @@ private:
   std::string workDir_;
   std::string dataDir_;
   std::string indexFilePath_;
+  std::string txIndexFilePath_;
   Meta meta_;
   DirDirStore store_;
 
+  /**
+   * Starting txIndex of each stored block (position = blockId - startingBlockId).
+   * Persisted as raw uint64_t values in txIndexFilePath_, one per block, appended on addBlock.
+   */
+  std::vector<uint64_t> blockTxIndexes_;
+
   /** Cached latest block for fast readLastBlock/readBlock(lastId) access. */
   mutable std::optional<ChainNode> latestBlockCache_;
 
   bool loadIndex();
   bool saveIndex();
+  bool loadTxIndex();
+  bool appendTxIndex(uint64_t txIndex);
+  Roe<void> rebuildTxIndex();
   Roe<void> cleanupData();
 };
 
@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 
 using namespace pp;
 
@@ -431,6 +432,41 @@ TEST_F(LedgerTest, ReadBlockSuccessfully) {
   }
 }
 
+TEST_F(LedgerTest, ReadRawBlockLocatesSerializedBlock) {
+  ensureTestDirDoesNotExist();
+  Ledger ledger;
+  Ledger::InitConfig config;
+  config.workDir = testDir_.string();
+  config.startingBlockId = 0;
+
+  auto result = ledger.init(config);
+  ASSERT_TRUE(result.isOk());
+
+  std::vector<Ledger::ChainNode> testBlocks;
+  for (uint64_t i = 1; i <= 3; ++i) {
+    Ledger::ChainNode block = createTestBlock(i, "data_" + std::to_string(i));
+    testBlocks.push_back(block);
+    ASSERT_TRUE(ledger.addBlock(block).isOk());
+  }
+
+  // The located bytes are what ChainNode::ltsToString() produces
+  for (uint64_t i = 0; i < 3; ++i) {
+    auto locationResult = ledger.readRawBlock(i);
+    ASSERT_TRUE(locationResult.isOk()) << locationResult.error().message;
+    const auto &location = locationResult.value();
+
+    std::ifstream file(location.filePath, std::ios::binary);
+    ASSERT_TRUE(file.is_open());
+    std::string bytes(location.size, '\0');
+    file.seekg(static_cast<std::streamoff>(location.offset));
+    file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    ASSERT_TRUE(file.good());
+    EXPECT_EQ(bytes, testBlocks[i].ltsToString());
+  }
+
+  EXPECT_FALSE(ledger.readRawBlock(3).isOk());
+}
+
 TEST_F(LedgerTest, ReadBlockWithInvalidIdFails) {
   ensureTestDirDoesNotExist();
   Ledger ledger;
@@ -678,6 +714,179 @@ TEST_F(LedgerTest, StartingBlockIdPreservedWithNonZeroStartingBlockId) {
   }
 }
 
+TEST_F(LedgerTest, FindBlockIdByTxIndex) {
+  // Block i (starting at 10) holds txCounts[i] records; block 11 is empty
+  const std::vector<uint64_t> txCounts = {3, 0, 2, 4};
+  {
+    ensureTestDirDoesNotExist();
+    Ledger ledger;
+    Ledger::InitConfig config;
+    config.workDir = testDir_.string();
+    config.startingBlockId = 10;
+    ASSERT_TRUE(ledger.init(config).isOk());
+
+    EXPECT_TRUE(ledger.findBlockIdByTxIndex(0).isError());
+
+    uint64_t txIndex = 0;
+    for (size_t i = 0; i < txCounts.size(); ++i) {
+      Ledger::ChainNode block = createTestBlock(10 + i, "");
+      block.block.txIndex = txIndex;
+      block.block.records.resize(txCounts[i]);
+      ASSERT_TRUE(ledger.addBlock(block).isOk());
+      txIndex += txCounts[i];
+    }
+
+    auto expectBlock = [&](uint64_t txIndex, uint64_t blockId) {
+      auto result = ledger.findBlockIdByTxIndex(txIndex);
+      ASSERT_TRUE(result.isOk()) << result.error().message;
+      EXPECT_EQ(result.value(), blockId) << "txIndex=" << txIndex;
+    };
+    expectBlock(0, 10);
+    expectBlock(2, 10);
+    expectBlock(3, 12);
+    expectBlock(4, 12);
+    expectBlock(5, 13);
+    expectBlock(8, 13);
+  }
+
+  // Index survives reopen, and is rebuilt when the side file is missing
+  for (bool removeIndexFile : {false, true}) {
+    if (removeIndexFile) {
+      std::filesystem::remove(testDir_ / "ledger_txindex.dat");
+    }
+    Ledger ledger;
+    ASSERT_TRUE(ledger.mount(testDir_.string()).isOk());
+    auto result = ledger.findBlockIdByTxIndex(6);
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(result.value(), 13);
+  }
+}
+
+namespace {
+std::vector<Ledger::Record> makeRecords(size_t count) {
+  std::vector<Ledger::Record> records(count);
+  for (size_t i = 0; i < count; ++i) {
+    records[i].type = Ledger::T_DEFAULT;
+    records[i].data = "record-" + std::to_string(i);
+    records[i].signatures = {"sig-" + std::to_string(i)};
+  }
+  return records;
+}
+} // namespace
+
+TEST(LedgerMerkleTest, ProofsVerifyForEveryLeaf) {
+  for (size_t count : {1, 2, 3, 5, 8}) {
+    const auto records = makeRecords(count);
+    const std::string root = Ledger::calculateMerkleRoot(records);
+    ASSERT_EQ(root.size(), 32u);
+    for (size_t i = 0; i < count; ++i) {
+      auto proof = Ledger::buildMerkleProof(records, i);
+      ASSERT_TRUE(proof.isOk()) << proof.error().message;
+      auto rebuilt = Ledger::calculateMerkleRootFromProof(
+          Ledger::calculateRecordHash(records[i]), proof.value());
+      ASSERT_TRUE(rebuilt.isOk()) << rebuilt.error().message;
+      EXPECT_EQ(rebuilt.value(), root) << "count=" << count << " leaf=" << i;
+    }
+  }
+  EXPECT_TRUE(Ledger::buildMerkleProof(makeRecords(3), 3).isError());
+}
+
+TEST(LedgerMerkleTest, TxProofRejectsTampering) {
+  Ledger::Block block;
+  block.index = 7;
+  block.previousHash = "prev";
+  block.txIndex = 100;
+  block.records = makeRecords(5);
+
+  Ledger::TxProof txProof;
+  txProof.record = block.records[3];
+  txProof.header = Ledger::BlockHeader::fromBlock(block);
+  txProof.blockHash = txProof.header.calculateHash();
+  txProof.proof = Ledger::buildMerkleProof(block.records, 3).value();
+  ASSERT_TRUE(txProof.verify(103).isOk());
+
+  // Round-trips over the wire format
+  Ledger::TxProof unpacked;
+  {
+    std::ostringstream oss(std::ios::binary);
+    OutputArchive ar(oss);
+    ar & txProof;
+    std::istringstream iss(oss.str(), std::ios::binary);
+    InputArchive in(iss);
+    in & unpacked;
+    ASSERT_FALSE(in.failed());
+  }
+  EXPECT_TRUE(unpacked.verify(103).isOk());
+
+  EXPECT_TRUE(txProof.verify(102).isError());
+
+  auto badRecord = txProof;
+  badRecord.record.data = "forged";
+  EXPECT_TRUE(badRecord.verify(103).isError());
+
+  auto badPath = txProof;
+  badPath.proof.path[0][0] ^= 0x01;
+  EXPECT_TRUE(badPath.verify(103).isError());
+
+  auto shortPath = txProof;
+  shortPath.proof.path.pop_back();
+  EXPECT_TRUE(shortPath.verify(103).isError());
+
+  auto badHeader = txProof;
+  badHeader.header.nonce = 1;
+  EXPECT_TRUE(badHeader.verify(103).isError());
+
+  auto oldVersion = txProof;
+  oldVersion.header.version = 1;
+  EXPECT_TRUE(oldVersion.verify(103).isError());
+}
+
+TEST(LedgerMerkleTest, TxProofRejectsRepositionedRecord) {
+  Ledger::Block block;
+  block.index = 7;
+  block.txIndex = 100;
+  block.records = makeRecords(3);
+  const auto header = Ledger::BlockHeader::fromBlock(block);
+  EXPECT_EQ(header.recordCount, 3u);
+
+  // Record c carried up unhashed: as leaf 1 of 2 beside H(a,b) it reaches
+  // the real root
+  Ledger::TxProof txProof;
+  txProof.record = block.records[2];
+  txProof.header = header;
+  txProof.blockHash = header.calculateHash();
+  txProof.proof.leafIndex = 1;
+  txProof.proof.leafCount = 2;
+  txProof.proof.path = {Ledger::calculateMerkleRoot(
+      {block.records[0], block.records[1]})};
+  auto root = Ledger::calculateMerkleRootFromProof(
+      Ledger::calculateRecordHash(txProof.record), txProof.proof);
+  ASSERT_TRUE(root.isOk());
+  ASSERT_EQ(root.value(), header.merkleRoot);
+  EXPECT_TRUE(txProof.verify(101).isError());
+
+  // Claiming the matching record count breaks the block hash instead
+  txProof.header.recordCount = 2;
+  EXPECT_TRUE(txProof.verify(101).isError());
+}
+
+TEST(LedgerMerkleTest, BlockVersionSurvivesRoundTrip) {
+  Ledger::Block block;
+  block.version = 1;
+  block.index = 4;
+  block.records = makeRecords(2);
+  const std::string bytes = block.ltsToString();
+
+  Ledger::Block decoded;
+  ASSERT_TRUE(decoded.ltsFromString(bytes));
+  EXPECT_EQ(decoded.version, 1);
+  EXPECT_EQ(decoded.ltsToString(), bytes);
+
+  Ledger::Block current;
+  ASSERT_TRUE(current.ltsFromString(Ledger::Block().ltsToString()));
+  EXPECT_EQ(current.version, Ledger::Block::CURRENT_VERSION);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
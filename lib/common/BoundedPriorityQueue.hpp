@@ -0,0 +1,155 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace pp {
+
+/**
+ * BoundedPriorityQueue - A thread-safe queue with priority lanes
+ *
+ * Elements are pushed into a lane; lane 0 has the highest priority and is
+ * always drained first, FIFO within a lane. Each lane has its own capacity,
+ * so a flood in a low-priority lane never blocks admission to a higher one.
+ * All public methods are thread-safe.
+ *
+ * @tparam T The type of elements stored in the queue
+ */
+template <typename T>
+class BoundedPriorityQueue {
+public:
+  /**
+   * Constructor
+   * @param laneCapacities Maximum number of queued elements per lane
+   *                       (its size is the number of lanes)
+   */
+  explicit BoundedPriorityQueue(std::vector<size_t> laneCapacities)
+      : capacities_(std::move(laneCapacities)), lanes_(capacities_.size()) {}
+
+  // Delete copy operations for safety
+  BoundedPriorityQueue(const BoundedPriorityQueue&) = delete;
+  BoundedPriorityQueue& operator=(const BoundedPriorityQueue&) = delete;
+
+  size_t getLaneCount() const { return lanes_.size(); }
+
+  /**
+   * Change the capacity of a lane; elements already queued are kept
+   */
+  void setCapacity(size_t lane, size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacities_.at(lane) = capacity;
+  }
+
+  size_t getCapacity(size_t lane) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacities_.at(lane);
+  }
+
+  /**
+   * Get the total number of queued elements
+   */
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = 0;
+    for (const auto& lane : lanes_) {
+      n += lane.size();
+    }
+    return n;
+  }
+
+  /**
+   * Get the number of queued elements in one lane
+   */
+  size_t size(size_t lane) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lanes_.at(lane).size();
+  }
+
+  /**
+   * Push an element to the back of a lane unless the lane is full
+   * @param lane Lane index (0 = highest priority)
+   * @param value The value to push; left untouched when rejected
+   * @return true if queued, false if the lane is at capacity
+   */
+  bool tryPush(size_t lane, T&& value) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& queue = lanes_.at(lane);
+      if (queue.size() >= capacities_[lane]) {
+        return false;
+      }
+      queue.push_back(std::move(value));
+    }
+    cv_.notify_one();
+    return true;
+  }
+
+  /**
+   * Poll the front element of the highest-priority non-empty lane
+   * @param t Reference to store the popped element
+   * @param lane If not null, receives the lane the element came from
+   * @return true if an element was popped, false if all lanes are empty
+   */
+  bool poll(T& t, size_t* lane = nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+      if (!lanes_[i].empty()) {
+        t = std::move(lanes_[i].front());
+        lanes_[i].pop_front();
+        if (lane) {
+          *lane = i;
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Wait until any lane is not empty or interrupt() is called
+   * @param timeout Maximum time to wait
+   * @return true if the queue has an element or was interrupted, false on timeout
+   */
+  template <typename Rep, typename Period>
+  bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const bool isReady = cv_.wait_for(
+        lock, timeout, [this] { return isInterrupted_ || !isEmptyLocked(); });
+    isInterrupted_ = false;
+    return isReady;
+  }
+
+  /**
+   * Wake one pending or the next waitFor call even though nothing was
+   * pushed, e.g. for work that arrives outside the queue
+   */
+  void interrupt() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      isInterrupted_ = true;
+    }
+    cv_.notify_all();
+  }
+
+private:
+  bool isEmptyLocked() const {
+    for (const auto& lane : lanes_) {
+      if (!lane.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cv_;
+  std::vector<size_t> capacities_;
+  std::vector<std::deque<T>> lanes_;
+  mutable bool isInterrupted_{ false };
+};
+
+} // namespace pp
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+namespace pp {
+
+/**
+ * TokenBucket - Rate limiter allowing bursts
+ *
+ * Holds up to `burst` tokens and refills at `ratePerSecond`; each admitted
+ * action takes one token. A rate of 0 disables limiting. Not thread-safe.
+ */
+class TokenBucket {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TokenBucket() = default;
+  TokenBucket(double ratePerSecond, double burst, Clock::time_point now = Clock::now())
+      : rate_(ratePerSecond), burst_(burst), tokens_(burst), lastRefill_(now) {}
+
+  /**
+   * Take one token if available
+   * @return true if the action is admitted
+   */
+  bool tryTake(Clock::time_point now = Clock::now()) {
+    if (rate_ <= 0) {
+      return true;
+    }
+    refill(now);
+    if (tokens_ < 1) {
+      return false;
+    }
+    tokens_ -= 1;
+    return true;
+  }
+
+  /**
+   * Whether the bucket has refilled completely, i.e. has been idle long
+   * enough that dropping it loses nothing
+   */
+  bool isFull(Clock::time_point now = Clock::now()) {
+    refill(now);
+    return tokens_ >= burst_;
+  }
+
+private:
+  void refill(Clock::time_point now) {
+    if (now <= lastRefill_) {
+      return;
+    }
+    const double seconds = std::chrono::duration<double>(now - lastRefill_).count();
+    tokens_ = std::min(burst_, tokens_ + seconds * rate_);
+    lastRefill_ = now;
+  }
+
+  double rate_{ 0 };
+  double burst_{ 0 };
+  double tokens_{ 0 };
+  Clock::time_point lastRefill_{};
+};
+
+} // namespace pp
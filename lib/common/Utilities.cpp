@@ -23,6 +23,16 @@ namespace {
     }
   };
   static SodiumInitializer sodium_initializer;
+
+  std::string digestToHex(const unsigned char *digest, size_t size) {
+    static const char *const HEX_DIGITS = "0123456789abcdef";
+    std::string hex(size * 2, '0');
+    for (size_t i = 0; i < size; ++i) {
+      hex[2 * i] = HEX_DIGITS[digest[i] >> 4];
+      hex[2 * i + 1] = HEX_DIGITS[digest[i] & 0x0f];
+    }
+    return hex;
+  }
 }
 
 int64_t getCurrentTime() {
@@ -129,12 +139,77 @@ std::string sha256(const std::string &input) {
     throw std::runtime_error("crypto_hash_sha256 failed");
   }
 
-  std::stringstream ss;
-  for (unsigned int i = 0; i < crypto_hash_sha256_BYTES; i++) {
-    ss << std::hex << std::setw(2) << std::setfill('0')
-       << static_cast<int>(hash[i]);
+  return digestToHex(hash, crypto_hash_sha256_BYTES);
+}
+
+Sha256Sink::Sha256Sink() {
+  static_assert(sizeof(crypto_hash_sha256_state) <= STATE_BYTES,
+                "Sha256Sink::STATE_BYTES too small");
+  static_assert(alignof(crypto_hash_sha256_state) <= 16,
+                "Sha256Sink state alignment too small");
+  reset();
+}
+
+void Sha256Sink::reset() {
+  crypto_hash_sha256_init(
+      reinterpret_cast<crypto_hash_sha256_state *>(state_));
+  setp(buffer_, buffer_ + BUFFER_BYTES);
+}
+
+void Sha256Sink::flushBuffer() {
+  const auto size = static_cast<size_t>(pptr() - pbase());
+  if (size > 0) {
+    crypto_hash_sha256_update(
+        reinterpret_cast<crypto_hash_sha256_state *>(state_),
+        reinterpret_cast<const unsigned char *>(pbase()), size);
   }
-  return ss.str();
+  setp(buffer_, buffer_ + BUFFER_BYTES);
+}
+
+void Sha256Sink::update(const char *data, size_t size) {
+  flushBuffer();
+  crypto_hash_sha256_update(
+      reinterpret_cast<crypto_hash_sha256_state *>(state_),
+      reinterpret_cast<const unsigned char *>(data), size);
+}
+
+std::string Sha256Sink::finalHex() {
+  std::string digest = finalDigest();
+  return digestToHex(reinterpret_cast<const unsigned char *>(digest.data()),
+                     digest.size());
+}
+
+std::string Sha256Sink::finalDigest() {
+  flushBuffer();
+  unsigned char hash[crypto_hash_sha256_BYTES];
+  crypto_hash_sha256_final(
+      reinterpret_cast<crypto_hash_sha256_state *>(state_), hash);
+  reset();
+  return std::string(reinterpret_cast<const char *>(hash),
+                     crypto_hash_sha256_BYTES);
+}
+
+Sha256Sink::int_type Sha256Sink::overflow(int_type ch) {
+  flushBuffer();
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+std::streamsize Sha256Sink::xsputn(const char *s, std::streamsize n) {
+  // Large writes (record payloads) skip the buffer copy
+  if (n >= static_cast<std::streamsize>(BUFFER_BYTES)) {
+    update(s, static_cast<size_t>(n));
+    return n;
+  }
+  return std::streambuf::xsputn(s, n);
+}
+
+int Sha256Sink::sync() {
+  flushBuffer();
+  return 0;
 }
 
 std::string hexEncode(const std::string &data) {
@@ -2,8 +2,10 @@
 #define PP_LEDGER_UTILITIES_H
 
 #include <string>
+#include <cstddef>
 #include <cstdint>
 #include <sstream>
+#include <streambuf>
 #include <vector>
 #include "Meta.h"
 #include "ResultOrError.hpp"
@@ -122,6 +124,46 @@ pp::Roe<nlohmann::json> parseJsonRequest(const std::string &request);
  */
 std::string sha256(const std::string &input);
 
+/**
+ * Incremental SHA-256 using libsodium's crypto_hash_sha256_state.
+ * Also a std::streambuf, so a std::ostream over it (e.g. feeding an
+ * OutputArchive) hashes serialized data as it is written, without building
+ * the whole byte string first.
+ */
+class Sha256Sink : public std::streambuf {
+public:
+  Sha256Sink();
+  Sha256Sink(const Sha256Sink &) = delete;
+  Sha256Sink &operator=(const Sha256Sink &) = delete;
+
+  void update(const char *data, size_t size);
+  /**
+   * Finish the hash and restart the sink
+   * @return Hexadecimal digest, same format as sha256()
+   */
+  std::string finalHex();
+  /**
+   * Finish the hash and restart the sink
+   * @return Raw 32-byte digest
+   */
+  std::string finalDigest();
+
+protected:
+  int_type overflow(int_type ch) override;
+  std::streamsize xsputn(const char *s, std::streamsize n) override;
+  int sync() override;
+
+private:
+  constexpr static size_t STATE_BYTES = 128; // >= sizeof(crypto_hash_sha256_state)
+  constexpr static size_t BUFFER_BYTES = 4096;
+
+  void flushBuffer();
+  void reset();
+
+  alignas(16) unsigned char state_[STATE_BYTES];
+  char buffer_[BUFFER_BYTES];
+};
+
 /**
  * Encode binary data as hex string (e.g. for JSON-safe transport)
  * @param data Raw bytes
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pp {
+
+/**
+ * WorkerPool - Fixed set of threads for fork-join batches
+ *
+ * run() hands out task indices to the workers and the calling thread and
+ * returns once every task has finished, so short batches pay a wakeup instead
+ * of a thread creation. One batch runs at a time; concurrent run() calls are
+ * serialized.
+ */
+class WorkerPool {
+public:
+  /**
+   * Constructor
+   * @param threads Worker threads in addition to the thread calling run()
+   */
+  explicit WorkerPool(size_t threads) {
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+      workers_.emplace_back([this] { workerLoop(); });
+    }
+  }
+
+  /**
+   * Destructor - stops and joins the workers
+   */
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      isStopping_ = true;
+    }
+    wakeCv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  /**
+   * Number of worker threads
+   */
+  size_t size() const { return workers_.size(); }
+
+  /**
+   * Run fn(0) .. fn(count - 1) across the workers and the calling thread
+   * @param count Number of tasks
+   * @param fn Task body; must not call run() on the same pool
+   */
+  void run(size_t count, const std::function<void(size_t)> &fn) {
+    if (count == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> runLock(runMutex_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fn_ = &fn;
+      taskCount_ = count;
+      nextTask_ = 0;
+      pendingTasks_ = count;
+      ++generation_;
+    }
+    wakeCv_.notify_all();
+    runTasks();
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [this] { return pendingTasks_ == 0; });
+    fn_ = nullptr;
+  }
+
+private:
+  void runTasks() {
+    for (;;) {
+      const std::function<void(size_t)> *fn = nullptr;
+      size_t task = 0;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fn_ == nullptr || nextTask_ >= taskCount_) {
+          return;
+        }
+        fn = fn_;
+        task = nextTask_++;
+      }
+      (*fn)(task);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pendingTasks_ == 0) {
+          doneCv_.notify_all();
+        }
+      }
+    }
+  }
+
+  void workerLoop() {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wakeCv_.wait(lock, [&] {
+          return isStopping_ || generation_ != seenGeneration;
+        });
+        if (isStopping_) {
+          return;
+        }
+        seenGeneration = generation_;
+      }
+      runTasks();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex runMutex_;
+  std::mutex mutex_;
+  std::condition_variable wakeCv_;
+  std::condition_variable doneCv_;
+  const std::function<void(size_t)> *fn_{nullptr};
+  size_t taskCount_{0};
+  size_t nextTask_{0};
+  size_t pendingTasks_{0};
+  uint64_t generation_{0};
+  bool isStopping_{false};
+};
+
+} // namespace pp
@@ -0,0 +1,105 @@
+#include "BoundedPriorityQueue.hpp"
+#include "TokenBucket.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(BoundedPriorityQueueTest, HigherLanesDrainFirst) {
+    pp::BoundedPriorityQueue<int> queue({10, 10, 10});
+    int value = 0;
+    EXPECT_TRUE(queue.tryPush(2, 20));
+    EXPECT_TRUE(queue.tryPush(1, 10));
+    EXPECT_TRUE(queue.tryPush(2, 21));
+    EXPECT_TRUE(queue.tryPush(0, 0));
+    EXPECT_EQ(queue.size(), 4u);
+    EXPECT_EQ(queue.size(2), 2u);
+
+    size_t lane = 99;
+    EXPECT_TRUE(queue.poll(value, &lane));
+    EXPECT_EQ(value, 0);
+    EXPECT_EQ(lane, 0u);
+    EXPECT_TRUE(queue.poll(value, &lane));
+    EXPECT_EQ(value, 10);
+    EXPECT_EQ(lane, 1u);
+    EXPECT_TRUE(queue.poll(value));
+    EXPECT_EQ(value, 20);
+    EXPECT_TRUE(queue.poll(value));
+    EXPECT_EQ(value, 21);
+    EXPECT_FALSE(queue.poll(value));
+}
+
+TEST(BoundedPriorityQueueTest, FullLaneRejectsWithoutBlockingOthers) {
+    pp::BoundedPriorityQueue<std::string> queue({1, 2});
+    std::string value = "a";
+    EXPECT_TRUE(queue.tryPush(1, std::move(value)));
+    value = "b";
+    EXPECT_TRUE(queue.tryPush(1, std::move(value)));
+    value = "c";
+    EXPECT_FALSE(queue.tryPush(1, std::move(value)));
+    EXPECT_EQ(value, "c");  // Rejected values are not moved from
+    EXPECT_TRUE(queue.tryPush(0, std::move(value)));
+
+    queue.setCapacity(1, 3);
+    value = "d";
+    EXPECT_TRUE(queue.tryPush(1, std::move(value)));
+    EXPECT_EQ(queue.size(1), 3u);
+}
+
+TEST(BoundedPriorityQueueTest, WaitForWakesOnPush) {
+    pp::BoundedPriorityQueue<int> queue({1, 1});
+    EXPECT_FALSE(queue.waitFor(10ms));
+    std::thread producer([&queue] {
+        std::this_thread::sleep_for(10ms);
+        queue.tryPush(1, 5);
+    });
+    EXPECT_TRUE(queue.waitFor(10s));
+    producer.join();
+    EXPECT_EQ(queue.size(), 1u);
+}
+
+TEST(BoundedPriorityQueueTest, InterruptWakesWaitOnce) {
+    pp::BoundedPriorityQueue<int> queue({1});
+    std::thread waker([&queue] {
+        std::this_thread::sleep_for(10ms);
+        queue.interrupt();
+    });
+    EXPECT_TRUE(queue.waitFor(10s));
+    waker.join();
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_FALSE(queue.waitFor(10ms));
+
+    queue.interrupt();  // Before anyone waits: the next wait returns at once
+    EXPECT_TRUE(queue.waitFor(10s));
+}
+
+TEST(TokenBucketTest, AllowsBurstThenRefillsAtRate) {
+    auto start = pp::TokenBucket::Clock::now();
+    pp::TokenBucket bucket(10, 3, start);
+    EXPECT_TRUE(bucket.tryTake(start));
+    EXPECT_TRUE(bucket.tryTake(start));
+    EXPECT_TRUE(bucket.tryTake(start));
+    EXPECT_FALSE(bucket.tryTake(start));
+    EXPECT_FALSE(bucket.isFull(start));
+
+    // 10 tokens per second: one token after 100 ms
+    EXPECT_FALSE(bucket.tryTake(start + 50ms));
+    EXPECT_TRUE(bucket.tryTake(start + 100ms));
+    EXPECT_FALSE(bucket.tryTake(start + 100ms));
+
+    // Never more than the burst
+    EXPECT_TRUE(bucket.isFull(start + 10s));
+    EXPECT_TRUE(bucket.tryTake(start + 10s));
+    EXPECT_TRUE(bucket.tryTake(start + 10s));
+    EXPECT_TRUE(bucket.tryTake(start + 10s));
+    EXPECT_FALSE(bucket.tryTake(start + 10s));
+}
+
+TEST(TokenBucketTest, ZeroRateIsUnlimited) {
+    pp::TokenBucket bucket(0, 0);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(bucket.tryTake());
+    }
+}
@@ -1,6 +1,9 @@
 #include "Utilities.h"
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <ostream>
+
 namespace pp {
 namespace utl {
 
@@ -23,6 +26,29 @@ TEST(Sha256Test, DifferentInputsProduceDifferentHashes) {
   EXPECT_NE(hash1, hash2);
 }
 
+TEST(Sha256Test, SinkMatchesOneShotHashAcrossChunkSizes) {
+  std::string input;
+  for (int i = 0; i < 10000; ++i) {
+    input.push_back(static_cast<char>(i * 31));
+  }
+  for (size_t chunk : {size_t(1), size_t(7), size_t(4096), size_t(5000)}) {
+    Sha256Sink sink;
+    std::ostream os(&sink);
+    for (size_t pos = 0; pos < input.size(); pos += chunk) {
+      os.write(input.data() + pos,
+               static_cast<std::streamsize>(std::min(chunk, input.size() - pos)));
+    }
+    EXPECT_EQ(sink.finalHex(), sha256(input)) << "chunk " << chunk;
+  }
+
+  // finalHex() restarts the sink
+  Sha256Sink sink;
+  sink.update("hello ", 6);
+  sink.update("world", 5);
+  EXPECT_EQ(sink.finalHex(), sha256("hello world"));
+  EXPECT_EQ(sink.finalHex(), sha256(""));
+}
+
 TEST(Sha256Test, SameInputProducesSameHash) {
   std::string input = "consistent input";
   std::string hash1 = sha256(input);
@@ -0,0 +1,44 @@
+#include "WorkerPool.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(WorkerPoolTest, RunsEveryTaskOnce) {
+    pp::WorkerPool pool(3);
+    EXPECT_EQ(pool.size(), 3u);
+
+    std::vector<std::atomic<int>> hits(100);
+    pool.run(hits.size(), [&hits](size_t i) { hits[i].fetch_add(1); });
+    for (const auto &hit : hits) {
+        EXPECT_EQ(hit.load(), 1);
+    }
+}
+
+TEST(WorkerPoolTest, ReusesThreadsAcrossBatches) {
+    pp::WorkerPool pool(2);
+    std::mutex mutex;
+    std::set<std::thread::id> threadIds;
+    std::atomic<size_t> total{0};
+    for (int batch = 0; batch < 200; ++batch) {
+        pool.run(4, [&](size_t) {
+            total.fetch_add(1);
+            std::lock_guard<std::mutex> lock(mutex);
+            threadIds.insert(std::this_thread::get_id());
+        });
+    }
+    EXPECT_EQ(total.load(), 800u);
+    // Workers plus the calling thread, never new ones per batch
+    EXPECT_LE(threadIds.size(), 3u);
+}
+
+TEST(WorkerPoolTest, RunsOnCallerWithoutWorkers) {
+    pp::WorkerPool pool(0);
+    std::vector<std::thread::id> threadIds(3);
+    pool.run(threadIds.size(), [&](size_t i) { threadIds[i] = std::this_thread::get_id(); });
+    for (const auto &id : threadIds) {
+        EXPECT_EQ(id, std::this_thread::get_id());
+    }
+    pool.run(0, [](size_t) { FAIL(); });
+}
@@ -1,16 +1,21 @@
 #include "BulkWriter.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
 #include <cstring>
 #include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <thread>
 #include <unordered_set>
 #include <unistd.h>
 
 #if defined(__linux__)
+#include <csignal>
+#include <pthread.h>
 #include <sys/epoll.h>
+#include <sys/sendfile.h>
 #else
 #include <poll.h>
 #endif
@@ -36,6 +41,43 @@ int calculateTimeout(int timeoutMs, int defaultTimeout) {
   return (timeoutMs >= 0) ? timeoutMs : defaultTimeout;
 }
 
+// In-memory segments gathered into one send call
+constexpr size_t MAX_IOVECS = 64;
+
+// Send up to count bytes of fileFd from offset to the socket; returns bytes
+// sent, or -1 with errno set
+ssize_t sendFileRange(int fd, int fileFd, uint64_t offset, uint64_t count) {
+#if defined(__linux__)
+  // sendfile has no MSG_NOSIGNAL: hold SIGPIPE back for this thread and
+  // swallow it if the peer has gone
+  sigset_t pipeSet;
+  sigset_t oldSet;
+  sigemptyset(&pipeSet);
+  sigaddset(&pipeSet, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+
+  off_t fileOffset = static_cast<off_t>(offset);
+  ssize_t sent = ::sendfile(fd, fileFd, &fileOffset, count);
+  int sendErrno = errno;
+  if (sent < 0 && sendErrno == EPIPE && !sigismember(&oldSet, SIGPIPE)) {
+    struct timespec noWait = {};
+    sigtimedwait(&pipeSet, nullptr, &noWait);
+  }
+  pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+  errno = sendErrno;
+  return sent;
+#else
+  // SIGPIPE is suppressed per socket (SO_NOSIGPIPE); copy through a buffer
+  char buffer[64 * 1024];
+  size_t chunk = static_cast<size_t>(std::min<uint64_t>(count, sizeof(buffer)));
+  ssize_t n = ::pread(fileFd, buffer, chunk, static_cast<off_t>(offset));
+  if (n <= 0) {
+    return n;
+  }
+  return ::send(fd, buffer, static_cast<size_t>(n), 0);
+#endif
+}
+
 } // namespace
 
 BulkWriter::~BulkWriter() {
@@ -48,7 +90,77 @@ BulkWriter::~BulkWriter() {
 #endif
 }
 
-BulkWriter::Roe<void> BulkWriter::add(int fd, const void *data, size_t size) {
+BulkWriter::Segment BulkWriter::Segment::bytes(std::string data) {
+  Segment segment;
+  segment.bytes_ = std::move(data);
+  return segment;
+}
+
+BulkWriter::Segment
+BulkWriter::Segment::shared(std::shared_ptr<const std::string> data) {
+  Segment segment;
+  segment.shared_ = std::move(data);
+  return segment;
+}
+
+BulkWriter::Segment BulkWriter::Segment::file(int fileFd, uint64_t offset,
+                                              uint64_t size) {
+  Segment segment;
+  segment.fileFd_ = fileFd;
+  segment.fileOffset_ = offset;
+  segment.fileSize_ = size;
+  return segment;
+}
+
+BulkWriter::Segment::Segment(Segment &&other) noexcept
+    : bytes_(std::move(other.bytes_)), shared_(std::move(other.shared_)),
+      fileFd_(other.fileFd_), fileOffset_(other.fileOffset_),
+      fileSize_(other.fileSize_) {
+  other.fileFd_ = -1;
+}
+
+BulkWriter::Segment &BulkWriter::Segment::operator=(Segment &&other) noexcept {
+  if (this != &other) {
+    if (fileFd_ >= 0) {
+      ::close(fileFd_);
+    }
+    bytes_ = std::move(other.bytes_);
+    shared_ = std::move(other.shared_);
+    fileFd_ = other.fileFd_;
+    fileOffset_ = other.fileOffset_;
+    fileSize_ = other.fileSize_;
+    other.fileFd_ = -1;
+  }
+  return *this;
+}
+
+BulkWriter::Segment::~Segment() {
+  if (fileFd_ >= 0) {
+    ::close(fileFd_);
+  }
+}
+
+uint64_t BulkWriter::Segment::size() const {
+  if (isFile()) {
+    return fileSize_;
+  }
+  return shared_ ? shared_->size() : bytes_.size();
+}
+
+const char *BulkWriter::Segment::data() const {
+  return shared_ ? shared_->data() : bytes_.data();
+}
+
+uint64_t BulkWriter::WriteJob::getRemaining() const {
+  uint64_t remaining = 0;
+  for (const auto &segment : segments) {
+    remaining += segment.size();
+  }
+  return remaining - offset;
+}
+
+BulkWriter::Roe<void> BulkWriter::queue(int fd, std::vector<Segment> segments,
+                                        bool isKeepOpen) {
   if (fd < 0) {
     return Error("Invalid fd");
   }
@@ -56,18 +168,44 @@ BulkWriter::Roe<void> BulkWriter::add(int fd, const void *data, size_t size) {
     return Error("Set non-blocking failed: " + std::string(std::strerror(errno)));
   }
 
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (isKeepOpen) {
+    // Already registered: extend the pending write and its deadline
+    auto it = std::find_if(jobs_.begin(), jobs_.end(),
+                           [fd](const WriteJob &job) { return job.fd == fd; });
+    if (it != jobs_.end()) {
+      for (auto &segment : segments) {
+        it->segments.push_back(std::move(segment));
+      }
+      int timeoutMs = calculateJobTimeout(it->getRemaining());
+      it->expireTime = std::chrono::steady_clock::now() +
+                       std::chrono::milliseconds(timeoutMs);
+      return {};
+    }
+  }
+
   WriteJob job;
   job.fd = fd;
-  job.buffer.assign(static_cast<const uint8_t *>(data),
-                   static_cast<const uint8_t *>(data) + size);
+  for (auto &segment : segments) {
+    job.segments.push_back(std::move(segment));
+  }
   job.offset = 0;
+  job.isKeepOpen = isKeepOpen;
+
+  // Most payloads fit the socket buffer: write now rather than on the loop's
+  // next pass, and queue only what remains
+  WriteResult result = attemptWrite(job);
+  if (result != WriteResult::Retry) {
+    std::vector<WriteJob> unused;
+    handleWriteResult(job, result, unused);
+    return {};
+  }
   
-  int timeoutMs = calculateJobTimeout(size);
+  int timeoutMs = calculateJobTimeout(job.getRemaining());
   job.expireTime = std::chrono::steady_clock::now() + 
                    std::chrono::milliseconds(timeoutMs);
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  
   jobs_.push_back(std::move(job));
 
 #if defined(__linux__)
@@ -89,8 +227,35 @@ BulkWriter::Roe<void> BulkWriter::add(int fd, const void *data, size_t size) {
   return {};
 }
 
-BulkWriter::Roe<void> BulkWriter::add(int fd, const std::string &data) {
-  return add(fd, data.data(), data.size());
+BulkWriter::Roe<void> BulkWriter::add(int fd, std::string data) {
+  std::vector<Segment> segments;
+  segments.push_back(Segment::bytes(std::move(data)));
+  return queue(fd, std::move(segments), false);
+}
+
+BulkWriter::Roe<void> BulkWriter::add(int fd, std::vector<Segment> segments) {
+  return queue(fd, std::move(segments), false);
+}
+
+BulkWriter::Roe<void> BulkWriter::append(int fd, std::string data) {
+  std::vector<Segment> segments;
+  segments.push_back(Segment::bytes(std::move(data)));
+  return queue(fd, std::move(segments), true);
+}
+
+BulkWriter::Roe<void> BulkWriter::append(int fd, std::vector<Segment> segments) {
+  return queue(fd, std::move(segments), true);
+}
+
+void BulkWriter::remove(int fd) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(jobs_.begin(), jobs_.end(),
+                         [fd](const WriteJob &job) { return job.fd == fd; });
+  if (it == jobs_.end()) {
+    return;
+  }
+  unregisterFd(fd);
+  jobs_.erase(it);
 }
 
 void BulkWriter::clear() {
@@ -108,93 +273,77 @@ void BulkWriter::clear() {
 void BulkWriter::runLoop() {
   const int pollMs = 100;
   while (!isStopSet()) {
-    bool isEmpty;
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      isEmpty = jobs_.empty();
-      if (!isEmpty) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (jobs_.empty()) {
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      continue;
+    }
+    // Wait without the lock so queue(), append() and remove() are not held
+    // up by a slow transfer; jobs changed meanwhile are sorted out in
+    // processJobs(), where a stale ready fd just retries its write
 #if defined(__linux__)
-        runEpoll(pollMs);
+    const int epollFd = epollFd_;
+    const size_t maxEvents = jobs_.size();
+    lock.unlock();
+    std::unordered_set<int> ready = waitEpoll(epollFd, maxEvents, pollMs);
 #else
-        runPoll(pollMs);
-#endif
-      }
-    }
-    if (isEmpty) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::vector<int> fds;
+    fds.reserve(jobs_.size());
+    for (const auto &job : jobs_) {
+      fds.push_back(job.fd);
     }
+    lock.unlock();
+    std::unordered_set<int> ready = waitPoll(fds, pollMs);
+#endif
+    lock.lock();
+    // Also run on timeouts, to expire jobs past their deadline
+    processJobs(ready);
   }
 }
 
 #if defined(__linux__)
-size_t BulkWriter::runEpoll(int timeoutMs) {
+std::unordered_set<int> BulkWriter::waitEpoll(int epollFd, size_t maxEvents,
+                                              int timeoutMs) {
   const int defaultTimeout = 1000;
+  int wait = calculateTimeout(timeoutMs, defaultTimeout);
 
-  while (!jobs_.empty()) {
-    int wait = calculateTimeout(timeoutMs, defaultTimeout);
-
-    size_t maxEvents = jobs_.size();
-    std::vector<struct epoll_event> events(maxEvents);
-    int n = epoll_wait(epollFd_, events.data(), static_cast<int>(maxEvents), wait);
-    
-    if (n < 0) {
-      if (errno == EINTR) continue;
-      break;
-    }
-    if (n == 0) {
-      // epoll timed out - still process jobs to check for expired timeouts
-      processJobs({});
-      break;
-    }
-
-    std::unordered_set<int> ready;
-    for (int i = 0; i < n; ++i) {
-      ready.insert(events[i].data.fd);
-    }
-
-    processJobs(ready);
-    break;
+  std::unordered_set<int> ready;
+  std::vector<struct epoll_event> events(std::max<size_t>(maxEvents, 1));
+  int n = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), wait);
+  for (int i = 0; i < n; ++i) {
+    ready.insert(events[i].data.fd);
   }
-
-  return jobs_.size();
+  return ready;
 }
 #endif
 
 #if !defined(__linux__)
-size_t BulkWriter::runPoll(int timeoutMs) {
+std::unordered_set<int> BulkWriter::waitPoll(const std::vector<int> &fds,
+                                             int timeoutMs) {
   const int defaultTimeout = 1000;
-  if (jobs_.empty()) return 0;
-
   int wait = calculateTimeout(timeoutMs, defaultTimeout);
 
   std::vector<struct pollfd> pfds;
-  pfds.reserve(jobs_.size());
-  for (const auto &job : jobs_) {
+  pfds.reserve(fds.size());
+  for (int fd : fds) {
     struct pollfd pfd = {};
-    pfd.fd = job.fd;
+    pfd.fd = fd;
     pfd.events = POLLOUT;
     pfds.push_back(pfd);
   }
 
+  std::unordered_set<int> ready;
   int r = poll(pfds.data(), static_cast<nfds_t>(pfds.size()), wait);
-  if (r < 0) {
-    if (errno == EINTR) return jobs_.size();
-    return jobs_.size();
-  }
-  if (r == 0) {
-    // poll timed out - still process jobs to check for expired timeouts
-    processJobs({});
-    return jobs_.size();
+  if (r <= 0) {
+    return ready;
   }
-
-  std::unordered_set<int> ready;
-  for (size_t i = 0; i < pfds.size(); ++i) {
-    if (pfds[i].revents & (POLLOUT | POLLERR | POLLHUP)) {
-      ready.insert(pfds[i].fd);
+  for (const auto &pfd : pfds) {
+    if (pfd.revents & (POLLOUT | POLLERR | POLLHUP)) {
+      ready.insert(pfd.fd);
     }
   }
-  processJobs(ready);
-  return jobs_.size();
+  return ready;
 }
 #endif
 
@@ -219,7 +368,7 @@ void BulkWriter::processJobs(const std::unordered_set<int> &ready) {
       if (config_.errorCallback) {
         config_.errorCallback(job.fd, Error("Send timeout exceeded"));
       }
-      ::close(job.fd);
+      releaseFd(job);
       continue;
     }
 
@@ -236,23 +385,77 @@ void BulkWriter::processJobs(const std::unordered_set<int> &ready) {
 }
 
 BulkWriter::WriteResult BulkWriter::attemptWrite(WriteJob &job) {
-  size_t remaining = job.buffer.size() - job.offset;
-  const void *ptr = job.buffer.data() + job.offset;
+  while (!job.segments.empty()) {
+    ssize_t sent = 0;
+    const Segment &front = job.segments.front();
+    if (front.isFile()) {
+      uint64_t remaining = front.fileSize_ - job.offset;
+      if (remaining > 0) {
+        sent = sendFileRange(job.fd, front.fileFd_, front.fileOffset_ + job.offset,
+                             remaining);
+        if (sent == 0) {
+          // The file ended early (truncated since the write was queued)
+          errno = EIO;
+          return WriteResult::Error;
+        }
+      }
+    } else {
+      // Gather the in-memory segments up to the next file segment
+      struct iovec iov[MAX_IOVECS];
+      size_t count = 0;
+      uint64_t skip = job.offset;
+      for (const auto &segment : job.segments) {
+        if (segment.isFile() || count == MAX_IOVECS) {
+          break;
+        }
+        if (segment.size() > skip) {
+          iov[count].iov_base = const_cast<char *>(segment.data() + skip);
+          iov[count].iov_len = segment.size() - skip;
+          ++count;
+        }
+        skip = 0;
+      }
+      if (count > 0) {
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
 #if defined(__linux__)
-  ssize_t sent = ::send(job.fd, ptr, remaining, MSG_NOSIGNAL);
+        sent = ::sendmsg(job.fd, &msg, MSG_NOSIGNAL);
 #else
-  ssize_t sent = ::send(job.fd, ptr, remaining, 0);
+        sent = ::sendmsg(job.fd, &msg, 0);
 #endif
+      }
+    }
 
-  if (sent < 0) {
-    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+    if (sent < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return WriteResult::Retry;
+      }
+      return WriteResult::Error;
+    }
+
+    // Drop what was sent; a short write means the socket buffer is full
+    uint64_t left = static_cast<uint64_t>(sent);
+    bool isShort = false;
+    while (!job.segments.empty()) {
+      uint64_t remaining = job.segments.front().size() - job.offset;
+      if (left < remaining) {
+        job.offset += left;
+        isShort = true;
+        break;
+      }
+      left -= remaining;
+      job.segments.pop_front();
+      job.offset = 0;
+      if (left == 0) {
+        break;
+      }
+    }
+    if (isShort) {
       return WriteResult::Retry;
     }
-    return WriteResult::Error;
   }
-
-  job.offset += static_cast<size_t>(sent);
-  return (job.offset >= job.buffer.size()) ? WriteResult::Complete : WriteResult::Retry;
+  return WriteResult::Complete;
 }
 
 void BulkWriter::handleWriteResult(WriteJob &job, WriteResult result, 
@@ -260,7 +463,9 @@ void BulkWriter::handleWriteResult(WriteJob &job, WriteResult result,
   switch (result) {
     case WriteResult::Complete:
       unregisterFd(job.fd);
-      ::close(job.fd);
+      if (!job.isKeepOpen) {
+        ::close(job.fd);
+      }
       break;
     case WriteResult::Retry:
       next.push_back(std::move(job));
@@ -270,12 +475,20 @@ void BulkWriter::handleWriteResult(WriteJob &job, WriteResult result,
       if (config_.errorCallback) {
         config_.errorCallback(job.fd, Error("Send failed: " + std::string(std::strerror(errno))));
       }
-      ::close(job.fd);
+      releaseFd(job);
       break;
   }
 }
 
-int BulkWriter::calculateJobTimeout(size_t bufferSize) const {
+void BulkWriter::releaseFd(const WriteJob &job) {
+  if (job.isKeepOpen) {
+    ::shutdown(job.fd, SHUT_RDWR);
+  } else {
+    ::close(job.fd);
+  }
+}
+
+int BulkWriter::calculateJobTimeout(uint64_t bufferSize) const {
   // Convert buffer size to MB (using floating point for precision)
   double sizeMb = static_cast<double>(bufferSize) / (1024.0 * 1024.0);
   int timeoutMs = config_.timeout.msBase + 
@@ -5,8 +5,12 @@
 
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
@@ -16,6 +20,7 @@ namespace network {
 /**
  * BulkWriter manages many socket fds in non-blocking mode.
  * Each fd has one fixed payload; after the full payload is written, the fd is closed.
+ * Persistent connections instead queue payloads with append() and stay open.
  * Inherits Service: when started, runs the write loop in a dedicated thread.
  */
 class BulkWriter : public Service {
@@ -46,10 +51,55 @@ public:
   // BulkWriter in that case; caller may close it.
   void setConfig(const Config &config) { config_ = config; }
 
-  // Add a socket fd and the single payload to write. Takes ownership of a copy
-  // of the data. The fd is set to non-blocking. Caller must not close the fd
-  // until the write is done (BulkWriter closes it when write completes).
-  Roe<void> add(int fd, const std::string &data);
+  /**
+   * One piece of a payload: owned bytes, bytes shared with other writes
+   * (never modified), or a range of a file. A payload's segments go out with
+   * one writev-style call where the socket takes them.
+   */
+  class Segment {
+  public:
+    // Takes the string; pass with std::move to avoid a copy
+    static Segment bytes(std::string data);
+    static Segment shared(std::shared_ptr<const std::string> data);
+    // Sent with sendfile where available, so it is never copied into the
+    // process. Takes ownership of fileFd (closed once sent or dropped).
+    static Segment file(int fileFd, uint64_t offset, uint64_t size);
+
+    Segment() = default;
+    Segment(Segment &&other) noexcept;
+    Segment &operator=(Segment &&other) noexcept;
+    ~Segment();
+
+    bool isFile() const { return fileFd_ >= 0; }
+    uint64_t size() const;
+    // In-memory bytes (not for file segments)
+    const char *data() const;
+
+  private:
+    friend class BulkWriter;
+
+    std::string bytes_;
+    std::shared_ptr<const std::string> shared_;
+    int fileFd_{-1};
+    uint64_t fileOffset_{0};
+    uint64_t fileSize_{0};
+  };
+
+  // Add a socket fd and the single payload to write. Takes the data (move it
+  // in to avoid a copy). The fd is set to non-blocking. Caller must not close
+  // the fd until the write is done (BulkWriter closes it when write completes).
+  Roe<void> add(int fd, std::string data);
+  Roe<void> add(int fd, std::vector<Segment> segments);
+
+  // Queue data on a persistent connection: appended to any pending write for
+  // the fd, and the fd stays open once written. On a send error or timeout
+  // the fd is shut down (not closed) so its reader notices and closes it.
+  Roe<void> append(int fd, std::string data);
+  Roe<void> append(int fd, std::vector<Segment> segments);
+
+  // Drop pending writes for the fd without closing it (call before closing a
+  // persistent connection).
+  void remove(int fd);
 
 protected:
   void runLoop() override;
@@ -57,9 +107,16 @@ protected:
 private:
   struct WriteJob {
     int fd{-1};
-    std::vector<uint8_t> buffer;
-    size_t offset{0};
+    std::deque<Segment> segments;
+    uint64_t offset{0}; // sent bytes of segments.front()
+    bool isKeepOpen{false};
     std::chrono::steady_clock::time_point expireTime;
+
+    WriteJob() = default;
+    WriteJob(WriteJob &&) noexcept = default;
+    WriteJob &operator=(WriteJob &&) noexcept = default;
+
+    uint64_t getRemaining() const;
   };
 
   enum class WriteResult {
@@ -68,7 +125,11 @@ private:
     Error      // Write error occurred
   };
 
-  Roe<void> add(int fd, const void *data, size_t size);
+  Roe<void> queue(int fd, std::vector<Segment> segments, bool isKeepOpen);
+
+  // Finish a job whose fd is no longer written: close it, or shut it down if
+  // the connection is persistent.
+  void releaseFd(const WriteJob &job);
 
   // Remove all pending jobs without writing; does not close fds.
   void clear();
@@ -80,17 +141,21 @@ private:
   void handleWriteResult(WriteJob &job, WriteResult result, 
                          std::vector<WriteJob> &next);
 
-  // Process jobs (mutex must be held by caller). Linux: epoll; macOS: poll.
+  // Wait for writable fds without holding mutex_. Linux: epoll; macOS: poll.
+  // Returns the ready fds, empty on timeout or interruption.
 #if defined(__linux__)
-  size_t runEpoll(int timeoutMs);
+  static std::unordered_set<int> waitEpoll(int epollFd, size_t maxEvents,
+                                           int timeoutMs);
 #else
-  size_t runPoll(int timeoutMs);
+  static std::unordered_set<int> waitPoll(const std::vector<int> &fds,
+                                          int timeoutMs);
 #endif
+  // Write ready jobs and expire timed out ones (mutex must be held by caller)
   void processJobs(const std::unordered_set<int> &ready);
   void unregisterFd(int fd);
 
   // Calculate timeout for a job based on its size
-  int calculateJobTimeout(size_t bufferSize) const;
+  int calculateJobTimeout(uint64_t bufferSize) const;
 
   // Check if a job has timed out
   bool isJobTimedOut(const WriteJob &job) const;
@@ -1,22 +1,116 @@
 #include "FetchClient.h"
-#include <thread>
+#include "FetchProtocol.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <optional>
 
 namespace pp {
 namespace network {
 
+/**
+ * A persistent multiplexed connection. Whichever waiting caller finds no
+ * reader reads frames and hands each response to its request's slot, until
+ * its own response arrives; then another waiter takes over reading.
+ */
+struct FetchClient::Session {
+  TcpClient client;
+  std::mutex writeMutex; // serializes frames written to client
+
+  std::mutex mutex; // guards the fields below
+  std::condition_variable cv;
+  uint64_t nextRequestId{ 1 };
+  bool isReading{ false };
+  bool isClosed{ false };
+  std::string closeReason;
+  std::chrono::steady_clock::time_point lastUsed{ std::chrono::steady_clock::now() };
+  std::map<uint64_t, std::optional<std::string>> mResponses; // in-flight requests
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Clock::time_point getDeadline(std::chrono::milliseconds timeout) {
+  return timeout.count() > 0 ? Clock::now() + timeout : Clock::time_point::max();
+}
+
+/** Remaining time to a deadline, at least 1 ms; 0 (no timeout) if unbounded. */
+std::chrono::milliseconds getRemaining(Clock::time_point deadline) {
+  if (deadline == Clock::time_point::max()) {
+    return std::chrono::milliseconds(0);
+  }
+  auto remaining =
+      std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+  return std::max(remaining, std::chrono::milliseconds(1));
+}
+
+} // namespace
+
 FetchClient::FetchClient() {}
 
+FetchClient::~FetchClient() { closeSessions(); }
+
+void FetchClient::setMultiplexEnabled(bool isEnabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  isMultiplexEnabled_ = isEnabled;
+}
+
+void FetchClient::setPoolConfig(const PoolConfig &config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  poolConfig_ = config;
+  if (poolConfig_.maxConnectionsPerPeer == 0) {
+    poolConfig_.maxConnectionsPerPeer = 1;
+  }
+  FetchEngine::getInstance().setLegacyPeerTtl(poolConfig_.legacyPeerTtl);
+}
+
+size_t FetchClient::getPoolSize(const IpEndpoint &endpoint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = mPools_.find(endpoint.ltsToString());
+  if (it == mPools_.end()) {
+    return 0;
+  }
+  pruneSessions(it->second);
+  return it->second.size();
+}
+
+void FetchClient::closeSessions() {
+  std::map<std::string, std::vector<SessionPtr>> pools;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pools.swap(mPools_);
+  }
+  for (auto &[key, pool] : pools) {
+    for (auto &session : pool) {
+      std::lock_guard<std::mutex> lock(session->mutex);
+      session->isClosed = true;
+      session->closeReason = "Session closed";
+      session->cv.notify_all();
+    }
+  }
+}
+
 void FetchClient::fetch(const IpEndpoint &endpoint, const std::string &data,
                         ResponseCallback callback,
                         std::chrono::milliseconds timeout) {
 
   log().info << "Fetching from " << endpoint;
 
-  // Run in a separate thread for async behavior
-  std::thread([this, endpoint, data, callback = std::move(callback), timeout]() {
-    auto result = fetchSync(endpoint, data, timeout);
-    callback(result);
-  }).detach();
+  FetchEngine::getInstance().submit(
+      endpoint, data, timeout,
+      [callback = std::move(callback)](const FetchEngine::Roe<std::string> &result) {
+        if (!result) {
+          callback(Error(result.error().code, result.error().message));
+          return;
+        }
+        callback(result.value());
+      });
+}
+
+FetchEngine::Awaitable FetchClient::fetchAsync(const IpEndpoint &endpoint,
+                                               std::string data,
+                                               std::chrono::milliseconds timeout) {
+  return FetchEngine::getInstance().fetch(endpoint, std::move(data), timeout);
 }
 
 FetchClient::Roe<std::string>
@@ -24,6 +118,48 @@ FetchClient::fetchSync(const IpEndpoint &endpoint, const std::string &data,
                        std::chrono::milliseconds timeout) {
   log().debug << "Sync fetch from " << endpoint;
 
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!isMultiplexEnabled_ || isLegacyPeer(endpoint.ltsToString())) {
+      return fetchOneShot(endpoint, data, timeout);
+    }
+  }
+
+  bool isReused = false;
+  auto sessionResult = getSession(endpoint, timeout, isReused);
+  if (!sessionResult) {
+    return sessionResult.error();
+  }
+  if (!sessionResult.value()) {
+    return fetchOneShot(endpoint, data, timeout);
+  }
+
+  auto result = fetchOnSession(*sessionResult.value(), data, timeout);
+  if (!result && result.error().code == E_SESSION_CLOSED) {
+    dropSession(endpoint.ltsToString(), sessionResult.value());
+    if (isReused) {
+      // The peer may have dropped an idle connection; retry once on a new one
+      log().debug << "Session to " << endpoint << " closed, reconnecting: "
+                  << result.error().message;
+      auto retrySession = getSession(endpoint, timeout, isReused);
+      if (!retrySession) {
+        return retrySession.error();
+      }
+      if (!retrySession.value()) {
+        return fetchOneShot(endpoint, data, timeout);
+      }
+      result = fetchOnSession(*retrySession.value(), data, timeout);
+      if (!result && result.error().code == E_SESSION_CLOSED) {
+        dropSession(endpoint.ltsToString(), retrySession.value());
+      }
+    }
+  }
+  return result;
+}
+
+FetchClient::Roe<std::string>
+FetchClient::fetchOneShot(const IpEndpoint &endpoint, const std::string &data,
+                          std::chrono::milliseconds timeout) {
   TcpClient client;
 
   // Connect to the server
@@ -67,5 +203,239 @@ FetchClient::fetchSync(const IpEndpoint &endpoint, const std::string &data,
   return response;
 }
 
+FetchClient::Roe<FetchClient::SessionPtr>
+FetchClient::getSession(const IpEndpoint &endpoint,
+                        std::chrono::milliseconds timeout, bool &isReused) {
+  const std::string key = endpoint.ltsToString();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &pool = mPools_[key];
+    pruneSessions(pool);
+
+    SessionPtr best;
+    size_t bestLoad = 0;
+    for (const auto &session : pool) {
+      std::lock_guard<std::mutex> sessionLock(session->mutex);
+      size_t load = session->mResponses.size();
+      if (!best || load < bestLoad) {
+        best = session;
+        bestLoad = load;
+      }
+    }
+    if (best && (bestLoad == 0 || pool.size() >= poolConfig_.maxConnectionsPerPeer)) {
+      isReused = true;
+      return best;
+    }
+  }
+
+  isReused = false;
+  auto openResult = openSession(endpoint, timeout);
+  if (!openResult) {
+    return openResult.error();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!openResult.value()) {
+    mLegacyPeers_[key] = Clock::now() + poolConfig_.legacyPeerTtl;
+    return SessionPtr();
+  }
+  // Concurrent callers may have filled the pool meanwhile; then this
+  // connection serves just the one request and closes when released
+  auto &pool = mPools_[key];
+  if (pool.size() < poolConfig_.maxConnectionsPerPeer) {
+    pool.push_back(openResult.value());
+  }
+  return openResult.value();
+}
+
+bool FetchClient::isLegacyPeer(const std::string &key) {
+  auto it = mLegacyPeers_.find(key);
+  if (it == mLegacyPeers_.end()) {
+    return false;
+  }
+  if (Clock::now() >= it->second) {
+    mLegacyPeers_.erase(it);
+    return false;
+  }
+  return true;
+}
+
+void FetchClient::pruneSessions(std::vector<SessionPtr> &pool) {
+  const auto now = Clock::now();
+  auto isExpired = [&](const SessionPtr &session) {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    if (!session->isClosed && session->mResponses.empty()) {
+      // Health check only while idle: no reader is using the socket
+      if (now - session->lastUsed > poolConfig_.idleTimeout) {
+        session->isClosed = true;
+        session->closeReason = "Session idle timeout";
+      } else if (!session->client.isIdleAndOpen()) {
+        session->isClosed = true;
+        session->closeReason = "Session closed by peer";
+      }
+    }
+    return session->isClosed;
+  };
+  pool.erase(std::remove_if(pool.begin(), pool.end(), isExpired), pool.end());
+}
+
+FetchClient::Roe<FetchClient::SessionPtr>
+FetchClient::openSession(const IpEndpoint &endpoint,
+                         std::chrono::milliseconds timeout) {
+  auto session = std::make_shared<Session>();
+  auto connectResult = session->client.connect(endpoint);
+  if (!connectResult) {
+    return Error(1, "Failed to connect: " + connectResult.error().message);
+  }
+  auto timeoutResult = session->client.setTimeout(timeout);
+  if (!timeoutResult) {
+    return Error(1, "Failed to set timeout: " + timeoutResult.error().message);
+  }
+
+  // Offer compression; the reader inflates compressed frames transparently
+  auto writeResult =
+      session->client.writeFrame(fetch_protocol::makeHello(true));
+  if (!writeResult) {
+    return Error(2, "Failed to send data: " + writeResult.error().message);
+  }
+  auto readResult = session->client.readFrame(timeout);
+  if (!readResult) {
+    return Error(3, "Failed to receive response: " + readResult.error().message);
+  }
+  bool isDeflate = false;
+  if (!fetch_protocol::parseHello(readResult.value(), isDeflate)) {
+    // A version 1 peer answered the hello as an ordinary request
+    log().info << "Peer " << endpoint
+               << " does not support multiplexing, using one-shot connections";
+    return SessionPtr();
+  }
+
+  log().debug << "Opened multiplexed session to " << endpoint
+              << (isDeflate ? " (compressed)" : "");
+  return session;
+}
+
+void FetchClient::dropSession(const std::string &key,
+                              const SessionPtr &session) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = mPools_.find(key);
+  if (it != mPools_.end()) {
+    auto &pool = it->second;
+    pool.erase(std::remove(pool.begin(), pool.end(), session), pool.end());
+  }
+}
+
+FetchClient::Roe<std::string>
+FetchClient::fetchOnSession(Session &session, const std::string &data,
+                            std::chrono::milliseconds timeout) {
+  const auto deadline = getDeadline(timeout);
+
+  uint64_t requestId = 0;
+  {
+    std::lock_guard<std::mutex> lock(session.mutex);
+    if (session.isClosed) {
+      return Error(E_SESSION_CLOSED, session.closeReason);
+    }
+    requestId = session.nextRequestId++;
+    session.mResponses[requestId] = std::nullopt;
+    session.lastUsed = Clock::now();
+  }
+
+  std::optional<std::string> writeError;
+  {
+    std::lock_guard<std::mutex> lock(session.writeMutex);
+    auto writeResult = session.client.writeFrame(
+        fetch_protocol::packMuxFrame(requestId, data));
+    if (!writeResult) {
+      writeError = writeResult.error().message;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(session.mutex);
+  if (writeError) {
+    session.mResponses.erase(requestId);
+    session.isClosed = true;
+    session.closeReason = "Failed to send data: " + *writeError;
+    session.cv.notify_all();
+    return Error(E_SESSION_CLOSED, session.closeReason);
+  }
+
+  log().debug << "Request " << requestId << " sent, waiting for response";
+
+  while (true) {
+    auto it = session.mResponses.find(requestId);
+    if (it->second.has_value()) {
+      std::string response = std::move(*it->second);
+      session.mResponses.erase(it);
+      session.lastUsed = Clock::now();
+      log().debug << "Received response " << requestId << " ("
+                  << response.size() << " bytes)";
+      return response;
+    }
+    if (session.isClosed) {
+      session.mResponses.erase(it);
+      return Error(E_SESSION_CLOSED, session.closeReason);
+    }
+    if (Clock::now() >= deadline) {
+      // Only this request gives up; a late response for its id is dropped
+      // by the reader and the session stays usable for the others
+      session.mResponses.erase(it);
+      return Error(E_TIMEOUT, "Failed to receive response: timeout");
+    }
+
+    if (session.isReading) {
+      session.cv.wait_until(lock, deadline);
+      continue;
+    }
+
+    // Become the reader until our own response arrives. Waiting for the
+    // next frame is bounded by our deadline; once a frame starts arriving it
+    // is read whole, so giving up never leaves the stream mid-frame
+    session.isReading = true;
+    lock.unlock();
+    bool isFrameReady = false;
+    TcpClient::Roe<std::string> readResult =
+        TcpClient::Error("Failed to set timeout");
+    auto readable = session.client.waitReadable(getRemaining(deadline));
+    if (!readable) {
+      readResult = TcpClient::Error(readable.error().message);
+    } else if (readable.value()) {
+      isFrameReady = true;
+      if (session.client.setTimeout(FRAME_READ_TIMEOUT)) {
+        readResult = session.client.readFrame(std::chrono::milliseconds(0));
+      }
+    }
+    lock.lock();
+    session.isReading = false;
+
+    if (readable && !isFrameReady) {
+      // Nothing arrived before our deadline; let another waiter read
+      session.cv.notify_all();
+      continue;
+    }
+    if (!readResult) {
+      // A partial frame may have been consumed; the stream cannot be resumed
+      session.isClosed = true;
+      session.closeReason =
+          "Failed to receive response: " + readResult.error().message;
+      session.cv.notify_all();
+      continue;
+    }
+
+    uint64_t responseId = 0;
+    std::string_view payload;
+    if (!fetch_protocol::unpackMuxFrame(readResult.value(), responseId, payload)) {
+      session.isClosed = true;
+      session.closeReason = "Malformed multiplexed response";
+    } else {
+      auto target = session.mResponses.find(responseId);
+      if (target != session.mResponses.end()) {
+        target->second = std::string(payload);
+      }
+    }
+    session.cv.notify_all();
+  }
+}
+
 } // namespace network
 } // namespace pp
@@ -2,12 +2,16 @@
 
 #include "lib/common/Module.h"
 #include "lib/common/ResultOrError.hpp"
+#include "FetchEngine.h"
 #include "TcpClient.h"
 #include "Types.hpp"
 #include <chrono>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace pp {
 namespace network {
@@ -16,7 +20,13 @@ namespace network {
  * FetchClient - Simple client for sending data and receiving responses
  *
  * Uses TCP sockets for peer-to-peer communication.
- * Simple pattern: connect, send, receive, close.
+ * Keeps a small pool of persistent multiplexed connections per peer (see
+ * fetch_protocol); concurrent fetches share them and their responses may
+ * arrive out of order. Peers that do not support it are served one request
+ * per connection: connect, send, receive, close.
+ *
+ * Asynchronous fetches run on the process-wide FetchEngine instead of the
+ * pool, so waiting on them costs no thread.
  */
 class FetchClient : public Module {
 public:
@@ -31,24 +41,56 @@ public:
   /** Default timeout for synchronous fetch operations. */
   static constexpr std::chrono::milliseconds DEFAULT_TIMEOUT{30000};
 
+  /** Error code of a fetchSync() whose response did not arrive in time. */
+  static constexpr int32_t E_TIMEOUT = 5;
+
+  struct PoolConfig {
+    // Another connection is opened only while every pooled one has requests in flight
+    size_t maxConnectionsPerPeer{ 4 };
+    // Connections unused this long are closed; keep below the server's idle timeout
+    std::chrono::milliseconds idleTimeout{ 60000 };
+    // A peer that rejected multiplexing is retried after this long, in case it
+    // upgraded; also applied to the shared FetchEngine
+    std::chrono::milliseconds legacyPeerTtl{ 600000 };
+  };
+
   /**
    * Constructor
    */
   FetchClient();
 
-  ~FetchClient() override = default;
+  ~FetchClient() override;
+
+  /** Use persistent multiplexed connections with peers supporting them (default on). */
+  void setMultiplexEnabled(bool isEnabled);
+
+  void setPoolConfig(const PoolConfig &config);
+
+  /** Number of pooled persistent connections to a peer. */
+  size_t getPoolSize(const IpEndpoint &endpoint);
+
+  /** Close all persistent connections. */
+  void closeSessions();
 
   /**
    * Fetch data from a remote peer (async)
    * @param endpoint Endpoint to connect to
    * @param data Data to send to the peer
-   * @param callback Callback function to receive the response
+   * @param callback Callback function to receive the response; runs on the
+   *                 fetch engine thread and must not block
    * @param timeout Maximum time to wait for a response (0 = no timeout)
    */
   void fetch(const IpEndpoint &endpoint, const std::string &data,
              ResponseCallback callback,
              std::chrono::milliseconds timeout = DEFAULT_TIMEOUT);
 
+  /**
+   * Fetch for co_await; yields FetchEngine::Roe<std::string> and resumes the
+   * coroutine on the fetch engine thread
+   */
+  FetchEngine::Awaitable fetchAsync(const IpEndpoint &endpoint, std::string data,
+                                    std::chrono::milliseconds timeout = DEFAULT_TIMEOUT);
+
   /**
    * Synchronous fetch - blocks until response is received or timeout expires
    * @param endpoint Endpoint to connect to
@@ -59,6 +101,45 @@ public:
   Roe<std::string> fetchSync(const IpEndpoint &endpoint,
                              const std::string &data,
                              std::chrono::milliseconds timeout = DEFAULT_TIMEOUT);
+
+private:
+  struct Session;
+  using SessionPtr = std::shared_ptr<Session>;
+
+  /** Error code of a session the peer closed or that failed to send. */
+  static constexpr int32_t E_SESSION_CLOSED = 4;
+  /** Once a frame starts arriving, how long the reader waits for the rest. */
+  static constexpr std::chrono::milliseconds FRAME_READ_TIMEOUT{30000};
+
+  /** True while the peer is remembered as version 1 only; forgets expired entries. */
+  bool isLegacyPeer(const std::string &key);
+
+  /** One request on its own connection (protocol version 1). */
+  Roe<std::string> fetchOneShot(const IpEndpoint &endpoint,
+                                const std::string &data,
+                                std::chrono::milliseconds timeout);
+
+  /**
+   * Least-loaded pooled session, or a new one if all are busy and the pool
+   * has room; nullptr if the peer only speaks version 1.
+   */
+  Roe<SessionPtr> getSession(const IpEndpoint &endpoint,
+                             std::chrono::milliseconds timeout, bool &isReused);
+  Roe<SessionPtr> openSession(const IpEndpoint &endpoint,
+                              std::chrono::milliseconds timeout);
+  void dropSession(const std::string &key, const SessionPtr &session);
+  /** Close and remove sessions that are closed, idle too long or dead. */
+  void pruneSessions(std::vector<SessionPtr> &pool);
+
+  Roe<std::string> fetchOnSession(Session &session, const std::string &data,
+                                  std::chrono::milliseconds timeout);
+
+  std::mutex mutex_;
+  bool isMultiplexEnabled_{ true };
+  PoolConfig poolConfig_;
+  std::map<std::string, std::vector<SessionPtr>> mPools_;
+  // Peers that only speak version 1 -> when to try multiplexing again
+  std::map<std::string, std::chrono::steady_clock::time_point> mLegacyPeers_;
 };
 
 } // namespace network
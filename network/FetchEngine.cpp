@@ -0,0 +1,822 @@
+#include "FetchEngine.h"
+#include "FetchProtocol.hpp"
+#include "FrameCompression.h"
+#include "TcpConnection.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+namespace pp {
+namespace network {
+
+namespace {
+
+constexpr size_t FRAME_HEADER_SIZE = 4;
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+constexpr int MAX_EVENTS = 64;
+// Upper bound on a loop wait so stop() is noticed promptly
+constexpr int MAX_WAIT_MS = 100;
+constexpr auto IDLE_SWEEP_INTERVAL = std::chrono::seconds(1);
+
+int setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0) return -1;
+  if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) return -1;
+#if !defined(__linux__)
+  // On non-Linux platforms (e.g. macOS), suppress SIGPIPE per socket
+  int val = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &val, sizeof(val));
+#endif
+  return 0;
+}
+
+std::string makeFrame(std::string_view body) {
+  std::string frame;
+  frame.reserve(FRAME_HEADER_SIZE + body.size());
+  uint32_t len = static_cast<uint32_t>(body.size());
+  frame.push_back(static_cast<char>((len >> 24) & 0xFF));
+  frame.push_back(static_cast<char>((len >> 16) & 0xFF));
+  frame.push_back(static_cast<char>((len >> 8) & 0xFF));
+  frame.push_back(static_cast<char>(len & 0xFF));
+  frame.append(body);
+  return frame;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Awaitable
+// ---------------------------------------------------------------------------
+
+FetchEngine::Awaitable::Awaitable(FetchEngine &engine, IpEndpoint endpoint,
+                                  std::string data,
+                                  std::chrono::milliseconds timeout)
+    : engine_(engine), endpoint_(std::move(endpoint)), data_(std::move(data)),
+      timeout_(timeout) {}
+
+void FetchEngine::Awaitable::await_suspend(std::coroutine_handle<> handle) {
+  // The callback may resume the coroutine before submit() returns, which can
+  // destroy this awaitable; nothing may touch members afterwards
+  engine_.submit(endpoint_, std::move(data_), timeout_,
+                 [this, handle](const Roe<std::string> &result) {
+                   result_.emplace(result);
+                   handle.resume();
+                 });
+}
+
+FetchEngine::Roe<std::string> FetchEngine::Awaitable::await_resume() {
+  return std::move(*result_);
+}
+
+// ---------------------------------------------------------------------------
+// FetchEngine
+// ---------------------------------------------------------------------------
+
+FetchEngine &FetchEngine::getInstance() {
+  static FetchEngine engine;
+  static std::once_flag startFlag;
+  std::call_once(startFlag, [] {
+    engine.redirectLogger("FetchEngine");
+    auto result = engine.start();
+    if (!result) {
+      // Submits then fail with E_STOPPED
+      engine.log().error << "Failed to start fetch engine: " << result.error().message;
+    }
+  });
+  return engine;
+}
+
+FetchEngine::FetchEngine() {}
+
+FetchEngine::~FetchEngine() { stop(); }
+
+uint64_t FetchEngine::submit(const IpEndpoint &endpoint, std::string data,
+                             std::chrono::milliseconds timeout,
+                             Callback callback) {
+  Request request;
+  request.id = nextRequestId_++;
+  request.endpoint = endpoint;
+  request.data = std::move(data);
+  if (timeout.count() > 0) {
+    request.deadline = Clock::now() + timeout;
+  }
+  request.callback = std::move(callback);
+  const uint64_t requestId = request.id;
+
+  {
+    std::lock_guard<std::mutex> lock(commandMutex_);
+    if (isRunning_) {
+      ++pendingCount_;
+      submitted_.push_back(std::move(request));
+      wake();
+      return requestId;
+    }
+  }
+  if (request.callback) {
+    request.callback(Error(E_STOPPED, "Fetch engine is not running"));
+  }
+  return requestId;
+}
+
+void FetchEngine::cancel(uint64_t requestId) {
+  {
+    std::lock_guard<std::mutex> lock(commandMutex_);
+    if (!isRunning_) {
+      return;
+    }
+    cancelled_.push_back(requestId);
+  }
+  wake();
+}
+
+FetchEngine::Awaitable FetchEngine::fetch(const IpEndpoint &endpoint,
+                                          std::string data,
+                                          std::chrono::milliseconds timeout) {
+  return Awaitable(*this, endpoint, std::move(data), timeout);
+}
+
+void FetchEngine::wake() {
+  char byte = 1;
+  // A full pipe already guarantees a wakeup
+  [[maybe_unused]] auto written = ::write(wakeFds_[1], &byte, 1);
+}
+
+Service::Roe<void> FetchEngine::onStart() {
+  if (::pipe(wakeFds_) < 0) {
+    return Service::Error(-1, "Failed to create wake pipe: " +
+                                  std::string(std::strerror(errno)));
+  }
+  setNonBlocking(wakeFds_[0]);
+  setNonBlocking(wakeFds_[1]);
+
+#if defined(__linux__)
+  epollFd_ = epoll_create1(0);
+  if (epollFd_ < 0) {
+    std::string message = std::strerror(errno);
+    ::close(wakeFds_[0]);
+    ::close(wakeFds_[1]);
+    wakeFds_[0] = wakeFds_[1] = -1;
+    return Service::Error(-1, "Failed to create epoll instance: " + message);
+  }
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.u64 = 0;
+  epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFds_[0], &ev);
+#endif
+
+  std::lock_guard<std::mutex> lock(commandMutex_);
+  isRunning_ = true;
+  return {};
+}
+
+void FetchEngine::runLoop() {
+  log().debug << "Fetch engine loop started";
+
+  while (!isStopSet()) {
+    drainCommands();
+    expireRequests();
+    closeIdleConnections();
+
+    int waitMs = getWaitMs();
+#if defined(__linux__)
+    epoll_event events[MAX_EVENTS];
+    int n = epoll_wait(epollFd_, events, MAX_EVENTS, waitMs);
+    if (n < 0) {
+      if (errno != EINTR) {
+        log().error << "epoll_wait failed: " << std::strerror(errno);
+      }
+      continue;
+    }
+    for (int i = 0; i < n; ++i) {
+      uint64_t connectionId = events[i].data.u64;
+      if (connectionId == 0) {
+        char buffer[256];
+        while (::read(wakeFds_[0], buffer, sizeof(buffer)) > 0) {
+        }
+        continue;
+      }
+      uint32_t flags = events[i].events;
+      handleEvent(connectionId, (flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0,
+                  (flags & EPOLLOUT) != 0);
+    }
+#else
+    std::vector<pollfd> pfds;
+    std::vector<uint64_t> ids;
+    pfds.push_back({ wakeFds_[0], POLLIN, 0 });
+    ids.push_back(0);
+    for (const auto &[id, conn] : mConnections_) {
+      short events = POLLIN;
+      if (conn->isWatchingWrite) {
+        events |= POLLOUT;
+      }
+      pfds.push_back({ conn->fd, events, 0 });
+      ids.push_back(id);
+    }
+    int n = ::poll(pfds.data(), pfds.size(), waitMs);
+    if (n < 0) {
+      if (errno != EINTR) {
+        log().error << "poll failed: " << std::strerror(errno);
+      }
+      continue;
+    }
+    for (size_t i = 0; i < pfds.size(); ++i) {
+      short revents = pfds[i].revents;
+      if (revents == 0) {
+        continue;
+      }
+      if (ids[i] == 0) {
+        char buffer[256];
+        while (::read(wakeFds_[0], buffer, sizeof(buffer)) > 0) {
+        }
+        continue;
+      }
+      handleEvent(ids[i], (revents & (POLLIN | POLLHUP | POLLERR)) != 0,
+                  (revents & POLLOUT) != 0);
+    }
+#endif
+  }
+
+  log().debug << "Fetch engine loop stopped";
+}
+
+void FetchEngine::onStop() {
+  std::vector<Request> submitted;
+  {
+    std::lock_guard<std::mutex> lock(commandMutex_);
+    isRunning_ = false;
+    submitted.swap(submitted_);
+    cancelled_.clear();
+  }
+
+  const Error stopped(E_STOPPED, "Fetch engine stopped");
+  while (!mConnections_.empty()) {
+    closeConnection(mConnections_.begin()->first, stopped);
+  }
+  for (auto &request : submitted) {
+    complete(request, stopped);
+  }
+  mMuxByPeer_.clear();
+  mRequestConnections_.clear();
+  mLegacyPeers_.clear();
+  deadlines_.clear();
+
+#if defined(__linux__)
+  if (epollFd_ >= 0) {
+    ::close(epollFd_);
+    epollFd_ = -1;
+  }
+#endif
+  for (int &fd : wakeFds_) {
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+}
+
+void FetchEngine::drainCommands() {
+  std::vector<Request> submitted;
+  std::vector<uint64_t> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(commandMutex_);
+    submitted.swap(submitted_);
+    cancelled.swap(cancelled_);
+  }
+
+  for (auto &request : submitted) {
+    dispatch(std::move(request));
+  }
+  for (uint64_t requestId : cancelled) {
+    Request request;
+    if (takeRequest(requestId, request)) {
+      complete(request, Error(E_CANCELLED, "Request cancelled"));
+    }
+  }
+}
+
+void FetchEngine::dispatch(Request request) {
+  const std::string peer = request.endpoint.ltsToString();
+  if (isLegacyPeer(peer)) {
+    startOneShot(std::move(request));
+    return;
+  }
+
+  Connection *conn = nullptr;
+  auto muxIt = mMuxByPeer_.find(peer);
+  if (muxIt != mMuxByPeer_.end()) {
+    conn = mConnections_.at(muxIt->second).get();
+  } else {
+    auto openResult = openConnection(request.endpoint, Connection::State::Hello);
+    if (!openResult) {
+      complete(request, openResult.error());
+      return;
+    }
+    conn = openResult.value();
+    mMuxByPeer_[peer] = conn->id;
+  }
+
+  if (request.deadline != Clock::time_point::max()) {
+    deadlines_.emplace(request.deadline, request.id);
+  }
+  mRequestConnections_[request.id] = conn->id;
+  if (conn->state == Connection::State::Ready) {
+    sendRequest(*conn, std::move(request));
+  } else {
+    conn->queued.push_back(std::move(request));
+  }
+}
+
+bool FetchEngine::isLegacyPeer(const std::string &peer) {
+  auto it = mLegacyPeers_.find(peer);
+  if (it == mLegacyPeers_.end()) {
+    return false;
+  }
+  if (Clock::now() >= it->second) {
+    mLegacyPeers_.erase(it);
+    return false;
+  }
+  return true;
+}
+
+void FetchEngine::startOneShot(Request request) {
+  auto openResult = openConnection(request.endpoint, Connection::State::OneShot);
+  if (!openResult) {
+    complete(request, openResult.error());
+    return;
+  }
+  Connection &conn = *openResult.value();
+  if (request.deadline != Clock::time_point::max()) {
+    deadlines_.emplace(request.deadline, request.id);
+  }
+  mRequestConnections_[request.id] = conn.id;
+  conn.out = makeFrame(request.data);
+  request.data.clear();
+  conn.mInflight.emplace(request.id, std::move(request));
+}
+
+FetchEngine::Roe<FetchEngine::Connection *>
+FetchEngine::openConnection(const IpEndpoint &endpoint, Connection::State state) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+
+  addrinfo *result = nullptr;
+  int gai = getaddrinfo(endpoint.address.c_str(),
+                        std::to_string(endpoint.port).c_str(), &hints, &result);
+  if (gai != 0 || result == nullptr) {
+    return Error(E_CONNECT, "Failed to resolve hostname: " + endpoint.address);
+  }
+
+  auto conn = std::make_unique<Connection>();
+  for (addrinfo *rp = result; rp != nullptr; rp = rp->ai_next) {
+    conn->addresses.emplace_back(reinterpret_cast<const char *>(rp->ai_addr),
+                                 rp->ai_addrlen);
+  }
+  freeaddrinfo(result);
+
+  conn->id = nextConnectionId_++;
+  conn->endpoint = endpoint;
+  conn->peer = endpoint.ltsToString();
+  conn->nextState = state;
+
+  auto connectResult = connectNext(*conn);
+  if (!connectResult) {
+    return connectResult.error();
+  }
+  Connection *raw = conn.get();
+  mConnections_[raw->id] = std::move(conn);
+  return raw;
+}
+
+FetchEngine::Roe<void> FetchEngine::connectNext(Connection &conn) {
+  std::string lastError = "no address";
+  for (; conn.addressIndex < conn.addresses.size(); ++conn.addressIndex) {
+    const std::string &address = conn.addresses[conn.addressIndex];
+    const auto *addr = reinterpret_cast<const sockaddr *>(address.data());
+    int fd = ::socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) {
+      lastError = std::strerror(errno);
+      continue;
+    }
+    if (setNonBlocking(fd) < 0 ||
+        (::connect(fd, addr, static_cast<socklen_t>(address.size())) < 0 &&
+         errno != EINPROGRESS)) {
+      lastError = std::strerror(errno);
+      ::close(fd);
+      continue;
+    }
+
+    // Writable once the connect finished, successfully or not
+    conn.fd = fd;
+    conn.state = Connection::State::Connecting;
+    conn.isConnected = false;
+    conn.isWatchingWrite = true;
+#if defined(__linux__)
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u64 = conn.id;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      lastError = std::strerror(errno);
+      ::close(fd);
+      conn.fd = -1;
+      continue;
+    }
+#endif
+    return {};
+  }
+  return Error(E_CONNECT, "Failed to connect to " + conn.peer + ": " + lastError);
+}
+
+void FetchEngine::handleEvent(uint64_t connectionId, bool isReadable,
+                              bool isWritable) {
+  auto it = mConnections_.find(connectionId);
+  if (it == mConnections_.end()) {
+    return;
+  }
+  Connection &conn = *it->second;
+
+  if (!conn.isConnected) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) {
+      err = errno;
+    }
+    if (err != 0) {
+      // Try the next resolved address
+#if defined(__linux__)
+      epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+#endif
+      ::close(conn.fd);
+      conn.fd = -1;
+      ++conn.addressIndex;
+      auto connectResult = connectNext(conn);
+      if (!connectResult) {
+        closeConnection(connectionId,
+                        Error(E_CONNECT, "Failed to connect to " + conn.peer +
+                                             ": " + std::strerror(err)));
+      }
+      return;
+    }
+    auto connectedResult = onConnected(conn);
+    if (!connectedResult) {
+      closeConnection(connectionId, connectedResult.error());
+    }
+    return;
+  }
+
+  if (isWritable) {
+    auto flushResult = flushOut(conn);
+    if (!flushResult) {
+      closeConnection(connectionId, flushResult.error());
+      return;
+    }
+  }
+
+  if (isReadable) {
+    auto readResult = readIn(conn);
+    if (!readResult) {
+      closeConnection(connectionId, readResult.error());
+      return;
+    }
+    auto processResult = processFrames(conn);
+    if (!processResult) {
+      closeConnection(connectionId, processResult.error());
+      return;
+    }
+    if (conn.state == Connection::State::OneShot && conn.mInflight.empty()) {
+      closeConnection(connectionId, Error(E_RECEIVE, "Request complete"));
+      return;
+    }
+    if (!readResult.value()) {
+      closeConnection(connectionId, Error(E_RECEIVE, "Connection closed by peer"));
+    }
+  }
+}
+
+FetchEngine::Roe<void> FetchEngine::onConnected(Connection &conn) {
+  conn.isConnected = true;
+  conn.state = conn.nextState;
+  conn.lastUsed = Clock::now();
+  if (conn.state == Connection::State::Hello) {
+    conn.out = makeFrame(fetch_protocol::makeHello(true));
+    conn.outOffset = 0;
+  }
+  log().debug << "Connected to " << conn.peer;
+  return flushOut(conn);
+}
+
+FetchEngine::Roe<void> FetchEngine::flushOut(Connection &conn) {
+  while (conn.outOffset < conn.out.size()) {
+    int flags = 0;
+#if defined(__linux__)
+    flags |= MSG_NOSIGNAL;
+#endif
+    ssize_t n = ::send(conn.fd, conn.out.data() + conn.outOffset,
+                       conn.out.size() - conn.outOffset, flags);
+    if (n > 0) {
+      conn.outOffset += static_cast<size_t>(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    return Error(E_SEND, "Failed to send data: " + std::string(std::strerror(errno)));
+  }
+
+  if (conn.outOffset == conn.out.size()) {
+    conn.out.clear();
+    conn.outOffset = 0;
+  }
+  setWantWrite(conn, !conn.out.empty());
+  return {};
+}
+
+FetchEngine::Roe<bool> FetchEngine::readIn(Connection &conn) {
+  char buffer[READ_CHUNK_SIZE];
+  while (true) {
+    ssize_t n = ::recv(conn.fd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      conn.in.append(buffer, static_cast<size_t>(n));
+      continue;
+    }
+    if (n == 0) {
+      return false;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return true;
+    }
+    return Error(E_RECEIVE,
+                 "Failed to receive response: " + std::string(std::strerror(errno)));
+  }
+}
+
+FetchEngine::Roe<void> FetchEngine::processFrames(Connection &conn) {
+  size_t offset = 0;
+  while (conn.in.size() - offset >= FRAME_HEADER_SIZE) {
+    const auto *header = reinterpret_cast<const uint8_t *>(conn.in.data() + offset);
+    uint32_t len = (static_cast<uint32_t>(header[0]) << 24) |
+                   (static_cast<uint32_t>(header[1]) << 16) |
+                   (static_cast<uint32_t>(header[2]) << 8) |
+                   static_cast<uint32_t>(header[3]);
+    const bool isCompressed = (len & fetch_protocol::COMPRESSED_FLAG) != 0;
+    len &= ~fetch_protocol::COMPRESSED_FLAG;
+    if (len > TcpConnection::MAX_FRAME_SIZE) {
+      return Error(E_RECEIVE, "Response frame too large: " + std::to_string(len));
+    }
+    if (conn.in.size() - offset - FRAME_HEADER_SIZE < len) {
+      break;
+    }
+    std::string_view body(conn.in.data() + offset + FRAME_HEADER_SIZE, len);
+    offset += FRAME_HEADER_SIZE + len;
+    std::string decompressed;
+    if (isCompressed) {
+      auto result = frame_compression::decompress(body, TcpConnection::MAX_FRAME_SIZE);
+      if (!result) {
+        return Error(E_RECEIVE, result.error().message);
+      }
+      decompressed = std::move(result.value());
+      body = decompressed;
+    }
+    auto frameResult = onFrame(conn, body);
+    if (!frameResult) {
+      return frameResult;
+    }
+  }
+  conn.in.erase(0, offset);
+  return {};
+}
+
+FetchEngine::Roe<void> FetchEngine::onFrame(Connection &conn, std::string_view body) {
+  conn.lastUsed = Clock::now();
+  switch (conn.state) {
+  case Connection::State::Hello: {
+    bool isDeflate = false;
+    if (fetch_protocol::parseHello(body, isDeflate)) {
+      conn.state = Connection::State::Ready;
+      log().debug << "Multiplexed connection to " << conn.peer << " ready"
+                  << (isDeflate ? " (compressed)" : "");
+      std::deque<Request> queued;
+      queued.swap(conn.queued);
+      for (auto &request : queued) {
+        sendRequest(conn, std::move(request));
+      }
+      return {};
+    }
+    // A version 1 peer answered the hello as an ordinary request
+    log().info << "Peer " << conn.peer
+               << " does not support multiplexing, using one-shot connections";
+    mLegacyPeers_[conn.peer] =
+        Clock::now() + std::chrono::milliseconds(legacyPeerTtlMs_.load());
+    std::deque<Request> queued;
+    queued.swap(conn.queued);
+    for (auto &request : queued) {
+      startOneShot(std::move(request));
+    }
+    return Error(E_RECEIVE, "Peer does not support multiplexing");
+  }
+  case Connection::State::Ready: {
+    uint64_t requestId = 0;
+    std::string_view payload;
+    if (!fetch_protocol::unpackMuxFrame(body, requestId, payload)) {
+      return Error(E_RECEIVE, "Malformed multiplexed response");
+    }
+    auto it = conn.mInflight.find(requestId);
+    if (it == conn.mInflight.end()) {
+      // Timed out or cancelled meanwhile
+      return {};
+    }
+    Request request = std::move(it->second);
+    conn.mInflight.erase(it);
+    mRequestConnections_.erase(request.id);
+    deadlines_.erase({ request.deadline, request.id });
+    complete(request, std::string(payload));
+    return {};
+  }
+  case Connection::State::OneShot: {
+    if (conn.mInflight.empty()) {
+      return Error(E_RECEIVE, "Unexpected response");
+    }
+    Request request = std::move(conn.mInflight.begin()->second);
+    conn.mInflight.clear();
+    mRequestConnections_.erase(request.id);
+    deadlines_.erase({ request.deadline, request.id });
+    complete(request, std::string(body));
+    return {};
+  }
+  case Connection::State::Connecting:
+    break;
+  }
+  return Error(E_RECEIVE, "Unexpected response");
+}
+
+void FetchEngine::sendRequest(Connection &conn, Request request) {
+  conn.out += makeFrame(fetch_protocol::packMuxFrame(request.id, request.data));
+  request.data.clear();
+  conn.lastUsed = Clock::now();
+  conn.mInflight.emplace(request.id, std::move(request));
+  // Written when the loop next sees the socket writable
+  setWantWrite(conn, true);
+}
+
+void FetchEngine::setWantWrite(Connection &conn, bool isWantWrite) {
+  if (conn.isWatchingWrite == isWantWrite) {
+    return;
+  }
+  conn.isWatchingWrite = isWantWrite;
+#if defined(__linux__)
+  epoll_event ev{};
+  ev.events = EPOLLIN | (isWantWrite ? EPOLLOUT : 0);
+  ev.data.u64 = conn.id;
+  epoll_ctl(epollFd_, EPOLL_CTL_MOD, conn.fd, &ev);
+#endif
+}
+
+void FetchEngine::closeConnection(uint64_t connectionId, const Error &error) {
+  auto it = mConnections_.find(connectionId);
+  if (it == mConnections_.end()) {
+    return;
+  }
+  std::unique_ptr<Connection> conn = std::move(it->second);
+  mConnections_.erase(it);
+
+  if (conn->fd >= 0) {
+#if defined(__linux__)
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+#endif
+    ::close(conn->fd);
+  }
+  auto muxIt = mMuxByPeer_.find(conn->peer);
+  if (muxIt != mMuxByPeer_.end() && muxIt->second == connectionId) {
+    mMuxByPeer_.erase(muxIt);
+  }
+
+  std::vector<Request> requests;
+  for (auto &request : conn->queued) {
+    requests.push_back(std::move(request));
+  }
+  for (auto &[id, request] : conn->mInflight) {
+    requests.push_back(std::move(request));
+  }
+  if (!requests.empty()) {
+    log().debug << "Connection to " << conn->peer << " closed: " << error.message;
+  }
+  for (auto &request : requests) {
+    mRequestConnections_.erase(request.id);
+    deadlines_.erase({ request.deadline, request.id });
+    complete(request, error);
+  }
+}
+
+void FetchEngine::complete(Request &request, const Roe<std::string> &result) {
+  --pendingCount_;
+  if (request.callback) {
+    request.callback(result);
+  }
+}
+
+bool FetchEngine::takeRequest(uint64_t requestId, Request &out) {
+  auto it = mRequestConnections_.find(requestId);
+  if (it == mRequestConnections_.end()) {
+    return false;
+  }
+  uint64_t connectionId = it->second;
+  mRequestConnections_.erase(it);
+
+  auto connIt = mConnections_.find(connectionId);
+  if (connIt == mConnections_.end()) {
+    return false;
+  }
+  Connection &conn = *connIt->second;
+
+  bool isFound = false;
+  auto inflightIt = conn.mInflight.find(requestId);
+  if (inflightIt != conn.mInflight.end()) {
+    out = std::move(inflightIt->second);
+    conn.mInflight.erase(inflightIt);
+    isFound = true;
+  } else {
+    auto queuedIt = std::find_if(conn.queued.begin(), conn.queued.end(),
+                                 [requestId](const Request &request) {
+                                   return request.id == requestId;
+                                 });
+    if (queuedIt != conn.queued.end()) {
+      out = std::move(*queuedIt);
+      conn.queued.erase(queuedIt);
+      isFound = true;
+    }
+  }
+  if (!isFound) {
+    return false;
+  }
+  deadlines_.erase({ out.deadline, out.id });
+
+  // A one-shot connection has no other use; a multiplexed one drops the late response
+  if (conn.state == Connection::State::OneShot ||
+      (conn.nextState == Connection::State::OneShot && !conn.isConnected)) {
+    closeConnection(connectionId, Error(E_CANCELLED, "Request abandoned"));
+  }
+  return true;
+}
+
+void FetchEngine::expireRequests() {
+  const auto now = Clock::now();
+  while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+    uint64_t requestId = deadlines_.begin()->second;
+    deadlines_.erase(deadlines_.begin());
+    Request request;
+    if (takeRequest(requestId, request)) {
+      complete(request, Error(E_TIMEOUT, "Failed to receive response: timeout"));
+    }
+  }
+}
+
+void FetchEngine::closeIdleConnections() {
+  const auto now = Clock::now();
+  if (now - lastIdleSweep_ < IDLE_SWEEP_INTERVAL) {
+    return;
+  }
+  lastIdleSweep_ = now;
+
+  std::vector<uint64_t> idle;
+  for (const auto &[id, conn] : mConnections_) {
+    if (conn->state == Connection::State::Ready && conn->mInflight.empty() &&
+        now - conn->lastUsed > IDLE_TIMEOUT) {
+      idle.push_back(id);
+    }
+  }
+  for (uint64_t id : idle) {
+    closeConnection(id, Error(E_RECEIVE, "Connection idle"));
+  }
+}
+
+int FetchEngine::getWaitMs() const {
+  if (deadlines_.empty()) {
+    return MAX_WAIT_MS;
+  }
+  auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+      deadlines_.begin()->first - Clock::now());
+  return static_cast<int>(
+      std::clamp<int64_t>(remaining.count(), 0, MAX_WAIT_MS));
+}
+
+} // namespace network
+} // namespace pp
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "lib/common/ResultOrError.hpp"
+#include "lib/common/Service.h"
+#include "Types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pp {
+namespace network {
+
+/**
+ * FetchEngine - non-blocking fetch client driven by one event loop thread
+ *
+ * Many concurrent requests share the thread: each peer gets one multiplexed
+ * connection (see fetch_protocol), and peers that only speak version 1 get a
+ * connection per request. Requests complete through a callback, or by
+ * co_await on fetch(); both run on the engine thread, so they must not block.
+ *
+ * getInstance() is the engine shared by the process; separate instances can
+ * be started for isolation (e.g. tests). Host names are resolved on the
+ * engine thread, so numeric addresses are preferred.
+ */
+class FetchEngine : public Service {
+public:
+  struct Error : RoeErrorBase {
+    using RoeErrorBase::RoeErrorBase;
+  };
+
+  template <typename T> using Roe = ResultOrError<T, Error>;
+
+  using Callback = std::function<void(const Roe<std::string> &)>;
+
+  static constexpr int32_t E_CONNECT = 1;
+  static constexpr int32_t E_SEND = 2;
+  static constexpr int32_t E_RECEIVE = 3;
+  static constexpr int32_t E_TIMEOUT = 4;
+  static constexpr int32_t E_CANCELLED = 5;
+  static constexpr int32_t E_STOPPED = 6;
+
+  /** Multiplexed connections unused this long are closed. */
+  static constexpr std::chrono::milliseconds IDLE_TIMEOUT{ 60000 };
+
+  /** A peer that rejected multiplexing is retried after this long, in case it upgraded. */
+  static constexpr std::chrono::milliseconds LEGACY_PEER_TTL{ 600000 };
+
+  /** co_await yields Roe<std::string>; the coroutine resumes on the engine thread. */
+  class Awaitable {
+  public:
+    Awaitable(FetchEngine &engine, IpEndpoint endpoint, std::string data,
+              std::chrono::milliseconds timeout);
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    Roe<std::string> await_resume();
+
+  private:
+    FetchEngine &engine_;
+    IpEndpoint endpoint_;
+    std::string data_;
+    std::chrono::milliseconds timeout_;
+    std::optional<Roe<std::string>> result_;
+  };
+
+  /** Process-wide engine, started on first use. */
+  static FetchEngine &getInstance();
+
+  FetchEngine();
+  ~FetchEngine() override;
+
+  /**
+   * Queue a request; the callback runs exactly once, on the engine thread.
+   * @param timeout Maximum time until the response (0 = no timeout)
+   * @return Id for cancel()
+   */
+  uint64_t submit(const IpEndpoint &endpoint, std::string data,
+                  std::chrono::milliseconds timeout, Callback callback);
+
+  /** Complete a pending request with E_CANCELLED (no-op if already done). */
+  void cancel(uint64_t requestId);
+
+  Awaitable fetch(const IpEndpoint &endpoint, std::string data,
+                  std::chrono::milliseconds timeout);
+
+  /** Applies to peers found to be version 1 from now on. */
+  void setLegacyPeerTtl(std::chrono::milliseconds ttl) { legacyPeerTtlMs_ = ttl.count(); }
+
+  /** Requests submitted and not yet completed. */
+  size_t getPendingCount() const { return pendingCount_; }
+
+protected:
+  Service::Roe<void> onStart() override;
+  void runLoop() override;
+  void onStop() override;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    uint64_t id{ 0 };
+    IpEndpoint endpoint;
+    std::string data;
+    Clock::time_point deadline{ Clock::time_point::max() };
+    Callback callback;
+  };
+
+  struct Connection {
+    enum class State { Connecting, Hello, Ready, OneShot };
+
+    uint64_t id{ 0 };
+    int fd{ -1 };
+    IpEndpoint endpoint;
+    std::string peer; // endpoint key
+    State state{ State::Connecting };
+    State nextState{ State::Hello };  // once connected
+    std::vector<std::string> addresses; // resolved sockaddrs, tried in order
+    size_t addressIndex{ 0 };
+    bool isConnected{ false };
+    bool isWatchingWrite{ false };
+    std::string out;
+    size_t outOffset{ 0 };
+    std::string in;
+    Clock::time_point lastUsed{ Clock::now() };
+    std::deque<Request> queued;            // waiting for the hello answer
+    std::map<uint64_t, Request> mInflight; // sent, by request id
+  };
+
+  void wake();
+  void drainCommands();
+  void dispatch(Request request);
+  bool isLegacyPeer(const std::string &peer);
+  void startOneShot(Request request);
+  Roe<Connection *> openConnection(const IpEndpoint &endpoint, Connection::State state);
+  Roe<void> connectNext(Connection &conn);
+
+  void handleEvent(uint64_t connectionId, bool isReadable, bool isWritable);
+  Roe<void> onConnected(Connection &conn);
+  Roe<void> flushOut(Connection &conn);
+  /** @return false once the peer closed the connection */
+  Roe<bool> readIn(Connection &conn);
+  Roe<void> processFrames(Connection &conn);
+  Roe<void> onFrame(Connection &conn, std::string_view body);
+  void sendRequest(Connection &conn, Request request);
+
+  void closeConnection(uint64_t connectionId, const Error &error);
+  void complete(Request &request, const Roe<std::string> &result);
+  bool takeRequest(uint64_t requestId, Request &out);
+  void expireRequests();
+  void closeIdleConnections();
+  int getWaitMs() const;
+  void setWantWrite(Connection &conn, bool isWantWrite);
+
+  // Commands from other threads
+  std::mutex commandMutex_;
+  std::vector<Request> submitted_;
+  std::vector<uint64_t> cancelled_;
+  bool isRunning_{ false }; // accepting submits, guarded by commandMutex_
+  int wakeFds_[2]{ -1, -1 };
+
+  std::atomic<uint64_t> nextRequestId_{ 1 };
+  std::atomic<size_t> pendingCount_{ 0 };
+  std::atomic<int64_t> legacyPeerTtlMs_{ LEGACY_PEER_TTL.count() };
+
+  // Loop thread state
+#if defined(__linux__)
+  int epollFd_{ -1 };
+#endif
+  uint64_t nextConnectionId_{ 1 }; // 0 marks the wake pipe
+  std::map<uint64_t, std::unique_ptr<Connection>> mConnections_;
+  std::map<std::string, uint64_t> mMuxByPeer_;     // peer -> connection id
+  std::map<uint64_t, uint64_t> mRequestConnections_; // request id -> connection id
+  std::map<std::string, Clock::time_point> mLegacyPeers_; // peer -> retry time
+  std::set<std::pair<Clock::time_point, uint64_t>> deadlines_;
+  Clock::time_point lastIdleSweep_{};
+};
+
+} // namespace network
+} // namespace pp
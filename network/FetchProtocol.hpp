@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace pp {
+namespace network {
+
+/**
+ * Fetch wire protocol shared by FetchServer and FetchClient.
+ *
+ * Every message is a frame: 4-byte length (network byte order) + body.
+ *
+ * Version 1 (one-shot): the client connects, sends one request frame, reads
+ * one response frame and the server closes the connection.
+ *
+ * Version 2 (multiplexed): the client's first frame is MUX_HELLO. A server
+ * that supports it echoes MUX_HELLO back and keeps the connection open; from
+ * then on each frame body is an 8-byte request id (network byte order)
+ * followed by the payload, and responses carry the id of their request so
+ * they may arrive in any order. A version 1 server treats the hello as an
+ * ordinary (invalid) request and answers with something else, which tells the
+ * client to fall back to version 1 for that peer.
+ *
+ * The hello may list capabilities after MUX_HELLO, space separated; the
+ * server's echo keeps those it accepts. With CAP_DEFLATE accepted, the server
+ * may compress a frame: COMPRESSED_FLAG is set in its length and the body is
+ * encoded as in frame_compression. Frames are never compressed otherwise.
+ */
+namespace fetch_protocol {
+
+inline constexpr std::string_view MUX_HELLO = "pp-fetch/2";
+inline constexpr size_t REQUEST_ID_SIZE = sizeof(uint64_t);
+
+inline constexpr std::string_view CAP_DEFLATE = "deflate";
+// Free bit of the frame length (frames are at most 16 MiB)
+inline constexpr uint32_t COMPRESSED_FLAG = 0x80000000u;
+
+inline std::string makeHello(bool isDeflate) {
+  std::string hello(MUX_HELLO);
+  if (isDeflate) {
+    hello += ' ';
+    hello += CAP_DEFLATE;
+  }
+  return hello;
+}
+
+/** False if body is not a hello; isDeflate tells whether CAP_DEFLATE is listed. */
+inline bool parseHello(std::string_view body, bool &isDeflate) {
+  isDeflate = false;
+  if (body.substr(0, MUX_HELLO.size()) != MUX_HELLO) {
+    return false;
+  }
+  std::string_view caps = body.substr(MUX_HELLO.size());
+  if (!caps.empty() && caps.front() != ' ') {
+    return false;
+  }
+  while (!caps.empty()) {
+    caps.remove_prefix(1); // separator
+    size_t end = caps.find(' ');
+    if (caps.substr(0, end) == CAP_DEFLATE) {
+      isDeflate = true;
+    }
+    caps = end == std::string_view::npos ? std::string_view() : caps.substr(end);
+  }
+  return true;
+}
+
+inline std::string packMuxFrame(uint64_t requestId, std::string_view payload) {
+  std::string body;
+  body.resize(REQUEST_ID_SIZE + payload.size());
+  for (size_t i = 0; i < REQUEST_ID_SIZE; ++i) {
+    body[i] = static_cast<char>((requestId >> (8 * (REQUEST_ID_SIZE - 1 - i))) & 0xFF);
+  }
+  body.replace(REQUEST_ID_SIZE, payload.size(), payload);
+  return body;
+}
+
+/** Split a multiplexed frame body; false if it is too short to hold an id. */
+inline bool unpackMuxFrame(std::string_view body, uint64_t &requestId,
+                           std::string_view &payload) {
+  if (body.size() < REQUEST_ID_SIZE) {
+    return false;
+  }
+  requestId = 0;
+  for (size_t i = 0; i < REQUEST_ID_SIZE; ++i) {
+    requestId = (requestId << 8) | static_cast<uint8_t>(body[i]);
+  }
+  payload = body.substr(REQUEST_ID_SIZE);
+  return true;
+}
+
+} // namespace fetch_protocol
+
+} // namespace network
+} // namespace pp
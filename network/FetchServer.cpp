@@ -1,4 +1,6 @@
 #include "FetchServer.h"
+#include "FetchProtocol.hpp"
+#include "FrameCompression.h"
 #include <algorithm>
 #include <arpa/inet.h>
 #include <cerrno>
@@ -6,6 +8,7 @@
 #include <fcntl.h>
 #include <string>
 #include <sys/socket.h>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
@@ -30,77 +33,284 @@ void unregisterRead(int queueFd, int fd) {
 #endif
 }
 
+// The 4-byte length that starts a frame with a body of bodySize bytes
+std::string makeFrameHead(uint64_t bodySize) {
+  std::string head(sizeof(uint32_t), '\0');
+  uint32_t netLen = htonl(static_cast<uint32_t>(bodySize));
+  std::memcpy(head.data(), &netLen, sizeof(netLen));
+  return head;
+}
+
+std::string makeFrame(std::string_view body) {
+  std::string framed;
+  framed.resize(sizeof(uint32_t) + body.size());
+  uint32_t netLen = htonl(static_cast<uint32_t>(body.size()));
+  std::memcpy(framed.data(), &netLen, sizeof(netLen));
+  if (!body.empty()) {
+    std::memcpy(framed.data() + sizeof(uint32_t), body.data(), body.size());
+  }
+  return framed;
+}
+
+// Read file.size bytes of the range into out
+FetchServer::Roe<void> readFileRange(const FetchServer::FileRange &file, char *out) {
+  int fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return FetchServer::Error(-3, "Failed to open " + file.path + ": " + std::strerror(errno));
+  }
+  uint64_t done = 0;
+  while (done < file.size) {
+    ssize_t n = ::pread(fd, out + done, file.size - done,
+                        static_cast<off_t>(file.offset + done));
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      ::close(fd);
+      return FetchServer::Error(-3, "Failed to read " + file.path);
+    }
+    done += static_cast<uint64_t>(n);
+  }
+  ::close(fd);
+  return {};
+}
+
 } // namespace
 
 FetchServer::FetchServer() {}
 
 FetchServer::~FetchServer() {
-#ifdef __APPLE__
-  if (kqueueFd_ >= 0) {
-    ::close(kqueueFd_);
-  }
-#else
-  if (epollFd_ >= 0) {
-    ::close(epollFd_);
+  stop();
+  for (auto &reactor : reactors_) {
+    stopReactor(*reactor);
   }
-#endif
-  // Close any remaining connections
-  for (auto& pair : activeConnections_) {
-    ::close(pair.first);
+}
+
+IpEndpoint FetchServer::getEndpoint() const {
+  if (reactors_.empty()) {
+    return config_.endpoint;
   }
+  return reactors_.front()->server.getEndpoint();
+}
+
+FetchServer::Roe<void> FetchServer::addResponse(const ReplyTarget &target,
+                                                std::string response) {
+  return queueResponse(target, std::move(response), nullptr);
+}
+
+FetchServer::Roe<void> FetchServer::addFileResponse(const ReplyTarget &target,
+                                                    std::string head,
+                                                    const FileRange &file) {
+  return queueResponse(target, std::move(head), &file);
 }
 
-FetchServer::Roe<void> FetchServer::addResponse(int fd, const std::string &response) {
-  if (response.size() > TcpConnection::MAX_FRAME_SIZE) {
-    return Error(-3, "Response frame too large: " + std::to_string(response.size()));
+FetchServer::Roe<void> FetchServer::queueResponse(const ReplyTarget &target,
+                                                  std::string head,
+                                                  const FileRange *file) {
+  if (target.reactor >= reactors_.size()) {
+    return Error(-4, "Unknown reactor " + std::to_string(target.reactor));
   }
+  Reactor &reactor = *reactors_[target.reactor];
 
-  std::string framed;
-  framed.resize(sizeof(uint32_t) + response.size());
-  uint32_t netLen = htonl(static_cast<uint32_t>(response.size()));
-  std::memcpy(framed.data(), &netLen, sizeof(netLen));
-  if (!response.empty()) {
-    std::memcpy(framed.data() + sizeof(uint32_t), response.data(), response.size());
+  const bool isMux = target.connectionId != 0;
+  const uint64_t bodySize = head.size() + (file ? file->size : 0) +
+                            (isMux ? fetch_protocol::REQUEST_ID_SIZE : 0);
+  if (bodySize > TcpConnection::MAX_FRAME_SIZE) {
+    return Error(-3, "Response frame too large: " + std::to_string(bodySize));
+  }
+
+  bool isCompressed = false;
+  if (isMux) {
+    std::lock_guard<std::mutex> lock(reactor.muxMutex);
+    auto it = reactor.mMuxConnections.find(target.fd);
+    if (it == reactor.mMuxConnections.end() || it->second.id != target.connectionId) {
+      return Error(-4, "Connection closed before response (fd=" +
+                           std::to_string(target.fd) + ")");
+    }
+    isCompressed = it->second.isCompressed;
   }
 
-  auto result = writer_.add(fd, framed);
+  std::vector<BulkWriter::Segment> segments;
+  if (isCompressed && config_.compressMinSize > 0 &&
+      bodySize >= config_.compressMinSize) {
+    auto frameResult = makeCompressedFrame(reactor, target, head, file);
+    if (!frameResult) {
+      return frameResult.error();
+    }
+    segments.push_back(BulkWriter::Segment::bytes(std::move(frameResult.value())));
+  } else {
+    // Frame length (and request id) in front of the response, which is moved
+    // into the writer rather than copied into one buffer
+    std::string prefix = makeFrameHead(bodySize);
+    if (isMux) {
+      prefix += fetch_protocol::packMuxFrame(target.requestId, {});
+    }
+    segments.push_back(BulkWriter::Segment::bytes(std::move(prefix)));
+    segments.push_back(BulkWriter::Segment::bytes(std::move(head)));
+    if (file) {
+      int fileFd = ::open(file->path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fileFd < 0) {
+        return Error(-3, "Failed to open " + file->path + ": " + std::strerror(errno));
+      }
+      segments.push_back(BulkWriter::Segment::file(fileFd, file->offset, file->size));
+    }
+  }
+
+  if (!isMux) {
+    auto result = reactor.writer.add(target.fd, std::move(segments));
+    if (!result) {
+      return Error(-3, "Failed to add response to bulk writer: " + result.error().message);
+    }
+    ++reactor.responses;
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(reactor.muxMutex);
+  auto it = reactor.mMuxConnections.find(target.fd);
+  if (it == reactor.mMuxConnections.end() || it->second.id != target.connectionId) {
+    return Error(-4, "Connection closed before response (fd=" +
+                         std::to_string(target.fd) + ")");
+  }
+  auto result = reactor.writer.append(target.fd, std::move(segments));
   if (!result) {
     return Error(-3, "Failed to add response to bulk writer: " + result.error().message);
   }
+  ++reactor.responses;
   return {};
 }
 
+FetchServer::Roe<std::string>
+FetchServer::makeCompressedFrame(Reactor &reactor, const ReplyTarget &target,
+                                 const std::string &head, const FileRange *file) {
+  std::string body = fetch_protocol::packMuxFrame(target.requestId, head);
+  if (file) {
+    // Compression needs the bytes in memory: no sendfile for this response
+    size_t headSize = body.size();
+    body.resize(headSize + file->size);
+    auto readResult = readFileRange(*file, body.data() + headSize);
+    if (!readResult) {
+      return readResult.error();
+    }
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+  auto compressed = frame_compression::compress(body, config_.compressLevel);
+  reactor.compressionMicros += static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - startTime)
+          .count());
+  reactor.compressionBytesIn += body.size();
+
+  if (!compressed || compressed.value().size() >= body.size()) {
+    // Not worth it (or failed): send the plain frame
+    reactor.compressionBytesOut += body.size();
+    return makeFrame(body);
+  }
+  const std::string &data = compressed.value();
+  reactor.compressionBytesOut += data.size();
+  ++reactor.compressedResponses;
+
+  uint32_t netLen = htonl(static_cast<uint32_t>(data.size()) |
+                          fetch_protocol::COMPRESSED_FLAG);
+  std::string frame(sizeof(netLen), '\0');
+  std::memcpy(frame.data(), &netLen, sizeof(netLen));
+  frame += data;
+  return frame;
+}
+
+std::vector<FetchServer::ReactorStats> FetchServer::getReactorStats() const {
+  std::vector<ReactorStats> stats;
+  stats.reserve(reactors_.size());
+  for (const auto &reactor : reactors_) {
+    ReactorStats s;
+    s.openConnections = reactor->openConnections;
+    s.acceptedConnections = reactor->acceptedConnections;
+    s.requests = reactor->requests;
+    s.responses = reactor->responses;
+    s.bytesRead = reactor->bytesRead;
+    s.compressedResponses = reactor->compressedResponses;
+    s.compressionBytesIn = reactor->compressionBytesIn;
+    s.compressionBytesOut = reactor->compressionBytesOut;
+    s.compressionMicros = reactor->compressionMicros;
+    stats.push_back(s);
+  }
+  return stats;
+}
+
 Service::Roe<void> FetchServer::start(const Config &config) {
   config_ = config;
+  if (config_.reactorCount == 0) {
+    config_.reactorCount = 1;
+  }
 
   log().info << "Starting server on " << config_.endpoint.address << ":"
-             << config_.endpoint.port;
+             << config_.endpoint.port << " (" << config_.reactorCount
+             << " reactor" << (config_.reactorCount > 1 ? "s" : "") << ")";
 
   // Call base class start() which will call onStart() then spawn thread
   return Service::start();
 }
 
 Service::Roe<void> FetchServer::onStart() {
+  reactors_.clear();
+  IpEndpoint endpoint = config_.endpoint;
+  for (size_t i = 0; i < config_.reactorCount; ++i) {
+    auto reactor = std::make_unique<Reactor>();
+    reactor->index = i;
+    reactor->writer.redirectLogger(log().getFullName() + ".Writer" + std::to_string(i));
+    reactor->server.setReusePort(config_.reactorCount > 1);
+    auto result = startReactor(*reactor, endpoint);
+    reactors_.push_back(std::move(reactor));
+    if (!result) {
+      for (auto &started : reactors_) {
+        stopReactor(*started);
+      }
+      return result;
+    }
+    // Later listeners join the port the first one bound (it may be ephemeral)
+    endpoint.port = reactors_.front()->server.getEndpoint().port;
+  }
+  return {};
+}
+
+Service::Roe<void> FetchServer::startReactor(Reactor& reactor, const IpEndpoint& endpoint) {
   // Create epoll/kqueue instance for monitoring connections
 #ifdef __APPLE__
-  kqueueFd_ = kqueue();
-  if (kqueueFd_ < 0) {
+  reactor.kqueueFd = kqueue();
+  if (reactor.kqueueFd < 0) {
     return Service::Error(-1, "Failed to create kqueue: " + std::string(std::strerror(errno)));
   }
 #else
-  epollFd_ = epoll_create1(0);
-  if (epollFd_ < 0) {
+  reactor.epollFd = epoll_create1(0);
+  if (reactor.epollFd < 0) {
     return Service::Error(-1, "Failed to create epoll: " + std::string(std::strerror(errno)));
   }
 #endif
 
   // Start listening
-  auto listenResult = server_.listen(config_.endpoint);
+  auto listenResult = reactor.server.listen(endpoint);
   if (!listenResult) {
     return Service::Error(-2, "Failed to start listening: " + listenResult.error().message);
   }
 
-  auto startResult = writer_.start();
+  // Watch the listening socket with the connections, so requests on open
+  // connections are served as soon as they arrive
+  const int listenFd = reactor.server.getFd();
+#ifdef __APPLE__
+  struct kevent ev;
+  EV_SET(&ev, listenFd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+  if (kevent(reactor.kqueueFd, &ev, 1, nullptr, 0, nullptr) < 0) {
+#else
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.fd = listenFd;
+  if (epoll_ctl(reactor.epollFd, EPOLL_CTL_ADD, listenFd, &ev) < 0) {
+#endif
+    return Service::Error(-2, "Failed to watch listening socket: " +
+                                  std::string(std::strerror(errno)));
+  }
+
+  auto startResult = reactor.writer.start();
   if (!startResult) {
     return Service::Error(-3, "Failed to start writer: " + startResult.error().message);
   }
@@ -108,27 +318,38 @@ Service::Roe<void> FetchServer::onStart() {
 }
 
 void FetchServer::onStop() {
-  writer_.stop();
-  server_.stop();
+  // Reactors stay allocated so late addResponse calls find them; their
+  // connection maps are empty, so such responses are rejected.
+  for (auto &reactor : reactors_) {
+    stopReactor(*reactor);
+  }
+}
+
+void FetchServer::stopReactor(Reactor& reactor) {
+  reactor.writer.stop();
+  reactor.server.stop();
   
   // Clean up epoll/kqueue
 #ifdef __APPLE__
-  if (kqueueFd_ >= 0) {
-    ::close(kqueueFd_);
-    kqueueFd_ = -1;
+  if (reactor.kqueueFd >= 0) {
+    ::close(reactor.kqueueFd);
+    reactor.kqueueFd = -1;
   }
 #else
-  if (epollFd_ >= 0) {
-    ::close(epollFd_);
-    epollFd_ = -1;
+  if (reactor.epollFd >= 0) {
+    ::close(reactor.epollFd);
+    reactor.epollFd = -1;
   }
 #endif
   
   // Close all active connections
-  for (auto& pair : activeConnections_) {
+  std::lock_guard<std::mutex> lock(reactor.muxMutex);
+  for (auto& pair : reactor.activeConnections) {
     ::close(pair.first);
   }
-  activeConnections_.clear();
+  reactor.activeConnections.clear();
+  reactor.mMuxConnections.clear();
+  reactor.openConnections = 0;
 }
 
 bool FetchServer::setNonBlocking(int fd) {
@@ -165,21 +386,21 @@ bool FetchServer::isAllowedByWhitelist(const IpEndpoint& peer) const {
                    peer.address) != config_.whitelist.end();
 }
 
-void FetchServer::processReadEvents(const std::vector<int>& readyFds) {
+void FetchServer::processReadEvents(Reactor& reactor, const std::vector<int>& readyFds) {
   for (int fd : readyFds) {
-    auto it = activeConnections_.find(fd);
-    if (it == activeConnections_.end()) {
+    auto it = reactor.activeConnections.find(fd);
+    if (it == reactor.activeConnections.end()) {
       continue; // Connection already removed
     }
     
-    readFromConnection(it->second);
+    readFromConnection(reactor, it->second);
     
     // Check if connection is complete (will be marked by readFromConnection)
     // We'll detect this by checking if recv returned 0 or error
   }
 }
 
-void FetchServer::readFromConnection(ActiveConnection& conn) {
+void FetchServer::readFromConnection(Reactor& reactor, ActiveConnection& conn) {
   char buffer[8192];
   
   while (true) {
@@ -188,14 +409,24 @@ void FetchServer::readFromConnection(ActiveConnection& conn) {
     if (bytesRead > 0) {
       // Data received, append to buffer
       conn.buffer.append(buffer, bytesRead);
+      reactor.bytesRead += static_cast<uint64_t>(bytesRead);
+      conn.lastActive = std::chrono::steady_clock::now();
       
-      // Try to parse a single framed request (one-request-per-connection).
-      if (tryParseSingleFrame(conn)) {
+      // Dispatch complete frames; stop if the connection was handed off or closed.
+      if (tryParseFrames(reactor, conn)) {
         return;
       }
     } else if (bytesRead == 0) {
+      if (conn.connectionId != 0 && conn.buffer.empty() &&
+          conn.stage == ActiveConnection::Stage::ReadLen) {
+        // Multiplexed peer closed between requests: normal end of session.
+        log().debug << "Multiplexed connection closed by " << conn.endpoint
+                    << " (fd=" << conn.fd << ")";
+        closeAndRemoveConnection(reactor, conn, "");
+        break;
+      }
       // Peer closed before completing a full frame (or after sending).
-      closeAndRemoveConnection(conn,
+      closeAndRemoveConnection(reactor, conn,
                                "Connection closed by peer while reading request from " +
                                    conn.endpoint.address + ":" +
                                    std::to_string(conn.endpoint.port) + " (fd=" +
@@ -210,30 +441,39 @@ void FetchServer::readFromConnection(ActiveConnection& conn) {
       } else {
         // Real error
         log().error << "Error reading from fd " << conn.fd << ": " << std::strerror(errno);
-        closeAndRemoveConnection(conn, "");
+        closeAndRemoveConnection(reactor, conn, "");
         break;
       }
     }
   }
 }
 
-void FetchServer::closeAndRemoveConnection(ActiveConnection& conn, const std::string& reason) {
+void FetchServer::closeAndRemoveConnection(Reactor& reactor, ActiveConnection& conn, const std::string& reason) {
   if (!reason.empty()) {
     log().error << reason;
   }
   unregisterRead(
 #ifdef __APPLE__
-      kqueueFd_,
+      reactor.kqueueFd,
 #else
-      epollFd_,
+      reactor.epollFd,
 #endif
       conn.fd);
-  ::close(conn.fd);
   int fd = conn.fd;
-  activeConnections_.erase(fd);
+  if (conn.connectionId != 0) {
+    // Drop queued responses first: once closed, the fd number may be reused
+    std::lock_guard<std::mutex> lock(reactor.muxMutex);
+    reactor.mMuxConnections.erase(fd);
+    reactor.writer.remove(fd);
+    ::close(fd);
+  } else {
+    ::close(fd);
+  }
+  reactor.activeConnections.erase(fd);
+  --reactor.openConnections;
 }
 
-void FetchServer::dispatchCompleteFrameAndRemove(ActiveConnection& conn, std::string requestBody) {
+void FetchServer::dispatchCompleteFrameAndRemove(Reactor& reactor, ActiveConnection& conn, std::string requestBody) {
   log().info << "Received complete request from " << conn.endpoint.address
              << ":" << conn.endpoint.port << " (" << requestBody.size()
              << " bytes, fd=" << conn.fd << ")";
@@ -241,15 +481,17 @@ void FetchServer::dispatchCompleteFrameAndRemove(ActiveConnection& conn, std::st
   // Stop reading; keep fd open for response (BulkWriter closes after send).
   unregisterRead(
 #ifdef __APPLE__
-      kqueueFd_,
+      reactor.kqueueFd,
 #else
-      epollFd_,
+      reactor.epollFd,
 #endif
       conn.fd);
 
+  ++reactor.requests;
   try {
     if (config_.handler) {
-      config_.handler(conn.fd, requestBody, conn.endpoint);
+      config_.handler(ReplyTarget{ conn.fd, 0, 0, reactor.index }, requestBody,
+                      conn.endpoint);
     }
     log().debug << "Request processed successfully for fd " << conn.fd;
   } catch (const std::exception &e) {
@@ -258,11 +500,62 @@ void FetchServer::dispatchCompleteFrameAndRemove(ActiveConnection& conn, std::st
   }
 
   int fd = conn.fd;
-  activeConnections_.erase(fd);
+  reactor.activeConnections.erase(fd);
+  --reactor.openConnections;
+}
+
+bool FetchServer::enableMultiplexing(Reactor& reactor, ActiveConnection& conn,
+                                     bool isDeflateOffered) {
+  // Acknowledgements are shared by all connections
+  static const auto helloFrame =
+      std::make_shared<const std::string>(makeFrame(fetch_protocol::makeHello(false)));
+  static const auto deflateHelloFrame =
+      std::make_shared<const std::string>(makeFrame(fetch_protocol::makeHello(true)));
+  const bool isCompressed = isDeflateOffered && config_.compressMinSize > 0;
+  std::vector<BulkWriter::Segment> segments;
+  segments.push_back(
+      BulkWriter::Segment::shared(isCompressed ? deflateHelloFrame : helloFrame));
+
+  std::lock_guard<std::mutex> lock(reactor.muxMutex);
+  auto result = reactor.writer.append(conn.fd, std::move(segments));
+  if (!result) {
+    log().error << "Failed to acknowledge multiplexing for " << conn.endpoint
+                << ": " << result.error().message;
+    return false;
+  }
+  conn.connectionId = nextConnectionId_++;
+  reactor.mMuxConnections[conn.fd] = Reactor::MuxConnection{ conn.connectionId, isCompressed };
+  log().debug << "Multiplexed connection from " << conn.endpoint
+              << " (fd=" << conn.fd << ", id=" << conn.connectionId
+              << (isCompressed ? ", compressed" : "") << ")";
+  return true;
+}
+
+bool FetchServer::dispatchMuxFrame(Reactor& reactor, ActiveConnection& conn, const std::string& frameBody) {
+  uint64_t requestId = 0;
+  std::string_view payload;
+  if (!fetch_protocol::unpackMuxFrame(frameBody, requestId, payload)) {
+    log().error << "Malformed multiplexed frame from " << conn.endpoint
+                << " (" << frameBody.size() << " bytes, fd=" << conn.fd << ")";
+    return false;
+  }
+
+  log().debug << "Received request " << requestId << " from " << conn.endpoint
+              << " (" << payload.size() << " bytes, fd=" << conn.fd << ")";
+  ++reactor.requests;
+  try {
+    if (config_.handler) {
+      config_.handler(ReplyTarget{ conn.fd, conn.connectionId, requestId, reactor.index },
+                      std::string(payload), conn.endpoint);
+    }
+  } catch (const std::exception &e) {
+    log().error << "Error processing request: " << e.what();
+    return false;
+  }
+  return true;
 }
 
-bool FetchServer::tryParseSingleFrame(ActiveConnection& conn) {
-  // Returns true if a complete frame was parsed and dispatched (and conn removed).
+bool FetchServer::tryParseFrames(Reactor& reactor, ActiveConnection& conn) {
   while (true) {
     if (conn.stage == ActiveConnection::Stage::ReadLen) {
       if (conn.buffer.size() < sizeof(uint32_t)) {
@@ -276,7 +569,7 @@ bool FetchServer::tryParseSingleFrame(ActiveConnection& conn) {
         log().error << "Frame too large from " << conn.endpoint.address
                     << ":" << conn.endpoint.port << " (" << len
                     << " bytes, fd=" << conn.fd << ")";
-        closeAndRemoveConnection(conn, "");
+        closeAndRemoveConnection(reactor, conn, "");
         return true;
       }
       conn.expectedLen = len;
@@ -290,47 +583,89 @@ bool FetchServer::tryParseSingleFrame(ActiveConnection& conn) {
       return false;
     }
 
-    std::string requestBody = conn.buffer.substr(0, conn.expectedLen);
-    dispatchCompleteFrameAndRemove(conn, std::move(requestBody));
-    return true;
+    std::string frameBody = conn.buffer.substr(0, conn.expectedLen);
+    conn.buffer.erase(0, conn.expectedLen);
+    conn.stage = ActiveConnection::Stage::ReadLen;
+
+    if (conn.connectionId == 0) {
+      // First frame: a hello switches to multiplexing, anything else is a
+      // one-shot request.
+      bool isDeflateOffered = false;
+      if (!fetch_protocol::parseHello(frameBody, isDeflateOffered)) {
+        dispatchCompleteFrameAndRemove(reactor, conn, std::move(frameBody));
+        return true;
+      }
+      if (!enableMultiplexing(reactor, conn, isDeflateOffered)) {
+        closeAndRemoveConnection(reactor, conn, "");
+        return true;
+      }
+      continue;
+    }
+
+    if (!dispatchMuxFrame(reactor, conn, frameBody)) {
+      closeAndRemoveConnection(reactor, conn, "");
+      return true;
+    }
   }
 }
 
-void FetchServer::pollActiveReads() {
-  if (activeConnections_.empty()) {
-    return;
-  }
+void FetchServer::waitForReactorEvents(Reactor& reactor, int timeoutMs) {
+  const int listenFd = reactor.server.getFd();
+  bool isAcceptReady = false;
+  std::vector<int> readyFds;
 #ifdef __APPLE__
   struct kevent events[32];
-  struct timespec timeout = {0, 1000000}; // 1ms
-  int n = kevent(kqueueFd_, nullptr, 0, events, 32, &timeout);
-  if (n > 0) {
-    std::vector<int> readyFds;
-    readyFds.reserve(n);
-    for (int i = 0; i < n; ++i) {
-      readyFds.push_back(static_cast<int>(events[i].ident));
-    }
-    processReadEvents(readyFds);
-  }
+  struct timespec timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+  int n = kevent(reactor.kqueueFd, nullptr, 0, events, 32, &timeout);
+  for (int i = 0; i < n; ++i) {
+    int fd = static_cast<int>(events[i].ident);
 #else
   struct epoll_event events[32];
-  int n = epoll_wait(epollFd_, events, 32, 1); // 1ms timeout
-  if (n > 0) {
-    std::vector<int> readyFds;
-    readyFds.reserve(n);
-    for (int i = 0; i < n; ++i) {
-      readyFds.push_back(events[i].data.fd);
+  int n = epoll_wait(reactor.epollFd, events, 32, timeoutMs);
+  for (int i = 0; i < n; ++i) {
+    int fd = events[i].data.fd;
+#endif
+    if (fd == listenFd) {
+      isAcceptReady = true;
+    } else {
+      readyFds.push_back(fd);
     }
-    processReadEvents(readyFds);
   }
-#endif
+
+  if (isAcceptReady) {
+    acceptPendingConnections(reactor);
+  }
+  if (!readyFds.empty()) {
+    processReadEvents(reactor, readyFds);
+  }
 }
 
-bool FetchServer::registerClientFd(int clientFd) {
+void FetchServer::closeIdleConnections(Reactor& reactor) {
+  const auto now = std::chrono::steady_clock::now();
+  if (now - reactor.lastIdleSweep < std::chrono::seconds(1)) {
+    return;
+  }
+  reactor.lastIdleSweep = now;
+
+  std::vector<int> idleFds;
+  for (const auto &[fd, conn] : reactor.activeConnections) {
+    if (conn.connectionId != 0 && now - conn.lastActive > config_.idleTimeout) {
+      idleFds.push_back(fd);
+    }
+  }
+  for (int fd : idleFds) {
+    auto it = reactor.activeConnections.find(fd);
+    log().debug << "Closing idle multiplexed connection from "
+                << it->second.endpoint << " (fd=" << fd << ")";
+    closeAndRemoveConnection(reactor, it->second, "");
+  }
+}
+
+bool FetchServer::registerClientFd(Reactor& reactor, int clientFd) {
 #ifdef __APPLE__
   struct kevent ev;
   EV_SET(&ev, clientFd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
-  if (kevent(kqueueFd_, &ev, 1, nullptr, 0, nullptr) < 0) {
+  if (kevent(reactor.kqueueFd, &ev, 1, nullptr, 0, nullptr) < 0) {
     log().error << "Failed to add fd to kqueue: " << std::strerror(errno);
     return false;
   }
@@ -338,7 +673,7 @@ bool FetchServer::registerClientFd(int clientFd) {
   struct epoll_event ev = {};
   ev.events = EPOLLIN | EPOLLET; // Edge-triggered for efficiency
   ev.data.fd = clientFd;
-  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, clientFd, &ev) < 0) {
+  if (epoll_ctl(reactor.epollFd, EPOLL_CTL_ADD, clientFd, &ev) < 0) {
     log().error << "Failed to add fd to epoll: " << std::strerror(errno);
     return false;
   }
@@ -346,9 +681,9 @@ bool FetchServer::registerClientFd(int clientFd) {
   return true;
 }
 
-void FetchServer::acceptPendingConnections() {
+void FetchServer::acceptPendingConnections(Reactor& reactor) {
   while (true) {
-    auto acceptResult = server_.accept();
+    auto acceptResult = reactor.server.accept();
     if (!acceptResult) {
       break;
     }
@@ -377,7 +712,7 @@ void FetchServer::acceptPendingConnections() {
       continue;
     }
 
-    if (!registerClientFd(clientFd)) {
+    if (!registerClientFd(reactor, clientFd)) {
       ::close(clientFd);
       continue;
     }
@@ -385,34 +720,38 @@ void FetchServer::acceptPendingConnections() {
     ActiveConnection conn;
     conn.fd = clientFd;
     conn.endpoint = peerEndpoint;
-    activeConnections_[clientFd] = std::move(conn);
+    reactor.activeConnections[clientFd] = std::move(conn);
+    ++reactor.acceptedConnections;
+    ++reactor.openConnections;
 
     log().debug << "Accepted new connection from " << peerEndpoint.address
-                << ":" << peerEndpoint.port << " (fd=" << clientFd << ")";
+                << ":" << peerEndpoint.port << " (fd=" << clientFd
+                << ", reactor " << reactor.index << ")";
   }
 }
 
 void FetchServer::runLoop() {
   log().debug << "Server loop started";
 
-  while (!isStopSet()) {
-    // Wait for events on the listening socket
-    auto waitResult = server_.waitForEvents(100); // 100ms timeout
-    if (!waitResult) {
-      // Timeout - check for ready connections
-      pollActiveReads();
-      continue;
-    }
-
-    // Accept all pending connections (edge-triggered accept must be drained).
-    acceptPendingConnections();
-
-    // Service any reads that became ready.
-    pollActiveReads();
+  // Reactor 0 runs on the service thread, the others on their own
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < reactors_.size(); ++i) {
+    threads.emplace_back([this, i]() { runReactor(*reactors_[i]); });
+  }
+  runReactor(*reactors_.front());
+  for (auto &thread : threads) {
+    thread.join();
   }
 
   log().debug << "Server loop ended";
 }
 
+void FetchServer::runReactor(Reactor& reactor) {
+  while (!isStopSet()) {
+    waitForReactorEvents(reactor, 100); // 100ms timeout
+    closeIdleConnections(reactor);
+  }
+}
+
 } // namespace network
 } // namespace pp
@@ -6,10 +6,14 @@
 #include "TcpServer.h"
 #include "TcpConnection.h"
 #include "Types.hpp"
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace pp {
 namespace network {
@@ -19,6 +23,13 @@ namespace network {
  *
  * Uses TCP sockets for peer-to-peer communication.
  * Handles multiple concurrent connections using non-blocking I/O.
+ * Serves one-shot connections and, for peers that open with the hello of
+ * fetch_protocol, persistent connections carrying many tagged requests.
+ *
+ * Runs Config::reactorCount reactors. Each has its own listening socket
+ * (SO_REUSEPORT when more than one, so the kernel spreads connections),
+ * epoll/kqueue set, writer and thread; a connection stays on the reactor
+ * that accepted it and its requests reach the handler on that thread.
  */
 class FetchServer : public Service {
 public:
@@ -28,12 +39,50 @@ public:
 
   template <typename T> using Roe = ResultOrError<T, Error>;
 
-  using RequestHandler = std::function<void(int fd, const std::string&, const IpEndpoint& endpoint)>;
+  /** Where the response to a request goes; pass it back to addResponse. */
+  struct ReplyTarget {
+    int fd{ -1 };
+    uint64_t connectionId{ 0 }; // 0: one-shot connection, closed after the response
+    uint64_t requestId{ 0 };
+    size_t reactor{ 0 };
+  };
+
+  /** A byte range of a file, sent as the tail of a response. */
+  struct FileRange {
+    std::string path;
+    uint64_t offset{ 0 };
+    uint64_t size{ 0 };
+  };
+
+  using RequestHandler = std::function<void(const ReplyTarget&, const std::string&, const IpEndpoint& endpoint)>;
 
   struct Config {
     IpEndpoint endpoint;
     RequestHandler handler{ nullptr };
     std::vector<std::string> whitelist;
+    // Multiplexed connections without requests for this long are closed
+    std::chrono::milliseconds idleTimeout{ 300000 };
+    // Reactor threads; the handler must be thread-safe when above 1
+    size_t reactorCount{ 1 };
+    // Responses of at least this many bytes are compressed for peers that
+    // negotiated it (0 disables compression)
+    size_t compressMinSize{ 4096 };
+    int compressLevel{ 1 };
+  };
+
+  /** Counters of one reactor, cumulative since start. */
+  struct ReactorStats {
+    uint64_t openConnections{ 0 };
+    uint64_t acceptedConnections{ 0 };
+    uint64_t requests{ 0 };
+    uint64_t responses{ 0 };
+    uint64_t bytesRead{ 0 };
+    // Responses that were worth compressing: sizes before and after (the
+    // smaller of compressed and plain) and time spent in the compressor
+    uint64_t compressedResponses{ 0 };
+    uint64_t compressionBytesIn{ 0 };
+    uint64_t compressionBytesOut{ 0 };
+    uint64_t compressionMicros{ 0 };
   };
 
   /**
@@ -43,9 +92,19 @@ public:
 
   ~FetchServer() override;
 
-  IpEndpoint getEndpoint() const { return server_.getEndpoint(); }
-  Roe<void> addResponse(int fd, const std::string &response);
+  IpEndpoint getEndpoint() const;
+  /** The response is moved to the writer; pass it with std::move to avoid a copy. */
+  Roe<void> addResponse(const ReplyTarget &target, std::string response);
+  /**
+   * Respond with head followed by the bytes of file, which go from the page
+   * cache to the socket without being copied into the process (sendfile).
+   */
+  Roe<void> addFileResponse(const ReplyTarget &target, std::string head,
+                            const FileRange &file);
   Service::Roe<void> start(const Config &config);
+
+  std::vector<ReactorStats> getReactorStats() const;
+
 protected:
   void runLoop() override;
 
@@ -61,8 +120,55 @@ private:
     Stage stage{ Stage::ReadLen };
     uint32_t expectedLen{ 0 };
     std::string buffer; // used for staged parsing (len header then body)
+    uint64_t connectionId{ 0 }; // non-zero once the peer switched to multiplexed frames
+    std::chrono::steady_clock::time_point lastActive{ std::chrono::steady_clock::now() };
   };
 
+  // One event loop: listener, readiness set, writer and the connections it owns
+  struct Reactor {
+    size_t index{ 0 };
+    TcpServer server;
+    BulkWriter writer;
+
+    // epoll file descriptor for monitoring connections
+#ifdef __APPLE__
+    int kqueueFd{ -1 };
+#else
+    int epollFd{ -1 };
+#endif
+
+    // Map of fd -> ActiveConnection for all connections being read
+    std::map<int, ActiveConnection> activeConnections;
+
+    struct MuxConnection {
+      uint64_t id{ 0 };
+      bool isCompressed{ false }; // peer accepted compressed frames
+    };
+
+    // fd -> open multiplexed connections, shared with addResponse callers so
+    // a response never reaches a reused fd
+    std::mutex muxMutex;
+    std::map<int, MuxConnection> mMuxConnections;
+    std::chrono::steady_clock::time_point lastIdleSweep{};
+
+    std::atomic<uint64_t> openConnections{ 0 };
+    std::atomic<uint64_t> acceptedConnections{ 0 };
+    std::atomic<uint64_t> requests{ 0 };
+    std::atomic<uint64_t> responses{ 0 };
+    std::atomic<uint64_t> bytesRead{ 0 };
+    std::atomic<uint64_t> compressedResponses{ 0 };
+    std::atomic<uint64_t> compressionBytesIn{ 0 };
+    std::atomic<uint64_t> compressionBytesOut{ 0 };
+    std::atomic<uint64_t> compressionMicros{ 0 };
+  };
+
+  // Frame head (+ file) and queue it on the target's connection
+  Roe<void> queueResponse(const ReplyTarget &target, std::string head,
+                          const FileRange *file);
+  // Whole frame for the response, compressed when that makes it smaller
+  Roe<std::string> makeCompressedFrame(Reactor &reactor, const ReplyTarget &target,
+                                       const std::string &head, const FileRange *file);
+
   // Helper: set a file descriptor to non-blocking mode
   bool setNonBlocking(int fd);
 
@@ -72,35 +178,35 @@ private:
   // Helper: true if peer is allowed by whitelist (empty whitelist = allow all)
   bool isAllowedByWhitelist(const IpEndpoint& peer) const;
 
+  Service::Roe<void> startReactor(Reactor& reactor, const IpEndpoint& endpoint);
+  void stopReactor(Reactor& reactor);
+  void runReactor(Reactor& reactor);
+
   // Helper: process read events from epoll
-  void processReadEvents(const std::vector<int>& readyFds);
+  void processReadEvents(Reactor& reactor, const std::vector<int>& readyFds);
 
   // Helper: read available data from a connection
-  void readFromConnection(ActiveConnection& conn);
-
-  // Helpers extracted from readFromConnection / runLoop
-  void closeAndRemoveConnection(ActiveConnection& conn, const std::string& reason);
-  void dispatchCompleteFrameAndRemove(ActiveConnection& conn, std::string requestBody);
-  // Returns true if a complete frame was dispatched (and conn removed).
-  bool tryParseSingleFrame(ActiveConnection& conn);
+  void readFromConnection(Reactor& reactor, ActiveConnection& conn);
+
+  // Helpers extracted from readFromConnection / runReactor
+  void closeAndRemoveConnection(Reactor& reactor, ActiveConnection& conn, const std::string& reason);
+  void dispatchCompleteFrameAndRemove(Reactor& reactor, ActiveConnection& conn, std::string requestBody);
+  // Keep conn open and acknowledge the multiplexing hello.
+  bool enableMultiplexing(Reactor& reactor, ActiveConnection& conn, bool isDeflateOffered);
+  // Dispatch one tagged request of a multiplexed connection.
+  bool dispatchMuxFrame(Reactor& reactor, ActiveConnection& conn, const std::string& frameBody);
+  // Parses and dispatches all complete frames; returns true if conn was removed.
+  bool tryParseFrames(Reactor& reactor, ActiveConnection& conn);
+
+  // One wait covering the listening socket and every open connection.
+  void waitForReactorEvents(Reactor& reactor, int timeoutMs);
+  void closeIdleConnections(Reactor& reactor);
+  bool registerClientFd(Reactor& reactor, int clientFd);
+  void acceptPendingConnections(Reactor& reactor);
 
-  void pollActiveReads();
-  bool registerClientFd(int clientFd);
-  void acceptPendingConnections();
-
-  TcpServer server_;
   Config config_;
-  BulkWriter writer_;
-
-  // epoll file descriptor for monitoring connections
-#ifdef __APPLE__
-  int kqueueFd_{ -1 };
-#else
-  int epollFd_{ -1 };
-#endif
-
-  // Map of fd -> ActiveConnection for all connections being read
-  std::map<int, ActiveConnection> activeConnections_;
+  std::vector<std::unique_ptr<Reactor>> reactors_;
+  std::atomic<uint64_t> nextConnectionId_{ 1 };
 };
 
 } // namespace network
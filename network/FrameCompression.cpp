@@ -0,0 +1,63 @@
+#include "FrameCompression.h"
+
+#include <cstdint>
+#include <zlib.h>
+
+namespace pp {
+namespace network {
+namespace frame_compression {
+
+namespace {
+
+constexpr size_t SIZE_BYTES = sizeof(uint32_t);
+
+} // namespace
+
+Roe<std::string> compress(std::string_view body, int level) {
+  if (body.size() > UINT32_MAX) {
+    return Error(1, "Body too large to compress: " + std::to_string(body.size()));
+  }
+  uLongf compressedSize = compressBound(static_cast<uLong>(body.size()));
+  std::string data(SIZE_BYTES + compressedSize, '\0');
+  uint32_t size = static_cast<uint32_t>(body.size());
+  for (size_t i = 0; i < SIZE_BYTES; ++i) {
+    data[i] = static_cast<char>((size >> (8 * (SIZE_BYTES - 1 - i))) & 0xFF);
+  }
+
+  int result = compress2(reinterpret_cast<Bytef *>(data.data() + SIZE_BYTES),
+                         &compressedSize,
+                         reinterpret_cast<const Bytef *>(body.data()),
+                         static_cast<uLong>(body.size()), level);
+  if (result != Z_OK) {
+    return Error(2, "compress2 failed: " + std::to_string(result));
+  }
+  data.resize(SIZE_BYTES + compressedSize);
+  return data;
+}
+
+Roe<std::string> decompress(std::string_view data, size_t maxSize) {
+  if (data.size() < SIZE_BYTES) {
+    return Error(3, "Compressed frame too short");
+  }
+  uint32_t size = 0;
+  for (size_t i = 0; i < SIZE_BYTES; ++i) {
+    size = (size << 8) | static_cast<uint8_t>(data[i]);
+  }
+  if (size > maxSize) {
+    return Error(4, "Decompressed frame too large: " + std::to_string(size));
+  }
+
+  std::string body(size, '\0');
+  uLongf bodySize = size;
+  int result = uncompress(reinterpret_cast<Bytef *>(body.data()), &bodySize,
+                          reinterpret_cast<const Bytef *>(data.data() + SIZE_BYTES),
+                          static_cast<uLong>(data.size() - SIZE_BYTES));
+  if (result != Z_OK || bodySize != size) {
+    return Error(5, "Invalid compressed frame (zlib " + std::to_string(result) + ")");
+  }
+  return body;
+}
+
+} // namespace frame_compression
+} // namespace network
+} // namespace pp
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "lib/common/ResultOrError.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace pp {
+namespace network {
+
+/**
+ * Body encoding of compressed fetch frames (see fetch_protocol): the 4-byte
+ * size of the original body (network byte order) followed by a zlib stream.
+ */
+namespace frame_compression {
+
+struct Error : RoeErrorBase {
+  using RoeErrorBase::RoeErrorBase;
+};
+
+template <typename T> using Roe = ResultOrError<T, Error>;
+
+/** Fast levels suit frames that are compressed once per response. */
+inline constexpr int DEFAULT_LEVEL = 1;
+
+Roe<std::string> compress(std::string_view body, int level = DEFAULT_LEVEL);
+
+/** Fails if the body would exceed maxSize once decompressed. */
+Roe<std::string> decompress(std::string_view data, size_t maxSize);
+
+} // namespace frame_compression
+
+} // namespace network
+} // namespace pp
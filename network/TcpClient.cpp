@@ -201,6 +201,17 @@ TcpClient::Roe<std::string> TcpClient::readFrame(std::chrono::milliseconds timeo
   return Roe<std::string>(r.value());
 }
 
+TcpClient::Roe<bool> TcpClient::waitReadable(std::chrono::milliseconds timeout) {
+  if (!connection_.has_value()) {
+    return Error("Not connected");
+  }
+  auto r = connection_->waitReadable(timeout);
+  if (!r) {
+    return Error(r.error().message);
+  }
+  return r.value();
+}
+
 void TcpClient::close() {
   if (connection_.has_value()) {
     connection_->close();
@@ -210,5 +221,9 @@ void TcpClient::close() {
 
 bool TcpClient::isConnected() const { return connection_.has_value(); }
 
+bool TcpClient::isIdleAndOpen() const {
+  return connection_.has_value() && connection_->isIdleAndOpen();
+}
+
 } // namespace network
 } // namespace pp
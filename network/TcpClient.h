@@ -57,6 +57,8 @@ public:
   // Framed I/O (length-prefixed messages)
   Roe<void> writeFrame(std::string_view body);
   Roe<std::string> readFrame(std::chrono::milliseconds timeout);
+  // Wait until a read would not block (see TcpConnection); false on timeout
+  Roe<bool> waitReadable(std::chrono::milliseconds timeout);
 
   // Close connection
   void close();
@@ -64,6 +66,9 @@ public:
   // Check if connected
   bool isConnected() const;
 
+  // Check that an idle connection is still usable (see TcpConnection)
+  bool isIdleAndOpen() const;
+
 private:
   std::optional<TcpConnection> connection_;
 };
@@ -1,8 +1,11 @@
 #include "TcpConnection.h"
+#include "FetchProtocol.hpp"
+#include "FrameCompression.h"
 
 #include <arpa/inet.h>
 #include <cerrno>
 #include <cstring>
+#include <poll.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
@@ -38,7 +41,12 @@ TcpConnection::Roe<void> sendAll(int fd, const void* data, size_t len) {
   auto* p = static_cast<const uint8_t*>(data);
   size_t off = 0;
   while (off < len) {
+#if defined(__linux__)
+    // A peer closing a persistent connection must not raise SIGPIPE
+    ssize_t n = ::send(fd, p + off, len - off, MSG_NOSIGNAL);
+#else
     ssize_t n = ::send(fd, p + off, len - off, 0);
+#endif
     if (n > 0) {
       off += static_cast<size_t>(n);
       continue;
@@ -201,6 +209,9 @@ TcpConnection::Roe<std::string> TcpConnection::readFrame(std::chrono::millisecon
   }
 
   uint32_t len = ntohl(netLen);
+  // Peers set the flag only after negotiating compression (fetch_protocol)
+  const bool isCompressed = (len & fetch_protocol::COMPRESSED_FLAG) != 0;
+  len &= ~fetch_protocol::COMPRESSED_FLAG;
   if (len > MAX_FRAME_SIZE) {
     return Error("Frame too large: " + std::to_string(len));
   }
@@ -214,6 +225,13 @@ TcpConnection::Roe<std::string> TcpConnection::readFrame(std::chrono::millisecon
     }
   }
 
+  if (isCompressed) {
+    auto decompressed = frame_compression::decompress(body, MAX_FRAME_SIZE);
+    if (!decompressed) {
+      return Error(decompressed.error().message);
+    }
+    return decompressed.value();
+  }
   return body;
 }
 
@@ -225,16 +243,17 @@ TcpConnection::Roe<void> TcpConnection::writeFrame(std::string_view body) {
     return Error("Frame too large: " + std::to_string(body.size()));
   }
 
+  // Header and body in one send: a separate small send would be held back
+  // by Nagle until the peer's delayed ACK on a persistent connection
+  std::string frame(sizeof(uint32_t) + body.size(), '\0');
   uint32_t netLen = htonl(static_cast<uint32_t>(body.size()));
-  auto h = sendAll(socketFd_, &netLen, sizeof(netLen));
-  if (!h) {
-    return Error(h.error().message);
-  }
+  std::memcpy(frame.data(), &netLen, sizeof(netLen));
   if (!body.empty()) {
-    auto b = sendAll(socketFd_, body.data(), body.size());
-    if (!b) {
-      return Error(b.error().message);
-    }
+    std::memcpy(frame.data() + sizeof(netLen), body.data(), body.size());
+  }
+  auto result = sendAll(socketFd_, frame.data(), frame.size());
+  if (!result) {
+    return Error(result.error().message);
   }
   return {};
 }
@@ -267,5 +286,37 @@ void TcpConnection::close() {
 
 const IpEndpoint &TcpConnection::getPeerEndpoint() const { return peer_; }
 
+TcpConnection::Roe<bool>
+TcpConnection::waitReadable(std::chrono::milliseconds timeout) {
+  if (socketFd_ < 0) {
+    return Error("Connection closed");
+  }
+  pollfd pfd{};
+  pfd.fd = socketFd_;
+  pfd.events = POLLIN;
+  const int timeoutMs = timeout.count() > 0 ? static_cast<int>(timeout.count()) : -1;
+  while (true) {
+    int n = ::poll(&pfd, 1, timeoutMs);
+    if (n > 0) {
+      return true;
+    }
+    if (n == 0) {
+      return false;
+    }
+    if (errno != EINTR) {
+      return Error("Failed to poll socket: " + std::string(std::strerror(errno)));
+    }
+  }
+}
+
+bool TcpConnection::isIdleAndOpen() const {
+  if (socketFd_ < 0) {
+    return false;
+  }
+  char byte = 0;
+  ssize_t n = ::recv(socketFd_, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+  return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
 } // namespace network
 } // namespace pp
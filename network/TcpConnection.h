@@ -52,6 +52,10 @@ public:
   Roe<std::string> readFrame(std::chrono::milliseconds timeout);
   Roe<void> writeFrame(std::string_view body);
 
+  // Wait until data (or EOF) can be read without consuming any; false on
+  // timeout (0 = wait indefinitely)
+  Roe<bool> waitReadable(std::chrono::milliseconds timeout);
+
   // Set socket send/receive timeout (0 = no timeout)
   Roe<void> setTimeout(std::chrono::milliseconds timeout);
 
@@ -61,6 +65,10 @@ public:
   // Get peer endpoint
   const IpEndpoint &getPeerEndpoint() const;
 
+  // True if the socket is open, the peer has not closed it and no unread
+  // data is pending (an idle connection that is safe to reuse)
+  bool isIdleAndOpen() const;
+
 private:
   int socketFd_;
   IpEndpoint peer_;
@@ -6,6 +6,7 @@
 #include <fcntl.h>
 #include <ifaddrs.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <string>
@@ -42,6 +43,12 @@ TcpServer::Roe<void> TcpServer::listen(const IpEndpoint &endpoint, int backlog)
     socketFd_ = -1;
     return Error("Failed to set socket options");
   }
+  if (isReusePort_ &&
+      setsockopt(socketFd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+    ::close(socketFd_);
+    socketFd_ = -1;
+    return Error("Failed to set SO_REUSEPORT");
+  }
 
   // Setup address structure
   struct sockaddr_in server_addr;
@@ -152,6 +159,11 @@ TcpServer::Roe<int> TcpServer::accept() {
     return Error("Failed to accept connection");
   }
 
+  // Responses may go out as several writes (header, then sendfile body);
+  // without this, Nagle holds the last one back until the peer's delayed ACK
+  int noDelay = 1;
+  setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
   return client_fd;
 }
 
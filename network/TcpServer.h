@@ -25,6 +25,10 @@ public:
   TcpServer(const TcpServer &) = delete;
   TcpServer &operator=(const TcpServer &) = delete;
 
+  // Let several sockets listen on one port, the kernel spreading connections
+  // across them (SO_REUSEPORT); set before listen()
+  void setReusePort(bool isEnabled) { isReusePort_ = isEnabled; }
+
   // Bind to a host and port and start listening
   Roe<void> listen(const IpEndpoint &endpoint, int backlog = 10);
 
@@ -42,6 +46,9 @@ public:
 
   IpEndpoint getEndpoint() const;
 
+  // Listening socket, for watching it from another event loop
+  int getFd() const { return socketFd_; }
+
 private:
   std::string getHost() const;
   // Helper to get the actual bound address
@@ -54,6 +61,7 @@ private:
   int epollFd_{ -1 };
 #endif
   bool listening_{ false };
+  bool isReusePort_{ false };
   IpEndpoint endpoint_;
 };
 
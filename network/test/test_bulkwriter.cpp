@@ -4,6 +4,9 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
 #include <chrono>
 #include <thread>
 
@@ -183,3 +186,122 @@ TEST(BulkWriterTest, FdClosedOnSuccessfulWrite) {
 
     EXPECT_FALSE(fdIsOpen(writer)) << "fd should have been closed after successful write";
 }
+
+// ============================================================================
+// BulkWriter: file ranges are sent in order with the in-memory segments
+// ============================================================================
+
+// Helper: write content to a temporary file and return an fd open for reading
+static int makeTempFile(const std::string &content) {
+    char path[] = "/tmp/test_bulkwriter_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return -1;
+    ::unlink(path);
+    if (::write(fd, content.data(), content.size()) != static_cast<ssize_t>(content.size())) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+TEST(BulkWriterTest, AppendFileSendsRangeInOrder) {
+    int writer = -1, reader = -1;
+    makeSocketPair(writer, reader);
+
+    // Larger than the socket buffer, so the range is sent over several passes
+    std::string content(1024 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>('a' + i % 26);
+    }
+    int fileFd = makeTempFile(content);
+    ASSERT_GE(fileFd, 0);
+
+    BulkWriter bw;
+    bw.start();
+
+    const uint64_t offset = 100;
+    const uint64_t size = content.size() - 200;
+    std::vector<BulkWriter::Segment> segments;
+    segments.push_back(BulkWriter::Segment::bytes("head:"));
+    segments.push_back(BulkWriter::Segment::file(fileFd, offset, size));
+    ASSERT_TRUE(bw.append(writer, std::move(segments)).isOk());
+    ASSERT_TRUE(bw.append(writer, ":tail").isOk());
+
+    std::string expected = "head:" + content.substr(offset, size) + ":tail";
+    std::string received;
+    char buffer[65536];
+    while (received.size() < expected.size()) {
+        ssize_t n = ::read(reader, buffer, sizeof(buffer));
+        ASSERT_GT(n, 0);
+        received.append(buffer, static_cast<size_t>(n));
+    }
+    EXPECT_EQ(received, expected);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    bw.stop();
+
+    EXPECT_FALSE(fdIsOpen(fileFd)) << "file fd should have been closed once sent";
+    EXPECT_TRUE(fdIsOpen(writer)) << "persistent fd should stay open";
+    ::close(writer);
+    ::close(reader);
+}
+
+TEST(BulkWriterTest, AddFileToClosedPeerClosesFds) {
+    int writer = -1, reader = -1;
+    makeSocketPair(writer, reader);
+    ::close(reader);
+
+    int fileFd = makeTempFile("block data");
+    ASSERT_GE(fileFd, 0);
+
+    BulkWriter bw;
+    bw.start();
+
+    // A broken pipe must fail the write, not raise SIGPIPE
+    std::vector<BulkWriter::Segment> segments;
+    segments.push_back(BulkWriter::Segment::file(fileFd, 0, 10));
+    ASSERT_TRUE(bw.add(writer, std::move(segments)).isOk());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    bw.stop();
+
+    EXPECT_FALSE(fdIsOpen(writer));
+    EXPECT_FALSE(fdIsOpen(fileFd));
+}
+
+// ============================================================================
+// BulkWriter: owned and shared segments are gathered into one stream
+// ============================================================================
+
+TEST(BulkWriterTest, SegmentsArriveInOrder) {
+    int writer = -1, reader = -1;
+    makeSocketPair(writer, reader);
+
+    BulkWriter bw;
+    bw.start();
+
+    auto shared = std::make_shared<const std::string>("shared|");
+    std::string body(256 * 1024, 'x');
+    std::vector<BulkWriter::Segment> segments;
+    segments.push_back(BulkWriter::Segment::bytes("head|"));
+    segments.push_back(BulkWriter::Segment::shared(shared));
+    segments.push_back(BulkWriter::Segment::bytes(""));
+    segments.push_back(BulkWriter::Segment::bytes(body));
+    ASSERT_TRUE(bw.append(writer, std::move(segments)).isOk());
+    ASSERT_TRUE(bw.append(writer, std::string("|end")).isOk());
+
+    std::string expected = "head|shared|" + body + "|end";
+    std::string received;
+    char buffer[65536];
+    while (received.size() < expected.size()) {
+        ssize_t n = ::read(reader, buffer, sizeof(buffer));
+        ASSERT_GT(n, 0);
+        received.append(buffer, static_cast<size_t>(n));
+    }
+    EXPECT_EQ(received, expected);
+    EXPECT_EQ(*shared, "shared|");
+
+    bw.stop();
+    ::close(writer);
+    ::close(reader);
+}
@@ -1,9 +1,18 @@
 #include "FetchClient.h"
+#include "FetchProtocol.hpp"
 #include "FetchServer.h"
+#include "FrameCompression.h"
+#include "TcpConnection.h"
+#include "TcpServer.h"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <set>
 #include <thread>
 #include <chrono>
+#include <vector>
 
 using namespace pp::network;
 
@@ -53,9 +62,9 @@ TEST_F(FetchServerTest, CreatesSuccessfully) {
 TEST_F(FetchServerTest, StartsAndStops) {
     FetchServer::Config config;
     config.endpoint = {"127.0.0.1", 18880};
-    config.handler = [this](int fd, const std::string& req, const IpEndpoint& endpoint) {
+    config.handler = [this](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint& endpoint) {
         std::string response = "Echo: " + req;
-        server->addResponse(fd, response);
+        server->addResponse(target, response);
     };
     auto started = server->start(config);
     
@@ -70,9 +79,9 @@ TEST_F(FetchServerTest, StartsAndStops) {
 TEST_F(FetchServerTest, FailsToStartOnSamePortTwice) {
     FetchServer::Config config;
     config.endpoint = {"127.0.0.1", 18881};
-    config.handler = [this](int fd, const std::string& req, const IpEndpoint& endpoint) {
+    config.handler = [this](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint& endpoint) {
         std::string response = "Echo: " + req;
-        server->addResponse(fd, response);
+        server->addResponse(target, response);
     };
     auto started1 = server->start(config);
     EXPECT_TRUE(started1.isOk());
@@ -81,7 +90,7 @@ TEST_F(FetchServerTest, FailsToStartOnSamePortTwice) {
     FetchServer server2;
     FetchServer::Config config2;
     config2.endpoint = {"127.0.0.1", 18881};
-    config2.handler = [](int fd, const std::string& req, const IpEndpoint& endpoint) {
+    config2.handler = [](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint& endpoint) {
         // This server won't start, so handler won't be called
     };
     auto started2 = server2.start(config2);
@@ -115,9 +124,9 @@ TEST_F(FetchIntegrationTest, ClientServerCommunication) {
     // Start server
     FetchServer::Config config;
     config.endpoint = {"127.0.0.1", 18882};
-    config.handler = [this](int fd, const std::string& req, const IpEndpoint& endpoint) {
+    config.handler = [this](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint& endpoint) {
         std::string response = "Echo: " + req;
-        server->addResponse(fd, response);
+        server->addResponse(target, response);
     };
     auto started = server->start(config);
     ASSERT_TRUE(started.isOk());
@@ -138,9 +147,9 @@ TEST_F(FetchIntegrationTest, MultipleRequests) {
     // Start server
     FetchServer::Config config;
     config.endpoint = {"127.0.0.1", 18883};
-    config.handler = [this](int fd, const std::string& req, const IpEndpoint& endpoint) {
+    config.handler = [this](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint& endpoint) {
         std::string response = "Response: " + req;
-        server->addResponse(fd, response);
+        server->addResponse(target, response);
     };
     auto started = server->start(config);
     ASSERT_TRUE(started.isOk());
@@ -162,9 +171,9 @@ TEST_F(FetchIntegrationTest, AsyncFetch) {
     // Start server
     FetchServer::Config config;
     config.endpoint = {"127.0.0.1", 18884};
-    config.handler = [this](int fd, const std::string& req, const IpEndpoint& endpoint) {
+    config.handler = [this](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint& endpoint) {
         std::string response = "Async: " + req;
-        server->addResponse(fd, response);
+        server->addResponse(target, response);
     };
     auto started = server->start(config);
     ASSERT_TRUE(started);
@@ -197,7 +206,7 @@ TEST_F(FetchIntegrationTest, FetchSyncTimesOutWhenServerStalls) {
     // Start a server that accepts connections but never responds
     FetchServer::Config config;
     config.endpoint = {"127.0.0.1", 18885};
-    config.handler = [](int fd, const std::string& req, const IpEndpoint& endpoint) {
+    config.handler = [](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint& endpoint) {
         // Intentionally do nothing - simulate a stalled server
     };
     auto started = server->start(config);
@@ -224,8 +233,8 @@ TEST_F(FetchIntegrationTest, ConcurrentFetchSyncNoTimeouts) {
     // Start server
     FetchServer::Config config;
     config.endpoint = {"127.0.0.1", 18886};
-    config.handler = [this](int fd, const std::string& req, const IpEndpoint&) {
-        server->addResponse(fd, "Echo: " + req);
+    config.handler = [this](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        server->addResponse(target, "Echo: " + req);
     };
     auto started = server->start(config);
     ASSERT_TRUE(started.isOk());
@@ -262,3 +271,462 @@ TEST_F(FetchIntegrationTest, ConcurrentFetchSyncNoTimeouts) {
 
     server->stop();
 }
+
+TEST_F(FetchIntegrationTest, MultiplexedResponsesReturnOutOfOrder) {
+    constexpr int kRequests = 8;
+    std::mutex mutex;
+    std::vector<std::pair<FetchServer::ReplyTarget, std::string>> pending;
+    std::set<uint64_t> connectionIds;
+
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18887};
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        connectionIds.insert(target.connectionId);
+        if (req == "warmup") {
+            server->addResponse(target, "ready");
+            return;
+        }
+        pending.emplace_back(target, req);
+        if (pending.size() == kRequests) {
+            // Answer in reverse arrival order
+            for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+                server->addResponse(it->first, "Echo: " + it->second);
+            }
+        }
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Open the session first so all requests share it
+    client->setPoolConfig({ .maxConnectionsPerPeer = 1, .idleTimeout = std::chrono::milliseconds(60000) });
+    auto warmup = client->fetchSync({"127.0.0.1", 18887}, "warmup");
+    ASSERT_TRUE(warmup.isOk()) << warmup.error().message;
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kRequests; ++i) {
+        threads.emplace_back([this, i, &failures]() {
+            std::string msg = "m" + std::to_string(i);
+            auto result = client->fetchSync({"127.0.0.1", 18887}, msg, std::chrono::milliseconds(3000));
+            if (!result.isOk() || result.value() != "Echo: " + msg) {
+                failures.fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(failures.load(), 0);
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(connectionIds.size(), 1u);
+    EXPECT_NE(*connectionIds.begin(), 0u);
+    server->stop();
+}
+
+TEST_F(FetchIntegrationTest, MultiplexedSessionIsReused) {
+    std::set<uint64_t> connectionIds;
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18888};
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        connectionIds.insert(target.connectionId);
+        server->addResponse(target, "Echo: " + req);
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for (int i = 0; i < 20; ++i) {
+        auto result = client->fetchSync({"127.0.0.1", 18888}, std::to_string(i));
+        ASSERT_TRUE(result.isOk()) << result.error().message;
+        EXPECT_EQ(result.value(), "Echo: " + std::to_string(i));
+    }
+    server->stop();
+
+    ASSERT_EQ(connectionIds.size(), 1u);
+    EXPECT_NE(*connectionIds.begin(), 0u);
+}
+
+TEST_F(FetchIntegrationTest, OneShotClientIsStillServed) {
+    std::set<uint64_t> connectionIds;
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18889};
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        connectionIds.insert(target.connectionId);
+        server->addResponse(target, "Echo: " + req);
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    client->setMultiplexEnabled(false);
+    for (int i = 0; i < 3; ++i) {
+        auto result = client->fetchSync({"127.0.0.1", 18889}, "Hello");
+        ASSERT_TRUE(result.isOk()) << result.error().message;
+        EXPECT_EQ(result.value(), "Echo: Hello");
+    }
+    server->stop();
+
+    EXPECT_EQ(connectionIds, std::set<uint64_t>{0});
+}
+
+TEST_F(FetchIntegrationTest, FallsBackToOneShotForLegacyPeer) {
+    // A version 1 peer: one frame in, one frame out, close
+    TcpServer legacy;
+    ASSERT_TRUE(legacy.listen({"127.0.0.1", 18890}).isOk());
+    std::atomic<bool> isStopped{false};
+    std::atomic<int> connections{0};
+    std::thread peer([&]() {
+        while (!isStopped) {
+            if (!legacy.waitForEvents(50)) {
+                continue;
+            }
+            while (true) {
+                auto fd = legacy.accept();
+                if (!fd) {
+                    break;
+                }
+                connections.fetch_add(1);
+                TcpConnection conn(fd.value());
+                auto req = conn.readFrame(std::chrono::milliseconds(1000));
+                if (req) {
+                    conn.writeFrame("Legacy: " + req.value());
+                }
+            }
+        }
+    });
+
+    for (int i = 0; i < 3; ++i) {
+        auto result = client->fetchSync({"127.0.0.1", 18890}, "Hello");
+        ASSERT_TRUE(result.isOk()) << result.error().message;
+        EXPECT_EQ(result.value(), "Legacy: Hello");
+    }
+    isStopped = true;
+    peer.join();
+    legacy.stop();
+
+    // One rejected hello, then one connection per request
+    EXPECT_EQ(connections.load(), 4);
+}
+
+TEST_F(FetchIntegrationTest, LegacyPeerIsRetriedAfterTtl) {
+    TcpServer legacy;
+    ASSERT_TRUE(legacy.listen({"127.0.0.1", 18897}).isOk());
+    std::atomic<bool> isStopped{false};
+    std::atomic<int> connections{0};
+    std::thread peer([&]() {
+        while (!isStopped) {
+            if (!legacy.waitForEvents(50)) {
+                continue;
+            }
+            while (true) {
+                auto fd = legacy.accept();
+                if (!fd) {
+                    break;
+                }
+                connections.fetch_add(1);
+                TcpConnection conn(fd.value());
+                auto req = conn.readFrame(std::chrono::milliseconds(1000));
+                if (req) {
+                    conn.writeFrame("Legacy: " + req.value());
+                }
+            }
+        }
+    });
+
+    client->setPoolConfig({ .maxConnectionsPerPeer = 1,
+                            .idleTimeout = std::chrono::milliseconds(60000),
+                            .legacyPeerTtl = std::chrono::milliseconds(0) });
+    for (int i = 0; i < 2; ++i) {
+        auto result = client->fetchSync({"127.0.0.1", 18897}, "Hello");
+        ASSERT_TRUE(result.isOk()) << result.error().message;
+        EXPECT_EQ(result.value(), "Legacy: Hello");
+    }
+    isStopped = true;
+    peer.join();
+    legacy.stop();
+
+    // The expired entry makes every request offer multiplexing again
+    EXPECT_EQ(connections.load(), 4);
+}
+
+TEST_F(FetchIntegrationTest, TimeoutFailsOnlyTheWaitingRequest) {
+    std::mutex mutex;
+    std::set<uint64_t> connectionIds;
+    std::vector<std::thread> responders;
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18898};
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        connectionIds.insert(target.connectionId);
+        if (req == "stall") {
+            return;
+        }
+        // Answer after the stalled request's deadline has passed
+        responders.emplace_back([this, target, req]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(req == "slow" ? 400 : 0));
+            server->addResponse(target, "Echo: " + req);
+        });
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    client->setPoolConfig({ .maxConnectionsPerPeer = 1, .idleTimeout = std::chrono::milliseconds(60000) });
+    ASSERT_TRUE(client->fetchSync({"127.0.0.1", 18898}, "warmup").isOk());
+
+    std::thread stalled([this]() {
+        auto result = client->fetchSync({"127.0.0.1", 18898}, "stall", std::chrono::milliseconds(200));
+        ASSERT_FALSE(result.isOk());
+        EXPECT_EQ(result.error().code, FetchClient::E_TIMEOUT);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto slow = client->fetchSync({"127.0.0.1", 18898}, "slow", std::chrono::milliseconds(3000));
+    stalled.join();
+    ASSERT_TRUE(slow.isOk()) << slow.error().message;
+    EXPECT_EQ(slow.value(), "Echo: slow");
+
+    auto after = client->fetchSync({"127.0.0.1", 18898}, "after", std::chrono::milliseconds(3000));
+    ASSERT_TRUE(after.isOk()) << after.error().message;
+    EXPECT_EQ(after.value(), "Echo: after");
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(connectionIds.size(), 1u);
+    }
+
+    for (auto& t : responders) {
+        t.join();
+    }
+    server->stop();
+}
+
+TEST_F(FetchIntegrationTest, PoolOpensConnectionsOnlyWhenBusy) {
+    std::mutex mutex;
+    std::set<uint64_t> connectionIds;
+    std::vector<std::thread> responders;
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18891};
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        connectionIds.insert(target.connectionId);
+        responders.emplace_back([this, target, req]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            server->addResponse(target, "Echo: " + req);
+        });
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    client->setPoolConfig({ .maxConnectionsPerPeer = 2, .idleTimeout = std::chrono::milliseconds(60000) });
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 6; ++i) {
+        threads.emplace_back([this, i, &failures]() {
+            std::string msg = "m" + std::to_string(i);
+            auto result = client->fetchSync({"127.0.0.1", 18891}, msg, std::chrono::milliseconds(3000));
+            if (!result.isOk() || result.value() != "Echo: " + msg) {
+                failures.fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_GE(client->getPoolSize({"127.0.0.1", 18891}), 1u);
+    EXPECT_LE(client->getPoolSize({"127.0.0.1", 18891}), 2u);
+
+    // Sequential requests reuse an idle pooled connection
+    std::set<uint64_t> before;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        before = connectionIds;
+    }
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(client->fetchSync({"127.0.0.1", 18891}, "again").isOk());
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(connectionIds, before);
+    }
+
+    for (auto& t : responders) {
+        t.join();
+    }
+    server->stop();
+}
+
+TEST_F(FetchIntegrationTest, PoolClosesIdleConnections) {
+    std::set<uint64_t> connectionIds;
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18892};
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        connectionIds.insert(target.connectionId);
+        server->addResponse(target, "Echo: " + req);
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    client->setPoolConfig({ .maxConnectionsPerPeer = 4, .idleTimeout = std::chrono::milliseconds(50) });
+    ASSERT_TRUE(client->fetchSync({"127.0.0.1", 18892}, "a").isOk());
+    EXPECT_EQ(client->getPoolSize({"127.0.0.1", 18892}), 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    EXPECT_EQ(client->getPoolSize({"127.0.0.1", 18892}), 0u);
+
+    ASSERT_TRUE(client->fetchSync({"127.0.0.1", 18892}, "b").isOk());
+    server->stop();
+    EXPECT_EQ(connectionIds.size(), 2u);
+}
+
+TEST_F(FetchIntegrationTest, PoolReplacesConnectionClosedByServer) {
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18893};
+    config.idleTimeout = std::chrono::milliseconds(100);
+    config.handler = [this](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        server->addResponse(target, "Echo: " + req);
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(client->fetchSync({"127.0.0.1", 18893}, "a").isOk());
+    // The server sweeps idle connections about once per second
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+
+    auto result = client->fetchSync({"127.0.0.1", 18893}, "b");
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(result.value(), "Echo: b");
+    server->stop();
+}
+
+TEST_F(FetchIntegrationTest, ReactorsShareThePortAndReportStats) {
+    std::mutex mutex;
+    std::set<std::thread::id> handlerThreads;
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18894};
+    config.reactorCount = 4;
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            handlerThreads.insert(std::this_thread::get_id());
+        }
+        server->addResponse(target, "Echo: " + req);
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // One-shot requests: each arrives on a new connection
+    constexpr int kRequests = 32;
+    client->setMultiplexEnabled(false);
+    for (int i = 0; i < kRequests; ++i) {
+        auto result = client->fetchSync({"127.0.0.1", 18894}, std::to_string(i));
+        ASSERT_TRUE(result.isOk()) << result.error().message;
+        EXPECT_EQ(result.value(), "Echo: " + std::to_string(i));
+    }
+
+    // A reactor counts a response once written, which can be just after the
+    // client has read it
+    uint64_t accepted = 0, requests = 0, responses = 0;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        auto stats = server->getReactorStats();
+        ASSERT_EQ(stats.size(), 4u);
+        accepted = requests = responses = 0;
+        for (const auto& s : stats) {
+            accepted += s.acceptedConnections;
+            requests += s.requests;
+            responses += s.responses;
+        }
+        if (responses >= static_cast<uint64_t>(kRequests)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(accepted, static_cast<uint64_t>(kRequests));
+    EXPECT_EQ(requests, static_cast<uint64_t>(kRequests));
+    EXPECT_EQ(responses, static_cast<uint64_t>(kRequests));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_GT(handlerThreads.size(), 1u);
+    }
+    server->stop();
+}
+
+TEST(FetchProtocolTest, HelloCarriesCapabilities) {
+    bool isDeflate = true;
+    EXPECT_TRUE(fetch_protocol::parseHello(fetch_protocol::MUX_HELLO, isDeflate));
+    EXPECT_FALSE(isDeflate);
+    EXPECT_TRUE(fetch_protocol::parseHello(fetch_protocol::makeHello(true), isDeflate));
+    EXPECT_TRUE(isDeflate);
+    EXPECT_TRUE(fetch_protocol::parseHello("pp-fetch/2 other deflate", isDeflate));
+    EXPECT_TRUE(isDeflate);
+    EXPECT_FALSE(fetch_protocol::parseHello("pp-fetch/20", isDeflate));
+    EXPECT_FALSE(fetch_protocol::parseHello("hello", isDeflate));
+}
+
+TEST(FrameCompressionTest, RoundTripsAndRejectsOversizedFrames) {
+    std::string body(100000, 'a');
+    auto compressed = frame_compression::compress(body);
+    ASSERT_TRUE(compressed.isOk());
+    EXPECT_LT(compressed.value().size(), body.size() / 10);
+
+    auto decompressed = frame_compression::decompress(compressed.value(), body.size());
+    ASSERT_TRUE(decompressed.isOk()) << decompressed.error().message;
+    EXPECT_EQ(decompressed.value(), body);
+
+    EXPECT_FALSE(frame_compression::decompress(compressed.value(), body.size() - 1).isOk());
+    EXPECT_FALSE(frame_compression::decompress("\0\0\0\x05garbage", 100).isOk());
+}
+
+TEST_F(FetchIntegrationTest, LargeResponsesAreCompressedWhenNegotiated) {
+    const std::string large(64 * 1024, 'z');
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18895};
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string& req, const IpEndpoint&) {
+        server->addResponse(target, req == "large" ? large : "small");
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Pooled session (TcpConnection::readFrame)
+    auto small = client->fetchSync({"127.0.0.1", 18895}, "tiny");
+    ASSERT_TRUE(small.isOk()) << small.error().message;
+    EXPECT_EQ(small.value(), "small");
+    auto result = client->fetchSync({"127.0.0.1", 18895}, "large");
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(result.value(), large);
+
+    // Event loop engine
+    std::promise<std::string> promise;
+    client->fetch({"127.0.0.1", 18895}, "large", [&](const auto& asyncResult) {
+        promise.set_value(asyncResult.isOk() ? asyncResult.value() : asyncResult.error().message);
+    });
+    auto future = promise.get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(future.get(), large);
+
+    auto stats = server->getReactorStats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].compressedResponses, 2u);
+    EXPECT_LT(stats[0].compressionBytesOut, stats[0].compressionBytesIn / 10);
+    server->stop();
+}
+
+TEST_F(FetchIntegrationTest, CompressionCanBeDisabled) {
+    const std::string large(64 * 1024, 'z');
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18896};
+    config.compressMinSize = 0;
+    config.handler = [&](const FetchServer::ReplyTarget& target, const std::string&, const IpEndpoint&) {
+        server->addResponse(target, large);
+    };
+    ASSERT_TRUE(server->start(config).isOk());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto result = client->fetchSync({"127.0.0.1", 18896}, "large");
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(result.value(), large);
+
+    auto stats = server->getReactorStats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].compressedResponses, 0u);
+    EXPECT_EQ(stats[0].compressionBytesIn, 0u);
+    server->stop();
+}
@@ -0,0 +1,269 @@
+#include "FetchEngine.h"
+#include "FetchServer.h"
+#include "TcpConnection.h"
+#include "TcpServer.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace pp::network;
+using namespace std::chrono_literals;
+
+namespace {
+
+/** Fire-and-forget coroutine; results are handed out through a promise. */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+DetachedTask fetchInSequence(FetchEngine& engine, IpEndpoint endpoint,
+                             std::promise<std::vector<std::string>>& done) {
+    std::vector<std::string> responses;
+    for (const char* request : {"one", "two", "three"}) {
+        auto result = co_await engine.fetch(endpoint, request, 2000ms);
+        responses.push_back(result ? result.value() : "error: " + result.error().message);
+    }
+    done.set_value(responses);
+}
+
+/** Collects callback results and lets the test wait for a number of them. */
+struct Completions {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<FetchEngine::Roe<std::string>> results;
+
+    FetchEngine::Callback callback() {
+        return [this](const FetchEngine::Roe<std::string>& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(result);
+            cv.notify_all();
+        };
+    }
+
+    bool waitFor(size_t count, std::chrono::milliseconds timeout = 5000ms) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, timeout, [&] { return results.size() >= count; });
+    }
+};
+
+/** A version 1 peer: one frame in, one frame out, close. */
+struct LegacyPeer {
+    TcpServer server;
+    std::atomic<bool> isStopped{false};
+    std::atomic<int> connections{0};
+    std::thread thread;
+
+    explicit LegacyPeer(uint16_t port) {
+        EXPECT_TRUE(server.listen({"127.0.0.1", port}).isOk());
+        thread = std::thread([this]() {
+            while (!isStopped) {
+                if (!server.waitForEvents(50)) {
+                    continue;
+                }
+                while (true) {
+                    auto fd = server.accept();
+                    if (!fd) {
+                        break;
+                    }
+                    connections.fetch_add(1);
+                    TcpConnection conn(fd.value());
+                    auto req = conn.readFrame(std::chrono::milliseconds(1000));
+                    if (req) {
+                        conn.writeFrame("Legacy: " + req.value());
+                    }
+                }
+            }
+        });
+    }
+
+    ~LegacyPeer() { stop(); }
+
+    void stop() {
+        isStopped = true;
+        if (thread.joinable()) {
+            thread.join();
+        }
+        server.stop();
+    }
+};
+
+} // namespace
+
+class FetchEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(engine.start().isOk());
+    }
+
+    void TearDown() override {
+        engine.stop();
+        server.stop();
+    }
+
+    void startEchoServer(uint16_t port) {
+        FetchServer::Config config;
+        config.endpoint = {"127.0.0.1", port};
+        config.handler = [this](const FetchServer::ReplyTarget& target, const std::string& req,
+                                const IpEndpoint& endpoint) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                connectionIds.insert(target.connectionId);
+            }
+            server.addResponse(target, "Echo: " + req);
+        };
+        ASSERT_TRUE(server.start(config).isOk());
+    }
+
+    FetchEngine engine;
+    FetchServer server;
+    std::mutex mutex;
+    std::set<uint64_t> connectionIds;
+};
+
+TEST_F(FetchEngineTest, ManyConcurrentRequestsShareOneConnection) {
+    startEchoServer(18900);
+
+    constexpr size_t COUNT = 500;
+    std::mutex resultMutex;
+    std::vector<std::string> responses(COUNT);
+    Completions completions;
+    for (size_t i = 0; i < COUNT; ++i) {
+        engine.submit({"127.0.0.1", 18900}, std::to_string(i), 5000ms,
+                      [&, i, done = completions.callback()](const FetchEngine::Roe<std::string>& result) {
+                          if (result) {
+                              std::lock_guard<std::mutex> lock(resultMutex);
+                              responses[i] = result.value();
+                          }
+                          done(result);
+                      });
+    }
+    ASSERT_TRUE(completions.waitFor(COUNT));
+
+    for (size_t i = 0; i < COUNT; ++i) {
+        EXPECT_EQ(responses[i], "Echo: " + std::to_string(i));
+    }
+    EXPECT_EQ(engine.getPendingCount(), 0u);
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(connectionIds.size(), 1u);
+}
+
+TEST_F(FetchEngineTest, StalledRequestTimesOut) {
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18901};
+    config.handler = [](const FetchServer::ReplyTarget&, const std::string&, const IpEndpoint&) {
+        // Never answers
+    };
+    ASSERT_TRUE(server.start(config).isOk());
+
+    Completions completions;
+    auto before = std::chrono::steady_clock::now();
+    engine.submit({"127.0.0.1", 18901}, "Hello", 200ms, completions.callback());
+    ASSERT_TRUE(completions.waitFor(1));
+    auto elapsed = std::chrono::steady_clock::now() - before;
+
+    ASSERT_FALSE(completions.results[0].isOk());
+    EXPECT_EQ(completions.results[0].error().code, FetchEngine::E_TIMEOUT);
+    EXPECT_GT(elapsed, 150ms);
+    EXPECT_LT(elapsed, 2000ms);
+}
+
+TEST_F(FetchEngineTest, CancelCompletesRequest) {
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18902};
+    config.handler = [](const FetchServer::ReplyTarget&, const std::string&, const IpEndpoint&) {};
+    ASSERT_TRUE(server.start(config).isOk());
+
+    Completions completions;
+    auto id = engine.submit({"127.0.0.1", 18902}, "Hello", 0ms, completions.callback());
+    std::this_thread::sleep_for(50ms);
+    engine.cancel(id);
+    ASSERT_TRUE(completions.waitFor(1));
+    ASSERT_FALSE(completions.results[0].isOk());
+    EXPECT_EQ(completions.results[0].error().code, FetchEngine::E_CANCELLED);
+}
+
+TEST_F(FetchEngineTest, ConnectFailureIsReported) {
+    Completions completions;
+    engine.submit({"127.0.0.1", 18903}, "Hello", 1000ms, completions.callback());
+    ASSERT_TRUE(completions.waitFor(1));
+    ASSERT_FALSE(completions.results[0].isOk());
+    EXPECT_EQ(completions.results[0].error().code, FetchEngine::E_CONNECT);
+}
+
+TEST_F(FetchEngineTest, StopFailsPendingRequests) {
+    FetchServer::Config config;
+    config.endpoint = {"127.0.0.1", 18904};
+    config.handler = [](const FetchServer::ReplyTarget&, const std::string&, const IpEndpoint&) {};
+    ASSERT_TRUE(server.start(config).isOk());
+
+    Completions completions;
+    engine.submit({"127.0.0.1", 18904}, "Hello", 0ms, completions.callback());
+    std::this_thread::sleep_for(50ms);
+    engine.stop();
+    ASSERT_TRUE(completions.waitFor(1));
+    EXPECT_EQ(completions.results[0].error().code, FetchEngine::E_STOPPED);
+
+    // Submits after stop fail right away
+    engine.submit({"127.0.0.1", 18904}, "Hello", 0ms, completions.callback());
+    ASSERT_TRUE(completions.waitFor(2, 0ms));
+    EXPECT_EQ(completions.results[1].error().code, FetchEngine::E_STOPPED);
+}
+
+TEST_F(FetchEngineTest, CoroutineAwaitsResponses) {
+    startEchoServer(18905);
+
+    std::promise<std::vector<std::string>> done;
+    auto future = done.get_future();
+    fetchInSequence(engine, {"127.0.0.1", 18905}, done);
+    ASSERT_EQ(future.wait_for(5s), std::future_status::ready);
+    EXPECT_EQ(future.get(), (std::vector<std::string>{"Echo: one", "Echo: two", "Echo: three"}));
+}
+
+TEST_F(FetchEngineTest, FallsBackToOneShotForLegacyPeer) {
+    LegacyPeer legacy(18906);
+    Completions completions;
+    for (int i = 0; i < 3; ++i) {
+        engine.submit({"127.0.0.1", 18906}, "Hello", 2000ms, completions.callback());
+    }
+    bool isDone = completions.waitFor(3);
+    legacy.stop();
+
+    ASSERT_TRUE(isDone);
+    for (const auto& result : completions.results) {
+        ASSERT_TRUE(result.isOk()) << result.error().message;
+        EXPECT_EQ(result.value(), "Legacy: Hello");
+    }
+    // One rejected hello, then one connection per request
+    EXPECT_EQ(legacy.connections.load(), 4);
+}
+
+TEST_F(FetchEngineTest, LegacyPeerIsRetriedAfterTtl) {
+    LegacyPeer legacy(18907);
+    engine.setLegacyPeerTtl(0ms);
+    Completions completions;
+    for (size_t i = 1; i <= 2; ++i) {
+        engine.submit({"127.0.0.1", 18907}, "Hello", 2000ms, completions.callback());
+        ASSERT_TRUE(completions.waitFor(i));
+    }
+    legacy.stop();
+
+    for (const auto& result : completions.results) {
+        ASSERT_TRUE(result.isOk()) << result.error().message;
+        EXPECT_EQ(result.value(), "Legacy: Hello");
+    }
+    // The expired mark sends each request through a hello again
+    EXPECT_EQ(legacy.connections.load(), 4);
+}
@@ -92,6 +92,7 @@ Napi::Object ClientWrapper::Init(Napi::Env env, Napi::Object exports) {
       InstanceMethod("fetchUserAccount", &ClientWrapper::FetchUserAccount),
       InstanceMethod("fetchTransactionsByWallet", &ClientWrapper::FetchTransactionsByWallet),
       InstanceMethod("fetchTransactionByIndex", &ClientWrapper::FetchTransactionByIndex),
+      InstanceMethod("fetchTransactionProof", &ClientWrapper::FetchTransactionProof),
       InstanceMethod("buildTransactionHex", &ClientWrapper::BuildTransactionHex),
       InstanceMethod("addTransaction", &ClientWrapper::AddTransaction),
     }
@@ -301,6 +302,47 @@ Napi::Value ClientWrapper::FetchTransactionByIndex(const Napi::CallbackInfo& inf
   });
 }
 
+Napi::Value ClientWrapper::FetchTransactionProof(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() != 1 || !info[0].IsObject()) {
+    throw Napi::TypeError::New(env, "fetchTransactionProof(request) expects an object");
+  }
+
+  Napi::Object requestObj = info[0].As<Napi::Object>();
+  if (!requestObj.Has("txIndex")) {
+    throw Napi::TypeError::New(env, "request.txIndex is required");
+  }
+
+  Client::TxGetByIndexRequest request;
+  request.txIndex = ValueToUint64(env, requestObj.Get("txIndex"), "txIndex");
+
+  // Optional trusted block hash; without it the proof is only checked
+  // against the block hash the server returned.
+  std::string expectedBlockHash;
+  if (requestObj.Has("expectedBlockHash")) {
+    if (!requestObj.Get("expectedBlockHash").IsString()) {
+      throw Napi::TypeError::New(env, "request.expectedBlockHash must be a string");
+    }
+    expectedBlockHash = requestObj.Get("expectedBlockHash").As<Napi::String>().Utf8Value();
+  }
+
+  return queueJson(env, [this, request, expectedBlockHash](std::string& outJson,
+                                                          std::string& errorMessage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto result = client_.fetchTransactionProof(request);
+    if (!result) {
+      errorMessage = result.error().message;
+      return false;
+    }
+    if (!expectedBlockHash.empty() && result.value().blockHash != expectedBlockHash) {
+      errorMessage = "Transaction proof block hash mismatch: " + result.value().blockHash;
+      return false;
+    }
+    outJson = pp::common::io::metaToJsonString(result.value().ltsToMeta());
+    return true;
+  });
+}
+
 Napi::Value ClientWrapper::BuildTransactionHex(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   if (info.Length() != 1 || !info[0].IsObject()) {
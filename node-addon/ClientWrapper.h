@@ -28,6 +28,7 @@ private:
   Napi::Value FetchUserAccount(const Napi::CallbackInfo& info);
   Napi::Value FetchTransactionsByWallet(const Napi::CallbackInfo& info);
   Napi::Value FetchTransactionByIndex(const Napi::CallbackInfo& info);
+  Napi::Value FetchTransactionProof(const Napi::CallbackInfo& info);
   Napi::Value BuildTransactionHex(const Napi::CallbackInfo& info);
   Napi::Value AddTransaction(const Napi::CallbackInfo& info);
 
@@ -26,6 +26,12 @@ interface FetchTransactionByIndexRequest {
   txIndex: number | string;
 }
 
+interface FetchTransactionProofRequest {
+  txIndex: number | string;
+  /** Trusted block hash the proof must resolve to. */
+  expectedBlockHash?: string;
+}
+
 declare class Client {
   constructor(endpoint?: string);
 
@@ -39,6 +45,8 @@ declare class Client {
   fetchUserAccount(accountId: number | string): Promise<Record<string, unknown>>;
   fetchTransactionsByWallet(request: FetchTransactionsByWalletRequest): Promise<Record<string, unknown>>;
   fetchTransactionByIndex(request: FetchTransactionByIndexRequest): Promise<Record<string, unknown>>;
+  /** Resolves only if the record's Merkle proof verifies. */
+  fetchTransactionProof(request: FetchTransactionProofRequest): Promise<Record<string, unknown>>;
 
   buildTransactionHex(request: BuildTransactionRequest): string;
   addTransaction(request: AddTransactionRequest): Promise<boolean>;
@@ -50,5 +58,6 @@ export type {
   AddTransactionRequest,
   FetchTransactionsByWalletRequest,
   FetchTransactionByIndexRequest,
+  FetchTransactionProofRequest,
 };
 export = addon;
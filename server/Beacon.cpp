@@ -56,6 +56,12 @@ uint64_t Beacon::getCurrentSlot() const { return chain_.getCurrentSlot(); }
 
 uint64_t Beacon::getCurrentEpoch() const { return chain_.getCurrentEpoch(); }
 
+uint64_t Beacon::getSlotDuration() const { return chain_.getSlotDuration(); }
+
+int64_t Beacon::getSlotStartTime(uint64_t slot) const {
+  return chain_.getSlotStartTime(slot);
+}
+
 std::vector<consensus::Stakeholder> Beacon::getStakeholders() const {
   return chain_.getStakeholders();
 }
@@ -68,6 +74,14 @@ Beacon::Roe<Ledger::ChainNode> Beacon::readBlock(uint64_t blockId) const {
   return result.value();
 }
 
+Beacon::Roe<Ledger::BlockLocation> Beacon::readRawBlock(uint64_t blockId) const {
+  auto result = chain_.readRawBlock(blockId);
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+  return result.value();
+}
+
 Beacon::Roe<Client::UserAccount> Beacon::getAccount(uint64_t accountId) const {
   auto result = chain_.getAccount(accountId);
   if (!result) {
@@ -98,6 +112,15 @@ Beacon::findTransactionByIndex(uint64_t txIndex) const {
   return result.value();
 }
 
+Beacon::Roe<Ledger::TxProof>
+Beacon::findTransactionProof(uint64_t txIndex) const {
+  auto result = chain_.findTransactionProof(txIndex);
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+  return result.value();
+}
+
 pp::common::Meta Beacon::InitKeyConfig::ltsToMeta() const {
   auto pairsToMeta = [](const std::vector<utl::Ed25519KeyPair> &pairs) {
     std::vector<pp::common::Meta::Value> elems;
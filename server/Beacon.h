@@ -72,10 +72,15 @@ public:
   uint64_t getNextBlockId() const;
   uint64_t getCurrentSlot() const;
   uint64_t getCurrentEpoch() const;
+  /** Slot duration in seconds. */
+  uint64_t getSlotDuration() const;
+  /** Start time of the given slot (consensus timestamp). */
+  int64_t getSlotStartTime(uint64_t slot) const;
   std::vector<consensus::Stakeholder> getStakeholders() const;
   Roe<Client::UserAccount> getAccount(uint64_t accountId) const;
 
   Roe<Ledger::ChainNode> readBlock(uint64_t blockId) const;
+  Roe<Ledger::BlockLocation> readRawBlock(uint64_t blockId) const;
   std::string calculateHash(const Ledger::Block &block) const;
   /** Find transactions involving walletId, scanning backwards from ioBlockId (0 = latest). ioBlockId is updated to the last block scanned. */
   Roe<std::vector<Ledger::Record>>
@@ -83,6 +88,9 @@ public:
   /** Find transaction by global chain index (0-based). */
   Roe<Ledger::Record>
   findTransactionByIndex(uint64_t txIndex) const;
+  /** Transaction at txIndex with its Merkle proof and block header. */
+  Roe<Ledger::TxProof>
+  findTransactionProof(uint64_t txIndex) const;
 
   // ----------------- methods -------------------------------------
   Roe<void> init(const InitConfig &config);
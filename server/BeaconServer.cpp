@@ -233,6 +233,9 @@ nlohmann::json BeaconServer::RunFileConfig::ltsToJson() {
   j["port"] = port;
   j["dhtPort"] = dhtPort;
   j["whitelist"] = whitelist;
+  j["fetchReactors"] = fetchReactors;
+  j["compressMinBytes"] = compressMinBytes;
+  j["peerRequestsPerSecond"] = peerRequestsPerSecond;
   return j;
 }
 
@@ -289,6 +292,33 @@ BeaconServer::RunFileConfig::ltsFromJson(const nlohmann::json &jd) {
       whitelist = jd["whitelist"].get<std::vector<std::string>>();
     }
 
+    if (jd.contains("fetchReactors")) {
+      if (!jd["fetchReactors"].is_number_unsigned()) {
+        return Error(E_CONFIG, "Field 'fetchReactors' must be a positive number");
+      }
+      uint64_t reactors = jd["fetchReactors"].get<uint64_t>();
+      if (reactors == 0 || reactors > MAX_FETCH_REACTORS) {
+        return Error(E_CONFIG, "Field 'fetchReactors' must be between 1 and " +
+                                   std::to_string(MAX_FETCH_REACTORS));
+      }
+      fetchReactors = static_cast<uint32_t>(reactors);
+    }
+
+    if (jd.contains("compressMinBytes")) {
+      if (!jd["compressMinBytes"].is_number_unsigned()) {
+        return Error(E_CONFIG, "Field 'compressMinBytes' must be a non-negative number");
+      }
+      compressMinBytes = jd["compressMinBytes"].get<uint64_t>();
+    }
+
+    if (jd.contains("peerRequestsPerSecond")) {
+      if (!jd["peerRequestsPerSecond"].is_number_unsigned()) {
+        return Error(E_CONFIG,
+                     "Field 'peerRequestsPerSecond' must be a non-negative number");
+      }
+      peerRequestsPerSecond = jd["peerRequestsPerSecond"].get<uint64_t>();
+    }
+
     return {};
   } catch (const std::exception &e) {
     return Error(E_CONFIG,
@@ -499,11 +529,19 @@ Service::Roe<void> BeaconServer::onStart() {
   config_.network.endpoint.address = runFileConfig.host;
   config_.network.endpoint.port = runFileConfig.port;
   config_.network.whitelist = runFileConfig.whitelist;
+  config_.network.fetchReactors = runFileConfig.fetchReactors;
+  config_.network.compressMinBytes = runFileConfig.compressMinBytes;
+  config_.network.peerRequestsPerSecond = runFileConfig.peerRequestsPerSecond;
 
   log().info << "Configuration loaded";
   log().info << "  Endpoint: " << config_.network.endpoint;
   log().info << "  Whitelisted beacons: "
              << utl::join(config_.network.whitelist, ", ");
+  log().info << "  Fetch reactors: " << config_.network.fetchReactors;
+  log().info << "  Compress responses from: " << config_.network.compressMinBytes
+             << " bytes";
+  log().info << "  Requests per second per peer: "
+             << config_.network.peerRequestsPerSecond;
 
   // Start DHT (beacon is the bootstrapping peer; no bootstrap endpoints)
   network::DhtRunner::Config dhtConfig;
@@ -543,6 +581,14 @@ Service::Roe<void> BeaconServer::onStart() {
 void BeaconServer::customizeFetchServerConfig(
     network::FetchServer::Config &config) {
   config.whitelist = config_.network.whitelist;
+  config.reactorCount = config_.network.fetchReactors;
+  config.compressMinSize = config_.network.compressMinBytes;
+}
+
+void BeaconServer::customizeRequestQueueConfig(RequestQueueConfig &config) {
+  config.peerRequestsPerSecond =
+      static_cast<double>(config_.network.peerRequestsPerSecond);
+  config.peerBurst = 2 * config.peerRequestsPerSecond;
 }
 
 void BeaconServer::initHandlers() {
@@ -557,6 +603,9 @@ void BeaconServer::initHandlers() {
   auto &hgb = requestHandlers_[Client::T_REQ_BLOCK_GET];
   hgb = [this](const Client::Request &request) { return hBlockGet(request); };
 
+  auto &hgbr = requestHandlers_[Client::T_REQ_BLOCK_GET_RANGE];
+  hgbr = [this](const Client::Request &request) { return hBlockGetRange(request); };
+
   auto &hga = requestHandlers_[Client::T_REQ_ACCOUNT_GET];
   hga = [this](const Client::Request &request) { return hAccountGet(request); };
 
@@ -566,6 +615,9 @@ void BeaconServer::initHandlers() {
   auto &htxi = requestHandlers_[Client::T_REQ_TX_GET_BY_INDEX];
   htxi = [this](const Client::Request &request) { return hTxGetByIndex(request); };
 
+  auto &htxp = requestHandlers_[Client::T_REQ_TX_PROOF];
+  htxp = [this](const Client::Request &request) { return hTxProof(request); };
+
   auto &hab = requestHandlers_[Client::T_REQ_BLOCK_ADD];
   hab = [this](const Client::Request &request) { return hBlockAdd(request); };
 
@@ -615,8 +667,8 @@ void BeaconServer::runLoop() {
 
       // Process queued requests
       if (!pollAndProcessOneRequest()) {
-        // Sleep for a short time if queue is not too busy
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // Idle until a request arrives or the next slot (stake refresh)
+        waitForRequest(getLoopWaitTime());
       }
     } catch (const std::exception &e) {
       log().error << "Exception in request handler loop: " << e.what();
@@ -627,6 +679,34 @@ void BeaconServer::runLoop() {
   log().info << "Request handler thread stopped";
 }
 
+std::chrono::milliseconds BeaconServer::getLoopWaitTime() const {
+  if (beacon_.getSlotDuration() == 0) {
+    return MAX_LOOP_WAIT;
+  }
+  return getWaitUntil(beacon_.getSlotStartTime(beacon_.getCurrentSlot() + 1));
+}
+
+std::optional<Ledger::BlockLocation>
+BeaconServer::locateBlock(uint64_t blockId) const {
+  auto result = beacon_.readRawBlock(blockId);
+  if (!result) {
+    return std::nullopt;
+  }
+  return result.value();
+}
+
+std::optional<uint64_t> BeaconServer::getSubscriptionEndId() const {
+  return beacon_.getNextBlockId();
+}
+
+std::optional<std::string> BeaconServer::readSerializedBlock(uint64_t blockId) const {
+  auto result = beacon_.readBlock(blockId);
+  if (!result) {
+    return std::nullopt;
+  }
+  return result.value().ltsToString();
+}
+
 std::string BeaconServer::handleParsedRequest(const Client::Request &request) {
   log().debug << "Handling request: " << request.type;
   auto it = requestHandlers_.find(request.type);
@@ -655,6 +735,17 @@ BeaconServer::hBlockGet(const Client::Request &request) {
   return result.value().ltsToString();
 }
 
+BeaconServer::Roe<std::string>
+BeaconServer::hBlockGetRange(const Client::Request &request) {
+  auto result = serveBlockRange(
+      request, [this](uint64_t) { return beacon_.getNextBlockId(); },
+      [this](uint64_t blockId) { return readSerializedBlock(blockId); });
+  if (!result) {
+    return Error(E_REQUEST, result.error().message);
+  }
+  return result.value();
+}
+
 BeaconServer::Roe<std::string>
 BeaconServer::hTxGetByWallet(const Client::Request &request) {
   auto reqResult = utl::binaryUnpack<Client::TxGetByWalletRequest>(request.payload);
@@ -686,6 +777,20 @@ BeaconServer::hTxGetByIndex(const Client::Request &request) {
   return utl::binaryPack(result.value());
 }
 
+BeaconServer::Roe<std::string>
+BeaconServer::hTxProof(const Client::Request &request) {
+  auto reqResult = utl::binaryUnpack<Client::TxGetByIndexRequest>(request.payload);
+  if (!reqResult) {
+    return Error(E_REQUEST, "Failed to deserialize request: " + reqResult.error().message);
+  }
+  auto &req = reqResult.value();
+  auto result = beacon_.findTransactionProof(req.txIndex);
+  if (!result) {
+    return Error(E_REQUEST, "Failed to get transaction proof: " + result.error().message);
+  }
+  return utl::binaryPack(result.value());
+}
+
 BeaconServer::Roe<std::string>
 BeaconServer::hBlockAdd(const Client::Request &request) {
   Ledger::ChainNode block;
@@ -732,7 +837,10 @@ BeaconServer::hRegister(const Client::Request &request) {
 
 BeaconServer::Roe<std::string>
 BeaconServer::hStatus(const Client::Request &request) {
-  return utl::binaryPack(buildStateResponse().ltsToMeta());
+  auto meta = buildStateResponse().ltsToMeta();
+  meta.set("fetchServer", getFetchServerStatsMeta());
+  meta.set("requestQueue", getRequestQueueStatsMeta());
+  return utl::binaryPack(meta);
 }
 
 BeaconServer::Roe<std::string>
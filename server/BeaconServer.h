@@ -49,6 +49,7 @@ protected:
   int32_t getRunErrorCode() const override { return E_BEACON; }
 
   void customizeFetchServerConfig(network::FetchServer::Config &config) override;
+  void customizeRequestQueueConfig(RequestQueueConfig &config) override;
 
   /**
    * Service thread main loop - processes queued requests
@@ -71,6 +72,7 @@ private:
   constexpr static const char* FILE_LOG = "beacon.log";
   constexpr static const char* FILE_SIGNATURE = ".signature";
   constexpr static const char* DIR_DATA = "data";
+  constexpr static const uint32_t MAX_FETCH_REACTORS = 64;
 
   // Default configuration values
   constexpr static const uint64_t DEFAULT_SLOT_DURATION = 7; // 7 seconds per slot
@@ -110,6 +112,9 @@ private:
     uint16_t port{ Client::DEFAULT_BEACON_PORT };
     uint16_t dhtPort{ Client::DEFAULT_DHT_PORT };
     std::vector<std::string> whitelist; // Whitelisted beacon addresses
+    uint32_t fetchReactors{ 1 };        // FetchServer reactor threads
+    uint64_t compressMinBytes{ 4096 };  // Smallest compressed response (0 = off)
+    uint64_t peerRequestsPerSecond{ 1000 };  // Per peer address (0 = unlimited)
 
     nlohmann::json ltsToJson();
     Roe<void> ltsFromJson(const nlohmann::json& jd);
@@ -118,6 +123,9 @@ private:
   struct NetworkConfig {
     network::IpEndpoint endpoint;
     std::vector<std::string> whitelist;
+    size_t fetchReactors{ 1 };
+    size_t compressMinBytes{ 4096 };
+    uint64_t peerRequestsPerSecond{ 1000 };
   };
 
   struct Config {
@@ -131,13 +139,20 @@ private:
   void registerServer(const Client::MinerInfo &minerInfo);
   Client::BeaconState buildStateResponse() const;
 
+  /** How long runLoop may idle: until the next slot starts. */
+  std::chrono::milliseconds getLoopWaitTime() const;
   std::string handleParsedRequest(const Client::Request &request) override;
+  std::optional<Ledger::BlockLocation> locateBlock(uint64_t blockId) const override;
+  std::optional<uint64_t> getSubscriptionEndId() const override;
+  std::optional<std::string> readSerializedBlock(uint64_t blockId) const override;
 
   Roe<std::string> hBlockGet(const Client::Request &request);
+  Roe<std::string> hBlockGetRange(const Client::Request &request);
   Roe<std::string> hBlockAdd(const Client::Request &request);
   Roe<std::string> hAccountGet(const Client::Request &request);
   Roe<std::string> hTxGetByWallet(const Client::Request &request);
   Roe<std::string> hTxGetByIndex(const Client::Request &request);
+  Roe<std::string> hTxProof(const Client::Request &request);
   Roe<std::string> hStatus(const Client::Request &request);
   Roe<std::string> hCalibration(const Client::Request &request);
   Roe<std::string> hRegister(const Client::Request &request);
@@ -0,0 +1,138 @@
+#include "BlockSubscription.h"
+#include "lib/common/Logger.h"
+
+namespace pp {
+
+BlockSubscription::BlockSubscription() : state_(std::make_shared<State>()) {}
+
+BlockSubscription::~BlockSubscription() { stop(); }
+
+void BlockSubscription::start(const Config &config) {
+  config_ = config;
+  client_.redirectLogger(log().getFullName() + ".Client");
+  client_.setEndpoint(config_.upstream);
+
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->isRunning = true;
+  state_->onUpdate = config_.onUpdate;
+  log().info << "Subscribing to blocks from " << config_.upstream;
+}
+
+void BlockSubscription::stop() {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->isRunning = false;
+  state_->isLive = false;
+  state_->onUpdate = nullptr;
+  state_->blocks.clear();
+}
+
+void BlockSubscription::poll(uint64_t nextBlockId) {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (!state_->isRunning || state_->isInFlight) {
+      return;
+    }
+    if (state_->isLive != wasLive_) {
+      wasLive_ = state_->isLive;
+      if (wasLive_) {
+        log().info << "Block subscription to " << config_.upstream << " is live";
+      } else {
+        log().warning << "Block subscription to " << config_.upstream
+                      << " failed: " << state_->lastError;
+      }
+    }
+    if (std::chrono::steady_clock::now() < state_->retryTime) {
+      return;
+    }
+    state_->isInFlight = true;
+  }
+
+  Client::BlockSubscribeRequest request;
+  request.fromId = nextBlockId;
+  request.maxWaitMs = static_cast<uint64_t>(config_.maxWait.count());
+  const auto sentTime = std::chrono::steady_clock::now();
+  subscribe(request, [state = state_, sentTime, maxWait = config_.maxWait](
+                         const Client::Roe<Client::BlockRange> &result) {
+    onResponse(*state, result, sentTime, maxWait);
+  });
+}
+
+void BlockSubscription::subscribe(const Client::BlockSubscribeRequest &request,
+                                  RangeCallback callback) {
+  client_.subscribeBlocks(request, std::move(callback));
+}
+
+void BlockSubscription::onResponse(State &state,
+                                   const Client::Roe<Client::BlockRange> &result,
+                                   std::chrono::steady_clock::time_point sentTime,
+                                   std::chrono::milliseconds maxWait) {
+  // Under the lock, so stop() returns only once onUpdate cannot run anymore
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.isInFlight = false;
+  if (!state.isRunning) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if (!result) {
+    state.isLive = false;
+    state.lastError = result.error().message;
+    state.retryTime = now + RETRY_DELAY;
+  } else if (result.value().blocks.empty()) {
+    state.isLive = true;
+    // Empty well before the wait expired: the upstream could not serve
+    // fromId, so do not spin on it
+    if (now - sentTime < maxWait / 2) {
+      state.retryTime = now + RETRY_DELAY;
+    }
+  } else {
+    state.isLive = true;
+    for (const auto &block : result.value().blocks) {
+      state.blocks.push_back(block);
+    }
+  }
+  if (state.onUpdate) {
+    state.onUpdate();
+  }
+}
+
+std::vector<Ledger::ChainNode> BlockSubscription::takeBlocks() {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  std::vector<Ledger::ChainNode> blocks;
+  blocks.swap(state_->blocks);
+  return blocks;
+}
+
+void BlockSubscription::addBlocks(const std::function<uint64_t()> &getNextBlockId,
+                                  const AddBlockFn &addBlock) {
+  for (auto &block : takeBlocks()) {
+    const uint64_t nextBlockId = getNextBlockId();
+    if (block.block.index < nextBlockId) {
+      continue;  // Already added by a sync
+    }
+    if (block.block.index > nextBlockId) {
+      break;  // Gap: renew the subscription from our chain end
+    }
+    auto addResult = addBlock(block);
+    if (!addResult) {
+      markFailed("pushed block " + std::to_string(block.block.index) +
+                 " rejected: " + addResult.error().message);
+      break;
+    }
+    log().debug << "Added pushed block " << block.block.index;
+  }
+  poll(getNextBlockId());
+}
+
+void BlockSubscription::markFailed(const std::string &error) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->isLive = false;
+  state_->lastError = error;
+  state_->retryTime = std::chrono::steady_clock::now() + RETRY_DELAY;
+}
+
+bool BlockSubscription::isLive() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->isLive;
+}
+
+} // namespace pp
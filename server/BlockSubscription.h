@@ -0,0 +1,105 @@
+#ifndef PP_LEDGER_BLOCK_SUBSCRIPTION_H
+#define PP_LEDGER_BLOCK_SUBSCRIPTION_H
+
+#include "../client/Client.h"
+#include "lib/common/Module.h"
+#include "lib/common/ResultOrError.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pp {
+
+/**
+ * BlockSubscription - Keeps a T_REQ_BLOCK_SUBSCRIBE long poll in flight to an
+ * upstream beacon or relay, so new blocks arrive one round trip after the
+ * upstream accepts them instead of at the next periodic sync.
+ *
+ * The long poll runs on the fetch engine, so no thread is spent waiting. The
+ * server's run loop calls addBlocks() to put the received blocks on its chain
+ * and ask for the next ones from its new chain end.
+ */
+class BlockSubscription : public Module {
+public:
+  /** Pause after a failed long poll before the next one. */
+  constexpr static std::chrono::milliseconds RETRY_DELAY{ 2000 };
+
+  struct Config {
+    network::IpEndpoint upstream;
+    std::chrono::milliseconds maxWait{ 20000 };
+    // Runs on the fetch engine thread when a long poll returns, to wake the
+    // run loop so it takes the blocks and polls again; must not block
+    std::function<void()> onUpdate;
+  };
+
+  BlockSubscription();
+  ~BlockSubscription() override;
+
+  void start(const Config &config);
+  /** Stop issuing long polls; one in flight is discarded when it returns. */
+  void stop();
+
+  /**
+   * Issue the next long poll, for the blocks from nextBlockId on, unless one
+   * is in flight or a failed one is waiting out RETRY_DELAY.
+   */
+  void poll(uint64_t nextBlockId);
+
+  /** Blocks received since the last call, in order from the polled block id. */
+  std::vector<Ledger::ChainNode> takeBlocks();
+
+  /** Adds one received block to the server's chain, filling in its hash. */
+  using AddBlockFn =
+      std::function<ResultOrError<void, RoeErrorBase>(Ledger::ChainNode &block)>;
+
+  /**
+   * Add the received blocks that extend the chain (from getNextBlockId on),
+   * then poll from the new chain end. A rejected block takes the subscription
+   * off live, so misses fall back to sync, and holds the next poll for
+   * RETRY_DELAY rather than asking the upstream for it again at once.
+   */
+  void addBlocks(const std::function<uint64_t()> &getNextBlockId,
+                 const AddBlockFn &addBlock);
+
+  /** Whether the last long poll succeeded, so new blocks arrive by push. */
+  bool isLive() const;
+
+protected:
+  using RangeCallback = std::function<void(const Client::Roe<Client::BlockRange> &)>;
+
+  /** Send the long poll upstream; overridden by tests. */
+  virtual void subscribe(const Client::BlockSubscribeRequest &request,
+                         RangeCallback callback);
+
+private:
+  // Shared with the in-flight callback, which may outlive this object
+  struct State {
+    mutable std::mutex mutex;
+    bool isRunning{ false };
+    bool isInFlight{ false };
+    bool isLive{ false };
+    std::chrono::steady_clock::time_point retryTime{};
+    std::string lastError;
+    std::vector<Ledger::ChainNode> blocks;
+    std::function<void()> onUpdate;
+  };
+
+  void markFailed(const std::string &error);
+
+  static void onResponse(State &state, const Client::Roe<Client::BlockRange> &result,
+                         std::chrono::steady_clock::time_point sentTime,
+                         std::chrono::milliseconds maxWait);
+
+  Config config_;
+  Client client_;
+  std::shared_ptr<State> state_;
+  bool wasLive_{ false };  // For logging transitions
+};
+
+} // namespace pp
+
+#endif // PP_LEDGER_BLOCK_SUBSCRIPTION_H
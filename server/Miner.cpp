@@ -67,6 +67,14 @@ Miner::Roe<Ledger::ChainNode> Miner::readBlock(uint64_t blockId) const {
   return result.value();
 }
 
+Miner::Roe<Ledger::BlockLocation> Miner::readRawBlock(uint64_t blockId) const {
+  auto result = chain_.readRawBlock(blockId);
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+  return result.value();
+}
+
 Miner::Roe<Client::UserAccount> Miner::getAccount(uint64_t accountId) const {
   auto result = chain_.getAccount(accountId);
   if (!result) {
@@ -97,6 +105,23 @@ Miner::findTransactionByIndex(uint64_t txIndex) const {
   return result.value();
 }
 
+Miner::Roe<Ledger::TxProof>
+Miner::findTransactionProof(uint64_t txIndex) const {
+  auto result = chain_.findTransactionProof(txIndex);
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+  return result.value();
+}
+
+Miner::Roe<void> Miner::checkAssumeValid() const {
+  auto result = chain_.checkAssumeValid();
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+  return {};
+}
+
 Miner::Roe<void> Miner::init(const InitConfig &config) {
   if (config.privateKeys.empty()) {
     return Error(1, "At least one private key is required");
@@ -153,11 +178,16 @@ Miner::Roe<void> Miner::init(const InitConfig &config) {
     }
   }
 
+  chain_.setAssumeValid(config.assumeValid);
+  if (config.parallelApplyThreads > 0) {
+    chain_.setParallelApplyThreads(config.parallelApplyThreads);
+  }
   auto loadResult = chain_.loadFromLedger(config.startingBlockId);
   if (!loadResult) {
     return Error(2,
                  "Failed to load from ledger: " + loadResult.error().message);
   }
+  chain_.initBufferBank(bufferBank_);
 
   log().info << "Miner initialized successfully";
   return {};
@@ -289,6 +319,23 @@ Miner::Roe<void> Miner::addBlock(const Ledger::ChainNode &block) {
     return Error(10, result.error().message);
   }
 
+  // Buffer deltas were taken against the previous state; rebuild them on top
+  // of the new block and drop pending txes it made invalid (e.g. included).
+  bufferBank_.clear();
+  std::vector<Ledger::Record> stillPending;
+  stillPending.reserve(pendingTxes_.size());
+  for (auto &rec : pendingTxes_) {
+    auto addResult =
+        chain_.addBufferTransaction(bufferBank_, rec, config_.minerId);
+    if (!addResult) {
+      log().warning << "Dropping pending transaction after block "
+                    << block.block.index << ": " << addResult.error().message;
+      continue;
+    }
+    stillPending.push_back(std::move(rec));
+  }
+  pendingTxes_.swap(stillPending);
+
   return {};
 }
 
@@ -85,6 +85,9 @@ nlohmann::json MinerServer::RunFileConfig::ltsToJson() const {
   for (const auto& b : beacons) {
     j["beacons"].push_back(b.ltsToJson());
   }
+  j["assumeValid"] = {{"blockId", assumeValid.blockId},
+                      {"hash", assumeValid.blockHash}};
+  j["parallelApplyThreads"] = parallelApplyThreads;
   return j;
 }
 
@@ -203,6 +206,29 @@ MinerServer::RunFileConfig::ltsFromJson(const nlohmann::json &jd) {
                              "valid beacon object");
     }
 
+    // Load and validate assumeValid (optional, empty hash disables it)
+    if (jd.contains("assumeValid")) {
+      auto assumeValidResult = parseAssumeValid(jd["assumeValid"]);
+      if (!assumeValidResult) {
+        return Error(E_CONFIG, assumeValidResult.error().message);
+      }
+      assumeValid = assumeValidResult.value();
+    }
+
+    // Load and validate parallelApplyThreads (optional, 0 = automatic)
+    if (jd.contains("parallelApplyThreads")) {
+      if (!jd["parallelApplyThreads"].is_number_unsigned()) {
+        return Error(E_CONFIG, "Field 'parallelApplyThreads' must be a "
+                               "non-negative number");
+      }
+      uint64_t threadsValue = jd["parallelApplyThreads"].get<uint64_t>();
+      if (threadsValue > Chain::MAX_PARALLEL_APPLY_THREADS) {
+        return Error(E_CONFIG, "Field 'parallelApplyThreads' must be at most " +
+                                   std::to_string(Chain::MAX_PARALLEL_APPLY_THREADS));
+      }
+      parallelApplyThreads = static_cast<uint32_t>(threadsValue);
+    }
+
     return {};
   } catch (const std::exception &e) {
     return Error(E_CONFIG,
@@ -216,6 +242,8 @@ MinerServer::MinerServer() {
   redirectLogger("MinerServer");
   miner_.redirectLogger(log().getFullName() + ".Miner");
   client_.redirectLogger(log().getFullName() + ".Client");
+  blockSubscription_.redirectLogger(log().getFullName() + ".Subscription");
+  syncScheduler_.redirectLogger(log().getFullName() + ".Sync");
   dhtRunner_.redirectLogger(log().getFullName() + ".Dht");
 }
 
@@ -278,6 +306,8 @@ Service::Roe<void> MinerServer::onStart() {
     }
     config_.privateKeys.push_back(keyResult.value());
   }
+  config_.assumeValid = runFileConfig.assumeValid;
+  config_.parallelApplyThreads = runFileConfig.parallelApplyThreads;
   config_.network.endpoint.address = runFileConfig.host;
   config_.network.endpoint.port = runFileConfig.port;
   config_.network.beacons.clear();
@@ -346,6 +376,10 @@ Service::Roe<void> MinerServer::onStart() {
   minerConfig.timeOffset = timeOffsetToBeaconMs_ / 1000;
   minerConfig.workDir = minerDataDir.string();
   minerConfig.startingBlockId = state.checkpointId;
+  minerConfig.assumeValid = config_.assumeValid;
+  minerConfig.parallelApplyThreads = config_.parallelApplyThreads;
+
+  getSlotTimer().setTimeOffset(minerConfig.timeOffset);
 
   auto minerInit = miner_.init(minerConfig);
   if (!minerInit) {
@@ -359,6 +393,12 @@ Service::Roe<void> MinerServer::onStart() {
                                        syncResult.error().message);
   }
 
+  auto assumeValidResult = miner_.checkAssumeValid();
+  if (!assumeValidResult) {
+    return Service::Error(E_MINER, "Assume-valid check failed: " +
+                                       assumeValidResult.error().message);
+  }
+
   lastBlockSyncTime_ = std::chrono::steady_clock::now();
   lastSyncedEpoch_ = miner_.getCurrentEpoch();
 
@@ -366,6 +406,11 @@ Service::Roe<void> MinerServer::onStart() {
 
   initHandlers();
 
+  BlockSubscription::Config subscriptionConfig;
+  subscriptionConfig.upstream = config_.network.beacons[0].endpoint;
+  subscriptionConfig.onUpdate = [this]() { wakeUp(); };
+  blockSubscription_.start(subscriptionConfig);
+
   log().info << "Miner core initialized";
   log().info << "  Miner ID: " << config_.minerId;
   log().info << "  Stake at init: " << miner_.getStake();
@@ -448,28 +493,39 @@ MinerServer::Roe<void> MinerServer::syncBlocksFromBeacon() {
 
   log().info << "Syncing blocks " << nextBlockId << " to " << latestBlockId;
 
-  for (uint64_t blockId = nextBlockId; blockId < latestBlockId; ++blockId) {
-    auto blockResult = client_.fetchBlock(blockId);
-    if (!blockResult) {
-      return Error(E_NETWORK,
-                   "Failed to fetch block " + std::to_string(blockId) +
-                       " from beacon: " + blockResult.error().message);
-    }
-
-    Ledger::ChainNode block = blockResult.value();
-    block.hash = miner_.calculateHash(block.block);
-
-    auto addResult = miner_.addBlock(block);
-    if (!addResult) {
-      return Error(E_MINER, "Failed to add block " + std::to_string(blockId) +
-                                ": " + addResult.error().message);
-    }
-
-    log().debug << "Synced block " << blockId;
+  // Assumed-valid blocks skip signature checks, so only the beacons may
+  // serve them; DHT peers help past that, where addBlock checks everything
+  SyncScheduler::Config syncConfig;
+  if (config_.assumeValid.isEnabled()) {
+    syncConfig.trustedEndId = config_.assumeValid.blockId + 1;
   }
-
-  log().info << "Sync complete: " << (latestBlockId - nextBlockId)
-             << " blocks added";
+  syncScheduler_.setConfig(syncConfig);
+  std::vector<network::IpEndpoint> beacons;
+  for (const auto &beacon : config_.network.beacons) {
+    beacons.push_back(beacon.endpoint);
+  }
+  syncScheduler_.setPeers(beacons, dhtRunner_.getDiscoveredPeers(),
+                          config_.network.endpoint);
+  auto synced = syncScheduler_.sync(
+      nextBlockId, latestBlockId,
+      [this](Ledger::ChainNode &block) -> SyncScheduler::Roe<void> {
+        block.hash = miner_.calculateHash(block.block);
+        auto addResult = miner_.addBlock(block);
+        if (!addResult) {
+          return SyncScheduler::Error(E_MINER, "Failed to add block " +
+                                                std::to_string(block.block.index) + ": " +
+                                                addResult.error().message);
+        }
+        log().debug << "Synced block " << block.block.index;
+        return {};
+      });
+  if (!synced) {
+    return Error(E_NETWORK, "Failed to sync blocks from " +
+                                std::to_string(miner_.getNextBlockId()) + ": " +
+                                synced.error().message);
+  }
+
+  log().info << "Sync complete: " << synced.value() << " blocks added";
 
   return {};
 }
@@ -486,6 +542,9 @@ void MinerServer::initHandlers() {
   auto &hgb = requestHandlers_[Client::T_REQ_BLOCK_GET];
   hgb = [this](const Client::Request &request) { return hBlockGet(request); };
 
+  auto &hgbr = requestHandlers_[Client::T_REQ_BLOCK_GET_RANGE];
+  hgbr = [this](const Client::Request &request) { return hBlockGetRange(request); };
+
   auto &hga = requestHandlers_[Client::T_REQ_ACCOUNT_GET];
   hga = [this](const Client::Request &request) { return hAccountGet(request); };
 
@@ -495,6 +554,9 @@ void MinerServer::initHandlers() {
   auto &htxi = requestHandlers_[Client::T_REQ_TX_GET_BY_INDEX];
   htxi = [this](const Client::Request &request) { return hTxGetByIndex(request); };
 
+  auto &htxp = requestHandlers_[Client::T_REQ_TX_PROOF];
+  htxp = [this](const Client::Request &request) { return hTxProof(request); };
+
   auto &hab = requestHandlers_[Client::T_REQ_BLOCK_ADD];
   hab = [this](const Client::Request &request) { return hBlockAdd(request); };
 
@@ -503,6 +565,7 @@ void MinerServer::initHandlers() {
 }
 
 void MinerServer::onStop() {
+  blockSubscription_.stop();
   dhtRunner_.stop();
   Server::onStop();
   log().info << "MinerServer resources cleaned up";
@@ -518,6 +581,8 @@ void MinerServer::runLoop() {
 
       pollAndProcessAllRequests();
 
+      addSubscribedBlocks();
+
       syncBlocksPeriodically();
 
       if (!miner_.isConfigReady()) {
@@ -529,8 +594,8 @@ void MinerServer::runLoop() {
         handleValidatorRole();
       }
 
-      // Sleep for a short time before checking again
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      // Idle until a request arrives or the next slot event
+      waitForRequest(getLoopWaitTime());
 
     } catch (const std::exception &e) {
       log().error << "Exception in block production loop: " << e.what();
@@ -541,6 +606,19 @@ void MinerServer::runLoop() {
   log().info << "Block production and request handler loop stopped";
 }
 
+std::chrono::milliseconds MinerServer::getLoopWaitTime() const {
+  if (!miner_.isConfigReady() || miner_.getSlotDuration() == 0) {
+    return MAX_LOOP_WAIT;
+  }
+  const uint64_t currentSlot = miner_.getCurrentSlot();
+  int64_t wakeTime = miner_.getSlotStartTime(currentSlot + 1);
+  // Production window and sync ahead of our slot are timed in whole seconds
+  if (miner_.isSlotLeader() || miner_.isSlotLeaderForSlot(currentSlot + 1)) {
+    wakeTime = std::min(wakeTime, miner_.getConsensusTimestamp() + 1);
+  }
+  return getWaitUntil(wakeTime);
+}
+
 void MinerServer::trySyncBlocksFromBeacon(bool bypassRateLimit) {
   const uint64_t slotDurationSec = miner_.getSlotDuration();
   if (!bypassRateLimit && slotDurationSec > 0) {
@@ -560,6 +638,19 @@ void MinerServer::trySyncBlocksFromBeacon(bool bypassRateLimit) {
   }
 }
 
+void MinerServer::addSubscribedBlocks() {
+  blockSubscription_.addBlocks(
+      [this]() { return miner_.getNextBlockId(); },
+      [this](Ledger::ChainNode &block) -> ResultOrError<void, RoeErrorBase> {
+        block.hash = miner_.calculateHash(block.block);
+        auto addResult = miner_.addBlock(block);
+        if (!addResult) {
+          return RoeErrorBase(addResult.error());
+        }
+        return {};
+      });
+}
+
 void MinerServer::syncBlocksPeriodically() {
   const uint64_t currentEpoch = miner_.getCurrentEpoch();
   const uint64_t currentSlot = miner_.getCurrentSlot();
@@ -631,6 +722,23 @@ std::string MinerServer::findTxSubmitAddress(uint64_t slotLeaderId) {
   return "";
 }
 
+std::optional<Ledger::BlockLocation>
+MinerServer::locateBlock(uint64_t blockId) const {
+  auto result = miner_.readRawBlock(blockId);
+  if (!result) {
+    return std::nullopt;
+  }
+  return result.value();
+}
+
+std::optional<std::string> MinerServer::readSerializedBlock(uint64_t blockId) const {
+  auto result = miner_.readBlock(blockId);
+  if (!result) {
+    return std::nullopt;
+  }
+  return result.value().ltsToString();
+}
+
 std::string MinerServer::handleParsedRequest(const Client::Request &request) {
   log().debug << "Handling request: " << request.type;
   auto it = requestHandlers_.find(request.type);
@@ -652,8 +760,9 @@ MinerServer::hBlockGet(const Client::Request &request) {
   uint64_t blockId = idResult.value();
   auto result = miner_.readBlock(blockId);
   if (!result) {
-    // User requested block we don't have: sync from beacon then retry
-    if (blockId >= miner_.getNextBlockId()) {
+    // User requested block we don't have: sync from beacon then retry,
+    // unless the beacon pushes new blocks anyway
+    if (blockId >= miner_.getNextBlockId() && !blockSubscription_.isLive()) {
       trySyncBlocksFromBeacon(true);
       result = miner_.readBlock(blockId);
     }
@@ -664,6 +773,25 @@ MinerServer::hBlockGet(const Client::Request &request) {
   return result.value().ltsToString();
 }
 
+MinerServer::Roe<std::string>
+MinerServer::hBlockGetRange(const Client::Request &request) {
+  auto result = serveBlockRange(
+      request,
+      [this](uint64_t fromId) {
+        // User requested blocks we don't have yet: sync from beacon first,
+        // unless the beacon pushes new blocks anyway
+        if (fromId >= miner_.getNextBlockId() && !blockSubscription_.isLive()) {
+          trySyncBlocksFromBeacon(true);
+        }
+        return miner_.getNextBlockId();
+      },
+      [this](uint64_t blockId) { return readSerializedBlock(blockId); });
+  if (!result) {
+    return Error(E_REQUEST, result.error().message);
+  }
+  return result.value();
+}
+
 MinerServer::Roe<std::string>
 MinerServer::hBlockAdd(const Client::Request &request) {
   Ledger::ChainNode block;
@@ -724,6 +852,20 @@ MinerServer::hTxGetByIndex(const Client::Request &request) {
   return utl::binaryPack(result.value());
 }
 
+MinerServer::Roe<std::string>
+MinerServer::hTxProof(const Client::Request &request) {
+  auto reqResult = utl::binaryUnpack<Client::TxGetByIndexRequest>(request.payload);
+  if (!reqResult) {
+    return Error(E_REQUEST, "Failed to deserialize request: " + reqResult.error().message);
+  }
+  auto &req = reqResult.value();
+  auto result = miner_.findTransactionProof(req.txIndex);
+  if (!result) {
+    return Error(E_REQUEST, "Failed to get transaction proof: " + result.error().message);
+  }
+  return utl::binaryPack(result.value());
+}
+
 MinerServer::Roe<std::string>
 MinerServer::hTxAdd(const Client::Request &request) {
   if (!miner_.isConfigReady()) {
@@ -788,7 +930,10 @@ MinerServer::hStatus(const Client::Request &request) {
     status.isSlotLeader = miner_.isSlotLeader();
   }
 
-  return utl::binaryPack(status.ltsToMeta());
+  auto meta = status.ltsToMeta();
+  meta.set("fetchServer", getFetchServerStatsMeta());
+  meta.set("requestQueue", getRequestQueueStatsMeta());
+  return utl::binaryPack(meta);
 }
 
 MinerServer::Roe<std::string>
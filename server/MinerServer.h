@@ -2,7 +2,9 @@
 #define PP_LEDGER_MINER_SERVER_H
 
 #include "Miner.h"
+#include "BlockSubscription.h"
 #include "Server.h"
+#include "SyncScheduler.h"
 #include "../client/Client.h"
 #include "../network/DhtRunner.h"
 #include "../network/Types.hpp"
@@ -86,6 +88,8 @@ private:
     uint16_t port{ Client::DEFAULT_MINER_PORT };
     uint16_t dhtPort{ Client::DEFAULT_DHT_PORT };
     std::vector<BeaconConfig> beacons{BeaconConfig{}};
+    Chain::AssumeValidConfig assumeValid;
+    uint32_t parallelApplyThreads{ 0 }; // 0 = one per core, up to the chain cap
 
     nlohmann::json ltsToJson() const;
     Roe<void> ltsFromJson(const nlohmann::json& jd);
@@ -99,6 +103,8 @@ private:
   struct Config {
     uint64_t minerId{ 0 };
     std::vector<std::string> privateKeys;  // hex-encoded
+    Chain::AssumeValidConfig assumeValid;
+    uint32_t parallelApplyThreads{ 0 };
     NetworkConfig network;
     std::map<uint64_t, Client::MinerInfo> mMiners;  // Other miners
   };
@@ -107,10 +113,14 @@ private:
 
   /** Refetch miner list from beacon. Updates config_.mMiners and lastMinerListFetchTime_. */
   void refreshMinerListFromBeacon();
+  /** How long runLoop may idle: until the next slot, or the next second while leading. */
+  std::chrono::milliseconds getLoopWaitTime() const;
   /** Smart sync: when needed (epoch start, before produce, on-demand) and rate-limited. */
   void syncBlocksPeriodically();
   /** Perform sync from beacon (updates lastBlockSyncTime_ and lastSyncedEpoch_ on success). */
   void trySyncBlocksFromBeacon(bool bypassRateLimit = false);
+  /** Add the blocks the beacon pushed, then renew the subscription from the chain end. */
+  void addSubscribedBlocks();
   Roe<Client::BeaconState> connectToBeacon();
   Roe<void> syncBlocksFromBeacon();
   /** Compute time offset in ms to beacon (beacon_time_ms = local_time_ms + offset). Call after connectToBeacon(); client_ must be set to beacon. */
@@ -123,12 +133,16 @@ private:
   Roe<void> broadcastBlock(const Ledger::ChainNode& block);
 
   std::string handleParsedRequest(const Client::Request &request) override;
+  std::optional<Ledger::BlockLocation> locateBlock(uint64_t blockId) const override;
+  std::optional<std::string> readSerializedBlock(uint64_t blockId) const override;
 
   Roe<std::string> hBlockGet(const Client::Request &request);
+  Roe<std::string> hBlockGetRange(const Client::Request &request);
   Roe<std::string> hBlockAdd(const Client::Request &request);
   Roe<std::string> hAccountGet(const Client::Request &request);
   Roe<std::string> hTxGetByWallet(const Client::Request &request);
   Roe<std::string> hTxGetByIndex(const Client::Request &request);
+  Roe<std::string> hTxProof(const Client::Request &request);
   Roe<std::string> hTxAdd(const Client::Request &request);
   Roe<std::string> hStatus(const Client::Request &request);
   Roe<std::string> hCalibration(const Client::Request &request);
@@ -136,6 +150,8 @@ private:
 
   Miner miner_;
   Client client_;
+  BlockSubscription blockSubscription_;
+  SyncScheduler syncScheduler_;
   Config config_;
   network::DhtRunner dhtRunner_;
 
@@ -12,7 +12,8 @@ namespace pp {
 std::ostream &operator<<(std::ostream &os, const Relay::InitConfig &config) {
   os << "InitConfig{workDir=\"" << config.workDir << "\", "
      << "timeOffset=" << config.timeOffset << ", "
-     << "startingBlockId=" << config.startingBlockId << "}";
+     << "startingBlockId=" << config.startingBlockId << ", "
+     << "assumeValidBlockId=" << config.assumeValid.blockId << "}";
   return os;
 }
 
@@ -33,6 +34,10 @@ uint64_t Relay::getCurrentEpoch() const { return chain_.getCurrentEpoch(); }
 
 uint64_t Relay::getSlotDuration() const { return chain_.getSlotDuration(); }
 
+int64_t Relay::getSlotStartTime(uint64_t slot) const {
+  return chain_.getSlotStartTime(slot);
+}
+
 std::vector<consensus::Stakeholder> Relay::getStakeholders() const {
   return chain_.getStakeholders();
 }
@@ -45,6 +50,14 @@ Relay::Roe<Ledger::ChainNode> Relay::readBlock(uint64_t blockId) const {
   return result.value();
 }
 
+Relay::Roe<Ledger::BlockLocation> Relay::readRawBlock(uint64_t blockId) const {
+  auto result = chain_.readRawBlock(blockId);
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+  return result.value();
+}
+
 Relay::Roe<Client::UserAccount> Relay::getAccount(uint64_t accountId) const {
   auto result = chain_.getAccount(accountId);
   if (!result) {
@@ -75,6 +88,23 @@ Relay::findTransactionByIndex(uint64_t txIndex) const {
   return result.value();
 }
 
+Relay::Roe<Ledger::TxProof>
+Relay::findTransactionProof(uint64_t txIndex) const {
+  auto result = chain_.findTransactionProof(txIndex);
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+  return result.value();
+}
+
+Relay::Roe<void> Relay::checkAssumeValid() const {
+  auto result = chain_.checkAssumeValid();
+  if (!result) {
+    return Error(result.error().code, result.error().message);
+  }
+  return {};
+}
+
 Relay::Roe<void> Relay::init(const InitConfig &config) {
   log().info << "Initializing Relay";
   log().debug << "Init config: " << config;
@@ -124,6 +154,10 @@ Relay::Roe<void> Relay::init(const InitConfig &config) {
   consensusConfig.timeOffset = config.timeOffset;
   chain_.initConsensus(consensusConfig);
 
+  chain_.setAssumeValid(config.assumeValid);
+  if (config.parallelApplyThreads > 0) {
+    chain_.setParallelApplyThreads(config.parallelApplyThreads);
+  }
   auto loadResult = chain_.loadFromLedger(config.startingBlockId);
   if (!loadResult) {
     return Error(2,
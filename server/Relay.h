@@ -36,6 +36,8 @@ public:
     std::string workDir;
     int64_t timeOffset{0};
     uint64_t startingBlockId{0};
+    Chain::AssumeValidConfig assumeValid;
+    size_t parallelApplyThreads{0}; // 0 keeps the chain default
   };
 
   Relay();
@@ -48,10 +50,13 @@ public:
   uint64_t getCurrentEpoch() const;
   /** Slot duration in seconds (for sync rate limiting). */
   uint64_t getSlotDuration() const;
+  /** Start time of the given slot (consensus timestamp). */
+  int64_t getSlotStartTime(uint64_t slot) const;
   std::vector<consensus::Stakeholder> getStakeholders() const;
   Roe<Client::UserAccount> getAccount(uint64_t accountId) const;
 
   Roe<Ledger::ChainNode> readBlock(uint64_t blockId) const;
+  Roe<Ledger::BlockLocation> readRawBlock(uint64_t blockId) const;
   std::string calculateHash(const Ledger::Block &block) const;
   /** Find transactions involving walletId, scanning backwards from ioBlockId (0 = latest). ioBlockId is updated to the last block scanned. */
   Roe<std::vector<Ledger::Record>>
@@ -59,6 +64,12 @@ public:
   /** Find transaction by global chain index (0-based). */
   Roe<Ledger::Record>
   findTransactionByIndex(uint64_t txIndex) const;
+  /** Transaction at txIndex with its Merkle proof and block header. */
+  Roe<Ledger::TxProof>
+  findTransactionProof(uint64_t txIndex) const;
+  /** Fails unless the configured assume-valid block was synced with its
+   * trusted hash. */
+  Roe<void> checkAssumeValid() const;
 
   // ----------------- methods -------------------------------------
   Roe<void> init(const InitConfig &config);
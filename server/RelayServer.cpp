@@ -79,6 +79,9 @@ nlohmann::json RelayServer::RunFileConfig::ltsToJson() {
   j["port"] = port;
   j["dhtPort"] = dhtPort;
   j["beacon"] = beacon.ltsToJson();
+  j["assumeValid"] = {{"blockId", assumeValid.blockId},
+                      {"hash", assumeValid.blockHash}};
+  j["parallelApplyThreads"] = parallelApplyThreads;
   return j;
 }
 
@@ -160,6 +163,28 @@ RelayServer::RunFileConfig::ltsFromJson(const nlohmann::json &jd) {
       dhtPort = static_cast<uint16_t>(v);
     }
 
+    // Load and validate assumeValid (optional, empty hash disables it)
+    if (jd.contains("assumeValid")) {
+      auto assumeValidResult = parseAssumeValid(jd["assumeValid"]);
+      if (!assumeValidResult) {
+        return Error(E_CONFIG, assumeValidResult.error().message);
+      }
+      assumeValid = assumeValidResult.value();
+    }
+
+    // Load and validate parallelApplyThreads (optional, 0 = automatic)
+    if (jd.contains("parallelApplyThreads")) {
+      if (!jd["parallelApplyThreads"].is_number_unsigned()) {
+        return Error(E_CONFIG, "Field 'parallelApplyThreads' must be a non-negative number");
+      }
+      uint64_t threadsValue = jd["parallelApplyThreads"].get<uint64_t>();
+      if (threadsValue > Chain::MAX_PARALLEL_APPLY_THREADS) {
+        return Error(E_CONFIG, "Field 'parallelApplyThreads' must be at most " +
+                                   std::to_string(Chain::MAX_PARALLEL_APPLY_THREADS));
+      }
+      parallelApplyThreads = static_cast<uint32_t>(threadsValue);
+    }
+
     return {};
   } catch (const std::exception &e) {
     return Error(E_CONFIG,
@@ -173,6 +198,8 @@ RelayServer::RelayServer() {
   redirectLogger("RelayServer");
   relay_.redirectLogger(log().getFullName() + ".Relay");
   client_.redirectLogger(log().getFullName() + ".Client");
+  blockSubscription_.redirectLogger(log().getFullName() + ".Subscription");
+  syncScheduler_.redirectLogger(log().getFullName() + ".Sync");
   dhtRunner_.redirectLogger(log().getFullName() + ".Dht");
 }
 
@@ -224,6 +251,8 @@ Service::Roe<void> RelayServer::onStart() {
   config_.network.beacon.address = runFileConfig.beacon.host;
   config_.network.beacon.port = runFileConfig.beacon.port;
   config_.network.beaconDhtPort = runFileConfig.beacon.dhtPort;
+  config_.assumeValid = runFileConfig.assumeValid;
+  config_.parallelApplyThreads = runFileConfig.parallelApplyThreads;
 
   log().info << "Configuration loaded";
   log().info << "  Endpoint: " << config_.network.endpoint;
@@ -257,12 +286,15 @@ Service::Roe<void> RelayServer::onStart() {
   relayConfig.workDir = relayDataDir.string();
   relayConfig.timeOffset = 0;
   relayConfig.startingBlockId = 0;
+  relayConfig.assumeValid = config_.assumeValid;
+  relayConfig.parallelApplyThreads = config_.parallelApplyThreads;
 
   {
     auto offsetResult = calibrateTimeToBeacon();
     if (offsetResult) {
       timeOffsetToBeaconMs_ = offsetResult.value();
       relayConfig.timeOffset = timeOffsetToBeaconMs_ / 1000;
+      getSlotTimer().setTimeOffset(relayConfig.timeOffset);
     } else {
       log().warning << "Time calibration skipped: " << offsetResult.error().message;
     }
@@ -279,6 +311,13 @@ Service::Roe<void> RelayServer::onStart() {
     return Service::Error(E_NETWORK, "Failed to sync blocks from beacon: " +
                                          syncResult.error().message);
   }
+
+  auto assumeValidResult = relay_.checkAssumeValid();
+  if (!assumeValidResult) {
+    return Service::Error(E_RELAY, "Assume-valid check failed: " +
+                                       assumeValidResult.error().message);
+  }
+
   lastBlockSyncTime_ = std::chrono::steady_clock::now();
   lastSyncedEpoch_ = relay_.getCurrentEpoch();
 
@@ -286,6 +325,10 @@ Service::Roe<void> RelayServer::onStart() {
   log().info << "  Next block ID: " << relay_.getNextBlockId();
 
   initHandlers();
+  BlockSubscription::Config subscriptionConfig;
+  subscriptionConfig.upstream = config_.network.beacon;
+  subscriptionConfig.onUpdate = [this]() { wakeUp(); };
+  blockSubscription_.start(subscriptionConfig);
   log().info << "RelayServer initialization complete";
   return {};
 }
@@ -314,28 +357,35 @@ RelayServer::Roe<void> RelayServer::syncBlocksFromBeacon() {
 
   log().info << "Syncing blocks " << nextBlockId << " to " << latestBlockId;
 
-  for (uint64_t blockId = nextBlockId; blockId < latestBlockId; ++blockId) {
-    auto blockResult = client_.fetchBlock(blockId);
-    if (!blockResult) {
-      return Error(E_NETWORK,
-                   "Failed to fetch block " + std::to_string(blockId) +
-                       " from beacon: " + blockResult.error().message);
-    }
-
-    Ledger::ChainNode block = blockResult.value();
-    block.hash = relay_.calculateHash(block.block);
-
-    auto addResult = relay_.addBlock(block);
-    if (!addResult) {
-      return Error(E_RELAY, "Failed to add block " + std::to_string(blockId) +
-                                ": " + addResult.error().message);
-    }
-
-    log().debug << "Synced block " << blockId;
-  }
-
-  log().info << "Sync complete: " << (latestBlockId - nextBlockId)
-             << " blocks added";
+  // Assumed-valid blocks skip signature checks, so only the beacon may
+  // serve them; DHT peers help past that, where addBlock checks everything
+  SyncScheduler::Config syncConfig;
+  if (config_.assumeValid.isEnabled()) {
+    syncConfig.trustedEndId = config_.assumeValid.blockId + 1;
+  }
+  syncScheduler_.setConfig(syncConfig);
+  syncScheduler_.setPeers({ config_.network.beacon }, dhtRunner_.getDiscoveredPeers(),
+                          config_.network.endpoint);
+  auto synced = syncScheduler_.sync(
+      nextBlockId, latestBlockId,
+      [this](Ledger::ChainNode &block) -> SyncScheduler::Roe<void> {
+        block.hash = relay_.calculateHash(block.block);
+        auto addResult = relay_.addBlock(block);
+        if (!addResult) {
+          return SyncScheduler::Error(E_RELAY, "Failed to add block " +
+                                                std::to_string(block.block.index) + ": " +
+                                                addResult.error().message);
+        }
+        log().debug << "Synced block " << block.block.index;
+        return {};
+      });
+  if (!synced) {
+    return Error(E_NETWORK, "Failed to sync blocks from " +
+                                std::to_string(relay_.getNextBlockId()) + ": " +
+                                synced.error().message);
+  }
+
+  log().info << "Sync complete: " << synced.value() << " blocks added";
   return {};
 }
 
@@ -351,6 +401,9 @@ void RelayServer::initHandlers() {
   auto &hgb = requestHandlers_[Client::T_REQ_BLOCK_GET];
   hgb = [this](const Client::Request &request) { return hBlockGet(request); };
 
+  auto &hgbr = requestHandlers_[Client::T_REQ_BLOCK_GET_RANGE];
+  hgbr = [this](const Client::Request &request) { return hBlockGetRange(request); };
+
   auto &hga = requestHandlers_[Client::T_REQ_ACCOUNT_GET];
   hga = [this](const Client::Request &request) { return hAccountGet(request); };
 
@@ -360,6 +413,9 @@ void RelayServer::initHandlers() {
   auto &htxi = requestHandlers_[Client::T_REQ_TX_GET_BY_INDEX];
   htxi = [this](const Client::Request &request) { return hTxGetByIndex(request); };
 
+  auto &htxp = requestHandlers_[Client::T_REQ_TX_PROOF];
+  htxp = [this](const Client::Request &request) { return hTxProof(request); };
+
   auto &hab = requestHandlers_[Client::T_REQ_BLOCK_ADD];
   hab = [this](const Client::Request &request) { return hBlockAdd(request); };
 
@@ -371,6 +427,7 @@ void RelayServer::initHandlers() {
 };
 
 void RelayServer::onStop() {
+  blockSubscription_.stop();
   dhtRunner_.stop();
   Server::onStop();
   log().info << "RelayServer resources cleaned up";
@@ -410,10 +467,12 @@ void RelayServer::runLoop() {
 
       syncBlocksPeriodically();
 
+      addSubscribedBlocks();
+
       // Process queued requests
       if (!pollAndProcessOneRequest()) {
-        // Sleep for a short time if queue is not too busy
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // Idle until a request arrives or the next slot (epoch sync)
+        waitForRequest(getLoopWaitTime());
       }
     } catch (const std::exception &e) {
       log().error << "Exception in request handler loop: " << e.what();
@@ -443,6 +502,28 @@ void RelayServer::trySyncBlocksFromBeacon(bool bypassRateLimit) {
   }
 }
 
+void RelayServer::addSubscribedBlocks() {
+  blockSubscription_.addBlocks(
+      [this]() { return relay_.getNextBlockId(); },
+      [this](Ledger::ChainNode &block) -> ResultOrError<void, RoeErrorBase> {
+        block.hash = relay_.calculateHash(block.block);
+        auto addResult = relay_.addBlock(block);
+        if (!addResult) {
+          return RoeErrorBase(addResult.error());
+        }
+        return {};
+      });
+  // Let our own subscribers (miners) have them right away
+  serveBlockSubscribers();
+}
+
+std::chrono::milliseconds RelayServer::getLoopWaitTime() const {
+  if (relay_.getSlotDuration() == 0) {
+    return MAX_LOOP_WAIT;
+  }
+  return getWaitUntil(relay_.getSlotStartTime(relay_.getCurrentSlot() + 1));
+}
+
 void RelayServer::syncBlocksPeriodically() {
   const uint64_t currentEpoch = relay_.getCurrentEpoch();
   const uint64_t slotDurationSec = relay_.getSlotDuration();
@@ -459,6 +540,27 @@ void RelayServer::syncBlocksPeriodically() {
   trySyncBlocksFromBeacon(false);
 }
 
+std::optional<Ledger::BlockLocation>
+RelayServer::locateBlock(uint64_t blockId) const {
+  auto result = relay_.readRawBlock(blockId);
+  if (!result) {
+    return std::nullopt;
+  }
+  return result.value();
+}
+
+std::optional<uint64_t> RelayServer::getSubscriptionEndId() const {
+  return relay_.getNextBlockId();
+}
+
+std::optional<std::string> RelayServer::readSerializedBlock(uint64_t blockId) const {
+  auto result = relay_.readBlock(blockId);
+  if (!result) {
+    return std::nullopt;
+  }
+  return result.value().ltsToString();
+}
+
 std::string RelayServer::handleParsedRequest(const Client::Request &request) {
   auto it = requestHandlers_.find(request.type);
   Roe<std::string> result = (it != requestHandlers_.end())
@@ -480,8 +582,9 @@ RelayServer::hBlockGet(const Client::Request &request) {
   uint64_t blockId = idResult.value();
   auto result = relay_.readBlock(blockId);
   if (!result) {
-    // User requested block we don't have: sync from beacon then retry
-    if (blockId >= relay_.getNextBlockId()) {
+    // User requested block we don't have: sync from beacon then retry,
+    // unless the beacon pushes new blocks anyway
+    if (blockId >= relay_.getNextBlockId() && !blockSubscription_.isLive()) {
       trySyncBlocksFromBeacon(true);
       result = relay_.readBlock(blockId);
     }
@@ -493,6 +596,25 @@ RelayServer::hBlockGet(const Client::Request &request) {
   return result.value().ltsToString();
 }
 
+RelayServer::Roe<std::string>
+RelayServer::hBlockGetRange(const Client::Request &request) {
+  auto result = serveBlockRange(
+      request,
+      [this](uint64_t fromId) {
+        // User requested blocks we don't have yet: sync from beacon first,
+        // unless the beacon pushes new blocks anyway
+        if (fromId >= relay_.getNextBlockId() && !blockSubscription_.isLive()) {
+          trySyncBlocksFromBeacon(true);
+        }
+        return relay_.getNextBlockId();
+      },
+      [this](uint64_t blockId) { return readSerializedBlock(blockId); });
+  if (!result) {
+    return Error(E_REQUEST, result.error().message);
+  }
+  return result.value();
+}
+
 RelayServer::Roe<std::string>
 RelayServer::hBlockAdd(const Client::Request &request) {
   Ledger::ChainNode block;
@@ -554,6 +676,20 @@ RelayServer::hTxGetByIndex(const Client::Request &request) {
   return utl::binaryPack(result.value());
 }
 
+RelayServer::Roe<std::string>
+RelayServer::hTxProof(const Client::Request &request) {
+  auto reqResult = utl::binaryUnpack<Client::TxGetByIndexRequest>(request.payload);
+  if (!reqResult) {
+    return Error(E_REQUEST, "Failed to deserialize request: " + reqResult.error().message);
+  }
+  auto &req = reqResult.value();
+  auto result = relay_.findTransactionProof(req.txIndex);
+  if (!result) {
+    return Error(E_REQUEST, "Failed to get transaction proof: " + result.error().message);
+  }
+  return utl::binaryPack(result.value());
+}
+
 RelayServer::Roe<std::string>
 RelayServer::hRegister(const Client::Request &request) {
   auto unpacked = utl::binaryUnpack<pp::common::Meta>(request.payload);
@@ -572,7 +708,10 @@ RelayServer::hRegister(const Client::Request &request) {
 
 RelayServer::Roe<std::string>
 RelayServer::hStatus(const Client::Request &request) {
-  return utl::binaryPack(buildStateResponse().ltsToMeta());
+  auto meta = buildStateResponse().ltsToMeta();
+  meta.set("fetchServer", getFetchServerStatsMeta());
+  meta.set("requestQueue", getRequestQueueStatsMeta());
+  return utl::binaryPack(meta);
 }
 
 RelayServer::Roe<std::string>
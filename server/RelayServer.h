@@ -6,8 +6,10 @@
 #include "../network/DhtRunner.h"
 #include "../network/TcpConnection.h"
 #include "../network/Types.hpp"
+#include "BlockSubscription.h"
 #include "Relay.h"
 #include "Server.h"
+#include "SyncScheduler.h"
 #include <atomic>
 #include <map>
 #include <memory>
@@ -83,6 +85,8 @@ private:
     uint16_t port{Client::DEFAULT_BEACON_PORT};
     uint16_t dhtPort{Client::DEFAULT_DHT_PORT};
     BeaconConfig beacon;
+    Chain::AssumeValidConfig assumeValid;
+    uint32_t parallelApplyThreads{0}; // 0 = one per core, up to the chain cap
 
     nlohmann::json ltsToJson();
     Roe<void> ltsFromJson(const nlohmann::json &jd);
@@ -96,28 +100,39 @@ private:
 
   struct Config {
     NetworkConfig network;
+    Chain::AssumeValidConfig assumeValid;
+    uint32_t parallelApplyThreads{0};
   };
 
   void initHandlers();
   Roe<void> syncBlocksFromBeacon();
+  /** How long runLoop may idle: until the next slot starts. */
+  std::chrono::milliseconds getLoopWaitTime() const;
   /** Smart sync: when needed (epoch start, on-demand) and rate-limited. No block production. */
   void syncBlocksPeriodically();
   /** Perform sync from beacon (updates lastBlockSyncTime_ and lastSyncedEpoch_ on success). */
   void trySyncBlocksFromBeacon(bool bypassRateLimit = false);
+  /** Add the blocks the beacon pushed, then renew the subscription from the chain end. */
+  void addSubscribedBlocks();
 
   void registerServer(const Client::MinerInfo &minerInfo);
   Client::BeaconState buildStateResponse() const;
 
   std::string handleParsedRequest(const Client::Request &request) override;
+  std::optional<Ledger::BlockLocation> locateBlock(uint64_t blockId) const override;
+  std::optional<uint64_t> getSubscriptionEndId() const override;
+  std::optional<std::string> readSerializedBlock(uint64_t blockId) const override;
 
   /** Compute time offset in ms to beacon (beacon_time_ms = local_time_ms + offset). */
   Roe<int64_t> calibrateTimeToBeacon();
 
   // Getters
   Roe<std::string> hBlockGet(const Client::Request &request);
+  Roe<std::string> hBlockGetRange(const Client::Request &request);
   Roe<std::string> hAccountGet(const Client::Request &request);
   Roe<std::string> hTxGetByWallet(const Client::Request &request);
   Roe<std::string> hTxGetByIndex(const Client::Request &request);
+  Roe<std::string> hTxProof(const Client::Request &request);
   Roe<std::string> hStatus(const Client::Request &request);
   Roe<std::string> hCalibration(const Client::Request &request);
   Roe<std::string> hMinerList(const Client::Request &request);
@@ -130,6 +145,8 @@ private:
   Config config_;
   Relay relay_;
   Client client_;
+  BlockSubscription blockSubscription_;
+  SyncScheduler syncScheduler_;
   network::DhtRunner dhtRunner_;
 
   /** RTT above this (ms) triggers multiple calibration samples. */
@@ -3,7 +3,9 @@
 #include "lib/common/BinaryPack.hpp"
 #include "lib/common/Logger.h"
 #include "lib/common/Utilities.h"
+#include <algorithm>
 #include <filesystem>
+#include <sstream>
 
 namespace pp {
 
@@ -36,12 +38,64 @@ Service::Roe<void> Server::run(const std::string &workDir) {
   return Service::run();
 }
 
+Client::BlockRangeResponse Server::collectBlockRange(
+    const Client::BlockRangeRequest &request, uint64_t endId,
+    const std::function<std::optional<std::string>(uint64_t)> &readBlock) {
+  const uint64_t maxCount =
+      std::clamp<uint64_t>(request.maxCount, 1, Client::MAX_BLOCK_RANGE_COUNT);
+  const uint64_t maxBytes = std::min(request.maxBytes, Client::MAX_BLOCK_RANGE_BYTES);
+
+  Client::BlockRangeResponse response;
+  uint64_t totalBytes = 0;
+  for (uint64_t blockId = request.fromId;
+       blockId < endId && response.blocks.size() < maxCount; ++blockId) {
+    auto block = readBlock(blockId);
+    if (!block) {
+      break;
+    }
+    // Each entry also carries its length
+    uint64_t size = block->size() + sizeof(uint64_t);
+    if (!response.blocks.empty() && totalBytes + size > maxBytes) {
+      break;
+    }
+    totalBytes += size;
+    response.blocks.push_back(std::move(*block));
+  }
+  response.nextBlockId = request.fromId + response.blocks.size();
+  return response;
+}
+
+Service::Roe<std::string> Server::serveBlockRange(
+    const Client::Request &request,
+    const std::function<uint64_t(uint64_t)> &getEndId,
+    const std::function<std::optional<std::string>(uint64_t)> &readBlock) {
+  auto reqResult = utl::binaryUnpack<Client::BlockRangeRequest>(request.payload);
+  if (!reqResult) {
+    return Service::Error(-1, "Failed to deserialize request: " +
+                                  reqResult.error().message);
+  }
+  const auto &req = reqResult.value();
+  auto response = collectBlockRange(req, getEndId(req.fromId), readBlock);
+  if (response.blocks.empty()) {
+    return Service::Error(-1, "Failed to get block: " + std::to_string(req.fromId));
+  }
+  return utl::binaryPack(response);
+}
+
+std::string Server::packResponseHead(uint16_t errorCode, uint64_t payloadSize) {
+  std::ostringstream oss;
+  OutputArchive ar(oss);
+  uint32_t version = Client::Response::VERSION;
+  ar & version & errorCode & payloadSize;
+  return oss.str();
+}
+
 std::string Server::packResponse(const std::string &payload) {
-  Client::Response resp;
-  resp.version = Client::Response::VERSION;
-  resp.errorCode = 0;
-  resp.payload = payload;
-  return utl::binaryPack(resp);
+  // Same bytes as binaryPack(Client::Response), with one copy of the payload
+  std::string packed = packResponseHead(0, payload.size());
+  packed.reserve(packed.size() + payload.size());
+  packed += payload;
+  return packed;
 }
 
 std::string Server::packResponse(uint16_t errorCode,
@@ -53,15 +107,31 @@ std::string Server::packResponse(uint16_t errorCode,
   return utl::binaryPack(resp);
 }
 
+Server::RequestLane Server::getRequestLane(uint32_t requestType) {
+  switch (requestType) {
+  case Client::T_REQ_BLOCK_ADD:
+    return LANE_CONSENSUS;
+  case Client::T_REQ_BLOCK_GET:
+  case Client::T_REQ_BLOCK_GET_RANGE:
+  case Client::T_REQ_TX_GET_BY_WALLET:
+  case Client::T_REQ_TX_GET_BY_INDEX:
+  case Client::T_REQ_TX_PROOF:
+    return LANE_BULK;
+  default:
+    return LANE_DEFAULT;
+  }
+}
+
 size_t Server::getRequestQueueSize() const { return requestQueue_.size(); }
 
 bool Server::pollAndProcessOneRequest() {
   QueuedRequest qr;
-  if (!requestQueue_.poll(qr)) {
-    return false;
+  const bool isPolled = requestQueue_.poll(qr);
+  if (isPolled) {
+    processQueuedRequest(qr);
   }
-  processQueuedRequest(qr);
-  return true;
+  serveBlockSubscribers();
+  return isPolled;
 }
 
 size_t Server::pollAndProcessAllRequests(size_t maxCount) {
@@ -71,13 +141,187 @@ size_t Server::pollAndProcessAllRequests(size_t maxCount) {
     processQueuedRequest(qr);
     ++n;
   }
+  serveBlockSubscribers();
   return n;
 }
 
+bool Server::waitForRequest(std::chrono::milliseconds timeout) const {
+  return requestQueue_.waitFor(timeout);
+}
+
+std::chrono::milliseconds Server::getWaitUntil(int64_t wakeTime) const {
+  const int64_t ms = slotTimer_.getMsUntilTime(wakeTime);
+  return std::min(MAX_LOOP_WAIT, std::chrono::milliseconds(ms));
+}
+
+void Server::admitRequest(const network::FetchServer::ReplyTarget &target,
+                          const std::string &data,
+                          const network::IpEndpoint &peer) {
+  auto reqResult = utl::binaryUnpack<Client::Request>(data);
+  if (!reqResult) {
+    sendResponse(target, packResponse(1, reqResult.error().message));
+    return;
+  }
+
+  QueuedRequest qr;
+  qr.target = target;
+  qr.request = std::move(reqResult.value());
+  qr.lane = getRequestLane(qr.request.type);
+  if (!takePeerToken(peer, qr.lane)) {
+    ++rateLimitedRequests_;
+    log().debug << "Rate limited request from " << peer;
+    sendResponse(target, packResponse(Client::E_BUSY,
+                                      "Request rate limit exceeded, retry later"));
+    return;
+  }
+
+  const RequestLane lane = qr.lane;
+  qr.enqueueTime = std::chrono::steady_clock::now();
+  if (!requestQueue_.tryPush(lane, std::move(qr))) {
+    ++laneStats_[lane].rejected;
+    log().debug << "Request queue lane " << lane << " full, rejecting request";
+    sendResponse(target, packResponse(Client::E_BUSY, "Server busy, retry later"));
+    return;
+  }
+  ++laneStats_[lane].admitted;
+  log().debug << "Request enqueued (queue size: " << getRequestQueueSize() << ")";
+}
+
+bool Server::takePeerToken(const network::IpEndpoint &peer, RequestLane lane) {
+  const bool isConsensus = lane == LANE_CONSENSUS;
+  const double rate = isConsensus ? requestQueueConfig_.peerConsensusPerSecond
+                                  : requestQueueConfig_.peerRequestsPerSecond;
+  const double burst = isConsensus ? requestQueueConfig_.peerConsensusBurst
+                                   : requestQueueConfig_.peerBurst;
+  if (rate <= 0) {
+    return true;
+  }
+  const auto now = TokenBucket::Clock::now();
+  std::lock_guard<std::mutex> lock(peerMutex_);
+  auto &buckets = isConsensus ? mPeerConsensusBuckets_ : mPeerBuckets_;
+  if (buckets.size() >= MAX_PEER_BUCKETS) {
+    // Idle peers lose nothing by starting over with a full bucket
+    for (auto it = buckets.begin(); it != buckets.end();) {
+      it = it->second.isFull(now) ? buckets.erase(it) : std::next(it);
+    }
+  }
+  auto it = buckets.find(peer.address);
+  if (it == buckets.end()) {
+    it = buckets.emplace(peer.address, TokenBucket(rate, burst, now)).first;
+  }
+  return it->second.tryTake(now);
+}
+
 void Server::processQueuedRequest(QueuedRequest &qr) {
-  log().debug << "Processing request from queue";
-  std::string response = handleRequest(qr.request);
-  sendResponse(qr.fd, response);
+  const uint64_t waitMicros =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - qr.enqueueTime)
+          .count();
+  LaneStats &stats = laneStats_[qr.lane];
+  ++stats.processed;
+  stats.waitMicros += waitMicros;
+  if (waitMicros > stats.maxWaitMicros) {
+    stats.maxWaitMicros = waitMicros;  // Only the request thread writes it
+  }
+
+  log().debug << "Processing request from queue (type " << qr.request.type
+              << ", waited " << waitMicros << " us)";
+  const Client::Request &request = qr.request;
+  if (request.type == Client::T_REQ_BLOCK_GET &&
+      sendBlockFromFile(qr.target, request)) {
+    return;
+  }
+  if (request.type == Client::T_REQ_BLOCK_SUBSCRIBE &&
+      handleBlockSubscribe(qr.target, request)) {
+    return;
+  }
+  sendResponse(qr.target, handleParsedRequest(request));
+}
+
+bool Server::handleBlockSubscribe(const network::FetchServer::ReplyTarget &target,
+                                  const Client::Request &request) {
+  const auto endId = getSubscriptionEndId();
+  if (!endId) {
+    return false;
+  }
+  auto reqResult = utl::binaryUnpack<Client::BlockSubscribeRequest>(request.payload);
+  if (!reqResult) {
+    sendResponse(target, packResponse(1, "Failed to deserialize request: " +
+                                             reqResult.error().message));
+    return true;
+  }
+
+  BlockSubscriber subscriber;
+  subscriber.target = target;
+  subscriber.request = reqResult.value();
+  if (subscriber.request.fromId < *endId || subscriber.request.maxWaitMs == 0) {
+    answerBlockSubscriber(subscriber, *endId);
+    return true;
+  }
+  if (blockSubscribers_.size() >= MAX_BLOCK_SUBSCRIBERS) {
+    sendResponse(target, packResponse(Client::E_BUSY, "Too many block subscribers"));
+    return true;
+  }
+  const uint64_t waitMs =
+      std::min(subscriber.request.maxWaitMs, Client::MAX_SUBSCRIBE_WAIT_MS);
+  subscriber.deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs);
+  blockSubscribers_.push_back(std::move(subscriber));
+  log().debug << "Holding block subscriber from " << reqResult.value().fromId
+              << " (" << blockSubscribers_.size() << " held)";
+  return true;
+}
+
+void Server::answerBlockSubscriber(const BlockSubscriber &subscriber, uint64_t endId) {
+  Client::BlockRangeRequest range;
+  range.fromId = subscriber.request.fromId;
+  range.maxBytes = subscriber.request.maxBytes;
+  auto response = collectBlockRange(
+      range, endId, [this](uint64_t blockId) { return readSerializedBlock(blockId); });
+  auto result = addResponse(subscriber.target, packResponse(utl::binaryPack(response)));
+  if (!result) {
+    // Subscribers that went away while held are expected
+    log().debug << "Block subscriber gone: " << result.error().message;
+  }
+}
+
+void Server::serveBlockSubscribers() {
+  if (blockSubscribers_.empty()) {
+    return;
+  }
+  const uint64_t endId = getSubscriptionEndId().value_or(0);
+  const auto now = std::chrono::steady_clock::now();
+  std::erase_if(blockSubscribers_, [&](const BlockSubscriber &subscriber) {
+    if (subscriber.request.fromId < endId || now >= subscriber.deadline) {
+      answerBlockSubscriber(subscriber, endId);
+      return true;
+    }
+    return false;
+  });
+}
+
+bool Server::sendBlockFromFile(const network::FetchServer::ReplyTarget &target,
+                               const Client::Request &request) {
+  auto idResult = utl::binaryUnpack<uint64_t>(request.payload);
+  if (!idResult) {
+    return false;
+  }
+  auto location = locateBlock(idResult.value());
+  if (!location) {
+    return false;
+  }
+
+  network::FetchServer::FileRange file;
+  file.path = location->filePath;
+  file.offset = location->offset;
+  file.size = location->size;
+  auto result = fetchServer_.addFileResponse(
+      target, packResponseHead(0, location->size), file);
+  if (!result) {
+    log().warning << "Failed to send block from file: " << result.error().message;
+    return false;
+  }
+  return true;
 }
 
 Service::Roe<void>
@@ -85,36 +329,81 @@ Server::startFetchServer(const network::IpEndpoint &endpoint) {
   fetchServer_.redirectLogger(log().getFullName() + ".FetchServer");
   network::FetchServer::Config config;
   config.endpoint = endpoint;
-  config.handler = [this](int fd, const std::string &request,
-                          const network::IpEndpoint &) {
-    requestQueue_.push(QueuedRequest{fd, request});
-
-    log().debug << "Request enqueued (queue size: " << getRequestQueueSize()
-                << ")";
+  config.handler = [this](const network::FetchServer::ReplyTarget &target,
+                          const std::string &request,
+                          const network::IpEndpoint &peer) {
+    admitRequest(target, request, peer);
   };
   customizeFetchServerConfig(config);
+  initRequestQueue();
   return fetchServer_.start(config);
 }
 
+void Server::initRequestQueue() {
+  customizeRequestQueueConfig(requestQueueConfig_);
+  for (size_t lane = 0; lane < LANE_COUNT; ++lane) {
+    requestQueue_.setCapacity(lane, requestQueueConfig_.laneCapacity[lane]);
+  }
+}
+
 void Server::stopFetchServer() { fetchServer_.stop(); }
 
+pp::common::Meta Server::getFetchServerStatsMeta() const {
+  std::vector<pp::common::Meta::Value> reactors;
+  for (const auto &stats : fetchServer_.getReactorStats()) {
+    pp::common::Meta r;
+    r.set("openConnections", stats.openConnections);
+    r.set("acceptedConnections", stats.acceptedConnections);
+    r.set("requests", stats.requests);
+    r.set("responses", stats.responses);
+    r.set("bytesRead", stats.bytesRead);
+    r.set("compressedResponses", stats.compressedResponses);
+    r.set("compressionBytesIn", stats.compressionBytesIn);
+    r.set("compressionBytesOut", stats.compressionBytesOut);
+    r.set("compressionMicros", stats.compressionMicros);
+    reactors.push_back(std::make_shared<pp::common::Meta>(std::move(r)));
+  }
+  pp::common::Meta m;
+  m.set("reactors", pp::common::Meta::array(std::move(reactors)));
+  return m;
+}
+
+pp::common::Meta Server::getRequestQueueStatsMeta() const {
+  static const char *const LANE_NAMES[LANE_COUNT] = {"consensus", "default", "bulk"};
+  std::vector<pp::common::Meta::Value> lanes;
+  for (size_t lane = 0; lane < LANE_COUNT; ++lane) {
+    const LaneStats &stats = laneStats_[lane];
+    pp::common::Meta l;
+    l.set("name", LANE_NAMES[lane]);
+    l.set("depth", static_cast<uint64_t>(requestQueue_.size(lane)));
+    l.set("capacity", static_cast<uint64_t>(requestQueue_.getCapacity(lane)));
+    l.set("admitted", stats.admitted.load());
+    l.set("rejected", stats.rejected.load());
+    l.set("processed", stats.processed.load());
+    l.set("waitMicros", stats.waitMicros.load());
+    l.set("maxWaitMicros", stats.maxWaitMicros.load());
+    lanes.push_back(std::make_shared<pp::common::Meta>(std::move(l)));
+  }
+  pp::common::Meta m;
+  m.set("lanes", pp::common::Meta::array(std::move(lanes)));
+  m.set("rateLimited", rateLimitedRequests_.load());
+  return m;
+}
+
 void Server::onStop() { stopFetchServer(); }
 
-void Server::sendResponse(int fd, const std::string &response) {
-  auto addResponseResult = fetchServer_.addResponse(fd, response);
+network::FetchServer::Roe<void>
+Server::addResponse(const network::FetchServer::ReplyTarget &target, std::string response) {
+  return fetchServer_.addResponse(target, std::move(response));
+}
+
+void Server::sendResponse(const network::FetchServer::ReplyTarget &target,
+                          std::string response) {
+  auto addResponseResult = addResponse(target, std::move(response));
   if (!addResponseResult) {
     log().error << "Failed to queue response: "
                 << addResponseResult.error().message;
   }
 }
 
-std::string Server::handleRequest(const std::string &request) {
-  log().debug << "Received request (" << request.size() << " bytes)";
-  auto reqResult = utl::binaryUnpack<Client::Request>(request);
-  if (!reqResult) {
-    return packResponse(1, reqResult.error().message);
-  }
-  return handleParsedRequest(reqResult.value());
-}
-
 } // namespace pp
@@ -3,10 +3,20 @@
 
 #include "../client/Client.h"
 #include "lib/common/Service.h"
-#include "lib/common/ThreadSafeQueue.hpp"
+#include "lib/common/BoundedPriorityQueue.hpp"
+#include "lib/common/TokenBucket.hpp"
 #include "../network/FetchServer.h"
+#include "../consensus/SlotTimer.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace pp {
 
@@ -16,8 +26,17 @@ namespace pp {
  * Provides common run(workDir) behavior: work directory setup, optional
  * signature file for directory recognition, log file handler, then
  * Service::run() (onStart + runLoop). Also provides shared request queue,
- * processQueuedRequest, and handleRequest(string) with virtual
- * handleParsedRequest and sendResponse for derived implementations.
+ * processQueuedRequest with virtual handleParsedRequest and sendResponse for
+ * derived implementations.
+ *
+ * Requests are admitted on the network threads: each goes to a priority lane
+ * by type, and is answered right away with Client::E_BUSY when its lane is
+ * full or its peer exceeded the per-peer rate. Block submissions are always
+ * processed first and have their own, smaller per-peer rate, so a peer's
+ * other traffic neither delays them nor uses up their budget.
+ *
+ * Servers with a chain to offer (getSubscriptionEndId) hold T_REQ_BLOCK_SUBSCRIBE
+ * long polls and answer them as soon as a new block is added.
  */
 class Server : public Service {
 public:
@@ -27,6 +46,9 @@ public:
   virtual Service::Roe<void> run(const std::string &workDir);
 
 protected:
+  /** Longest a run loop blocks, so a stop flag set from a signal handler is seen. */
+  constexpr static std::chrono::milliseconds MAX_LOOP_WAIT{ 1000 };
+
   virtual bool useSignatureFile() const { return true; }
 
   const std::string &getWorkDir() const { return workDir_; }
@@ -38,39 +60,171 @@ protected:
     return fetchServer_.getEndpoint();
   }
 
+  /** Request priority lanes, processed in this order. */
+  enum RequestLane : size_t {
+    LANE_CONSENSUS = 0,  // Block submission
+    LANE_DEFAULT,        // Transactions, status, accounts, registration, calibration
+    LANE_BULK,           // Block and transaction history reads
+    LANE_COUNT
+  };
+
+  struct RequestQueueConfig {
+    std::array<size_t, LANE_COUNT> laneCapacity{ 1000, 10000, 10000 };
+    // Per peer address (all of its connections); 0 = unlimited
+    double peerRequestsPerSecond{ 1000 };
+    double peerBurst{ 2000 };
+    // Consensus lane only, apart from the above; a slot leader submits about
+    // one block per slot, so no single peer can fill the lane
+    double peerConsensusPerSecond{ 10 };
+    double peerConsensusBurst{ 20 };
+  };
+
+  static RequestLane getRequestLane(uint32_t requestType);
+
   size_t getRequestQueueSize() const;
 
   static std::string packResponse(const std::string &payload);
   static std::string packResponse(uint16_t errorCode,
                                   const std::string &message);
-
+  /** packResponse() up to the payload bytes: version, error code and payload length. */
+  static std::string packResponseHead(uint16_t errorCode, uint64_t payloadSize);
+
+  /**
+   * Blocks for a T_REQ_BLOCK_GET_RANGE request: from request.fromId up to
+   * endId, within the request's and the server's count and byte caps, and
+   * stopping at the first block readBlock cannot serialize. The first block
+   * is included regardless of the byte cap.
+   */
+  static Client::BlockRangeResponse collectBlockRange(
+      const Client::BlockRangeRequest &request, uint64_t endId,
+      const std::function<std::optional<std::string>(uint64_t)> &readBlock);
+  /**
+   * T_REQ_BLOCK_GET_RANGE for every server: parse the request, then
+   * collectBlockRange() up to getEndId(fromId) with readBlock. getEndId runs
+   * after parsing, so a server may sync first when fromId is past its chain
+   * end. Fails when not even the first block is available.
+   */
+  static Service::Roe<std::string> serveBlockRange(
+      const Client::Request &request,
+      const std::function<uint64_t(uint64_t)> &getEndId,
+      const std::function<std::optional<std::string>(uint64_t)> &readBlock);
+
+  /** Process one queued request, then serve block subscribers. */
   bool pollAndProcessOneRequest();
-  /** Process all pending requests in the queue (up to a cap). Returns number processed. */
+  /** Process all pending requests in the queue (up to a cap), then serve block subscribers. Returns number processed. */
   size_t pollAndProcessAllRequests(size_t maxCount = 100);
+  /** Block until a request is queued, wakeUp() is called or the timeout passes. Returns true unless timed out. */
+  bool waitForRequest(std::chrono::milliseconds timeout) const;
+  /** End the current (or next) waitForRequest early; thread-safe. */
+  void wakeUp() { requestQueue_.interrupt(); }
+  /** Time until the slot timer reaches wakeTime (consensus seconds), capped by MAX_LOOP_WAIT. */
+  std::chrono::milliseconds getWaitUntil(int64_t wakeTime) const;
+  consensus::SlotTimer &getSlotTimer() { return slotTimer_; }
 
   virtual std::string handleParsedRequest(const Client::Request &request) = 0;
 
+  /**
+   * Where block blockId is stored, so T_REQ_BLOCK_GET is answered straight
+   * from the block file. nullopt leaves the request to handleParsedRequest.
+   */
+  virtual std::optional<Ledger::BlockLocation> locateBlock(uint64_t blockId) const {
+    return std::nullopt;
+  }
+
+  /**
+   * Chain end for T_REQ_BLOCK_SUBSCRIBE: a subscriber is answered with the
+   * blocks from its fromId once that is below the returned id. nullopt
+   * (default) leaves the request to handleParsedRequest.
+   */
+  virtual std::optional<uint64_t> getSubscriptionEndId() const { return std::nullopt; }
+  /** Block blockId serialized as in block range responses; nullopt if unreadable. */
+  virtual std::optional<std::string> readSerializedBlock(uint64_t blockId) const {
+    return std::nullopt;
+  }
+  /**
+   * Answer held subscribers that have new blocks or whose wait expired.
+   * The pollAndProcess calls run it; call it also after adding blocks
+   * outside of requests.
+   */
+  void serveBlockSubscribers();
+
   Service::Roe<void> startFetchServer(const network::IpEndpoint &endpoint);
   void stopFetchServer();
 
+  /** Per-reactor FetchServer counters, for status responses. */
+  pp::common::Meta getFetchServerStatsMeta() const;
+
+  /** Per-lane queue depth, admissions, rejections and queue wait times. */
+  pp::common::Meta getRequestQueueStatsMeta() const;
+
   /** Override to customize FetchServer config (e.g. whitelist) before start. */
   virtual void customizeFetchServerConfig(network::FetchServer::Config &config) {}
+  /** Override to customize request queue limits before the FetchServer starts. */
+  virtual void customizeRequestQueueConfig(RequestQueueConfig &config) {}
+  /** Apply customizeRequestQueueConfig(); startFetchServer() calls it. */
+  void initRequestQueue();
+
+  /** FetchServer handler (network threads): parse, rate limit and queue. */
+  void admitRequest(const network::FetchServer::ReplyTarget &target,
+                    const std::string &data, const network::IpEndpoint &peer);
+  /** Queue a response on the FetchServer; overridden by tests. */
+  virtual network::FetchServer::Roe<void>
+  addResponse(const network::FetchServer::ReplyTarget &target, std::string response);
+
+  /** Held T_REQ_BLOCK_SUBSCRIBE requests; more are answered with E_BUSY. */
+  constexpr static size_t MAX_BLOCK_SUBSCRIBERS{ 1024 };
 
   void onStop() override;
 
 private:
+  /** Peers whose buckets are kept before idle (full) ones are dropped. */
+  constexpr static size_t MAX_PEER_BUCKETS{ 4096 };
   struct QueuedRequest {
-    int fd{-1};
-    std::string request;
+    network::FetchServer::ReplyTarget target;
+    Client::Request request;
+    RequestLane lane{ LANE_DEFAULT };
+    std::chrono::steady_clock::time_point enqueueTime;
   };
 
-  void processQueuedRequest(QueuedRequest &qr);
-  std::string handleRequest(const std::string &request);
+  struct LaneStats {
+    std::atomic<uint64_t> admitted{ 0 };
+    std::atomic<uint64_t> rejected{ 0 };  // Lane full
+    std::atomic<uint64_t> processed{ 0 };
+    std::atomic<uint64_t> waitMicros{ 0 };  // Total time spent queued
+    std::atomic<uint64_t> maxWaitMicros{ 0 };
+  };
 
-  void sendResponse(int fd, const std::string &response);
+  struct BlockSubscriber {
+    network::FetchServer::ReplyTarget target;
+    Client::BlockSubscribeRequest request;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  bool takePeerToken(const network::IpEndpoint &peer, RequestLane lane);
+  void processQueuedRequest(QueuedRequest &qr);
+  /** Answer or hold a T_REQ_BLOCK_SUBSCRIBE; false if this server has no chain to offer. */
+  bool handleBlockSubscribe(const network::FetchServer::ReplyTarget &target,
+                            const Client::Request &request);
+  void answerBlockSubscriber(const BlockSubscriber &subscriber, uint64_t endId);
+  /** Answer T_REQ_BLOCK_GET from locateBlock(); false if not possible. */
+  bool sendBlockFromFile(const network::FetchServer::ReplyTarget &target,
+                         const Client::Request &request);
+
+  /** addResponse(), logging failures. */
+  void sendResponse(const network::FetchServer::ReplyTarget &target,
+                    std::string response);
 
   std::string workDir_;
-  ThreadSafeQueue<QueuedRequest> requestQueue_;
+  RequestQueueConfig requestQueueConfig_;
+  BoundedPriorityQueue<QueuedRequest> requestQueue_{
+      std::vector<size_t>(LANE_COUNT, 0) };
+  std::array<LaneStats, LANE_COUNT> laneStats_;
+  std::atomic<uint64_t> rateLimitedRequests_{ 0 };
+  std::mutex peerMutex_;
+  std::unordered_map<std::string, TokenBucket> mPeerBuckets_;
+  std::unordered_map<std::string, TokenBucket> mPeerConsensusBuckets_;
+  std::vector<BlockSubscriber> blockSubscribers_;  // Request thread only
+  consensus::SlotTimer slotTimer_;
   network::FetchServer fetchServer_;
 };
 
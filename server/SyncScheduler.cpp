@@ -0,0 +1,328 @@
+#include "SyncScheduler.h"
+#include "lib/common/Logger.h"
+#include <algorithm>
+
+namespace pp {
+
+namespace {
+
+bool isSameEndpoint(const network::IpEndpoint &a, const network::IpEndpoint &b) {
+  return a.address == b.address && a.port == b.port;
+}
+
+} // namespace
+
+void SyncScheduler::setPeers(const std::vector<network::IpEndpoint> &trusted,
+                             const std::vector<network::IpEndpoint> &discovered,
+                             const network::IpEndpoint &self) {
+  std::vector<Peer> peers;
+  auto addPeer = [this, &peers](const network::IpEndpoint &endpoint, bool isTrusted) {
+    auto it = std::find_if(peers_.begin(), peers_.end(), [&endpoint](const Peer &p) {
+      return isSameEndpoint(p.stats.endpoint, endpoint);
+    });
+    if (it != peers_.end()) {
+      peers.push_back(std::move(*it));
+      peers_.erase(it);
+      peers.back().stats.isTrusted = isTrusted;
+      return;
+    }
+    Peer peer;
+    peer.stats.endpoint = endpoint;
+    peer.stats.isTrusted = isTrusted;
+    peer.stats.score = MAX_SCORE;
+    peer.client = std::make_unique<Client>();
+    peer.client->redirectLogger(log().getFullName() + ".Client");
+    peer.client->setEndpoint(endpoint);
+    peers.push_back(std::move(peer));
+  };
+  auto isKnown = [&peers](const network::IpEndpoint &endpoint) {
+    return std::any_of(peers.begin(), peers.end(), [&endpoint](const Peer &p) {
+      return isSameEndpoint(p.stats.endpoint, endpoint);
+    });
+  };
+
+  for (const auto &endpoint : trusted) {
+    if (!isKnown(endpoint)) {
+      addPeer(endpoint, true);
+    }
+  }
+  size_t discoveredCount = 0;
+  for (const auto &endpoint : discovered) {
+    if (discoveredCount >= config_.maxDiscoveredPeers) {
+      break;
+    }
+    const bool isSelf = endpoint.port == self.port &&
+                        (endpoint.address == self.address || endpoint.address == "127.0.0.1");
+    if (isSelf || isKnown(endpoint)) {
+      continue;
+    }
+    addPeer(endpoint, false);
+    ++discoveredCount;
+  }
+  peers_ = std::move(peers);
+}
+
+std::vector<SyncScheduler::PeerStats> SyncScheduler::getPeerStats() const {
+  std::vector<PeerStats> stats;
+  for (const auto &peer : peers_) {
+    stats.push_back(peer.stats);
+  }
+  return stats;
+}
+
+std::optional<size_t> SyncScheduler::choosePeer(uint64_t blockId) const {
+  std::optional<size_t> best;
+  double bestRank = 0;
+  for (size_t i = 0; i < peers_.size(); ++i) {
+    const auto &peer = peers_[i];
+    if (!peer.stats.isTrusted && blockId < config_.trustedEndId) {
+      continue;
+    }
+    if (peer.stats.score < MIN_SCORE || !peer.nextBlockId ||
+        *peer.nextBlockId <= blockId || peer.inFlight >= config_.maxInFlightPerPeer) {
+      continue;
+    }
+    // Spread load: a busy peer ranks below an idle one with a similar score
+    const double rank = peer.stats.score / static_cast<double>(1 + peer.inFlight);
+    if (!best || rank > bestRank) {
+      best = i;
+      bestRank = rank;
+    }
+  }
+  return best;
+}
+
+void SyncScheduler::requestChunk(size_t peer, const Chunk &chunk) {
+  Client::BlockRangeRequest request;
+  request.fromId = chunk.fromId;
+  request.maxCount = chunk.count;
+  ++peers_[peer].inFlight;
+  const auto sentTime = std::chrono::steady_clock::now();
+  fetchBlockRange(
+      peer, request,
+      [inbox = inbox_, peer, chunk, sentTime](const Client::Roe<Client::BlockRange> &result) {
+        Completion completion;
+        completion.peer = peer;
+        completion.chunk = chunk;
+        completion.sentTime = sentTime;
+        completion.range = result;
+        {
+          std::lock_guard<std::mutex> lock(inbox->mutex);
+          inbox->completions.push_back(std::move(completion));
+        }
+        inbox->cv.notify_one();
+      });
+}
+
+void SyncScheduler::fetchCalibration(size_t peer, CalibrationCallback callback) {
+  peers_[peer].client->fetchCalibration(std::move(callback));
+}
+
+void SyncScheduler::fetchBlockRange(size_t peer, const Client::BlockRangeRequest &request,
+                                    RangeCallback callback) {
+  peers_[peer].client->fetchBlockRange(request, std::move(callback));
+}
+
+void SyncScheduler::penalize(Peer &peer, double factor) {
+  peer.stats.score *= factor;
+  if (peer.stats.score < MIN_SCORE) {
+    log().warning << "Not syncing from " << peer.stats.endpoint << " anymore (score "
+                  << peer.stats.score << ")";
+  }
+}
+
+SyncScheduler::Roe<uint64_t> SyncScheduler::sync(uint64_t fromId, uint64_t endId,
+                                                 const AddBlock &addBlock) {
+  if (fromId >= endId) {
+    return 0;
+  }
+  if (peers_.empty()) {
+    return Error(E_NO_PEER, "No peers to sync from");
+  }
+
+  // Completions of an earlier sync that gave up carry stale peer indices
+  auto inbox = std::make_shared<Inbox>();
+  inbox_ = inbox;
+
+  // Probe each peer's chain end, so chunks only go to peers that have them
+  size_t probesInFlight = 0;
+  for (size_t i = 0; i < peers_.size(); ++i) {
+    auto &peer = peers_[i];
+    peer.stats.score = std::max(peer.stats.score, MIN_SCORE);
+    peer.nextBlockId.reset();
+    peer.inFlight = 0;
+    ++probesInFlight;
+    fetchCalibration(
+        i, [inbox, i](const Client::Roe<Client::CalibrationResponse> &result) {
+          Completion completion;
+          completion.peer = i;
+          completion.calibration = result;
+          {
+            std::lock_guard<std::mutex> lock(inbox->mutex);
+            inbox->completions.push_back(std::move(completion));
+          }
+          inbox->cv.notify_one();
+        });
+  }
+
+  std::deque<Chunk> retries;  // Chunks to fetch again, lowest first
+  std::map<uint64_t, Buffered> buffer;
+  uint64_t nextRequestId = fromId;
+  uint64_t nextId = fromId;
+  size_t requestsInFlight = 0;
+  std::optional<std::chrono::steady_clock::time_point> probeDeadline;
+  std::string lastError;
+
+  const uint64_t window = config_.chunkSize * config_.maxChunksAhead;
+  while (nextId < endId) {
+    // Assign chunks within the reorder window to the best free peers; wait a
+    // moment after the first probe answers so the others can join in
+    const bool isProbing =
+        probesInFlight > 0 &&
+        (!probeDeadline || std::chrono::steady_clock::now() < *probeDeadline);
+    while (!isProbing) {
+      Chunk chunk;
+      if (!retries.empty()) {
+        chunk = retries.front();
+      } else if (nextRequestId < endId) {
+        chunk.fromId = nextRequestId;
+        chunk.count = std::min(config_.chunkSize, endId - nextRequestId);
+      } else {
+        break;
+      }
+      if (chunk.fromId >= nextId + window) {
+        break;
+      }
+      auto peer = choosePeer(chunk.fromId);
+      if (!peer) {
+        break;
+      }
+      // Ask only for what the peer has; the rest stays queued
+      chunk.count = std::min(chunk.count, *peers_[*peer].nextBlockId - chunk.fromId);
+      if (!retries.empty()) {
+        retries.front().fromId += chunk.count;
+        retries.front().count -= chunk.count;
+        if (retries.front().count == 0) {
+          retries.pop_front();
+        }
+      } else {
+        nextRequestId += chunk.count;
+      }
+      requestChunk(*peer, chunk);
+      ++requestsInFlight;
+    }
+
+    if (requestsInFlight == 0 && probesInFlight == 0) {
+      return Error(E_NO_PEER, "No peer can supply block " + std::to_string(nextId) +
+                                  (lastError.empty() ? "" : ": " + lastError));
+    }
+
+    std::deque<Completion> completions;
+    {
+      std::unique_lock<std::mutex> lock(inbox->mutex);
+      inbox->cv.wait_for(lock, PROBE_WAIT, [&inbox] { return !inbox->completions.empty(); });
+      completions.swap(inbox->completions);
+    }
+
+    for (auto &completion : completions) {
+      auto &peer = peers_[completion.peer];
+      if (completion.calibration) {
+        --probesInFlight;
+        const auto &result = *completion.calibration;
+        if (!result) {
+          ++peer.stats.failures;
+          penalize(peer, FAILURE_FACTOR);
+          lastError = result.error().message;
+          continue;
+        }
+        peer.nextBlockId = result.value().nextBlockId;
+        if (!probeDeadline && *peer.nextBlockId > nextId) {
+          probeDeadline = std::chrono::steady_clock::now() + PROBE_WAIT;
+        }
+        continue;
+      }
+
+      --peer.inFlight;
+      --requestsInFlight;
+      const auto &result = *completion.range;
+      const auto &chunk = completion.chunk;
+      if (!result) {
+        log().debug << "Blocks " << chunk.fromId << "+" << chunk.count << " from "
+                    << peer.stats.endpoint << " failed: " << result.error().message;
+        ++peer.stats.failures;
+        penalize(peer, FAILURE_FACTOR);
+        lastError = result.error().message;
+        retries.push_back(chunk);
+        continue;
+      }
+
+      const auto &blocks = result.value().blocks;
+      uint64_t blockId = chunk.fromId;
+      for (const auto &block : blocks) {
+        if (blockId >= nextId) {
+          buffer[blockId] = Buffered{ block, completion.peer };
+        }
+        ++blockId;
+      }
+      if (blocks.size() < chunk.count) {
+        // Size limits cut the range short; fetch the remainder again
+        retries.push_back({ chunk.fromId + blocks.size(), chunk.count - blocks.size() });
+      }
+      if (std::chrono::steady_clock::now() - completion.sentTime > config_.slowRequest) {
+        penalize(peer, SLOW_FACTOR);
+      } else {
+        peer.stats.score = std::min(MAX_SCORE, peer.stats.score + SUCCESS_STEP);
+      }
+    }
+    std::sort(retries.begin(), retries.end(),
+              [](const Chunk &a, const Chunk &b) { return a.fromId < b.fromId; });
+
+    // Add what is contiguous from nextId
+    while (!buffer.empty() && buffer.begin()->first == nextId) {
+      auto buffered = std::move(buffer.begin()->second);
+      buffer.erase(buffer.begin());
+      auto &peer = peers_[buffered.peer];
+      auto added = addBlock(buffered.block);
+      if (added) {
+        ++peer.stats.blocks;
+        ++nextId;
+        continue;
+      }
+
+      // The peer served a block our chain rejects: stop using it and fetch
+      // everything it delivered again from the others
+      log().warning << "Block " << nextId << " from " << peer.stats.endpoint
+                    << " rejected: " << added.error().message;
+      ++peer.stats.failures;
+      peer.stats.score = 0;
+      lastError = added.error().message;
+      std::vector<uint64_t> dropped{ nextId };
+      for (auto it = buffer.begin(); it != buffer.end();) {
+        if (it->second.peer == buffered.peer) {
+          dropped.push_back(it->first);
+          it = buffer.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      for (uint64_t id : dropped) {
+        if (!retries.empty() && retries.back().fromId + retries.back().count == id) {
+          ++retries.back().count;
+        } else {
+          retries.push_back({ id, 1 });
+        }
+      }
+      std::sort(retries.begin(), retries.end(),
+                [](const Chunk &a, const Chunk &b) { return a.fromId < b.fromId; });
+      break;
+    }
+  }
+
+  for (const auto &peer : peers_) {
+    log().debug << "Sync peer " << peer.stats.endpoint << ": score " << peer.stats.score
+                << ", blocks " << peer.stats.blocks << ", failures " << peer.stats.failures;
+  }
+  return nextId - fromId;
+}
+
+} // namespace pp
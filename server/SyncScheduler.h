@@ -0,0 +1,161 @@
+#ifndef PP_LEDGER_SYNC_SCHEDULER_H
+#define PP_LEDGER_SYNC_SCHEDULER_H
+
+#include "../client/Client.h"
+#include "../network/Types.hpp"
+#include "lib/common/Module.h"
+#include "lib/common/ResultOrError.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace pp {
+
+/**
+ * SyncScheduler - Downloads a block range from several upstream peers at once.
+ *
+ * The range is split into chunks that are fetched concurrently with
+ * T_REQ_BLOCK_GET_RANGE from the peers whose chain reaches them. Blocks go
+ * through a reorder buffer and are passed to the caller's addBlock strictly
+ * in order, on the calling thread. Each peer has a score: failed or slow
+ * requests lower it and a block addBlock rejects zeroes it, so bad peers get
+ * fewer chunks and eventually none. Scores carry over between syncs.
+ *
+ * Peers are trusted (the configured upstreams) or discovered (DHT). The
+ * chain skips signature and slot-leader checks up to the assume-valid block,
+ * so a discovered peer could serve a forged prefix there; blocks below
+ * Config::trustedEndId therefore come from trusted peers only.
+ */
+class SyncScheduler : public Module {
+public:
+  struct Error : RoeErrorBase {
+    using RoeErrorBase::RoeErrorBase;
+  };
+
+  template <typename T> using Roe = ResultOrError<T, Error>;
+
+  static constexpr const int32_t E_NO_PEER = -1;
+
+  struct Config {
+    uint64_t chunkSize{ 100 };        // Blocks per range request
+    size_t maxInFlightPerPeer{ 2 };
+    size_t maxChunksAhead{ 16 };      // Reorder window past the next block to add
+    // Requests slower than this lower the peer's score
+    std::chrono::milliseconds slowRequest{ 5000 };
+    size_t maxDiscoveredPeers{ 8 };   // Used besides the trusted ones
+    // Blocks below this are fetched from trusted peers only; set past the
+    // assume-valid block when assume-valid is enabled
+    uint64_t trustedEndId{ 0 };
+  };
+
+  struct PeerStats {
+    network::IpEndpoint endpoint;
+    bool isTrusted{ false };
+    double score{ 0 };
+    uint64_t blocks{ 0 };    // Blocks added from this peer
+    uint64_t failures{ 0 };  // Failed requests and rejected blocks
+  };
+
+  /** Adds one block to the chain; an error blames the peer that served it. */
+  using AddBlock = std::function<Roe<void>(Ledger::ChainNode &block)>;
+
+  SyncScheduler() = default;
+  ~SyncScheduler() override = default;
+
+  void setConfig(const Config &config) { config_ = config; }
+
+  /**
+   * Set the candidate peers: all trusted ones, then up to maxDiscoveredPeers
+   * discovered ones that are neither trusted nor self. Scores of peers
+   * already known are kept.
+   */
+  void setPeers(const std::vector<network::IpEndpoint> &trusted,
+                const std::vector<network::IpEndpoint> &discovered,
+                const network::IpEndpoint &self);
+
+  /**
+   * Fetch blocks [fromId, endId) and pass them to addBlock in order.
+   * Returns the number of blocks added; an error if no peer can supply the
+   * rest (blocks added before that stay added).
+   */
+  Roe<uint64_t> sync(uint64_t fromId, uint64_t endId, const AddBlock &addBlock);
+
+  std::vector<PeerStats> getPeerStats() const;
+
+protected:
+  using CalibrationCallback =
+      std::function<void(const Client::Roe<Client::CalibrationResponse> &)>;
+  using RangeCallback = std::function<void(const Client::Roe<Client::BlockRange> &)>;
+
+  /** Requests to peer (index in getPeerStats order); callbacks may run on any thread. */
+  virtual void fetchCalibration(size_t peer, CalibrationCallback callback);
+  virtual void fetchBlockRange(size_t peer, const Client::BlockRangeRequest &request,
+                               RangeCallback callback);
+
+private:
+  constexpr static double MAX_SCORE = 1.0;
+  // Peers below this get no chunks; every sync lifts them back to it, so a
+  // peer is retried (last) rather than banned for good
+  constexpr static double MIN_SCORE = 0.1;
+  constexpr static double FAILURE_FACTOR = 0.5;
+  constexpr static double SLOW_FACTOR = 0.8;
+  constexpr static double SUCCESS_STEP = 0.1;
+  /** How long to wait for other peers' chain ends once one peer is usable. */
+  constexpr static std::chrono::milliseconds PROBE_WAIT{ 500 };
+
+  struct Peer {
+    PeerStats stats;
+    std::unique_ptr<Client> client;
+    std::optional<uint64_t> nextBlockId;  // Peer's chain end, once probed
+    size_t inFlight{ 0 };
+  };
+
+  struct Chunk {
+    uint64_t fromId{ 0 };
+    uint64_t count{ 0 };
+  };
+
+  // Responses, posted from the fetch engine thread. Shared with the
+  // callbacks, which may outlive a sync that gave up.
+  struct Completion {
+    size_t peer{ 0 };
+    Chunk chunk;
+    std::chrono::steady_clock::time_point sentTime;
+    std::optional<Client::Roe<Client::CalibrationResponse>> calibration;
+    std::optional<Client::Roe<Client::BlockRange>> range;
+  };
+  struct Inbox {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Completion> completions;
+  };
+
+  struct Buffered {
+    Ledger::ChainNode block;
+    size_t peer{ 0 };
+  };
+
+  /**
+   * Best peer with a free slot whose chain reaches blockId, trusted if
+   * blockId is below trustedEndId; nullopt if none.
+   */
+  std::optional<size_t> choosePeer(uint64_t blockId) const;
+  void requestChunk(size_t peer, const Chunk &chunk);
+  void penalize(Peer &peer, double factor);
+
+  Config config_;
+  std::vector<Peer> peers_;  // Used only by the thread running sync()
+  std::shared_ptr<Inbox> inbox_{ std::make_shared<Inbox>() };
+};
+
+} // namespace pp
+
+#endif // PP_LEDGER_SYNC_SCHEDULER_H
@@ -0,0 +1,112 @@
+#include "BlockSubscription.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace pp;
+
+namespace {
+
+/** Records long polls instead of sending them; the test answers them. */
+class StubSubscription : public BlockSubscription {
+public:
+    std::vector<uint64_t> polledFromIds;
+
+    /** Answer the long poll in flight with blocks `ids`. */
+    void answer(const std::vector<uint64_t> &ids) {
+        ASSERT_TRUE(pending_);
+        Client::BlockRange range;
+        for (uint64_t id : ids) {
+            Ledger::ChainNode block;
+            block.block.index = id;
+            range.blocks.push_back(block);
+        }
+        range.nextBlockId = ids.empty() ? 0 : ids.back() + 1;
+        auto callback = std::move(pending_);
+        pending_ = nullptr;
+        callback(range);
+    }
+
+protected:
+    void subscribe(const Client::BlockSubscribeRequest &request,
+                   RangeCallback callback) override {
+        polledFromIds.push_back(request.fromId);
+        pending_ = std::move(callback);
+    }
+
+private:
+    RangeCallback pending_;
+};
+
+/** Chain stand-in: adds blocks in order, rejecting rejectId. */
+struct TestChain {
+    uint64_t nextBlockId{ 0 };
+    std::optional<uint64_t> rejectId;
+    std::vector<uint64_t> added;
+
+    void addTo(StubSubscription &subscription) {
+        subscription.addBlocks(
+            [this]() { return nextBlockId; },
+            [this](Ledger::ChainNode &block) -> ResultOrError<void, RoeErrorBase> {
+                if (rejectId && block.block.index == *rejectId) {
+                    return RoeErrorBase("invalid block");
+                }
+                added.push_back(block.block.index);
+                ++nextBlockId;
+                return {};
+            });
+    }
+};
+
+class BlockSubscriptionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        BlockSubscription::Config config;
+        config.upstream = { "127.0.0.1", 1 };
+        subscription.start(config);
+        chain.nextBlockId = 3;
+        subscription.poll(chain.nextBlockId);
+        ASSERT_EQ(subscription.polledFromIds, std::vector<uint64_t>{ 3 });
+    }
+
+    StubSubscription subscription;
+    TestChain chain;
+};
+
+} // namespace
+
+TEST_F(BlockSubscriptionTest, AddsPushedBlocksAndPollsFromNewEnd) {
+    subscription.answer({ 2, 3, 4 });  // Block 2 already on the chain
+    chain.addTo(subscription);
+    EXPECT_EQ(chain.added, (std::vector<uint64_t>{ 3, 4 }));
+    EXPECT_TRUE(subscription.isLive());
+    EXPECT_EQ(subscription.polledFromIds, (std::vector<uint64_t>{ 3, 5 }));
+}
+
+TEST_F(BlockSubscriptionTest, GapRenewsFromChainEnd) {
+    subscription.answer({ 5, 6 });
+    chain.addTo(subscription);
+    EXPECT_TRUE(chain.added.empty());
+    EXPECT_EQ(subscription.polledFromIds, (std::vector<uint64_t>{ 3, 3 }));
+}
+
+TEST_F(BlockSubscriptionTest, RejectedBlockBacksOffAndEndsLive) {
+    chain.rejectId = 4;
+    subscription.answer({ 3, 4, 5 });
+    chain.addTo(subscription);
+    EXPECT_EQ(chain.added, std::vector<uint64_t>{ 3 });
+    // Not live, so reads past the chain end sync again; no immediate re-poll
+    EXPECT_FALSE(subscription.isLive());
+    EXPECT_EQ(subscription.polledFromIds, std::vector<uint64_t>{ 3 });
+    chain.addTo(subscription);
+    EXPECT_EQ(subscription.polledFromIds, std::vector<uint64_t>{ 3 });
+
+    std::this_thread::sleep_for(BlockSubscription::RETRY_DELAY +
+                                std::chrono::milliseconds(50));
+    chain.addTo(subscription);
+    EXPECT_EQ(subscription.polledFromIds, (std::vector<uint64_t>{ 3, 4 }));
+}
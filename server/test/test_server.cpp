@@ -0,0 +1,311 @@
+#include "Server.h"
+#include "lib/common/Utilities.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pp;
+
+namespace {
+
+/** Exposes the protected block range helpers; never instantiated. */
+struct ServerAccess : Server {
+    using Server::collectBlockRange;
+    using Server::serveBlockRange;
+};
+
+/** Block i is i % 251 repeated `size` bytes. */
+std::function<std::optional<std::string>(uint64_t)> fixedSizeBlocks(size_t size) {
+    return [size](uint64_t blockId) -> std::optional<std::string> {
+        return std::string(size, static_cast<char>(blockId % 251));
+    };
+}
+
+/** Server without a network: responses are captured, requests recorded. */
+class TestServer : public Server {
+public:
+    struct Sent {
+        network::FetchServer::ReplyTarget target;
+        Client::Response response;
+    };
+
+    using Server::LANE_CONSENSUS;
+    using Server::LANE_DEFAULT;
+    using Server::MAX_BLOCK_SUBSCRIBERS;
+    using Server::admitRequest;
+    using Server::getRequestLane;
+    using Server::initRequestQueue;
+    using Server::pollAndProcessAllRequests;
+
+    std::vector<Sent> sent;
+    std::vector<std::string> handled;  // Payloads of processed requests, in order
+    std::optional<uint64_t> subscriptionEndId;  // Chain end offered to subscribers
+
+    TestServer() { initRequestQueue(); }
+
+    /** Admit a request of `type` from `address`; requestId tells replies apart. */
+    void admit(const std::string &address, uint64_t requestId, uint32_t type,
+               const std::string &payload = "") {
+        Client::Request request;
+        request.type = type;
+        request.payload = payload;
+        network::FetchServer::ReplyTarget target;
+        target.requestId = requestId;
+        admitRequest(target, utl::binaryPack(request), { address, 40000 });
+    }
+
+    /** Admit and process a T_REQ_BLOCK_SUBSCRIBE. */
+    void subscribe(uint64_t requestId, uint64_t fromId, uint64_t maxWaitMs) {
+        Client::BlockSubscribeRequest request;
+        request.fromId = fromId;
+        request.maxWaitMs = maxWaitMs;
+        admit("10.0.0.2", requestId, Client::T_REQ_BLOCK_SUBSCRIBE, utl::binaryPack(request));
+        pollAndProcessAllRequests();
+    }
+
+    /** Block range sent in reply to requestId; nullopt if none was sent. */
+    std::optional<Client::BlockRangeResponse> getReplyRange(uint64_t requestId) const {
+        for (const auto &s : sent) {
+            if (s.target.requestId == requestId) {
+                auto range = utl::binaryUnpack<Client::BlockRangeResponse>(s.response.payload);
+                EXPECT_TRUE(range.isOk());
+                return range.value();
+            }
+        }
+        return std::nullopt;
+    }
+
+    /** Error code of the reply to requestId; nullopt if none was sent. */
+    std::optional<uint16_t> getReplyCode(uint64_t requestId) const {
+        for (const auto &s : sent) {
+            if (s.target.requestId == requestId) {
+                return s.response.errorCode;
+            }
+        }
+        return std::nullopt;
+    }
+
+protected:
+    std::string getSignatureFileName() const override { return "test.sig"; }
+    std::string getLogFileName() const override { return "test.log"; }
+    std::string getServerName() const override { return "TestServer"; }
+    void runLoop() override {}
+
+    std::optional<uint64_t> getSubscriptionEndId() const override { return subscriptionEndId; }
+
+    std::optional<std::string> readSerializedBlock(uint64_t blockId) const override {
+        return "block-" + std::to_string(blockId);
+    }
+
+    std::string handleParsedRequest(const Client::Request &request) override {
+        handled.push_back(request.payload);
+        return packResponse("ok");
+    }
+
+    network::FetchServer::Roe<void> addResponse(const network::FetchServer::ReplyTarget &target,
+                                                std::string response) override {
+        auto unpacked = utl::binaryUnpack<Client::Response>(response);
+        EXPECT_TRUE(unpacked.isOk());
+        sent.push_back({ target, unpacked.value() });
+        return {};
+    }
+};
+
+} // namespace
+
+TEST(ServerRequestQueueTest, OnlyBlockSubmissionsUseTheConsensusLane) {
+    EXPECT_EQ(TestServer::getRequestLane(Client::T_REQ_BLOCK_ADD), TestServer::LANE_CONSENSUS);
+    for (uint32_t type : { Client::T_REQ_MINER_LIST, Client::T_REQ_REGISTER,
+                           Client::T_REQ_CALIBRATION }) {
+        EXPECT_EQ(TestServer::getRequestLane(type), TestServer::LANE_DEFAULT) << type;
+    }
+}
+
+TEST(ServerRequestQueueTest, FloodingPeerCannotCrowdOutBlockSubmissions) {
+    TestServer server;
+    uint64_t requestId = 0;
+    // A peer floods read-only queries and block submissions alike
+    for (int i = 0; i < 3000; ++i) {
+        server.admit("10.0.0.66", ++requestId, Client::T_REQ_MINER_LIST, "flood");
+    }
+    for (int i = 0; i < 100; ++i) {
+        server.admit("10.0.0.66", ++requestId, Client::T_REQ_BLOCK_ADD, "flood-block");
+    }
+    size_t busyQueries = 0;
+    size_t busyBlocks = 0;
+    for (const auto &s : server.sent) {
+        EXPECT_EQ(s.response.errorCode, Client::E_BUSY);
+        ++(s.target.requestId <= 3000 ? busyQueries : busyBlocks);
+    }
+    // About its burst is all it gets (buckets refill while the test runs):
+    // 2000 queries and 20 blocks
+    EXPECT_GE(busyQueries, 500u);
+    EXPECT_GE(busyBlocks, 60u);
+
+    const uint64_t leaderRequest = ++requestId;
+    server.admit("10.0.0.7", leaderRequest, Client::T_REQ_BLOCK_ADD, "leader-block");
+    EXPECT_EQ(server.getReplyCode(leaderRequest), std::nullopt);
+
+    // Block submissions, the leader's included, are processed before any query
+    const size_t blocks = 100 - busyBlocks + 1;
+    server.pollAndProcessAllRequests(blocks);
+    ASSERT_EQ(server.handled.size(), blocks);
+    EXPECT_EQ(server.handled.back(), "leader-block");
+    EXPECT_EQ(std::count(server.handled.begin(), server.handled.end(), "flood"), 0);
+    EXPECT_EQ(server.getReplyCode(leaderRequest), 0);
+}
+
+TEST(ServerBlockSubscribeTest, HeldSubscriberAnsweredWhenBlockAdded) {
+    TestServer server;
+    server.subscriptionEndId = 5;
+    server.subscribe(1, 5, 10000);
+    EXPECT_FALSE(server.getReplyRange(1).has_value());
+
+    // Nothing new yet: still held
+    server.pollAndProcessAllRequests();
+    EXPECT_FALSE(server.getReplyRange(1).has_value());
+
+    server.subscriptionEndId = 6;
+    server.pollAndProcessAllRequests();
+    auto range = server.getReplyRange(1);
+    ASSERT_TRUE(range.has_value());
+    EXPECT_EQ(range->blocks, std::vector<std::string>{ "block-5" });
+    EXPECT_EQ(range->nextBlockId, 6u);
+}
+
+TEST(ServerBlockSubscribeTest, AnswersEmptyAtDeadline) {
+    TestServer server;
+    server.subscriptionEndId = 5;
+    server.subscribe(1, 5, 20);
+    EXPECT_FALSE(server.getReplyRange(1).has_value());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    server.pollAndProcessAllRequests();
+    auto range = server.getReplyRange(1);
+    ASSERT_TRUE(range.has_value());
+    EXPECT_TRUE(range->blocks.empty());
+    EXPECT_EQ(server.getReplyCode(1), 0);
+}
+
+TEST(ServerBlockSubscribeTest, AnswersAtOnceBelowChainEnd) {
+    TestServer server;
+    server.subscriptionEndId = 5;
+    server.subscribe(1, 3, 10000);
+    auto range = server.getReplyRange(1);
+    ASSERT_TRUE(range.has_value());
+    EXPECT_EQ(range->blocks, (std::vector<std::string>{ "block-3", "block-4" }));
+    EXPECT_EQ(range->nextBlockId, 5u);
+}
+
+TEST(ServerBlockSubscribeTest, BusyPastMaxSubscribers) {
+    TestServer server;
+    server.subscriptionEndId = 5;
+    uint64_t requestId = 0;
+    for (size_t i = 0; i < TestServer::MAX_BLOCK_SUBSCRIBERS; ++i) {
+        server.subscribe(++requestId, 5, 10000);
+    }
+    EXPECT_TRUE(server.sent.empty());
+
+    server.subscribe(++requestId, 5, 10000);
+    EXPECT_EQ(server.getReplyCode(requestId), Client::E_BUSY);
+
+    // A block answers all of them and frees the slots
+    server.subscriptionEndId = 6;
+    server.pollAndProcessAllRequests();
+    EXPECT_EQ(server.sent.size(), TestServer::MAX_BLOCK_SUBSCRIBERS + 1);
+    server.subscribe(++requestId, 6, 10000);
+    EXPECT_EQ(server.getReplyCode(requestId), std::nullopt);
+}
+
+TEST(ServerBlockRangeTest, CapsCountAtServerLimit) {
+    Client::BlockRangeRequest request;
+    request.fromId = 5;
+    request.maxCount = 5000;
+    auto response = ServerAccess::collectBlockRange(request, 5000, fixedSizeBlocks(10));
+    EXPECT_EQ(response.blocks.size(), Client::MAX_BLOCK_RANGE_COUNT);
+    EXPECT_EQ(response.nextBlockId, 5 + Client::MAX_BLOCK_RANGE_COUNT);
+}
+
+TEST(ServerBlockRangeTest, CapsBytesAtServerLimit) {
+    const size_t blockSize = 1024 * 1024;
+    Client::BlockRangeRequest request;
+    request.maxBytes = 100 * blockSize;
+    auto response = ServerAccess::collectBlockRange(request, 100, fixedSizeBlocks(blockSize));
+    // Each entry carries an 8-byte length, so 15 whole MiB blocks do not fit
+    EXPECT_EQ(response.blocks.size(), 14u);
+    EXPECT_EQ(response.nextBlockId, 14u);
+}
+
+TEST(ServerBlockRangeTest, IncludesFirstBlockBeyondByteCap) {
+    Client::BlockRangeRequest request;
+    request.fromId = 3;
+    request.maxBytes = 10;
+    auto response = ServerAccess::collectBlockRange(request, 10, fixedSizeBlocks(100));
+    ASSERT_EQ(response.blocks.size(), 1u);
+    EXPECT_EQ(response.blocks[0], std::string(100, '\3'));
+    EXPECT_EQ(response.nextBlockId, 4u);
+}
+
+TEST(ServerBlockRangeTest, ReturnsEmptyRangePastChainEnd) {
+    Client::BlockRangeRequest request;
+    request.fromId = 12;
+    auto response = ServerAccess::collectBlockRange(request, 10, fixedSizeBlocks(10));
+    EXPECT_TRUE(response.blocks.empty());
+    EXPECT_EQ(response.nextBlockId, 12u);
+}
+
+TEST(ServerBlockRangeTest, ZeroMaxCountReturnsOneBlock) {
+    Client::BlockRangeRequest request;
+    request.fromId = 2;
+    request.maxCount = 0;
+    auto response = ServerAccess::collectBlockRange(request, 10, fixedSizeBlocks(10));
+    EXPECT_EQ(response.blocks.size(), 1u);
+    EXPECT_EQ(response.nextBlockId, 3u);
+}
+
+TEST(ServerBlockRangeTest, StopsAtFirstUnreadableBlock) {
+    Client::BlockRangeRequest request;
+    auto readBlock = [](uint64_t blockId) -> std::optional<std::string> {
+        if (blockId == 4) {
+            return std::nullopt;
+        }
+        return std::to_string(blockId);
+    };
+    auto response = ServerAccess::collectBlockRange(request, 10, readBlock);
+    EXPECT_EQ(response.blocks.size(), 4u);
+    EXPECT_EQ(response.nextBlockId, 4u);
+}
+
+TEST(ServerBlockRangeTest, ServeParsesRequestAndAsksEndIdForFromId) {
+    Client::BlockRangeRequest request;
+    request.fromId = 7;
+    request.maxCount = 2;
+    Client::Request wire;
+    wire.type = Client::T_REQ_BLOCK_GET_RANGE;
+    wire.payload = utl::binaryPack(request);
+
+    uint64_t askedFromId = 0;
+    auto result = ServerAccess::serveBlockRange(
+        wire, [&](uint64_t fromId) { askedFromId = fromId; return uint64_t(20); },
+        fixedSizeBlocks(4));
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(askedFromId, 7u);
+    auto response = utl::binaryUnpack<Client::BlockRangeResponse>(result.value());
+    ASSERT_TRUE(response.isOk());
+    EXPECT_EQ(response.value().blocks.size(), 2u);
+    EXPECT_EQ(response.value().nextBlockId, 9u);
+
+    // Nothing to serve at the chain end, and garbage payloads, are errors
+    EXPECT_TRUE(ServerAccess::serveBlockRange(
+                    wire, [](uint64_t) { return uint64_t(7); }, fixedSizeBlocks(4))
+                    .isError());
+    wire.payload = "x";
+    EXPECT_TRUE(ServerAccess::serveBlockRange(
+                    wire, [](uint64_t) { return uint64_t(20); }, fixedSizeBlocks(4))
+                    .isError());
+}
@@ -0,0 +1,251 @@
+#include "SyncScheduler.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace pp;
+
+namespace {
+
+/** Answers from in-memory peers instead of the network, on the sync thread. */
+class StubSyncScheduler : public SyncScheduler {
+public:
+    struct StubPeer {
+        uint64_t nextBlockId{ 0 };
+        uint64_t maxBlocks{ std::numeric_limits<uint64_t>::max() };  // Per response
+        bool isFailing{ false };
+        bool isForging{ false };  // Serves blocks with nonce 1, which addBlock rejects
+    };
+
+    struct Request {
+        size_t peer{ 0 };
+        uint64_t fromId{ 0 };
+        uint64_t count{ 0 };
+    };
+
+    std::vector<StubPeer> stubs;  // By peer index
+    std::vector<Request> requests;
+    // Hold this many range responses, then answer them in reverse order
+    size_t holdCount{ 0 };
+
+protected:
+    void fetchCalibration(size_t peer, CalibrationCallback callback) override {
+        Client::CalibrationResponse response;
+        response.nextBlockId = stubs[peer].nextBlockId;
+        callback(response);
+    }
+
+    void fetchBlockRange(size_t peer, const Client::BlockRangeRequest &request,
+                         RangeCallback callback) override {
+        requests.push_back({ peer, request.fromId, request.maxCount });
+        const auto &stub = stubs[peer];
+        Client::Roe<Client::BlockRange> result = Client::Error(-1, "stub failure");
+        if (!stub.isFailing) {
+            Client::BlockRange range;
+            const uint64_t count = std::min(request.maxCount, stub.maxBlocks);
+            for (uint64_t id = request.fromId; id < request.fromId + count; ++id) {
+                Ledger::ChainNode block;
+                block.block.index = id;
+                block.block.nonce = stub.isForging ? 1 : 0;
+                range.blocks.push_back(block);
+            }
+            range.nextBlockId = request.fromId + count;
+            result = range;
+        }
+        if (holdCount == 0) {
+            callback(result);
+            return;
+        }
+        held_.emplace_back(std::move(callback), result);
+        if (held_.size() == holdCount) {
+            holdCount = 0;
+            for (auto it = held_.rbegin(); it != held_.rend(); ++it) {
+                it->first(it->second);
+            }
+            held_.clear();
+        }
+    }
+
+private:
+    std::vector<std::pair<RangeCallback, Client::Roe<Client::BlockRange>>> held_;
+};
+
+network::IpEndpoint endpoint(uint16_t port) { return { "10.0.0.1", port }; }
+
+const network::IpEndpoint SELF{ "10.0.0.9", 9000 };
+
+struct AddedBlocks {
+    std::vector<uint64_t> ids;
+
+    SyncScheduler::AddBlock addBlock() {
+        return [this](Ledger::ChainNode &block) -> SyncScheduler::Roe<void> {
+            if (block.block.nonce != 0) {
+                return SyncScheduler::Error(-1, "forged block");
+            }
+            ids.push_back(block.block.index);
+            return {};
+        };
+    }
+};
+
+std::vector<uint64_t> idsFrom(uint64_t fromId, uint64_t endId) {
+    std::vector<uint64_t> ids;
+    for (uint64_t id = fromId; id < endId; ++id) {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+} // namespace
+
+TEST(SyncSchedulerTest, SetPeersPutsTrustedFirstAndSkipsSelfAndDuplicates) {
+    StubSyncScheduler scheduler;
+    SyncScheduler::Config config;
+    config.maxDiscoveredPeers = 2;
+    scheduler.setConfig(config);
+    scheduler.setPeers({ endpoint(1) },
+                       { endpoint(1), SELF, { "127.0.0.1", SELF.port }, endpoint(2),
+                         endpoint(3), endpoint(4) },
+                       SELF);
+
+    auto stats = scheduler.getPeerStats();
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[0].endpoint.port, 1);
+    EXPECT_TRUE(stats[0].isTrusted);
+    EXPECT_EQ(stats[1].endpoint.port, 2);
+    EXPECT_FALSE(stats[1].isTrusted);
+    EXPECT_EQ(stats[2].endpoint.port, 3);
+    EXPECT_FALSE(stats[2].isTrusted);
+}
+
+TEST(SyncSchedulerTest, AddsInOrderWhenChunksCompleteOutOfOrder) {
+    StubSyncScheduler scheduler;
+    SyncScheduler::Config config;
+    config.chunkSize = 10;
+    config.maxInFlightPerPeer = 3;
+    scheduler.setConfig(config);
+    scheduler.setPeers({ endpoint(1) }, {}, SELF);
+    scheduler.stubs = { { 30 } };
+    scheduler.holdCount = 3;
+
+    AddedBlocks added;
+    auto result = scheduler.sync(0, 30, added.addBlock());
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(result.value(), 30u);
+    EXPECT_EQ(added.ids, idsFrom(0, 30));
+    ASSERT_EQ(scheduler.requests.size(), 3u);
+    EXPECT_EQ(scheduler.requests[0].fromId, 0u);
+    EXPECT_EQ(scheduler.requests[1].fromId, 10u);
+    EXPECT_EQ(scheduler.requests[2].fromId, 20u);
+}
+
+TEST(SyncSchedulerTest, ShortRangeRequeuesRemainder) {
+    StubSyncScheduler scheduler;
+    SyncScheduler::Config config;
+    config.chunkSize = 10;
+    scheduler.setConfig(config);
+    scheduler.setPeers({ endpoint(1) }, {}, SELF);
+    scheduler.stubs = { { 10, 4 } };
+
+    AddedBlocks added;
+    auto result = scheduler.sync(0, 10, added.addBlock());
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(added.ids, idsFrom(0, 10));
+    ASSERT_EQ(scheduler.requests.size(), 3u);
+    EXPECT_EQ(scheduler.requests[0].fromId, 0u);
+    EXPECT_EQ(scheduler.requests[0].count, 10u);
+    EXPECT_EQ(scheduler.requests[1].fromId, 4u);
+    EXPECT_EQ(scheduler.requests[1].count, 6u);
+    EXPECT_EQ(scheduler.requests[2].fromId, 8u);
+    EXPECT_EQ(scheduler.requests[2].count, 2u);
+}
+
+TEST(SyncSchedulerTest, RejectedBlockRefetchesBadPeerBlocksFromOthers) {
+    StubSyncScheduler scheduler;
+    SyncScheduler::Config config;
+    config.chunkSize = 10;
+    config.maxInFlightPerPeer = 1;
+    scheduler.setConfig(config);
+    scheduler.setPeers({ endpoint(1), endpoint(2) }, {}, SELF);
+    StubSyncScheduler::StubPeer forger{ 40 };
+    forger.isForging = true;
+    scheduler.stubs = { forger, { 40 } };
+
+    AddedBlocks added;
+    auto result = scheduler.sync(0, 40, added.addBlock());
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(added.ids, idsFrom(0, 40));
+
+    // The forger got the first chunk; everything after its rejection went to
+    // the honest peer, including the chunk the forger had served
+    ASSERT_FALSE(scheduler.requests.empty());
+    EXPECT_EQ(scheduler.requests[0].peer, 0u);
+    size_t refetched = 0;
+    for (size_t i = 1; i < scheduler.requests.size(); ++i) {
+        if (scheduler.requests[i].fromId == 0) {
+            EXPECT_EQ(scheduler.requests[i].peer, 1u);
+            ++refetched;
+        }
+    }
+    EXPECT_EQ(refetched, 1u);
+
+    auto stats = scheduler.getPeerStats();
+    EXPECT_EQ(stats[0].score, 0);
+    EXPECT_EQ(stats[0].blocks, 0u);
+    EXPECT_EQ(stats[0].failures, 1u);
+    EXPECT_EQ(stats[1].blocks, 40u);
+}
+
+TEST(SyncSchedulerTest, NoPeerWhenAllScoresFallBelowMinimum) {
+    StubSyncScheduler scheduler;
+    SyncScheduler::Config config;
+    config.chunkSize = 10;
+    scheduler.setConfig(config);
+    scheduler.setPeers({ endpoint(1), endpoint(2) }, {}, SELF);
+    StubSyncScheduler::StubPeer failing{ 20 };
+    failing.isFailing = true;
+    scheduler.stubs = { failing, failing };
+
+    AddedBlocks added;
+    auto result = scheduler.sync(0, 20, added.addBlock());
+    ASSERT_FALSE(result.isOk());
+    EXPECT_EQ(result.error().code, SyncScheduler::E_NO_PEER);
+    EXPECT_TRUE(added.ids.empty());
+    for (const auto &stats : scheduler.getPeerStats()) {
+        EXPECT_LT(stats.score, 0.1);
+        EXPECT_GT(stats.failures, 0u);
+    }
+}
+
+TEST(SyncSchedulerTest, DiscoveredPeersGetNoBlocksBelowTrustedEnd) {
+    StubSyncScheduler scheduler;
+    SyncScheduler::Config config;
+    config.chunkSize = 10;
+    config.maxInFlightPerPeer = 1;
+    config.trustedEndId = 20;
+    scheduler.setConfig(config);
+    scheduler.setPeers({ endpoint(1) }, { endpoint(2) }, SELF);
+    StubSyncScheduler::StubPeer forger{ 40 };
+    forger.isForging = true;
+    scheduler.stubs = { { 40 }, forger };
+
+    AddedBlocks added;
+    auto result = scheduler.sync(0, 20, added.addBlock());
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_EQ(added.ids, idsFrom(0, 20));
+    for (const auto &request : scheduler.requests) {
+        EXPECT_EQ(request.peer, 0u);
+    }
+
+    // Past trustedEndId the discovered peer takes chunks again
+    scheduler.requests.clear();
+    scheduler.stubs[1].isForging = false;
+    result = scheduler.sync(20, 40, added.addBlock());
+    ASSERT_TRUE(result.isOk()) << result.error().message;
+    EXPECT_TRUE(std::any_of(scheduler.requests.begin(), scheduler.requests.end(),
+                            [](const auto &request) { return request.peer == 1; }));
+}